@@ -0,0 +1,133 @@
+#version 460 core
+
+// specialized by ShaderVariants - the following defines are
+// injected after the version line when a variant is compiled
+//   USE_TEXTURE  - color comes from the draw's texture slot
+//   USE_LIGHTING - the Phong light model is applied
+//   NUM_LIGHTS   - number of active entries in lightSources[]
+//   USE_LIGHTMAP - the light comes from the baked lightmap
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS 4
+#endif
+
+// maximum number of texture slots bound by SceneManager, defined
+// by ShaderVariants from ShaderVariants::MAX_TEXTURE_SLOTS
+#ifndef MAX_TEXTURE_SLOTS
+#define MAX_TEXTURE_SLOTS 15
+#endif
+// maximum number of views drawn in one pass, must match
+// ShaderVariants::MAX_VIEWS
+#define MAX_VIEWS 4
+
+struct LightSource
+{
+	vec3 position;
+	vec3 ambientColor;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float focalStrength;
+	float specularIntensity;
+};
+
+// per-draw values written by IndirectDraws, must match DRAW_RECORD
+struct DrawRecord
+{
+	mat4 model;
+	vec4 color;
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	vec2 uvScale;
+	int textureSlot;
+	int lightmapFirst;
+};
+
+layout (std430, binding = 0) readonly buffer DrawRecords
+{
+	DrawRecord draws[];
+};
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in int drawIndex;
+flat in int viewIndex;
+
+out vec4 outFragmentColor;
+
+#ifdef USE_TEXTURE
+// the textures are bound to the units matching their slots
+layout (binding = 0) uniform sampler2D objectTextures[MAX_TEXTURE_SLOTS];
+#endif
+
+#ifdef USE_LIGHTMAP
+// baked ambient and diffuse light of the static surfaces, on the
+// unit after the texture slots
+layout (binding = MAX_TEXTURE_SLOTS) uniform sampler2D lightmap;
+in vec2 fragmentLightmapCoordinate;
+#endif
+
+#ifdef USE_LIGHTING
+// camera position of each view drawn in one pass
+uniform vec3 viewPositions[MAX_VIEWS];
+#if NUM_LIGHTS > 0
+uniform LightSource lightSources[NUM_LIGHTS];
+#endif
+
+/***********************************************************
+ *  CalcLightSource()
+ *
+ *  Calculate the ambient, diffuse and specular contribution
+ *  of a single light source for the current fragment.
+ ***********************************************************/
+vec3 CalcLightSource(LightSource light, DrawRecord draw, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+	// ambient lighting
+	vec3 ambient = light.ambientColor * draw.ambientColor.rgb;
+
+	// diffuse lighting
+	vec3 lightDirection = normalize(light.position - vertexPosition);
+	float impact = max(dot(lightNormal, lightDirection), 0.0f);
+	vec3 diffuse = impact * light.diffuseColor * draw.diffuseColor.rgb;
+
+	// specular lighting
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+	vec3 specular = light.specularIntensity * specularComponent * light.specularColor * draw.specularColor.rgb;
+
+	return(ambient + diffuse + specular);
+}
+#endif
+
+void main()
+{
+	DrawRecord draw = draws[drawIndex];
+
+#ifdef USE_TEXTURE
+	// the slot is the same for every fragment of a draw
+	vec4 baseColor = texture(objectTextures[draw.textureSlot], fragmentTextureCoordinate * draw.uvScale);
+#else
+	vec4 baseColor = draw.color;
+#endif
+
+#if defined(USE_LIGHTMAP)
+	// a single fetch replaces the light model
+	vec3 bakedLight = texture(lightmap, fragmentLightmapCoordinate).rgb;
+	outFragmentColor = vec4(bakedLight * baseColor.xyz, baseColor.a);
+#elif defined(USE_LIGHTING)
+	vec3 lightNormal = normalize(fragmentVertexNormal);
+	vec3 viewDirection = normalize(viewPositions[viewIndex] - fragmentPosition);
+	vec3 phongResult = vec3(0.0f);
+
+#if NUM_LIGHTS > 0
+	for (int i = 0; i < NUM_LIGHTS; i++)
+	{
+		phongResult += CalcLightSource(lightSources[i], draw, lightNormal, fragmentPosition, viewDirection);
+	}
+#endif
+
+	outFragmentColor = vec4(phongResult * baseColor.xyz, baseColor.a);
+#else
+	outFragmentColor = baseColor;
+#endif
+}
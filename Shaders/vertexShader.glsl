@@ -0,0 +1,111 @@
+#version 460 core
+
+// specialized by ShaderVariants - USE_LIGHTING is defined only
+// for the variants that run the light model, COMPACT_VERTICES
+// when the mesh buffer holds quantized vertices, and USE_LIGHTMAP
+// for the static surfaces with baked lighting
+layout (location = 0) in vec3 inVertexPosition;
+#ifdef COMPACT_VERTICES
+// octahedral encoded normal - the positions are 0..1 within the
+// mesh bounds, which are folded into the model matrix
+layout (location = 1) in vec2 inVertexNormal;
+#else
+layout (location = 1) in vec3 inVertexNormal;
+#endif
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// maximum number of views drawn in one pass, must match
+// ShaderVariants::MAX_VIEWS
+#define MAX_VIEWS 4
+
+// per-draw values written by IndirectDraws, must match DRAW_RECORD
+struct DrawRecord
+{
+	mat4 model;
+	vec4 color;
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	vec2 uvScale;
+	int textureSlot;
+	int lightmapFirst;
+};
+
+layout (std430, binding = 0) readonly buffer DrawRecords
+{
+	DrawRecord draws[];
+};
+
+#ifdef USE_LIGHTMAP
+// lightmap coordinate of every baked vertex, starting at the
+// draw's lightmapFirst for the first vertex of its mesh
+layout (std430, binding = 1) readonly buffer LightmapCoordinates
+{
+	vec2 lightmapCoordinates[];
+};
+
+out vec2 fragmentLightmapCoordinate;
+#endif
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out int drawIndex;
+flat out int viewIndex;
+
+// each instance of a draw is one view - its projection times
+// view, and the part of the target it covers as a scale and
+// offset in normalized device coordinates
+uniform mat4 viewProjections[MAX_VIEWS];
+uniform vec4 viewRects[MAX_VIEWS];
+// index of the first record of the current multi-draw call
+uniform int firstDraw;
+
+#ifdef COMPACT_VERTICES
+// expand an octahedral encoded normal to a unit vector
+vec3 DecodeNormal(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0f);
+	normal.x += (normal.x >= 0.0f) ? -fold : fold;
+	normal.y += (normal.y >= 0.0f) ? -fold : fold;
+	return(normalize(normal));
+}
+#endif
+
+void main()
+{
+#ifdef COMPACT_VERTICES
+	vec3 vertexNormal = DecodeNormal(inVertexNormal);
+#else
+	vec3 vertexNormal = inVertexNormal;
+#endif
+
+	drawIndex = firstDraw + gl_DrawID;
+	mat4 model = draws[drawIndex].model;
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0f);
+
+	viewIndex = gl_InstanceID;
+	vec4 clipPosition = viewProjections[viewIndex] * worldPosition;
+
+	// the view is clipped to its own frustum, then moved into its
+	// rectangle so it cannot spill over into the other views
+	gl_ClipDistance[0] = clipPosition.w + clipPosition.x;
+	gl_ClipDistance[1] = clipPosition.w - clipPosition.x;
+	gl_ClipDistance[2] = clipPosition.w + clipPosition.y;
+	gl_ClipDistance[3] = clipPosition.w - clipPosition.y;
+	gl_Position = vec4(
+		clipPosition.xy * viewRects[viewIndex].xy + viewRects[viewIndex].zw * clipPosition.w,
+		clipPosition.zw);
+	fragmentPosition = vec3(worldPosition);
+#ifdef USE_LIGHTING
+	// normals only need the inverse transpose when they are lit
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * vertexNormal;
+#else
+	fragmentVertexNormal = vertexNormal;
+#endif
+	fragmentTextureCoordinate = inTextureCoordinate;
+#ifdef USE_LIGHTMAP
+	fragmentLightmapCoordinate = lightmapCoordinates[draws[drawIndex].lightmapFirst + gl_VertexID - gl_BaseVertex];
+#endif
+}
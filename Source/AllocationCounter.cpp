@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the general heap allocations made by each thread, for checking
+// that the render path does not allocate in steady frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// allocations made by the thread through operator new
+	thread_local unsigned long long t_allocationCount = 0;
+
+#if defined(__cpp_aligned_new)
+	// get memory aligned beyond what malloc() guarantees - it
+	// must be freed with FreeAligned()
+	void* AllocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		std::size_t bytes = (size > 0) ? size : 1;
+#if defined(_WIN32)
+		return(_aligned_malloc(bytes, (std::size_t)alignment));
+#else
+		// the size must be a multiple of the alignment
+		std::size_t mask = (std::size_t)alignment - 1;
+		return(std::aligned_alloc((std::size_t)alignment, (bytes + mask) & ~mask));
+#endif
+	}
+
+	void FreeAligned(void* pMemory)
+	{
+#if defined(_WIN32)
+		_aligned_free(pMemory);
+#else
+		std::free(pMemory);
+#endif
+	}
+#endif
+}
+
+/***********************************************************
+ *  operator new()
+ *
+ *  The replaced global allocation function.  Every other
+ *  form of new below forwards to it, or counts the same
+ *  way, so no allocation is missed by the count.
+ ***********************************************************/
+void* operator new(std::size_t size)
+{
+	t_allocationCount++;
+
+	void* pMemory = std::malloc((size > 0) ? size : 1);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+/***********************************************************
+ *  operator delete()
+ *
+ *  The replaced global deallocation function.
+ ***********************************************************/
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+/***********************************************************
+ *  operator new[]()
+ *
+ *  The array, nothrow and sized forms, which must match the
+ *  replaced pair, as the library's own versions may not
+ *  forward to it.
+ ***********************************************************/
+void* operator new[](std::size_t size)
+{
+	return(operator new(size));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return(operator new(size));
+	}
+	catch (const std::bad_alloc&)
+	{
+		return(NULL);
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return(operator new(size, std::nothrow));
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	operator delete(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	operator delete(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t) noexcept
+{
+	operator delete(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	operator delete(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	operator delete(pMemory);
+}
+
+#if defined(__cpp_aligned_new)
+/***********************************************************
+ *  operator new()
+ *
+ *  The forms for types aligned beyond what malloc()
+ *  guarantees, counted like the others.  Their memory is
+ *  only freed by the aligned forms of delete.
+ ***********************************************************/
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	t_allocationCount++;
+
+	void* pMemory = AllocateAligned(size, alignment);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return(operator new(size, alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	t_allocationCount++;
+	return(AllocateAligned(size, alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return(operator new(size, alignment, std::nothrow));
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pMemory);
+}
+#endif
+
+/***********************************************************
+ *  GetThreadCount()
+ *
+ *  This method is used for getting the number of heap
+ *  allocations the calling thread has made.  The difference
+ *  between two calls is the count of the code in between.
+ ***********************************************************/
+unsigned long long AllocationCounter::GetThreadCount()
+{
+	return(t_allocationCount);
+}
@@ -0,0 +1,24 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the general heap allocations made by each thread, for checking
+// that the render path does not allocate in steady frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  This class contains the code for reading the number of
+ *  heap allocations made through operator new, which is
+ *  replaced in AllocationCounter.cpp.  Each thread has its
+ *  own count, so loader and worker threads do not show up
+ *  in the frames of the render thread.
+ ***********************************************************/
+class AllocationCounter
+{
+public:
+	// heap allocations made by the calling thread so far
+	static unsigned long long GetThreadCount();
+};
@@ -0,0 +1,536 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// read the textures, shaders and meshes in place from one memory-mapped
+// archive file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// "APAK" and the layout version of the archive
+	const uint32_t PACK_MAGIC = 0x4B415041;
+	const uint32_t PACK_VERSION = 1;
+	// payloads start on a cache line
+	const size_t PAYLOAD_ALIGNMENT = 64;
+	// an entry is only stored compressed when that saves at
+	// least an eighth of its size
+	const size_t COMPRESSION_MIN_SAVING = 8;
+
+	// the codec matches runs of at least four bytes up to 64KB
+	// back, found through a hash of the next four bytes
+	const size_t MIN_MATCH = 4;
+	const size_t MAX_OFFSET = 65535;
+	const int MATCH_HASH_BITS = 16;
+
+	// archive paths use forward slashes on every platform
+	std::string NormalizeName(const char* name)
+	{
+		std::string normalized = name;
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		return(normalized);
+	}
+
+	uint32_t Read32(const unsigned char* pData)
+	{
+		uint32_t value;
+		memcpy(&value, pData, sizeof(value));
+		return(value);
+	}
+
+	// write a length that did not fit in its token nibble as
+	// a run of 255 bytes and the remainder
+	void WriteLength(std::vector<unsigned char>& output, size_t length)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+		output.push_back((unsigned char)length);
+	}
+
+	bool ReadLength(const unsigned char*& pInput, const unsigned char* pEnd, size_t& length)
+	{
+		unsigned char value = 255;
+		while (value == 255)
+		{
+			if (pInput >= pEnd)
+			{
+				return(false);
+			}
+			value = *pInput++;
+			length += value;
+		}
+		return(true);
+	}
+
+	// write the literals before a match, and the match - the
+	// last sequence of a payload has no match
+	void WriteSequence(std::vector<unsigned char>& output, const unsigned char* pLiterals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		size_t matchCode = (matchLength > 0) ? matchLength - MIN_MATCH : 0;
+		output.push_back((unsigned char)((std::min(literalCount, (size_t)15) << 4) | std::min(matchCode, (size_t)15)));
+		if (literalCount >= 15)
+		{
+			WriteLength(output, literalCount - 15);
+		}
+		output.insert(output.end(), pLiterals, pLiterals + literalCount);
+
+		if (matchLength > 0)
+		{
+			output.push_back((unsigned char)(offset & 0xFF));
+			output.push_back((unsigned char)(offset >> 8));
+			if (matchCode >= 15)
+			{
+				WriteLength(output, matchCode - 15);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_lookupCount = 0;
+	m_servedBytes = 0;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the archive and checking
+ *  its index.  Nothing but the header and the index is
+ *  touched, so the payloads are only paged in when found.
+ ***********************************************************/
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+
+	if (m_file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	const PACK_HEADER* pHeader = (const PACK_HEADER*)m_file.GetData();
+	if ((m_file.GetSize() < sizeof(PACK_HEADER)) || (pHeader->magic != PACK_MAGIC) || (pHeader->version != PACK_VERSION))
+	{
+		std::cout << "Not an asset pack of this version:" << filename << std::endl;
+		m_file.Close();
+		return(false);
+	}
+
+	m_pEntries = (const PACK_ENTRY*)(m_file.GetData() + sizeof(PACK_HEADER));
+	m_entryCount = (int)pHeader->entryCount;
+	if (ValidateIndex() == false)
+	{
+		std::cout << "Asset pack index is damaged:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the archive.  The bytes
+ *  handed out by Find() are no longer valid afterwards.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	std::lock_guard<std::mutex> lock(m_unpackMutex);
+	m_unpacked.clear();
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_file.Close();
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether an archive is
+ *  mapped.
+ ***********************************************************/
+bool AssetPack::IsOpen()
+{
+	return(m_file.IsOpen());
+}
+
+/***********************************************************
+ *  ValidateIndex()
+ *
+ *  This method is used for checking that every index entry,
+ *  name and payload lies inside the mapped file, so a
+ *  truncated or damaged archive is never read past its end.
+ ***********************************************************/
+bool AssetPack::ValidateIndex()
+{
+	uint64_t fileSize = m_file.GetSize();
+	if ((uint64_t)m_entryCount * sizeof(PACK_ENTRY) > fileSize - sizeof(PACK_HEADER))
+	{
+		return(false);
+	}
+
+	for (int i = 0; i < m_entryCount; i++)
+	{
+		const PACK_ENTRY& entry = m_pEntries[i];
+		if (((uint64_t)entry.nameOffset + entry.nameLength > fileSize) ||
+			(entry.offset > fileSize) || (entry.storedSize > fileSize - entry.offset) ||
+			((entry.compression != COMPRESSION_NONE) && (entry.compression != COMPRESSION_LZ)) ||
+			((entry.compression == COMPRESSION_NONE) && (entry.storedSize != entry.size)))
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding an entry by a binary
+ *  search of the index, which is sorted by name.
+ ***********************************************************/
+int AssetPack::FindEntry(const std::string& name)
+{
+	int low = 0;
+	int high = m_entryCount - 1;
+	while (low <= high)
+	{
+		int middle = (low + high) / 2;
+		const PACK_ENTRY& entry = m_pEntries[middle];
+		int order = name.compare(0, name.size(), (const char*)m_file.GetData() + entry.nameOffset, entry.nameLength);
+		if (order == 0)
+		{
+			return(middle);
+		}
+		if (order < 0)
+		{
+			high = middle - 1;
+		}
+		else
+		{
+			low = middle + 1;
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for getting the bytes of an asset.
+ *  Stored entries point into the mapping without a copy.
+ *  Compressed entries are unpacked on their first lookup
+ *  and the unpacked bytes are kept, so later lookups are
+ *  free as well.  The loaders may run on several threads.
+ ***********************************************************/
+bool AssetPack::Find(const char* name, const unsigned char** ppData, size_t* pSize)
+{
+	int index = (IsOpen() == true) ? FindEntry(NormalizeName(name)) : -1;
+	if (index < 0)
+	{
+		return(false);
+	}
+
+	const PACK_ENTRY& entry = m_pEntries[index];
+	const unsigned char* pStored = m_file.GetData() + entry.offset;
+
+	std::lock_guard<std::mutex> lock(m_unpackMutex);
+	if (entry.compression == COMPRESSION_NONE)
+	{
+		*ppData = pStored;
+	}
+	else
+	{
+		std::map<int, std::vector<unsigned char> >::iterator it = m_unpacked.find(index);
+		if (it == m_unpacked.end())
+		{
+			std::vector<unsigned char> unpacked((size_t)entry.size);
+			if (Decompress(pStored, (size_t)entry.storedSize, unpacked.data(), unpacked.size()) == false)
+			{
+				std::cout << "Could not unpack asset:" << name << std::endl;
+				return(false);
+			}
+			it = m_unpacked.insert(std::make_pair(index, std::vector<unsigned char>())).first;
+			it->second.swap(unpacked);
+		}
+		*ppData = it->second.data();
+	}
+	*pSize = (size_t)entry.size;
+
+	m_lookupCount++;
+	m_servedBytes += (size_t)entry.size;
+	return(true);
+}
+
+/***********************************************************
+ *  Compress()
+ *
+ *  This method is used for compressing a payload into
+ *  sequences of literal bytes, each followed by a copy of
+ *  earlier output.  A sequence starts with a token holding
+ *  the literal count and the match length in a nibble each,
+ *  and the match is stored as a 16 bit offset back.
+ ***********************************************************/
+void AssetPack::Compress(const unsigned char* pData, size_t size, std::vector<unsigned char>& output)
+{
+	output.clear();
+	output.reserve(size + size / 255 + 16);
+
+	std::vector<int64_t> lastPositions((size_t)1 << MATCH_HASH_BITS, -1);
+	size_t anchor = 0;
+	size_t position = 0;
+	while (position + MIN_MATCH <= size)
+	{
+		uint32_t sequence = Read32(pData + position);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - MATCH_HASH_BITS);
+		int64_t candidate = lastPositions[hash];
+		lastPositions[hash] = (int64_t)position;
+
+		if ((candidate < 0) || (position - (size_t)candidate > MAX_OFFSET) || (Read32(pData + candidate) != sequence))
+		{
+			position++;
+			continue;
+		}
+
+		size_t matchLength = MIN_MATCH;
+		while ((position + matchLength < size) && (pData[candidate + matchLength] == pData[position + matchLength]))
+		{
+			matchLength++;
+		}
+
+		WriteSequence(output, pData + anchor, position - anchor, position - (size_t)candidate, matchLength);
+		position += matchLength;
+		anchor = position;
+	}
+
+	WriteSequence(output, pData + anchor, size - anchor, 0, 0);
+}
+
+/***********************************************************
+ *  Decompress()
+ *
+ *  This method is used for unpacking a compressed payload
+ *  into a buffer of its unpacked size.  Every length and
+ *  offset is checked, so a damaged payload fails instead
+ *  of writing past the buffer.
+ ***********************************************************/
+bool AssetPack::Decompress(const unsigned char* pData, size_t storedSize, unsigned char* pOutput, size_t size)
+{
+	const unsigned char* pInput = pData;
+	const unsigned char* pEnd = pData + storedSize;
+	size_t written = 0;
+
+	while (pInput < pEnd)
+	{
+		unsigned char token = *pInput++;
+
+		size_t literalCount = token >> 4;
+		if ((literalCount == 15) && (ReadLength(pInput, pEnd, literalCount) == false))
+		{
+			return(false);
+		}
+		if ((literalCount > (size_t)(pEnd - pInput)) || (literalCount > size - written))
+		{
+			return(false);
+		}
+		memcpy(pOutput + written, pInput, literalCount);
+		pInput += literalCount;
+		written += literalCount;
+
+		// the last sequence ends with its literals
+		if (pInput == pEnd)
+		{
+			break;
+		}
+
+		if (pEnd - pInput < 2)
+		{
+			return(false);
+		}
+		size_t offset = pInput[0] | ((size_t)pInput[1] << 8);
+		pInput += 2;
+		size_t matchLength = token & 0x0F;
+		if ((matchLength == 15) && (ReadLength(pInput, pEnd, matchLength) == false))
+		{
+			return(false);
+		}
+		matchLength += MIN_MATCH;
+		if ((offset == 0) || (offset > written) || (matchLength > size - written))
+		{
+			return(false);
+		}
+
+		// the copy may overlap its own output, so it goes byte by
+		// byte to repeat short runs
+		const unsigned char* pMatch = pOutput + written - offset;
+		for (size_t i = 0; i < matchLength; i++)
+		{
+			pOutput[written + i] = pMatch[i];
+		}
+		written += matchLength;
+	}
+
+	return(written == size);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for writing an archive of the passed
+ *  in files, each stored under its path.  A file is stored
+ *  compressed only when that makes it clearly smaller, so
+ *  the already compressed images are left as they are and
+ *  stay readable in place.
+ ***********************************************************/
+bool AssetPack::Build(const char* filename, const std::vector<std::string>& assetFiles)
+{
+	struct BUILD_ENTRY
+	{
+		std::string name;
+		std::vector<unsigned char> payload;
+		PACK_ENTRY entry;
+	};
+
+	std::vector<BUILD_ENTRY> entries(assetFiles.size());
+	for (size_t i = 0; i < assetFiles.size(); i++)
+	{
+		MappedFile file;
+		if (file.Open(assetFiles[i].c_str()) == false)
+		{
+			return(false);
+		}
+
+		BUILD_ENTRY& build = entries[i];
+		build.name = NormalizeName(assetFiles[i].c_str());
+		memset(&build.entry, 0, sizeof(build.entry));
+		build.entry.size = file.GetSize();
+
+		Compress(file.GetData(), file.GetSize(), build.payload);
+		if (build.payload.size() * COMPRESSION_MIN_SAVING <= file.GetSize() * (COMPRESSION_MIN_SAVING - 1))
+		{
+			build.entry.compression = COMPRESSION_LZ;
+		}
+		else
+		{
+			build.payload.assign(file.GetData(), file.GetData() + file.GetSize());
+			build.entry.compression = COMPRESSION_NONE;
+		}
+		build.entry.storedSize = build.payload.size();
+	}
+
+	// the index is searched by name
+	std::sort(entries.begin(), entries.end(),
+		[](const BUILD_ENTRY& a, const BUILD_ENTRY& b) { return(a.name < b.name); });
+	for (size_t i = 1; i < entries.size(); i++)
+	{
+		if (entries[i].name == entries[i - 1].name)
+		{
+			std::cout << "Asset pack lists a file twice:" << entries[i].name << std::endl;
+			return(false);
+		}
+	}
+
+	// the names follow the index, then the aligned payloads
+	uint64_t offset = sizeof(PACK_HEADER) + entries.size() * sizeof(PACK_ENTRY);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		entries[i].entry.nameOffset = (uint32_t)offset;
+		entries[i].entry.nameLength = (uint32_t)entries[i].name.size();
+		offset += entries[i].name.size();
+	}
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		offset = (offset + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+		entries[i].entry.offset = offset;
+		offset += entries[i].entry.storedSize;
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Could not write asset pack:" << filename << std::endl;
+		return(false);
+	}
+
+	PACK_HEADER header;
+	header.magic = PACK_MAGIC;
+	header.version = PACK_VERSION;
+	header.entryCount = (uint32_t)entries.size();
+	header.reserved = 0;
+	file.write((const char*)&header, sizeof(header));
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		file.write((const char*)&entries[i].entry, sizeof(PACK_ENTRY));
+	}
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		file.write(entries[i].name.data(), entries[i].name.size());
+	}
+
+	size_t storedBytes = 0;
+	size_t assetBytes = 0;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		// pad up to the payload's aligned offset
+		static const char padding[PAYLOAD_ALIGNMENT] = { 0 };
+		file.write(padding, (std::streamsize)(entries[i].entry.offset - (uint64_t)file.tellp()));
+		file.write((const char*)entries[i].payload.data(), entries[i].payload.size());
+
+		storedBytes += entries[i].payload.size();
+		assetBytes += (size_t)entries[i].entry.size;
+	}
+
+	if (!file)
+	{
+		std::cout << "Could not write asset pack:" << filename << std::endl;
+		return(false);
+	}
+
+	std::cout << "Asset pack: wrote " << entries.size() << " assets to " << filename << ", "
+		<< assetBytes << " bytes stored in " << storedBytes << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing how many assets were
+ *  read from the archive, and how many of them had to be
+ *  unpacked.
+ ***********************************************************/
+void AssetPack::PrintReport()
+{
+	std::lock_guard<std::mutex> lock(m_unpackMutex);
+
+	std::cout << "Asset pack: " << m_lookupCount << " lookups of " << m_entryCount << " entries served "
+		<< m_servedBytes << " bytes, " << m_unpacked.size() << " entries unpacked" << std::endl;
+}
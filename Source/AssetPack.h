@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// read the textures, shaders and meshes in place from one memory-mapped
+// archive file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class contains the code for building and reading
+ *  an archive that holds every asset file of the scene.  The
+ *  archive starts with an index of the entries sorted by
+ *  name, followed by the names and the payloads, each
+ *  payload aligned to a cache line.  Opening it maps the
+ *  whole file once, and an asset is found by a binary search
+ *  of the index and read straight from the mapping, so only
+ *  the pages of the assets actually used are ever loaded.
+ *  Entries that shrink enough are stored compressed with a
+ *  small LZ77 codec and unpacked once, on first use.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	// how an entry's payload is stored
+	enum COMPRESSION
+	{
+		COMPRESSION_NONE = 0,
+		COMPRESSION_LZ = 1
+	};
+
+private:
+	// start of the archive
+	struct PACK_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+	};
+
+	// index entry of one asset - offsets are from the start of
+	// the archive
+	struct PACK_ENTRY
+	{
+		uint64_t offset;
+		uint64_t storedSize;
+		uint64_t size;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t compression;
+		uint32_t reserved;
+	};
+
+	MappedFile m_file;
+	const PACK_ENTRY* m_pEntries;
+	int m_entryCount;
+
+	// payloads of the compressed entries unpacked so far, kept
+	// until the archive is closed, by entry index
+	std::map<int, std::vector<unsigned char> > m_unpacked;
+	std::mutex m_unpackMutex;
+	// lookups answered, and the bytes they were served
+	int m_lookupCount;
+	size_t m_servedBytes;
+
+	// find the index of an entry by name, or -1
+	int FindEntry(const std::string& name);
+	// check that the index, names and payloads lie in the file
+	bool ValidateIndex();
+
+	// compress and decompress a payload with the LZ77 codec
+	static void Compress(const unsigned char* pData, size_t size, std::vector<unsigned char>& output);
+	static bool Decompress(const unsigned char* pData, size_t storedSize, unsigned char* pOutput, size_t size);
+
+public:
+	// map the archive, closing any open archive first
+	bool Open(const char* filename);
+	// unmap the archive and free the unpacked entries
+	void Close();
+	bool IsOpen();
+
+	// get the bytes of the asset stored under the passed in
+	// path - they stay valid until the archive is closed
+	bool Find(const char* name, const unsigned char** ppData, size_t* pSize);
+
+	// write an archive holding the passed in files, stored
+	// under their paths
+	static bool Build(const char* filename, const std::vector<std::string>& assetFiles);
+
+	// print the entries read from the archive
+	void PrintReport();
+};
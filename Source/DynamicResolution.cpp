@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// render the scene into an offscreen target whose resolution follows
+// the GPU frame time, and upscale it to the window
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// the scale is only lowered when the GPU time is above the
+	// target, and only raised when it is well below it
+	const float RAISE_THRESHOLD = 0.85f;
+	// weight of the newest frame in the smoothed GPU time
+	const float SMOOTHING = 0.1f;
+	// steps the scale moves in, so small timing noise does not
+	// change the rendered size every frame
+	const float SCALE_STEP = 0.05f;
+	// frames to wait after a change before judging the new scale
+	const int SETTLE_FRAMES = 30;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution()
+{
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_scale = 1.0f;
+	m_minScale = 0.5f;
+	m_maxScale = 1.0f;
+	// 60 frames per second, with some room for the CPU and the
+	// buffer swap
+	m_targetMilliseconds = 14.0f;
+	m_gpuMilliseconds = 0.0f;
+	m_settleFrames = SETTLE_FRAMES;
+	m_frameIndex = 0;
+	for (int i = 0; i < TIMER_QUERY_COUNT; i++)
+	{
+		m_timerQueries[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	if (m_timerQueries[0] != 0)
+	{
+		for (int i = 0; i < TIMER_QUERY_COUNT; i++)
+		{
+			GpuResources::Release(GpuResources::RESOURCE_QUERY, m_timerQueries[i]);
+		}
+		glDeleteQueries(TIMER_QUERY_COUNT, m_timerQueries);
+		for (int i = 0; i < TIMER_QUERY_COUNT; i++)
+		{
+			m_timerQueries[i] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for following the size of the
+ *  window's framebuffer.  The offscreen targets are kept at
+ *  this size by the frame graph.
+ ***********************************************************/
+void DynamicResolution::Resize(int width, int height)
+{
+	m_windowWidth = width;
+	m_windowHeight = height;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for setting the viewport to the
+ *  scaled size of the frame, in the offscreen target the
+ *  frame graph bound.  The GPU time of the frame is
+ *  measured from here.
+ ***********************************************************/
+bool DynamicResolution::BeginFrame()
+{
+	if ((m_windowWidth <= 0) || (m_windowHeight <= 0))
+	{
+		return(false);
+	}
+
+	if (m_timerQueries[0] == 0)
+	{
+		glGenQueries(TIMER_QUERY_COUNT, m_timerQueries);
+		for (int i = 0; i < TIMER_QUERY_COUNT; i++)
+		{
+			GpuResources::Track(GpuResources::RESOURCE_QUERY, m_timerQueries[i], 0, "DynamicResolution timers");
+		}
+	}
+
+	m_renderWidth = std::max((int)std::lround(m_windowWidth * m_scale), 1);
+	m_renderHeight = std::max((int)std::lround(m_windowHeight * m_scale), 1);
+
+	glViewport(0, 0, m_renderWidth, m_renderHeight);
+
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_frameIndex % TIMER_QUERY_COUNT]);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stretching the rendered part of
+ *  the offscreen target over the whole window with linear
+ *  filtering, then updating the scale for later frames.
+ ***********************************************************/
+void DynamicResolution::EndFrame(GLuint sourceFramebuffer)
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	m_frameIndex++;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(
+		0, 0, m_renderWidth, m_renderHeight,
+		0, 0, m_windowWidth, m_windowHeight,
+		GL_COLOR_BUFFER_BIT,
+		(m_renderWidth == m_windowWidth) ? GL_NEAREST : GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, m_windowWidth, m_windowHeight);
+
+	UpdateScale();
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for reading the GPU time of the
+ *  oldest frame in flight and moving the resolution scale
+ *  toward the one expected to hold the target time.  The
+ *  pixel count follows the square of the scale.
+ ***********************************************************/
+void DynamicResolution::UpdateScale()
+{
+	if (m_frameIndex < TIMER_QUERY_COUNT)
+	{
+		return;
+	}
+
+	// the query after the newest one is the oldest in the ring
+	GLuint query = m_timerQueries[m_frameIndex % TIMER_QUERY_COUNT];
+	GLint available = 0;
+	glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == 0)
+	{
+		return;
+	}
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+	float milliseconds = (float)nanoseconds / 1000000.0f;
+	if (m_gpuMilliseconds <= 0.0f)
+	{
+		m_gpuMilliseconds = milliseconds;
+	}
+	m_gpuMilliseconds += (milliseconds - m_gpuMilliseconds) * SMOOTHING;
+
+	if (m_settleFrames > 0)
+	{
+		m_settleFrames--;
+		return;
+	}
+
+	float newScale = m_scale;
+	if ((m_gpuMilliseconds > m_targetMilliseconds) || (m_gpuMilliseconds < m_targetMilliseconds * RAISE_THRESHOLD))
+	{
+		newScale = m_scale * std::sqrt(m_targetMilliseconds * RAISE_THRESHOLD / m_gpuMilliseconds);
+		// raising is done one step at a time, since the timing
+		// of a very light frame says little about a bigger one
+		newScale = std::min(newScale, m_scale + SCALE_STEP);
+		newScale = std::floor(newScale / SCALE_STEP + 0.5f) * SCALE_STEP;
+		newScale = std::min(std::max(newScale, m_minScale), m_maxScale);
+	}
+
+	if (newScale != m_scale)
+	{
+		m_scale = newScale;
+		m_settleFrames = SETTLE_FRAMES;
+	}
+}
+
+/***********************************************************
+ *  SetTargetFrameTime()
+ *
+ *  This method is used for setting the GPU time per frame
+ *  that the resolution scale is adjusted to hold.
+ ***********************************************************/
+void DynamicResolution::SetTargetFrameTime(float milliseconds)
+{
+	m_targetMilliseconds = std::max(milliseconds, 1.0f);
+}
+
+/***********************************************************
+ *  SetScaleRange()
+ *
+ *  This method is used for limiting the resolution scale.
+ *  A fixed scale is set with the same minimum and maximum.
+ ***********************************************************/
+void DynamicResolution::SetScaleRange(float minScale, float maxScale)
+{
+	m_minScale = std::min(std::max(minScale, 0.1f), 1.0f);
+	m_maxScale = std::min(std::max(maxScale, m_minScale), 1.0f);
+	m_scale = std::min(std::max(m_scale, m_minScale), m_maxScale);
+}
+
+/***********************************************************
+ *  GetScale()
+ *
+ *  This method is used for getting the fraction of the
+ *  window resolution that is rendered.
+ ***********************************************************/
+float DynamicResolution::GetScale()
+{
+	return(m_scale);
+}
+
+/***********************************************************
+ *  GetGPUMilliseconds()
+ *
+ *  This method is used for getting the smoothed GPU time of
+ *  the recent frames.
+ ***********************************************************/
+float DynamicResolution::GetGPUMilliseconds()
+{
+	return(m_gpuMilliseconds);
+}
+
+/***********************************************************
+ *  GetRenderWidth()
+ *
+ *  This method is used for getting the width rendered in
+ *  the current frame.
+ ***********************************************************/
+int DynamicResolution::GetRenderWidth()
+{
+	return(m_renderWidth);
+}
+
+/***********************************************************
+ *  GetRenderHeight()
+ *
+ *  This method is used for getting the height rendered in
+ *  the current frame.
+ ***********************************************************/
+int DynamicResolution::GetRenderHeight()
+{
+	return(m_renderHeight);
+}
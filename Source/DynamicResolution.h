@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// render the scene into an offscreen target whose resolution follows
+// the GPU frame time, and upscale it to the window
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class contains the code for rendering each frame
+ *  into an offscreen color and depth target at a fraction
+ *  of the window resolution.  The targets are allocated at
+ *  the window size by the frame graph, and a lower scale
+ *  only renders into their lower left part.  The GPU time
+ *  of every frame is measured with timer queries, read a
+ *  few frames later so the CPU never waits for them, and
+ *  the resolution scale is lowered or raised to hold the
+ *  target frame time.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// constructor
+	DynamicResolution();
+	// destructor
+	~DynamicResolution();
+
+private:
+	// number of frames a timer query is kept before reading it
+	static const int TIMER_QUERY_COUNT = 4;
+
+	// size of the window's framebuffer
+	int m_windowWidth;
+	int m_windowHeight;
+	// size rendered in the current frame
+	int m_renderWidth;
+	int m_renderHeight;
+
+	// fraction of the window resolution rendered per axis
+	float m_scale;
+	float m_minScale;
+	float m_maxScale;
+	// GPU time to hold, in milliseconds
+	float m_targetMilliseconds;
+	// smoothed GPU time of the finished frames
+	float m_gpuMilliseconds;
+	// frames left before the scale may change again
+	int m_settleFrames;
+
+	// GPU timer queries in a ring, one per frame in flight
+	GLuint m_timerQueries[TIMER_QUERY_COUNT];
+	int m_frameIndex;
+
+	// read the oldest finished timer query and adjust the scale
+	void UpdateScale();
+
+public:
+	// set the size of the window's framebuffer
+	void Resize(int width, int height);
+	// set the viewport for rendering the frame into the bound
+	// offscreen target - fails while the window is minimized
+	bool BeginFrame();
+	// upscale the frame rendered into the passed in framebuffer
+	// into the window
+	void EndFrame(GLuint sourceFramebuffer);
+
+	// set the frame time to hold, in milliseconds
+	void SetTargetFrameTime(float milliseconds);
+	// set the range the resolution scale is kept within
+	void SetScaleRange(float minScale, float maxScale);
+
+	float GetScale();
+	float GetGPUMilliseconds();
+	int GetRenderWidth();
+	int GetRenderHeight();
+};
@@ -0,0 +1,479 @@
+///////////////////////////////////////////////////////////////////////////////
+// entitystore.cpp
+// ============
+// keep the scene objects as entities with densely packed component arrays
+// and stable entity IDs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "EntityStore.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// the low bits of an entity ID are the slot index and the
+	// high bits count how often the slot was reused, so a
+	// removed entity's ID does not match the next one
+	const unsigned int SLOT_INDEX_BITS = 22;
+	const unsigned int SLOT_INDEX_MASK = (1u << SLOT_INDEX_BITS) - 1;
+	const unsigned int GENERATION_MASK = (1u << (32 - SLOT_INDEX_BITS)) - 1;
+	// marks the end of the free slot list
+	const unsigned int NO_FREE_SLOT = 0xFFFFFFFF;
+}
+
+/***********************************************************
+ *  EntityStore()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+EntityStore::EntityStore()
+{
+	m_pTransforms = new TransformBatch();
+	m_freeSlot = NO_FREE_SLOT;
+	m_bWorldDirty = false;
+}
+
+/***********************************************************
+ *  ~EntityStore()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+EntityStore::~EntityStore()
+{
+	if (NULL != m_pTransforms)
+	{
+		delete m_pTransforms;
+		m_pTransforms = NULL;
+	}
+}
+
+/***********************************************************
+ *  GetSlotIndex()
+ *
+ *  This method is used for getting the slot index of an
+ *  entity ID.
+ ***********************************************************/
+unsigned int EntityStore::GetSlotIndex(ENTITY_ID entity)
+{
+	return(entity & SLOT_INDEX_MASK);
+}
+
+/***********************************************************
+ *  GetGeneration()
+ *
+ *  This method is used for getting the generation of an
+ *  entity ID.
+ ***********************************************************/
+unsigned int EntityStore::GetGeneration(ENTITY_ID entity)
+{
+	return(entity >> SLOT_INDEX_BITS);
+}
+
+/***********************************************************
+ *  AddEntity()
+ *
+ *  This method is used for adding an entity at the end of
+ *  the component arrays.  A removed entity's slot is reused
+ *  before a new slot is added, so the IDs of a store that
+ *  never had an entity removed follow the order they were
+ *  added in.
+ ***********************************************************/
+EntityStore::ENTITY_ID EntityStore::AddEntity(int meshID, glm::vec3 localBoundsMin, glm::vec3 localBoundsMax, unsigned int flags)
+{
+	unsigned int slotIndex = 0;
+	if (m_freeSlot != NO_FREE_SLOT)
+	{
+		slotIndex = m_freeSlot;
+		m_freeSlot = m_slots[slotIndex].denseIndex;
+	}
+	else
+	{
+		if (m_slots.size() >= SLOT_INDEX_MASK)
+		{
+			return(INVALID_ENTITY);
+		}
+
+		ENTITY_SLOT slot;
+		slot.generation = 0;
+		m_slots.push_back(slot);
+		slotIndex = (unsigned int)m_slots.size() - 1;
+	}
+
+	int denseIndex = GetCount();
+	m_slots[slotIndex].denseIndex = denseIndex;
+	ENTITY_ID entity = (m_slots[slotIndex].generation << SLOT_INDEX_BITS) | slotIndex;
+
+	m_pTransforms->AddTransform(glm::vec3(1.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+	m_meshIDs.push_back(meshID);
+	m_materialIndices.push_back(-1);
+	m_textureSlots.push_back(-1);
+	m_uvScales.push_back(glm::vec2(1.0f, 1.0f));
+	m_colors.push_back(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+	m_localBoundsMin.push_back(localBoundsMin);
+	m_localBoundsMax.push_back(localBoundsMax);
+	m_boundsMin.push_back(localBoundsMin);
+	m_boundsMax.push_back(localBoundsMax);
+	m_flags.push_back(flags);
+	m_objectIDs.push_back(-1);
+	m_entityIDs.push_back(entity);
+	m_bWorldDirty = true;
+
+	return(entity);
+}
+
+/***********************************************************
+ *  RemoveEntity()
+ *
+ *  This method is used for removing an entity.  The last
+ *  entity is moved into its place in the component arrays
+ *  and its slot is pointed at the new place, so no other
+ *  entity moves and no ID changes.
+ ***********************************************************/
+void EntityStore::RemoveEntity(ENTITY_ID entity)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex < 0)
+	{
+		return;
+	}
+
+	int last = m_pTransforms->RemoveTransform(denseIndex);
+	m_meshIDs[denseIndex] = m_meshIDs[last];
+	m_materialIndices[denseIndex] = m_materialIndices[last];
+	m_textureSlots[denseIndex] = m_textureSlots[last];
+	m_uvScales[denseIndex] = m_uvScales[last];
+	m_colors[denseIndex] = m_colors[last];
+	m_localBoundsMin[denseIndex] = m_localBoundsMin[last];
+	m_localBoundsMax[denseIndex] = m_localBoundsMax[last];
+	m_boundsMin[denseIndex] = m_boundsMin[last];
+	m_boundsMax[denseIndex] = m_boundsMax[last];
+	m_flags[denseIndex] = m_flags[last];
+	m_objectIDs[denseIndex] = m_objectIDs[last];
+	m_entityIDs[denseIndex] = m_entityIDs[last];
+	m_slots[GetSlotIndex(m_entityIDs[denseIndex])].denseIndex = denseIndex;
+
+	m_meshIDs.pop_back();
+	m_materialIndices.pop_back();
+	m_textureSlots.pop_back();
+	m_uvScales.pop_back();
+	m_colors.pop_back();
+	m_localBoundsMin.pop_back();
+	m_localBoundsMax.pop_back();
+	m_boundsMin.pop_back();
+	m_boundsMax.pop_back();
+	m_flags.pop_back();
+	m_objectIDs.pop_back();
+	m_entityIDs.pop_back();
+
+	// the slot joins the free list with a new generation
+	unsigned int slotIndex = GetSlotIndex(entity);
+	m_slots[slotIndex].generation = (m_slots[slotIndex].generation + 1) & GENERATION_MASK;
+	m_slots[slotIndex].denseIndex = m_freeSlot;
+	m_freeSlot = slotIndex;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every entity.  The
+ *  slots are kept, with new generations, so the IDs handed
+ *  out before do not match the entities added after.
+ ***********************************************************/
+void EntityStore::Clear()
+{
+	for (int i = 0; i < m_entityIDs.size(); i++)
+	{
+		unsigned int slotIndex = GetSlotIndex(m_entityIDs[i]);
+		m_slots[slotIndex].generation = (m_slots[slotIndex].generation + 1) & GENERATION_MASK;
+		m_slots[slotIndex].denseIndex = m_freeSlot;
+		m_freeSlot = slotIndex;
+	}
+
+	m_pTransforms->Clear();
+	m_meshIDs.clear();
+	m_materialIndices.clear();
+	m_textureSlots.clear();
+	m_uvScales.clear();
+	m_colors.clear();
+	m_localBoundsMin.clear();
+	m_localBoundsMax.clear();
+	m_boundsMin.clear();
+	m_boundsMax.clear();
+	m_flags.clear();
+	m_objectIDs.clear();
+	m_entityIDs.clear();
+	m_bWorldDirty = false;
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room for the passed in
+ *  number of entities, so adding them does not reallocate
+ *  the component arrays.
+ ***********************************************************/
+void EntityStore::Reserve(int count)
+{
+	m_pTransforms->Reserve(count);
+	m_meshIDs.reserve(count);
+	m_materialIndices.reserve(count);
+	m_textureSlots.reserve(count);
+	m_uvScales.reserve(count);
+	m_colors.reserve(count);
+	m_localBoundsMin.reserve(count);
+	m_localBoundsMax.reserve(count);
+	m_boundsMin.reserve(count);
+	m_boundsMax.reserve(count);
+	m_flags.reserve(count);
+	m_objectIDs.reserve(count);
+	m_entityIDs.reserve(count);
+	m_slots.reserve(count);
+}
+
+/***********************************************************
+ *  IsAlive()
+ *
+ *  This method is used for checking whether an entity ID
+ *  belongs to an entity that was not removed.
+ ***********************************************************/
+bool EntityStore::IsAlive(ENTITY_ID entity)
+{
+	return(GetDenseIndex(entity) >= 0);
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for changing the transform of an
+ *  entity.  The world data is built by the next call to
+ *  UpdateWorld().
+ ***********************************************************/
+void EntityStore::SetTransform(ENTITY_ID entity, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex < 0)
+	{
+		return;
+	}
+
+	m_pTransforms->SetTransform(denseIndex, scaleXYZ, rotationDegrees, positionXYZ);
+	m_bWorldDirty = true;
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method is used for setting the index of the defined
+ *  material an entity is drawn with, or -1 for the default.
+ ***********************************************************/
+void EntityStore::SetMaterial(ENTITY_ID entity, int materialIndex)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex >= 0)
+	{
+		m_materialIndices[denseIndex] = materialIndex;
+	}
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method is used for setting the texture slot and UV
+ *  scale an entity is drawn with.  A slot of -1 draws the
+ *  entity with its color.
+ ***********************************************************/
+void EntityStore::SetTexture(ENTITY_ID entity, int textureSlot, glm::vec2 uvScale)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex >= 0)
+	{
+		m_textureSlots[denseIndex] = textureSlot;
+		m_uvScales[denseIndex] = uvScale;
+	}
+}
+
+/***********************************************************
+ *  SetColor()
+ *
+ *  This method is used for setting the color of an entity.
+ ***********************************************************/
+void EntityStore::SetColor(ENTITY_ID entity, glm::vec4 color)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex >= 0)
+	{
+		m_colors[denseIndex] = color;
+	}
+}
+
+/***********************************************************
+ *  SetFlags()
+ *
+ *  This method is used for setting the flags of an entity.
+ ***********************************************************/
+void EntityStore::SetFlags(ENTITY_ID entity, unsigned int flags)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex >= 0)
+	{
+		m_flags[denseIndex] = flags;
+	}
+}
+
+/***********************************************************
+ *  SetObjectID()
+ *
+ *  This method is used for linking an entity to the object
+ *  it is drawn through, like its static batch object.
+ ***********************************************************/
+void EntityStore::SetObjectID(ENTITY_ID entity, int objectID)
+{
+	int denseIndex = GetDenseIndex(entity);
+	if (denseIndex >= 0)
+	{
+		m_objectIDs[denseIndex] = objectID;
+	}
+}
+
+/***********************************************************
+ *  UpdateWorld()
+ *
+ *  This method is used for building the world matrices and
+ *  the world space bounding boxes of the entities, in one
+ *  pass over the packed arrays.  Nothing is done when no
+ *  entity was added or moved since the last call.
+ ***********************************************************/
+void EntityStore::UpdateWorld()
+{
+	if (m_bWorldDirty == false)
+	{
+		return;
+	}
+
+	m_pTransforms->ComputeWorldMatrices();
+	const glm::mat4* pWorldMatrices = m_pTransforms->GetWorldMatrices();
+
+	int count = GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		// the box around the transformed local box is centered on
+		// the transformed center, and its extent is the local
+		// extent through the absolute values of the matrix
+		const glm::mat4& world = pWorldMatrices[i];
+		glm::vec3 center = (m_localBoundsMin[i] + m_localBoundsMax[i]) * 0.5f;
+		glm::vec3 extent = (m_localBoundsMax[i] - m_localBoundsMin[i]) * 0.5f;
+
+		glm::vec3 worldCenter = glm::vec3(world * glm::vec4(center, 1.0f));
+		glm::vec3 worldExtent;
+		for (int row = 0; row < 3; row++)
+		{
+			worldExtent[row] =
+				std::fabs(world[0][row]) * extent.x +
+				std::fabs(world[1][row]) * extent.y +
+				std::fabs(world[2][row]) * extent.z;
+		}
+
+		m_boundsMin[i] = worldCenter - worldExtent;
+		m_boundsMax[i] = worldCenter + worldExtent;
+	}
+
+	m_bWorldDirty = false;
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of entities.
+ ***********************************************************/
+int EntityStore::GetCount()
+{
+	return((int)m_entityIDs.size());
+}
+
+/***********************************************************
+ *  GetDenseIndex()
+ *
+ *  This method is used for getting the place of an entity
+ *  in the component arrays, or -1 when the ID belongs to a
+ *  removed entity or was never handed out.
+ ***********************************************************/
+int EntityStore::GetDenseIndex(ENTITY_ID entity)
+{
+	unsigned int slotIndex = GetSlotIndex(entity);
+	if ((entity == INVALID_ENTITY) || (slotIndex >= m_slots.size()))
+	{
+		return(-1);
+	}
+
+	const ENTITY_SLOT& slot = m_slots[slotIndex];
+	if ((slot.generation != GetGeneration(entity)) ||
+		(slot.denseIndex >= m_entityIDs.size()) ||
+		(m_entityIDs[slot.denseIndex] != entity))
+	{
+		return(-1);
+	}
+
+	return((int)slot.denseIndex);
+}
+
+/***********************************************************
+ *  GetEntityIDs()
+ *
+ *  The following methods are used for getting the packed
+ *  component arrays, indexed from 0 to GetCount().
+ ***********************************************************/
+const EntityStore::ENTITY_ID* EntityStore::GetEntityIDs()
+{
+	return(m_entityIDs.data());
+}
+
+const int* EntityStore::GetMeshIDs()
+{
+	return(m_meshIDs.data());
+}
+
+const int* EntityStore::GetMaterialIndices()
+{
+	return(m_materialIndices.data());
+}
+
+const int* EntityStore::GetTextureSlots()
+{
+	return(m_textureSlots.data());
+}
+
+const glm::vec2* EntityStore::GetUVScales()
+{
+	return(m_uvScales.data());
+}
+
+const glm::vec4* EntityStore::GetColors()
+{
+	return(m_colors.data());
+}
+
+const unsigned int* EntityStore::GetFlags()
+{
+	return(m_flags.data());
+}
+
+const int* EntityStore::GetObjectIDs()
+{
+	return(m_objectIDs.data());
+}
+
+const glm::mat4* EntityStore::GetWorldMatrices()
+{
+	return(m_pTransforms->GetWorldMatrices());
+}
+
+const glm::vec3* EntityStore::GetBoundsMin()
+{
+	return(m_boundsMin.data());
+}
+
+const glm::vec3* EntityStore::GetBoundsMax()
+{
+	return(m_boundsMax.data());
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// entitystore.h
+// ============
+// keep the scene objects as entities with densely packed component arrays
+// and stable entity IDs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformBatch.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  EntityStore
+ *
+ *  This class contains the code for keeping the objects of
+ *  the scene as entities.  Each component (transform, mesh,
+ *  material, texture, color, bounds and flags) is stored in
+ *  its own array, and the arrays are kept packed so the
+ *  entities can be walked in one linear pass.  An entity ID
+ *  holds a slot index and a generation - the slot maps the
+ *  ID to the entity's place in the arrays, and removing an
+ *  entity moves the last one into the hole, so adding and
+ *  removing are both O(1) and IDs stay valid in between.
+ ***********************************************************/
+class EntityStore
+{
+public:
+	// constructor
+	EntityStore();
+	// destructor
+	~EntityStore();
+
+	typedef unsigned int ENTITY_ID;
+
+	// the ID no entity ever has
+	static const ENTITY_ID INVALID_ENTITY = 0xFFFFFFFF;
+
+	// flags of an entity, combined with |
+	enum ENTITY_FLAGS
+	{
+		ENTITY_NONE = 0,
+		// the entity never moves and is drawn from the batches
+		ENTITY_STATIC = 1 << 0,
+		// the entity is skipped when drawing
+		ENTITY_HIDDEN = 1 << 1
+	};
+
+private:
+	// maps an entity ID to the entity's place in the arrays,
+	// or to the next free slot once the entity is removed
+	struct ENTITY_SLOT
+	{
+		unsigned int denseIndex;
+		unsigned int generation;
+	};
+
+	// the packed components, all indexed by the dense index
+	TransformBatch* m_pTransforms;
+	std::vector<int> m_meshIDs;
+	std::vector<int> m_materialIndices;
+	// texture slot, or -1 for the entities drawn with a color
+	std::vector<int> m_textureSlots;
+	std::vector<glm::vec2> m_uvScales;
+	std::vector<glm::vec4> m_colors;
+	// bounds of the mesh in its model space, and of the entity
+	// in world space
+	std::vector<glm::vec3> m_localBoundsMin;
+	std::vector<glm::vec3> m_localBoundsMax;
+	std::vector<glm::vec3> m_boundsMin;
+	std::vector<glm::vec3> m_boundsMax;
+	std::vector<unsigned int> m_flags;
+	// ID of the object the entity is drawn through, like its
+	// static batch object, or -1
+	std::vector<int> m_objectIDs;
+	// ID of the entity at each dense index
+	std::vector<ENTITY_ID> m_entityIDs;
+
+	// slots of every entity ID handed out
+	std::vector<ENTITY_SLOT> m_slots;
+	// first slot of the free list, with all bits set when
+	// no slot is free
+	unsigned int m_freeSlot;
+	// the transforms changed since the world data was built
+	bool m_bWorldDirty;
+
+	// get the slot index and generation of an entity ID
+	static unsigned int GetSlotIndex(ENTITY_ID entity);
+	static unsigned int GetGeneration(ENTITY_ID entity);
+
+public:
+	// add an entity drawing the passed in mesh, with an
+	// identity transform, and get its ID
+	ENTITY_ID AddEntity(int meshID, glm::vec3 localBoundsMin, glm::vec3 localBoundsMax, unsigned int flags);
+	// remove an entity - its ID is not valid anymore
+	void RemoveEntity(ENTITY_ID entity);
+	// remove every entity
+	void Clear();
+	// make room for the passed in number of entities
+	void Reserve(int count);
+	bool IsAlive(ENTITY_ID entity);
+
+	// change the components of an entity
+	void SetTransform(ENTITY_ID entity, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ);
+	void SetMaterial(ENTITY_ID entity, int materialIndex);
+	void SetTexture(ENTITY_ID entity, int textureSlot, glm::vec2 uvScale);
+	void SetColor(ENTITY_ID entity, glm::vec4 color);
+	void SetFlags(ENTITY_ID entity, unsigned int flags);
+	void SetObjectID(ENTITY_ID entity, int objectID);
+
+	// build the world matrices and bounds of the entities,
+	// when any of them was added or moved
+	void UpdateWorld();
+
+	// number of entities, and the dense index of an entity
+	// or -1 when the ID is not valid
+	int GetCount();
+	int GetDenseIndex(ENTITY_ID entity);
+
+	// the packed components, for walking the entities from
+	// dense index 0 to GetCount() - only valid until the next
+	// add or remove, and the world data after UpdateWorld()
+	const ENTITY_ID* GetEntityIDs();
+	const int* GetMeshIDs();
+	const int* GetMaterialIndices();
+	const int* GetTextureSlots();
+	const glm::vec2* GetUVScales();
+	const glm::vec4* GetColors();
+	const unsigned int* GetFlags();
+	const int* GetObjectIDs();
+	const glm::mat4* GetWorldMatrices();
+	const glm::vec3* GetBoundsMin();
+	const glm::vec3* GetBoundsMax();
+};
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// linear allocator for the transient data of a frame, released all at
+// once when the next frame begins
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <iostream>
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t capacity)
+{
+	m_capacity = std::max(capacity, (size_t)1);
+	m_pBlock = new unsigned char[m_capacity];
+	m_usedBytes = 0;
+	m_overflowBytes = 0;
+	m_peakBytes = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	for (int i = 0; i < m_overflowBlocks.size(); i++)
+	{
+		delete[] m_overflowBlocks[i];
+	}
+	m_overflowBlocks.clear();
+	delete[] m_pBlock;
+	m_pBlock = NULL;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for releasing every allocation of
+ *  the last frame.  When the frame needed extra blocks, the
+ *  main block is replaced by one that fits the whole frame
+ *  with some room to spare.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	m_peakBytes = std::max(m_peakBytes, m_usedBytes + m_overflowBytes);
+
+	if (m_overflowBlocks.size() > 0)
+	{
+		for (int i = 0; i < m_overflowBlocks.size(); i++)
+		{
+			delete[] m_overflowBlocks[i];
+		}
+		m_overflowBlocks.clear();
+
+		delete[] m_pBlock;
+		m_capacity = m_peakBytes + m_peakBytes / 2;
+		m_pBlock = new unsigned char[m_capacity];
+
+		std::cout << "Frame arena grown to " << m_capacity << " bytes" << std::endl;
+	}
+
+	m_usedBytes = 0;
+	m_overflowBytes = 0;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for taking the passed in number of
+ *  bytes from the arena, aligned to the passed in power of
+ *  two.  The memory is not initialized.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	if (bytes == 0)
+	{
+		bytes = 1;
+	}
+
+	size_t offset = (m_usedBytes + alignment - 1) & ~(alignment - 1);
+	if (offset + bytes <= m_capacity)
+	{
+		m_usedBytes = offset + bytes;
+		return(m_pBlock + offset);
+	}
+
+	// the frame outgrew the block - new[] is aligned for any
+	// fundamental type, which covers everything in the frame
+	unsigned char* pOverflow = new unsigned char[bytes];
+	m_overflowBlocks.push_back(pOverflow);
+	m_overflowBytes += bytes + alignment;
+
+	return(pOverflow);
+}
+
+/***********************************************************
+ *  GetUsedBytes()
+ *
+ *  This method is used for getting the bytes allocated in
+ *  the current frame.
+ ***********************************************************/
+size_t FrameArena::GetUsedBytes()
+{
+	return(m_usedBytes + m_overflowBytes);
+}
+
+/***********************************************************
+ *  GetCapacityBytes()
+ *
+ *  This method is used for getting the size of the block
+ *  the frame's allocations are taken from.
+ ***********************************************************/
+size_t FrameArena::GetCapacityBytes()
+{
+	return(m_capacity);
+}
+
+/***********************************************************
+ *  GetPeakBytes()
+ *
+ *  This method is used for getting the most bytes a single
+ *  frame allocated.
+ ***********************************************************/
+size_t FrameArena::GetPeakBytes()
+{
+	return(std::max(m_peakBytes, m_usedBytes + m_overflowBytes));
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// linear allocator for the transient data of a frame, released all at
+// once when the next frame begins
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class contains the code for handing out memory for
+ *  data that only lives until the end of a frame, like the
+ *  sorted draw lists and the culling results.  Allocation
+ *  only moves an offset forward, and Reset() frees all of
+ *  it.  A frame that outgrows the block is served from
+ *  extra heap blocks, and the next Reset() replaces them
+ *  with one block big enough for that frame, so steady
+ *  frames do not touch the heap.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor
+	FrameArena(size_t capacity);
+	// destructor
+	~FrameArena();
+
+private:
+	// memory the frame's allocations are taken from
+	unsigned char* m_pBlock;
+	size_t m_capacity;
+	size_t m_usedBytes;
+	// blocks of the allocations that did not fit this frame
+	std::vector<unsigned char*> m_overflowBlocks;
+	size_t m_overflowBytes;
+	// most bytes a single frame used
+	size_t m_peakBytes;
+
+public:
+	// release the allocations of the last frame
+	void Reset();
+	// get uninitialized memory that lives until the next reset
+	void* Allocate(size_t bytes, size_t alignment);
+
+	// get an uninitialized array that lives until the next
+	// reset - only for types that need no destructor
+	template<typename T>
+	T* AllocateArray(size_t count)
+	{
+		return((T*)Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	size_t GetUsedBytes();
+	size_t GetCapacityBytes();
+	size_t GetPeakBytes();
+};
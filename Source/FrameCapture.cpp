@@ -0,0 +1,576 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// read the rendered frames back through pixel buffer objects and write
+// them as images or raw video on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+#include "GpuResources.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// the buffers are read by the encoder thread while mapped,
+	// and the GPU writes are seen without mapping them again
+	const GLbitfield READBACK_FLAGS = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	// frames a copy is left in flight before its fence is checked
+	const int READBACK_LATENCY_FRAMES = 2;
+	// bytes of a BGRA pixel
+	const int PIXEL_BYTES = 4;
+	// frame rate the raw video is played back at
+	const int VIDEO_FRAME_RATE = 60;
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class.  The encoder thread is
+ *  started right away, and the readback buffers are created
+ *  by the first captured frame.
+ ***********************************************************/
+FrameCapture::FrameCapture(CAPTURE_MODE mode, const char* outputPath)
+{
+	m_mode = mode;
+	m_outputPath = outputPath;
+	for (int i = 0; i < READBACK_COUNT; i++)
+	{
+		m_readbacks[i].buffer = 0;
+		m_readbacks[i].pPixels = NULL;
+		m_readbacks[i].capacity = 0;
+		m_readbacks[i].fence = 0;
+		m_readbacks[i].state = READBACK_FREE;
+		m_readbacks[i].width = 0;
+		m_readbacks[i].height = 0;
+		m_readbacks[i].frameNumber = 0;
+		m_readbacks[i].issuedAt = 0;
+		m_queue[i] = 0;
+	}
+	m_queueHead = 0;
+	m_queueCount = 0;
+	m_bStopping = false;
+	m_videoWidth = 0;
+	m_videoHeight = 0;
+	m_frameCount = 0;
+	m_capturedCount = 0;
+	m_droppedCount = 0;
+	m_encodedCount = 0;
+	m_skippedCount = 0;
+	m_encodeMilliseconds = 0.0;
+
+	if (m_mode == CAPTURE_VIDEO)
+	{
+		m_videoFile.open(m_outputPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (m_videoFile.is_open() == false)
+		{
+			std::cout << "Could not open video file: " << m_outputPath << std::endl;
+		}
+	}
+
+	m_encoder = std::thread(&FrameCapture::EncoderLoop, this);
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	Finish();
+}
+
+/***********************************************************
+ *  ReserveReadback()
+ *
+ *  This method is used for making sure a readback buffer
+ *  can hold a frame of the passed in size.  The storage of
+ *  a persistently mapped buffer cannot change, so a buffer
+ *  that is too small is replaced.
+ ***********************************************************/
+bool FrameCapture::ReserveReadback(READBACK& readback, size_t bytes)
+{
+	if ((readback.buffer != 0) && (readback.capacity >= bytes))
+	{
+		return(true);
+	}
+
+	if (readback.buffer != 0)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, readback.buffer);
+		glDeleteBuffers(1, &readback.buffer);
+		readback.buffer = 0;
+		readback.pPixels = NULL;
+		readback.capacity = 0;
+	}
+
+	glGenBuffers(1, &readback.buffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	glBufferStorage(GL_PIXEL_PACK_BUFFER, bytes, NULL, READBACK_FLAGS | GL_CLIENT_STORAGE_BIT);
+	readback.pPixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, READBACK_FLAGS);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if (NULL == readback.pPixels)
+	{
+		std::cout << "Could not map a frame capture buffer" << std::endl;
+		glDeleteBuffers(1, &readback.buffer);
+		readback.buffer = 0;
+		return(false);
+	}
+
+	readback.capacity = bytes;
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, readback.buffer, bytes, "FrameCapture readbacks");
+	return(true);
+}
+
+/***********************************************************
+ *  CollectReadbacks()
+ *
+ *  This method is used for handing the copies the GPU has
+ *  finished to the encoder thread, oldest first.  Copies
+ *  are only checked once they are a few frames old, and
+ *  the check does not wait unless asked to.
+ ***********************************************************/
+void FrameCapture::CollectReadbacks(bool bWait)
+{
+	while (true)
+	{
+		// the oldest copy still in flight - the encoder thread
+		// changes the states of the buffers it is done with
+		int oldest = -1;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (int i = 0; i < READBACK_COUNT; i++)
+			{
+				if ((m_readbacks[i].state == READBACK_READING) &&
+					((oldest < 0) || (m_readbacks[i].issuedAt < m_readbacks[oldest].issuedAt)))
+				{
+					oldest = i;
+				}
+			}
+		}
+		if (oldest < 0)
+		{
+			return;
+		}
+
+		READBACK& readback = m_readbacks[oldest];
+		if (bWait == false)
+		{
+			if (m_frameCount - readback.issuedAt < READBACK_LATENCY_FRAMES)
+			{
+				return;
+			}
+			if (glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				return;
+			}
+		}
+		else
+		{
+			GLenum result = GL_TIMEOUT_EXPIRED;
+			while (result == GL_TIMEOUT_EXPIRED)
+			{
+				result = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+		}
+
+		glDeleteSync(readback.fence);
+		readback.fence = 0;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		readback.state = READBACK_ENCODING;
+		m_queue[(m_queueHead + m_queueCount) % READBACK_COUNT] = oldest;
+		m_queueCount++;
+		m_wake.notify_one();
+	}
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for starting the copy of the frame
+ *  in the back buffer into a free readback buffer.  The
+ *  copy runs on the GPU after the frame's draws, and the
+ *  render loop moves on without waiting for it.
+ ***********************************************************/
+void FrameCapture::CaptureFrame(int width, int height)
+{
+	m_frameCount++;
+	if ((width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	CollectReadbacks(false);
+
+	int freeIndex = -1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (int i = 0; (i < READBACK_COUNT) && (freeIndex < 0); i++)
+		{
+			if (m_readbacks[i].state == READBACK_FREE)
+			{
+				freeIndex = i;
+			}
+		}
+	}
+
+	// every buffer is waiting for the GPU or the encoder
+	if (freeIndex < 0)
+	{
+		m_droppedCount++;
+		return;
+	}
+
+	READBACK& readback = m_readbacks[freeIndex];
+	if (ReserveReadback(readback, (size_t)width * height * PIXEL_BYTES) == false)
+	{
+		m_droppedCount++;
+		return;
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glReadBuffer(GL_BACK);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.width = width;
+	readback.height = height;
+	readback.frameNumber = m_capturedCount;
+	readback.issuedAt = m_frameCount;
+	readback.state = READBACK_READING;
+	m_capturedCount++;
+}
+
+/***********************************************************
+ *  EncoderLoop()
+ *
+ *  This method is run by the encoder thread.  It writes the
+ *  queued frames in order and gives their buffers back,
+ *  until it is stopped and the queue is empty.
+ ***********************************************************/
+void FrameCapture::EncoderLoop()
+{
+	while (true)
+	{
+		int index = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this]() { return((m_queueCount > 0) || (m_bStopping == true)); });
+			if (m_queueCount == 0)
+			{
+				return;
+			}
+
+			index = m_queue[m_queueHead];
+			m_queueHead = (m_queueHead + 1) % READBACK_COUNT;
+			m_queueCount--;
+		}
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		EncodeFrame(m_readbacks[index]);
+		double milliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_encodeMilliseconds += milliseconds;
+		m_readbacks[index].state = READBACK_FREE;
+	}
+}
+
+/***********************************************************
+ *  EncodeFrame()
+ *
+ *  This method is used for writing a frame in the chosen
+ *  format.  It runs on the encoder thread.
+ ***********************************************************/
+void FrameCapture::EncodeFrame(const READBACK& readback)
+{
+	bool bWritten = false;
+	if (m_mode == CAPTURE_IMAGES)
+	{
+		bWritten = WriteImage(readback);
+	}
+	else
+	{
+		bWritten = WriteVideoFrame(readback);
+	}
+
+	if (bWritten == true)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_encodedCount++;
+	}
+}
+
+/***********************************************************
+ *  WriteImage()
+ *
+ *  This method is used for writing a frame as a 32 bit TGA
+ *  image.  TGA stores BGRA rows from the bottom up, which
+ *  is the order OpenGL reads them in.
+ ***********************************************************/
+bool FrameCapture::WriteImage(const READBACK& readback)
+{
+	char number[16];
+	snprintf(number, sizeof(number), "_%05d.tga", readback.frameNumber);
+	std::string filename = m_outputPath + number;
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write captured frame: " << filename << std::endl;
+		return(false);
+	}
+
+	// uncompressed true color image with 8 alpha bits and the
+	// origin in the lower left corner
+	unsigned char header[18] = { 0 };
+	header[2] = 2;
+	header[12] = (unsigned char)(readback.width & 0xFF);
+	header[13] = (unsigned char)(readback.width >> 8);
+	header[14] = (unsigned char)(readback.height & 0xFF);
+	header[15] = (unsigned char)(readback.height >> 8);
+	header[16] = 32;
+	header[17] = 8;
+
+	file.write((const char*)header, sizeof(header));
+	file.write((const char*)readback.pPixels, (std::streamsize)readback.width * readback.height * PIXEL_BYTES);
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteVideoFrame()
+ *
+ *  This method is used for appending a frame to the raw
+ *  video file, with its rows from the top down.  The video
+ *  has the size of its first frame, and frames of another
+ *  size are skipped.
+ ***********************************************************/
+bool FrameCapture::WriteVideoFrame(const READBACK& readback)
+{
+	if (m_videoFile.is_open() == false)
+	{
+		return(false);
+	}
+
+	if (m_videoWidth == 0)
+	{
+		m_videoWidth = readback.width;
+		m_videoHeight = readback.height;
+	}
+	if ((readback.width != m_videoWidth) || (readback.height != m_videoHeight))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_skippedCount++;
+		return(false);
+	}
+
+	size_t rowBytes = (size_t)readback.width * PIXEL_BYTES;
+	for (int y = readback.height - 1; y >= 0; y--)
+	{
+		m_videoFile.write((const char*)(readback.pPixels + y * rowBytes), (std::streamsize)rowBytes);
+	}
+
+	return(m_videoFile.good());
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting for the copies still in
+ *  flight, letting the encoder write them, and stopping the
+ *  encoder thread.  The readback buffers are freed after.
+ ***********************************************************/
+void FrameCapture::Finish()
+{
+	if (m_encoder.joinable() == false)
+	{
+		return;
+	}
+
+	CollectReadbacks(true);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+		m_wake.notify_one();
+	}
+	m_encoder.join();
+
+	for (int i = 0; i < READBACK_COUNT; i++)
+	{
+		if (m_readbacks[i].buffer != 0)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbacks[i].buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_readbacks[i].buffer);
+			glDeleteBuffers(1, &m_readbacks[i].buffer);
+			m_readbacks[i].buffer = 0;
+			m_readbacks[i].pPixels = NULL;
+		}
+	}
+
+	if (m_videoFile.is_open() == true)
+	{
+		m_videoFile.close();
+	}
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the capture counts, and
+ *  for the video the command that converts it.
+ ***********************************************************/
+void FrameCapture::PrintReport()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::cout << "Frame capture: " << m_capturedCount << " of " << m_frameCount << " frames captured, "
+		<< m_droppedCount << " dropped, " << m_encodedCount << " written";
+	if (m_encodedCount > 0)
+	{
+		std::cout << " in " << (m_encodeMilliseconds / m_encodedCount) << " ms each";
+	}
+	std::cout << std::endl;
+
+	if ((m_mode == CAPTURE_VIDEO) && (m_videoWidth > 0))
+	{
+		if (m_skippedCount > 0)
+		{
+			std::cout << m_skippedCount << " frames of another size were left out of the video" << std::endl;
+		}
+		std::cout << "Convert the video with: ffmpeg -f rawvideo -pixel_format bgra -video_size "
+			<< m_videoWidth << "x" << m_videoHeight << " -framerate " << VIDEO_FRAME_RATE
+			<< " -i " << m_outputPath << " capture.mp4" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ReadImage()
+ *
+ *  This method is used for reading an uncompressed 32 bit
+ *  TGA image, as written by WriteImage(), into BGRA rows
+ *  from the bottom up.
+ ***********************************************************/
+bool FrameCapture::ReadImage(const char* filename, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not open image: " << filename << std::endl;
+		return(false);
+	}
+
+	unsigned char header[18] = { 0 };
+	file.read((char*)header, sizeof(header));
+	width = header[12] | (header[13] << 8);
+	height = header[14] | (header[15] << 8);
+	if ((file.good() == false) || (header[2] != 2) || (header[16] != 32) || (width <= 0) || (height <= 0))
+	{
+		std::cout << "Not a 32 bit uncompressed TGA image: " << filename << std::endl;
+		return(false);
+	}
+
+	// skip the image ID, which WriteImage() never writes
+	file.seekg(sizeof(header) + header[0], std::ios::beg);
+	pixels.resize((size_t)width * height * PIXEL_BYTES);
+	file.read((char*)pixels.data(), (std::streamsize)pixels.size());
+	if (file.good() == false)
+	{
+		std::cout << "Image is cut short: " << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompareImages()
+ *
+ *  This method is used for checking that two renderers draw
+ *  the same frame, such as the OpenGL and the software
+ *  rasterizer captures of one view.  The mean difference,
+ *  the PSNR and the fraction of the pixels differing by
+ *  more than the tolerance are printed.  The alpha channel
+ *  is not compared.
+ ***********************************************************/
+bool FrameCapture::CompareImages(const char* firstFile, const char* secondFile, int tolerance, float maxDifferentFraction)
+{
+	std::vector<unsigned char> first;
+	std::vector<unsigned char> second;
+	int firstWidth = 0;
+	int firstHeight = 0;
+	int secondWidth = 0;
+	int secondHeight = 0;
+	if ((ReadImage(firstFile, first, firstWidth, firstHeight) == false) ||
+		(ReadImage(secondFile, second, secondWidth, secondHeight) == false))
+	{
+		return(false);
+	}
+	if ((firstWidth != secondWidth) || (firstHeight != secondHeight))
+	{
+		std::cout << "Images differ in size: " << firstWidth << "x" << firstHeight
+			<< " and " << secondWidth << "x" << secondHeight << std::endl;
+		return(false);
+	}
+
+	size_t pixelCount = (size_t)firstWidth * firstHeight;
+	size_t differentCount = 0;
+	double sumDifference = 0.0;
+	double sumSquaredDifference = 0.0;
+	int maxDifference = 0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		int pixelDifference = 0;
+		for (int channel = 0; channel < 3; channel++)
+		{
+			int difference = std::abs((int)first[i * PIXEL_BYTES + channel] - (int)second[i * PIXEL_BYTES + channel]);
+			sumDifference += difference;
+			sumSquaredDifference += (double)difference * difference;
+			if (difference > pixelDifference)
+			{
+				pixelDifference = difference;
+			}
+		}
+		if (pixelDifference > tolerance)
+		{
+			differentCount++;
+		}
+		if (pixelDifference > maxDifference)
+		{
+			maxDifference = pixelDifference;
+		}
+	}
+
+	double meanDifference = sumDifference / (double)(pixelCount * 3);
+	double meanSquaredDifference = sumSquaredDifference / (double)(pixelCount * 3);
+	float differentFraction = (float)differentCount / (float)pixelCount;
+	bool bMatch = (differentFraction <= maxDifferentFraction);
+
+	std::cout << "Image difference: " << meanDifference << " mean, " << maxDifference << " max, ";
+	if (meanSquaredDifference > 0.0)
+	{
+		std::cout << (10.0 * std::log10(255.0 * 255.0 / meanSquaredDifference)) << " dB PSNR, ";
+	}
+	else
+	{
+		std::cout << "identical, ";
+	}
+	std::cout << (differentFraction * 100.0f) << "% of the pixels off by more than " << tolerance
+		<< " - " << ((bMatch == true) ? "match" : "MISMATCH") << std::endl;
+
+	return(bMatch);
+}
\ No newline at end of file
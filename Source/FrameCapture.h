@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// read the rendered frames back through pixel buffer objects and write
+// them as images or raw video on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class contains the code for capturing the frames
+ *  shown in the window without waiting for the GPU.  Each
+ *  frame is copied into one of a ring of pixel buffer
+ *  objects, and a fence is placed after the copy.  A few
+ *  frames later, once the fence has passed, the buffer is
+ *  handed to an encoder thread that reads it through its
+ *  persistent mapping and writes it to disk.  When every
+ *  buffer is still busy the frame is dropped and counted
+ *  rather than stalling the render loop.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// what the captured frames are written as
+	enum CAPTURE_MODE
+	{
+		// one TGA image per frame
+		CAPTURE_IMAGES,
+		// every frame appended to one raw BGRA video file
+		CAPTURE_VIDEO
+	};
+
+	// constructor
+	FrameCapture(CAPTURE_MODE mode, const char* outputPath);
+	// destructor
+	~FrameCapture();
+
+private:
+	// owner of a readback buffer
+	enum READBACK_STATE
+	{
+		READBACK_FREE,
+		// the GPU is copying the frame into it
+		READBACK_READING,
+		// the encoder thread is writing it out
+		READBACK_ENCODING
+	};
+
+	struct READBACK
+	{
+		GLuint buffer;
+		// persistent mapping of the buffer
+		const unsigned char* pPixels;
+		size_t capacity;
+		GLsync fence;
+		READBACK_STATE state;
+		int width;
+		int height;
+		// number of the captured frame, and the frame count
+		// when the copy was issued
+		int frameNumber;
+		int issuedAt;
+	};
+
+	static const int READBACK_COUNT = 6;
+
+	CAPTURE_MODE m_mode;
+	std::string m_outputPath;
+	READBACK m_readbacks[READBACK_COUNT];
+
+	// encoder thread and the readbacks waiting for it, in order
+	std::thread m_encoder;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	int m_queue[READBACK_COUNT];
+	int m_queueHead;
+	int m_queueCount;
+	bool m_bStopping;
+
+	// raw video output, sized by its first frame
+	std::ofstream m_videoFile;
+	int m_videoWidth;
+	int m_videoHeight;
+
+	// frames offered, copied, dropped because no buffer was free,
+	// written, and skipped by the video for having another size
+	int m_frameCount;
+	int m_capturedCount;
+	int m_droppedCount;
+	int m_encodedCount;
+	int m_skippedCount;
+	double m_encodeMilliseconds;
+
+	// make sure a readback buffer holds the passed in bytes
+	bool ReserveReadback(READBACK& readback, size_t bytes);
+	// hand the finished copies to the encoder thread
+	void CollectReadbacks(bool bWait);
+	// write out the queued frames until stopped
+	void EncoderLoop();
+	// write one frame as an image or a video frame
+	void EncodeFrame(const READBACK& readback);
+	bool WriteImage(const READBACK& readback);
+	bool WriteVideoFrame(const READBACK& readback);
+	// read the BGRA pixels of a captured TGA image
+	static bool ReadImage(const char* filename, std::vector<unsigned char>& pixels, int& width, int& height);
+
+public:
+	// copy the frame in the window's back buffer - call after
+	// the frame is drawn and before the buffers are swapped
+	void CaptureFrame(int width, int height);
+	// write out every frame still in flight and stop the
+	// encoder thread
+	void Finish();
+	// print how many frames were captured, dropped and written
+	void PrintReport();
+
+	// compare two captured images of the same size, printing
+	// how far they differ - fails when more than the passed
+	// in fraction of the pixels differ by more than tolerance
+	// levels in any channel
+	static bool CompareImages(const char* firstFile, const char* secondFile, int tolerance, float maxDifferentFraction);
+};
@@ -0,0 +1,666 @@
+///////////////////////////////////////////////////////////////////////////////
+// framegraph.cpp
+// ============
+// order the render passes of a frame from the targets they read and
+// write, and share the memory of transient targets between passes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameGraph.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <iostream>
+
+/***********************************************************
+ *  FrameGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameGraph::FrameGraph()
+{
+	m_bCompiled = false;
+	m_bReported = false;
+	m_declaredBytes = 0;
+	m_allocatedBytes = 0;
+}
+
+/***********************************************************
+ *  ~FrameGraph()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameGraph::~FrameGraph()
+{
+	DestroyGLObjects();
+	m_passes.clear();
+	m_targets.clear();
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for declaring a render target that
+ *  only lives while the passes using it run.  It gets a
+ *  texture when the graph is compiled, and only when a pass
+ *  that is not culled uses it.
+ ***********************************************************/
+int FrameGraph::CreateTarget(const char* name, const TARGET_DESC& desc)
+{
+	GRAPH_TARGET target;
+	target.name = name;
+	target.desc = desc;
+	target.bImported = false;
+	target.importedFramebuffer = 0;
+	target.firstUse = -1;
+	target.lastUse = -1;
+	target.physicalIndex = -1;
+	m_targets.push_back(target);
+	m_bCompiled = false;
+
+	return((int)m_targets.size() - 1);
+}
+
+/***********************************************************
+ *  ImportTarget()
+ *
+ *  This method is used for declaring a render target owned
+ *  outside of the graph, like the window.  What the passes
+ *  write into it is used after the frame, so its writers
+ *  are never culled.
+ ***********************************************************/
+int FrameGraph::ImportTarget(const char* name, const TARGET_DESC& desc, GLuint framebuffer)
+{
+	int target = CreateTarget(name, desc);
+	m_targets[target].bImported = true;
+	m_targets[target].importedFramebuffer = framebuffer;
+
+	return(target);
+}
+
+/***********************************************************
+ *  SetTargetDesc()
+ *
+ *  This method is used for changing the size or format of
+ *  a target.  The graph is compiled again before the next
+ *  frame only when something actually changed.
+ ***********************************************************/
+void FrameGraph::SetTargetDesc(int target, const TARGET_DESC& desc)
+{
+	if ((target < 0) || (target >= (int)m_targets.size()))
+	{
+		return;
+	}
+
+	TARGET_DESC& current = m_targets[target].desc;
+	if ((current.width != desc.width) || (current.height != desc.height) || (current.format != desc.format))
+	{
+		current = desc;
+		m_bCompiled = false;
+	}
+}
+
+/***********************************************************
+ *  AddPass()
+ *
+ *  This method is used for declaring a pass.  The function
+ *  is called every frame the pass runs, with the pass's
+ *  framebuffer bound.
+ ***********************************************************/
+int FrameGraph::AddPass(const char* name, unsigned int flags, std::function<void()> execute)
+{
+	GRAPH_PASS pass;
+	pass.name = name;
+	pass.flags = flags;
+	pass.execute = execute;
+	pass.bCulled = false;
+	pass.framebuffer = 0;
+	pass.bOwnsFramebuffer = false;
+	m_passes.push_back(pass);
+	m_bCompiled = false;
+
+	return((int)m_passes.size() - 1);
+}
+
+/***********************************************************
+ *  ReadTarget()
+ *
+ *  This method is used for declaring that a pass reads what
+ *  the writers of a target drew into it.
+ ***********************************************************/
+void FrameGraph::ReadTarget(int pass, int target)
+{
+	if ((pass >= 0) && (pass < (int)m_passes.size()) && (target >= 0) && (target < (int)m_targets.size()))
+	{
+		m_passes[pass].reads.push_back(target);
+		m_bCompiled = false;
+	}
+}
+
+/***********************************************************
+ *  WriteTarget()
+ *
+ *  This method is used for declaring that a pass draws into
+ *  a target.  The written targets are attached to the
+ *  pass's framebuffer.
+ ***********************************************************/
+void FrameGraph::WriteTarget(int pass, int target)
+{
+	if ((pass >= 0) && (pass < (int)m_passes.size()) && (target >= 0) && (target < (int)m_targets.size()))
+	{
+		m_passes[pass].writes.push_back(target);
+		m_bCompiled = false;
+	}
+}
+
+/***********************************************************
+ *  IsDepthFormat()
+ *
+ *  This method is used for checking whether a format is
+ *  attached as a depth target.
+ ***********************************************************/
+bool FrameGraph::IsDepthFormat(GLenum format)
+{
+	return((format == GL_DEPTH_COMPONENT16) || (format == GL_DEPTH_COMPONENT24) ||
+		(format == GL_DEPTH_COMPONENT32F) || (format == GL_DEPTH24_STENCIL8) ||
+		(format == GL_DEPTH32F_STENCIL8));
+}
+
+/***********************************************************
+ *  GetTargetBytes()
+ *
+ *  This method is used for getting the memory of a target
+ *  with the passed in size and format.
+ ***********************************************************/
+size_t FrameGraph::GetTargetBytes(const TARGET_DESC& desc)
+{
+	int bytesPerTexel = 4;
+	switch (desc.format)
+	{
+	case GL_R8:
+		bytesPerTexel = 1;
+		break;
+	case GL_RG8:
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16:
+		bytesPerTexel = 2;
+		break;
+	case GL_RGBA16F:
+	case GL_DEPTH32F_STENCIL8:
+		bytesPerTexel = 8;
+		break;
+	case GL_RGBA32F:
+		bytesPerTexel = 16;
+		break;
+	default:
+		break;
+	}
+
+	return(GpuResources::GetTextureBytes(desc.width, desc.height, bytesPerTexel, false));
+}
+
+/***********************************************************
+ *  CullPasses()
+ *
+ *  This method is used for finding the passes that matter
+ *  to the frame - the ones with side effects, the writers of
+ *  the imported targets, and, walking back, every pass
+ *  writing a target those passes use.  The others are
+ *  culled and their targets are never allocated.
+ ***********************************************************/
+void FrameGraph::CullPasses()
+{
+	std::vector<bool> bNeededTargets(m_targets.size(), false);
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		GRAPH_PASS& pass = m_passes[i];
+		pass.bCulled = ((pass.flags & PASS_SIDE_EFFECT) == 0);
+		for (size_t j = 0; j < pass.writes.size(); j++)
+		{
+			if (m_targets[pass.writes[j]].bImported == true)
+			{
+				pass.bCulled = false;
+			}
+		}
+	}
+
+	// a kept pass needs what it reads and the earlier contents
+	// of what it writes, until no more passes are kept
+	bool bChanged = true;
+	while (bChanged == true)
+	{
+		bChanged = false;
+		for (size_t i = 0; i < m_passes.size(); i++)
+		{
+			if (m_passes[i].bCulled == true)
+			{
+				continue;
+			}
+			for (size_t j = 0; j < m_passes[i].reads.size(); j++)
+			{
+				bNeededTargets[m_passes[i].reads[j]] = true;
+			}
+			for (size_t j = 0; j < m_passes[i].writes.size(); j++)
+			{
+				bNeededTargets[m_passes[i].writes[j]] = true;
+			}
+		}
+
+		for (size_t i = 0; i < m_passes.size(); i++)
+		{
+			GRAPH_PASS& pass = m_passes[i];
+			for (size_t j = 0; (j < pass.writes.size()) && (pass.bCulled == true); j++)
+			{
+				if (bNeededTargets[pass.writes[j]] == true)
+				{
+					pass.bCulled = false;
+					bChanged = true;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SortPasses()
+ *
+ *  This method is used for ordering the kept passes.  The
+ *  writers of a target run in the order they were declared,
+ *  and the passes that only read it run after all of them,
+ *  wherever they were declared.  Among the passes that are
+ *  free to run, the one declared first goes first.  A cycle
+ *  fails the compile.
+ ***********************************************************/
+bool FrameGraph::SortPasses()
+{
+	int passCount = (int)m_passes.size();
+	std::vector<std::vector<int> > successors(passCount);
+	std::vector<int> predecessorCounts(passCount, 0);
+
+	for (int target = 0; target < (int)m_targets.size(); target++)
+	{
+		int lastWriter = -1;
+		std::vector<int> writers;
+		for (int i = 0; i < passCount; i++)
+		{
+			const GRAPH_PASS& pass = m_passes[i];
+			if ((pass.bCulled == false) && (std::find(pass.writes.begin(), pass.writes.end(), target) != pass.writes.end()))
+			{
+				if (lastWriter >= 0)
+				{
+					successors[lastWriter].push_back(i);
+					predecessorCounts[i]++;
+				}
+				lastWriter = i;
+				writers.push_back(i);
+			}
+		}
+
+		for (int i = 0; i < passCount; i++)
+		{
+			const GRAPH_PASS& pass = m_passes[i];
+			if ((pass.bCulled == true) || (std::find(writers.begin(), writers.end(), i) != writers.end()) ||
+				(std::find(pass.reads.begin(), pass.reads.end(), target) == pass.reads.end()))
+			{
+				continue;
+			}
+			for (size_t j = 0; j < writers.size(); j++)
+			{
+				successors[writers[j]].push_back(i);
+				predecessorCounts[i]++;
+			}
+		}
+	}
+
+	m_order.clear();
+	std::vector<bool> bDone(passCount, false);
+	int keptCount = 0;
+	for (int i = 0; i < passCount; i++)
+	{
+		keptCount += (m_passes[i].bCulled == false) ? 1 : 0;
+	}
+
+	while ((int)m_order.size() < keptCount)
+	{
+		int next = -1;
+		for (int i = 0; (i < passCount) && (next < 0); i++)
+		{
+			if ((m_passes[i].bCulled == false) && (bDone[i] == false) && (predecessorCounts[i] == 0))
+			{
+				next = i;
+			}
+		}
+		if (next < 0)
+		{
+			std::cout << "Frame graph: the passes depend on each other in a cycle" << std::endl;
+			m_order.clear();
+			return(false);
+		}
+
+		bDone[next] = true;
+		m_order.push_back(next);
+		for (size_t j = 0; j < successors[next].size(); j++)
+		{
+			predecessorCounts[successors[next][j]]--;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  AssignTextures()
+ *
+ *  This method is used for finding the lifetime of every
+ *  transient target in the execution order, and giving
+ *  each one a texture.  Going through the targets by their
+ *  first use, a target takes over the texture of an earlier
+ *  target of the same size and format that is no longer
+ *  used, and only gets a new texture when there is none.
+ ***********************************************************/
+void FrameGraph::AssignTextures()
+{
+	for (size_t i = 0; i < m_targets.size(); i++)
+	{
+		m_targets[i].firstUse = -1;
+		m_targets[i].lastUse = -1;
+		m_targets[i].physicalIndex = -1;
+	}
+
+	for (int position = 0; position < (int)m_order.size(); position++)
+	{
+		const GRAPH_PASS& pass = m_passes[m_order[position]];
+		for (int k = 0; k < 2; k++)
+		{
+			const std::vector<int>& used = (k == 0) ? pass.reads : pass.writes;
+			for (size_t j = 0; j < used.size(); j++)
+			{
+				GRAPH_TARGET& target = m_targets[used[j]];
+				if (target.firstUse < 0)
+				{
+					target.firstUse = position;
+				}
+				target.lastUse = position;
+			}
+		}
+	}
+
+	std::vector<int> transients;
+	for (int i = 0; i < (int)m_targets.size(); i++)
+	{
+		if ((m_targets[i].bImported == false) && (m_targets[i].firstUse >= 0))
+		{
+			transients.push_back(i);
+		}
+	}
+	std::stable_sort(transients.begin(), transients.end(),
+		[this](int a, int b) { return(m_targets[a].firstUse < m_targets[b].firstUse); });
+
+	m_declaredBytes = 0;
+	m_allocatedBytes = 0;
+	for (size_t i = 0; i < transients.size(); i++)
+	{
+		GRAPH_TARGET& target = m_targets[transients[i]];
+		m_declaredBytes += GetTargetBytes(target.desc);
+
+		for (size_t j = 0; (j < m_physicalTargets.size()) && (target.physicalIndex < 0); j++)
+		{
+			PHYSICAL_TARGET& physical = m_physicalTargets[j];
+			if ((physical.desc.width == target.desc.width) && (physical.desc.height == target.desc.height) &&
+				(physical.desc.format == target.desc.format) && (physical.lastUse < target.firstUse))
+			{
+				target.physicalIndex = (int)j;
+				physical.lastUse = target.lastUse;
+			}
+		}
+
+		if (target.physicalIndex < 0)
+		{
+			PHYSICAL_TARGET physical;
+			physical.desc = target.desc;
+			physical.texture = 0;
+			physical.lastUse = target.lastUse;
+			m_physicalTargets.push_back(physical);
+			target.physicalIndex = (int)m_physicalTargets.size() - 1;
+			m_allocatedBytes += GetTargetBytes(target.desc);
+		}
+	}
+
+	for (size_t i = 0; i < m_physicalTargets.size(); i++)
+	{
+		PHYSICAL_TARGET& physical = m_physicalTargets[i];
+		glGenTextures(1, &physical.texture);
+		glBindTexture(GL_TEXTURE_2D, physical.texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, physical.desc.format, physical.desc.width, physical.desc.height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GpuResources::Track(GpuResources::RESOURCE_TEXTURE, physical.texture,
+			GetTargetBytes(physical.desc), "FrameGraph targets");
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  CreateFramebuffers()
+ *
+ *  This method is used for giving every kept pass that
+ *  writes targets a framebuffer.  A pass writing an imported
+ *  target draws into its framebuffer, and the others get
+ *  one with their written textures attached in the order
+ *  they were declared.
+ ***********************************************************/
+void FrameGraph::CreateFramebuffers()
+{
+	for (size_t i = 0; i < m_order.size(); i++)
+	{
+		GRAPH_PASS& pass = m_passes[m_order[i]];
+		pass.framebuffer = 0;
+		pass.bOwnsFramebuffer = false;
+
+		bool bImported = false;
+		for (size_t j = 0; j < pass.writes.size(); j++)
+		{
+			if (m_targets[pass.writes[j]].bImported == true)
+			{
+				pass.framebuffer = m_targets[pass.writes[j]].importedFramebuffer;
+				bImported = true;
+			}
+		}
+		if ((bImported == true) || (pass.writes.size() == 0))
+		{
+			continue;
+		}
+
+		glGenFramebuffers(1, &pass.framebuffer);
+		GpuResources::Track(GpuResources::RESOURCE_FRAMEBUFFER, pass.framebuffer, 0, "FrameGraph targets");
+		pass.bOwnsFramebuffer = true;
+		glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+
+		GLenum drawBuffers[8];
+		int colorCount = 0;
+		for (size_t j = 0; j < pass.writes.size(); j++)
+		{
+			const GRAPH_TARGET& target = m_targets[pass.writes[j]];
+			GLuint texture = m_physicalTargets[target.physicalIndex].texture;
+			if (IsDepthFormat(target.desc.format) == true)
+			{
+				GLenum attachment = ((target.desc.format == GL_DEPTH24_STENCIL8) || (target.desc.format == GL_DEPTH32F_STENCIL8)) ?
+					GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+				glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+			}
+			else if (colorCount < 8)
+			{
+				drawBuffers[colorCount] = GL_COLOR_ATTACHMENT0 + colorCount;
+				glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[colorCount], GL_TEXTURE_2D, texture, 0);
+				colorCount++;
+			}
+		}
+		if (colorCount > 0)
+		{
+			glDrawBuffers(colorCount, drawBuffers);
+		}
+		else
+		{
+			glDrawBuffer(GL_NONE);
+		}
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Frame graph: the targets of pass " << pass.name << " are incomplete" << std::endl;
+		}
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  DestroyGLObjects()
+ *
+ *  This method is used for freeing the shared textures and
+ *  the framebuffers of the passes.
+ ***********************************************************/
+void FrameGraph::DestroyGLObjects()
+{
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		if (m_passes[i].bOwnsFramebuffer == true)
+		{
+			GpuResources::Release(GpuResources::RESOURCE_FRAMEBUFFER, m_passes[i].framebuffer);
+			glDeleteFramebuffers(1, &m_passes[i].framebuffer);
+		}
+		m_passes[i].framebuffer = 0;
+		m_passes[i].bOwnsFramebuffer = false;
+	}
+
+	for (size_t i = 0; i < m_physicalTargets.size(); i++)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_TEXTURE, m_physicalTargets[i].texture);
+		glDeleteTextures(1, &m_physicalTargets[i].texture);
+	}
+	m_physicalTargets.clear();
+	m_bCompiled = false;
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for culling and ordering the passes
+ *  and allocating the targets of the kept ones.  It runs on
+ *  the first frame and whenever a target changed, and the
+ *  report is printed the first time only.
+ ***********************************************************/
+bool FrameGraph::Compile()
+{
+	DestroyGLObjects();
+
+	CullPasses();
+	if (SortPasses() == false)
+	{
+		return(false);
+	}
+	AssignTextures();
+	CreateFramebuffers();
+
+	m_bCompiled = true;
+	if (m_bReported == false)
+	{
+		PrintReport();
+		m_bReported = true;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for running the kept passes in
+ *  order.  The framebuffer of each pass that writes targets
+ *  is bound before its function is called.
+ ***********************************************************/
+void FrameGraph::Execute()
+{
+	if ((m_bCompiled == false) && (Compile() == false))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_order.size(); i++)
+	{
+		GRAPH_PASS& pass = m_passes[m_order[i]];
+		if (pass.writes.size() > 0)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+		}
+		pass.execute();
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  GetTexture()
+ *
+ *  This method is used for getting the texture a target was
+ *  given, or 0 for an imported or unused target.  Targets
+ *  sharing a texture hold the contents of the last writer.
+ ***********************************************************/
+GLuint FrameGraph::GetTexture(int target)
+{
+	if ((target < 0) || (target >= (int)m_targets.size()) || (m_targets[target].physicalIndex < 0))
+	{
+		return(0);
+	}
+
+	return(m_physicalTargets[m_targets[target].physicalIndex].texture);
+}
+
+/***********************************************************
+ *  GetFramebuffer()
+ *
+ *  This method is used for getting the framebuffer a pass
+ *  draws into, so a later pass can read or blit from it.
+ ***********************************************************/
+GLuint FrameGraph::GetFramebuffer(int pass)
+{
+	if ((pass < 0) || (pass >= (int)m_passes.size()))
+	{
+		return(0);
+	}
+
+	return(m_passes[pass].framebuffer);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the order the passes
+ *  run in, the culled passes, and the memory of the
+ *  transient targets.  The memory saved by sharing is only
+ *  mentioned when targets actually shared a texture.
+ ***********************************************************/
+void FrameGraph::PrintReport()
+{
+	std::cout << "Frame graph: ";
+	for (size_t i = 0; i < m_order.size(); i++)
+	{
+		std::cout << ((i > 0) ? " -> " : "") << m_passes[m_order[i]].name;
+	}
+
+	int culledCount = 0;
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		if (m_passes[i].bCulled == true)
+		{
+			std::cout << ((culledCount == 0) ? ", culled " : ", ") << m_passes[i].name;
+			culledCount++;
+		}
+	}
+
+	std::cout << std::endl << "Frame graph: transient targets use " << m_physicalTargets.size() << " textures of "
+		<< m_allocatedBytes / 1024 << " KB";
+	if (m_allocatedBytes < m_declaredBytes)
+	{
+		std::cout << ", sharing saved " << (m_declaredBytes - m_allocatedBytes) / 1024 << " KB";
+	}
+	std::cout << std::endl;
+}
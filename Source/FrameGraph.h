@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// framegraph.h
+// ============
+// order the render passes of a frame from the targets they read and
+// write, and share the memory of transient targets between passes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameGraph
+ *
+ *  This class contains the code for describing a frame as
+ *  passes that declare the render targets they read and
+ *  write, instead of each pass owning its targets.  When the
+ *  graph is compiled, the passes are put in an order that
+ *  runs every writer before its readers, passes whose output
+ *  nothing uses are culled, and each transient target lives
+ *  from its first to its last use.  Transient targets of the
+ *  same size and format whose lifetimes do not overlap share
+ *  one texture.  The graph is declared once, compiled again
+ *  only when a target changes size, and run every frame
+ *  without allocating.
+ ***********************************************************/
+class FrameGraph
+{
+public:
+	// constructor
+	FrameGraph();
+	// destructor
+	~FrameGraph();
+
+	// size and internal format of a render target - a depth
+	// format is attached as the depth target of its writers
+	struct TARGET_DESC
+	{
+		int width;
+		int height;
+		GLenum format;
+	};
+
+	// passes that are never culled, since they have effects
+	// outside of the graph's targets
+	enum PASS_FLAGS
+	{
+		PASS_NONE = 0,
+		PASS_SIDE_EFFECT = 1 << 0
+	};
+
+private:
+	struct GRAPH_TARGET
+	{
+		std::string name;
+		TARGET_DESC desc;
+		// imported targets are owned outside of the graph, and
+		// what they hold is used after the frame
+		bool bImported;
+		GLuint importedFramebuffer;
+		// first and last place in the execution order it is
+		// used at, and the shared texture it was given
+		int firstUse;
+		int lastUse;
+		int physicalIndex;
+	};
+
+	struct GRAPH_PASS
+	{
+		std::string name;
+		unsigned int flags;
+		std::function<void()> execute;
+		std::vector<int> reads;
+		std::vector<int> writes;
+		bool bCulled;
+		// framebuffer holding the written targets, and whether
+		// the graph owns it
+		GLuint framebuffer;
+		bool bOwnsFramebuffer;
+	};
+
+	// texture shared by the transient targets given to it
+	struct PHYSICAL_TARGET
+	{
+		TARGET_DESC desc;
+		GLuint texture;
+		int lastUse;
+	};
+
+	std::vector<GRAPH_TARGET> m_targets;
+	std::vector<GRAPH_PASS> m_passes;
+	std::vector<PHYSICAL_TARGET> m_physicalTargets;
+	// indices of the passes that run, in execution order
+	std::vector<int> m_order;
+	bool m_bCompiled;
+	// the report is printed after the first compile only, not
+	// again for every resize
+	bool m_bReported;
+
+	// bytes of the transient targets as declared, and as
+	// allocated after sharing
+	size_t m_declaredBytes;
+	size_t m_allocatedBytes;
+
+	// put the passes in an order where every writer of a
+	// target runs before the passes that read it
+	bool SortPasses();
+	// cull the passes no output depends on
+	void CullPasses();
+	// give every transient target a texture, sharing them
+	// between targets whose lifetimes do not overlap
+	void AssignTextures();
+	// create the framebuffer of each pass for its targets
+	void CreateFramebuffers();
+	// free the textures and framebuffers
+	void DestroyGLObjects();
+
+	static bool IsDepthFormat(GLenum format);
+	static size_t GetTargetBytes(const TARGET_DESC& desc);
+
+public:
+	// declare a target that lives only within the frame
+	int CreateTarget(const char* name, const TARGET_DESC& desc);
+	// declare a target owned outside of the graph, drawn into
+	// through the passed in framebuffer - 0 for the window
+	int ImportTarget(const char* name, const TARGET_DESC& desc, GLuint framebuffer);
+	// change the size or format of a target, compiling the
+	// graph again before the next frame
+	void SetTargetDesc(int target, const TARGET_DESC& desc);
+
+	// declare a pass run by the passed in function
+	int AddPass(const char* name, unsigned int flags, std::function<void()> execute);
+	// declare the targets a pass reads and writes
+	void ReadTarget(int pass, int target);
+	void WriteTarget(int pass, int target);
+
+	// order and cull the passes, and allocate the targets
+	bool Compile();
+	// run the passes in order, each with its framebuffer bound
+	void Execute();
+
+	// get the texture of a target, valid while the graph runs
+	GLuint GetTexture(int target);
+	// get the framebuffer a pass draws into
+	GLuint GetFramebuffer(int pass);
+
+	// print the pass order, the culled passes and the memory
+	// of the transient targets
+	void PrintReport();
+};
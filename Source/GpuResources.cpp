@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresources.cpp
+// ============
+// keep a registry of the OpenGL objects the application creates, with
+// their sizes and owners, for reporting video memory use and leaks
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuResources.h"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+// declaration of global variables
+namespace
+{
+	struct TRACKED_RESOURCE
+	{
+		GpuResources::RESOURCE_TYPE type;
+		GLuint name;
+		size_t bytes;
+		const char* owner;
+	};
+
+	struct RESOURCE_REGISTRY
+	{
+		// guards the registry - loader threads may create objects
+		// on a shared context
+		std::mutex mutex;
+		// tracked objects by their type and name
+		std::unordered_map<unsigned long long, TRACKED_RESOURCE> resources;
+		size_t liveBytes[GpuResources::RESOURCE_TYPE_COUNT];
+		int liveCount[GpuResources::RESOURCE_TYPE_COUNT];
+	};
+
+	const char* const RESOURCE_TYPE_NAMES[GpuResources::RESOURCE_TYPE_COUNT] =
+	{
+		"textures",
+		"buffers",
+		"renderbuffers",
+		"framebuffers",
+		"vertex arrays",
+		"programs",
+		"queries"
+	};
+
+	// the registry is created on first use, so objects created
+	// by other global constructors are tracked too
+	RESOURCE_REGISTRY& GetRegistry()
+	{
+		static RESOURCE_REGISTRY registry = {};
+		return(registry);
+	}
+
+	unsigned long long MakeKey(GpuResources::RESOURCE_TYPE type, GLuint name)
+	{
+		return(((unsigned long long)type << 32) | name);
+	}
+
+	// the delete call matching the type of an object
+	void DeleteResource(GpuResources::RESOURCE_TYPE type, GLuint name)
+	{
+		switch (type)
+		{
+		case GpuResources::RESOURCE_TEXTURE:
+			glDeleteTextures(1, &name);
+			break;
+		case GpuResources::RESOURCE_BUFFER:
+			glDeleteBuffers(1, &name);
+			break;
+		case GpuResources::RESOURCE_RENDERBUFFER:
+			glDeleteRenderbuffers(1, &name);
+			break;
+		case GpuResources::RESOURCE_FRAMEBUFFER:
+			glDeleteFramebuffers(1, &name);
+			break;
+		case GpuResources::RESOURCE_VERTEX_ARRAY:
+			glDeleteVertexArrays(1, &name);
+			break;
+		case GpuResources::RESOURCE_PROGRAM:
+			glDeleteProgram(name);
+			break;
+		case GpuResources::RESOURCE_QUERY:
+			glDeleteQueries(1, &name);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// bytes with a binary unit, for the printed reports
+	void PrintBytes(size_t bytes)
+	{
+		if (bytes >= 1024 * 1024)
+		{
+			std::cout << ((double)bytes / (1024.0 * 1024.0)) << " MB";
+		}
+		else if (bytes >= 1024)
+		{
+			std::cout << ((double)bytes / 1024.0) << " KB";
+		}
+		else
+		{
+			std::cout << bytes << " bytes";
+		}
+	}
+}
+
+/***********************************************************
+ *  Track()
+ *
+ *  This method is used for recording an object that was
+ *  just created.  Tracking an object again replaces its
+ *  size and owner.
+ ***********************************************************/
+void GpuResources::Track(RESOURCE_TYPE type, GLuint name, size_t bytes, const char* owner)
+{
+	if ((name == 0) || (type >= RESOURCE_TYPE_COUNT))
+	{
+		return;
+	}
+
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	TRACKED_RESOURCE& resource = registry.resources[MakeKey(type, name)];
+	if (resource.name == name)
+	{
+		registry.liveBytes[type] -= resource.bytes;
+		registry.liveCount[type]--;
+	}
+
+	resource.type = type;
+	resource.name = name;
+	resource.bytes = bytes;
+	resource.owner = owner;
+	registry.liveBytes[type] += bytes;
+	registry.liveCount[type]++;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for forgetting an object before it
+ *  is deleted.  Objects that were never tracked are ignored.
+ ***********************************************************/
+void GpuResources::Release(RESOURCE_TYPE type, GLuint name)
+{
+	if ((name == 0) || (type >= RESOURCE_TYPE_COUNT))
+	{
+		return;
+	}
+
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::unordered_map<unsigned long long, TRACKED_RESOURCE>::iterator it = registry.resources.find(MakeKey(type, name));
+	if (it == registry.resources.end())
+	{
+		return;
+	}
+
+	registry.liveBytes[type] -= it->second.bytes;
+	registry.liveCount[type]--;
+	registry.resources.erase(it);
+}
+
+/***********************************************************
+ *  GetTextureBytes()
+ *
+ *  This method is used for estimating the memory of a 2D
+ *  texture.  A full mipmap chain adds about a third.
+ ***********************************************************/
+size_t GpuResources::GetTextureBytes(int width, int height, int bytesPerTexel, bool bMipmaps)
+{
+	size_t bytes = 0;
+	while ((width > 0) && (height > 0))
+	{
+		bytes += (size_t)width * height * bytesPerTexel;
+		if ((bMipmaps == false) || ((width == 1) && (height == 1)))
+		{
+			break;
+		}
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	return(bytes);
+}
+
+/***********************************************************
+ *  GetLiveBytes()
+ *
+ *  This method is used for getting the tracked bytes of the
+ *  live objects of a category.
+ ***********************************************************/
+size_t GpuResources::GetLiveBytes(RESOURCE_TYPE type)
+{
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	return(registry.liveBytes[type]);
+}
+
+/***********************************************************
+ *  GetLiveCount()
+ *
+ *  This method is used for getting the number of live
+ *  objects of a category.
+ ***********************************************************/
+int GpuResources::GetLiveCount(RESOURCE_TYPE type)
+{
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	return(registry.liveCount[type]);
+}
+
+/***********************************************************
+ *  GetTotalLiveBytes()
+ *
+ *  This method is used for getting the tracked bytes of
+ *  every live object.
+ ***********************************************************/
+size_t GpuResources::GetTotalLiveBytes()
+{
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	size_t bytes = 0;
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; i++)
+	{
+		bytes += registry.liveBytes[i];
+	}
+
+	return(bytes);
+}
+
+/***********************************************************
+ *  PrintUsage()
+ *
+ *  This method is used for printing the live objects and
+ *  bytes of the categories that have any.
+ ***********************************************************/
+void GpuResources::PrintUsage()
+{
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	size_t totalBytes = 0;
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; i++)
+	{
+		totalBytes += registry.liveBytes[i];
+	}
+
+	std::cout << "GPU memory: ";
+	PrintBytes(totalBytes);
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; i++)
+	{
+		if (registry.liveCount[i] > 0)
+		{
+			std::cout << ", " << registry.liveCount[i] << " " << RESOURCE_TYPE_NAMES[i] << " ";
+			PrintBytes(registry.liveBytes[i]);
+		}
+	}
+	std::cout << std::endl;
+}
+
+/***********************************************************
+ *  ReleaseLeaks()
+ *
+ *  This method is used for printing every object that is
+ *  still tracked after its owners were destroyed, and
+ *  deleting it so nothing outlives the context.
+ ***********************************************************/
+int GpuResources::ReleaseLeaks()
+{
+	RESOURCE_REGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	int leakCount = 0;
+	size_t leakBytes = 0;
+	std::unordered_map<unsigned long long, TRACKED_RESOURCE>::iterator it;
+	for (it = registry.resources.begin(); it != registry.resources.end(); it++)
+	{
+		const TRACKED_RESOURCE& resource = it->second;
+		std::cout << "Leaked " << RESOURCE_TYPE_NAMES[resource.type] << " object " << resource.name
+			<< " of " << ((NULL != resource.owner) ? resource.owner : "unknown owner") << ", ";
+		PrintBytes(resource.bytes);
+		std::cout << std::endl;
+
+		DeleteResource(resource.type, resource.name);
+		leakCount++;
+		leakBytes += resource.bytes;
+	}
+
+	registry.resources.clear();
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; i++)
+	{
+		registry.liveBytes[i] = 0;
+		registry.liveCount[i] = 0;
+	}
+
+	std::cout << "GPU resources: " << leakCount << " leaked objects, ";
+	PrintBytes(leakBytes);
+	std::cout << std::endl;
+
+	return(leakCount);
+}
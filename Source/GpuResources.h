@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresources.h
+// ============
+// keep a registry of the OpenGL objects the application creates, with
+// their sizes and owners, for reporting video memory use and leaks
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+/***********************************************************
+ *  GpuResources
+ *
+ *  This class contains the code for accounting the OpenGL
+ *  objects that hold video memory.  Each object is tracked
+ *  right after it is created and released right before it
+ *  is deleted, so the live bytes of every category can be
+ *  read at any time.  The objects still tracked when the
+ *  application shuts down are leaks - they are printed with
+ *  their owners and then deleted, while the context is
+ *  still current.
+ ***********************************************************/
+class GpuResources
+{
+public:
+	// kinds of tracked objects, each freed by its own call
+	enum RESOURCE_TYPE
+	{
+		RESOURCE_TEXTURE,
+		RESOURCE_BUFFER,
+		RESOURCE_RENDERBUFFER,
+		RESOURCE_FRAMEBUFFER,
+		RESOURCE_VERTEX_ARRAY,
+		RESOURCE_PROGRAM,
+		RESOURCE_QUERY,
+		RESOURCE_TYPE_COUNT
+	};
+
+	// record a created object, its estimated size in bytes and
+	// the name of the code that owns it - the owner must be a
+	// string that outlives the object
+	static void Track(RESOURCE_TYPE type, GLuint name, size_t bytes, const char* owner);
+	// forget an object that is about to be deleted
+	static void Release(RESOURCE_TYPE type, GLuint name);
+
+	// estimated bytes of a texture, including its mipmaps
+	static size_t GetTextureBytes(int width, int height, int bytesPerTexel, bool bMipmaps);
+
+	static size_t GetLiveBytes(RESOURCE_TYPE type);
+	static int GetLiveCount(RESOURCE_TYPE type);
+	static size_t GetTotalLiveBytes();
+	// print the live objects and bytes of every category
+	static void PrintUsage();
+	// print and delete every object still tracked, returning
+	// how many there were - call once the owners are destroyed
+	static int ReleaseLeaks();
+};
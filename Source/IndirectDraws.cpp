@@ -0,0 +1,529 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectdraws.cpp
+// ============
+// collect the draws of a frame into an indirect command buffer and
+// submit them with multi-draw indirect calls
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IndirectDraws.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// shader storage binding point of the draw records
+	const GLuint DRAW_RECORD_BINDING = 0;
+	// draws the list of the first frame has room for
+	const int INITIAL_DRAW_CAPACITY = 64;
+	// starting size of each frame's region of the ring buffer -
+	// it grows to fit the largest frame
+	const size_t RING_REGION_BYTES = 64 * 1024;
+	// clip distances the vertex shader writes for the edges of
+	// a view's part of the target
+	const int VIEW_CLIP_PLANES = 4;
+}
+
+/***********************************************************
+ *  IndirectDraws()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IndirectDraws::IndirectDraws(MeshBuffer* pMeshBuffer, ShaderVariants* pShaderVariants)
+{
+	m_pMeshBuffer = pMeshBuffer;
+	m_pShaderVariants = pShaderVariants;
+	m_pFrameArena = NULL;
+	m_pItems = NULL;
+	m_itemCount = 0;
+	m_itemCapacity = 0;
+	m_lastItemCount = 0;
+	m_pCommands = NULL;
+	m_pRecords = NULL;
+	m_pRingBuffer = new RingBuffer(RING_REGION_BYTES);
+	m_commandOffset = 0;
+	m_recordAlignment = 0;
+	m_submitCount = 0;
+	m_stateChanges = 0;
+	m_triangleCount = 0;
+	m_pBoundShader = NULL;
+	m_bDepthPrepass = false;
+	m_viewCount = 1;
+	m_bCountOverdraw = false;
+	m_overdrawQueries[0] = 0;
+	m_overdrawQueries[1] = 0;
+	m_overdrawFrame = 0;
+	m_overdraw = 0.0f;
+}
+
+/***********************************************************
+ *  ~IndirectDraws()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+IndirectDraws::~IndirectDraws()
+{
+	if (NULL != m_pRingBuffer)
+	{
+		delete m_pRingBuffer;
+		m_pRingBuffer = NULL;
+	}
+	if (m_overdrawQueries[0] != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_QUERY, m_overdrawQueries[0]);
+		GpuResources::Release(GpuResources::RESOURCE_QUERY, m_overdrawQueries[1]);
+		glDeleteQueries(2, m_overdrawQueries);
+		m_overdrawQueries[0] = 0;
+		m_overdrawQueries[1] = 0;
+	}
+	m_pMeshBuffer = NULL;
+	m_pShaderVariants = NULL;
+	m_pFrameArena = NULL;
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for clearing the draws of the last
+ *  frame before the new frame is collected.  The list of
+ *  draws is taken from the passed in frame arena, sized for
+ *  as many draws as the last frame had.
+ ***********************************************************/
+void IndirectDraws::Begin(FrameArena* pFrameArena)
+{
+	m_pFrameArena = pFrameArena;
+	m_lastItemCount = m_itemCount;
+	m_itemCount = 0;
+	m_itemCapacity = std::max(m_lastItemCount, INITIAL_DRAW_CAPACITY);
+	m_pItems = m_pFrameArena->AllocateArray<DRAW_ITEM>(m_itemCapacity);
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method is used for adding the draw of a mesh with
+ *  the passed in shader variant and per-draw values.
+ *  Transparent draws are blended over the opaque scene.
+ ***********************************************************/
+void IndirectDraws::AddDraw(int meshID, unsigned int variantFlags, const DRAW_RECORD& record, bool bTransparent)
+{
+	const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(meshID);
+	glm::vec3 center = glm::vec3(record.model * glm::vec4(range.center, 1.0f));
+
+	AddDrawRange(meshID, 0, range.indexCount, center, variantFlags, record, bTransparent);
+}
+
+/***********************************************************
+ *  AddDrawRange()
+ *
+ *  This method is used for adding a draw of part of the
+ *  indices of a mesh, like the visible objects of a static
+ *  batch.  The center orders the draw by view distance.
+ ***********************************************************/
+void IndirectDraws::AddDrawRange(int meshID, unsigned int firstIndex, unsigned int indexCount, glm::vec3 center, unsigned int variantFlags, const DRAW_RECORD& record, bool bTransparent)
+{
+	DRAW_ITEM item;
+	item.variantFlags = variantFlags;
+	item.meshID = meshID;
+	item.firstIndex = firstIndex;
+	item.indexCount = indexCount;
+	item.record = record;
+	item.bTransparent = bTransparent;
+	item.center = center;
+	item.viewDistance = 0.0f;
+
+	// compact positions are expanded to the mesh bounds by the
+	// model matrix, and need the shader variant that decodes them
+	if (m_pMeshBuffer->IsCompact() == true)
+	{
+		item.variantFlags |= ShaderVariants::VARIANT_COMPACT_VERTICES;
+		item.record.model = record.model * m_pMeshBuffer->GetDequantizeMatrix(meshID);
+	}
+
+	// a full list moves to a bigger array in the frame arena -
+	// the old array is given back when the arena is reset
+	if (m_itemCount == m_itemCapacity)
+	{
+		int newCapacity = m_itemCapacity * 2;
+		DRAW_ITEM* pNewItems = m_pFrameArena->AllocateArray<DRAW_ITEM>(newCapacity);
+		std::copy(m_pItems, m_pItems + m_itemCount, pNewItems);
+		m_pItems = pNewItems;
+		m_itemCapacity = newCapacity;
+	}
+
+	m_pItems[m_itemCount++] = item;
+}
+
+/***********************************************************
+ *  DrawRange()
+ *
+ *  This method is used for issuing the draws between the
+ *  passed in positions of the submission order, with one
+ *  multi-draw call for each run of the same shader variant.
+ ***********************************************************/
+void IndirectDraws::DrawRange(const DRAW_LIST& list, int first, int last, int lightCount)
+{
+	while (first < last)
+	{
+		unsigned int flags = list.pItems[list.pOrder[first]].variantFlags;
+		int runEnd = first + 1;
+		while ((runEnd < last) && (list.pItems[list.pOrder[runEnd]].variantFlags == flags))
+		{
+			runEnd++;
+		}
+
+		GLint firstDrawLocation = -1;
+		ShaderManager* pShader = m_pShaderVariants->UseVariant(flags, lightCount, firstDrawLocation);
+		if (NULL != pShader)
+		{
+			if (pShader != m_pBoundShader)
+			{
+				m_pBoundShader = pShader;
+				m_stateChanges++;
+			}
+			// gl_DrawID restarts at zero for each multi-draw call -
+			// the location was looked up when the variant was built
+			glUniform1i(firstDrawLocation, first);
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES,
+				GL_UNSIGNED_INT,
+				(void*)(m_commandOffset + first * sizeof(DRAW_COMMAND)),
+				runEnd - first,
+				0);
+			m_submitCount++;
+		}
+
+		first = runEnd;
+	}
+}
+
+/***********************************************************
+ *  BeginOverdrawQuery()
+ *
+ *  This method is used for reading the samples passed by
+ *  the last frame, when the GPU has finished it, and for
+ *  starting to count the samples of this frame.
+ ***********************************************************/
+void IndirectDraws::BeginOverdrawQuery()
+{
+	if (m_overdrawQueries[0] == 0)
+	{
+		glGenQueries(2, m_overdrawQueries);
+		GpuResources::Track(GpuResources::RESOURCE_QUERY, m_overdrawQueries[0], 0, "IndirectDraws overdraw");
+		GpuResources::Track(GpuResources::RESOURCE_QUERY, m_overdrawQueries[1], 0, "IndirectDraws overdraw");
+		m_overdrawFrame = 0;
+	}
+
+	if (m_overdrawFrame > 0)
+	{
+		GLuint lastQuery = m_overdrawQueries[(m_overdrawFrame + 1) % 2];
+		GLuint available = 0;
+		glGetQueryObjectuiv(lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != 0)
+		{
+			GLuint samples = 0;
+			GLint viewport[4] = { 0, 0, 0, 0 };
+			glGetQueryObjectuiv(lastQuery, GL_QUERY_RESULT, &samples);
+			glGetIntegerv(GL_VIEWPORT, viewport);
+			if ((viewport[2] > 0) && (viewport[3] > 0))
+			{
+				m_overdraw = (float)samples / (float)(viewport[2] * viewport[3]);
+			}
+		}
+	}
+
+	glBeginQuery(GL_SAMPLES_PASSED, m_overdrawQueries[m_overdrawFrame % 2]);
+	m_overdrawFrame++;
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for sorting the collected draws into
+ *  two queues.  Opaque draws are grouped by shader variant
+ *  and ordered front to back within each group, so the depth
+ *  test rejects hidden fragments early.  Transparent draws
+ *  are ordered back to front, so they blend over everything
+ *  behind them.  No OpenGL call is made.
+ ***********************************************************/
+void IndirectDraws::Finish(glm::vec3 viewPosition, DRAW_LIST& list)
+{
+	// split the draws into the two queues
+	int* pOrder = m_pFrameArena->AllocateArray<int>(std::max(m_itemCount, 1));
+	int opaqueCount = 0;
+	for (int i = 0; i < m_itemCount; i++)
+	{
+		glm::vec3 offset = m_pItems[i].center - viewPosition;
+		m_pItems[i].viewDistance = glm::dot(offset, offset);
+		if (m_pItems[i].bTransparent == false)
+		{
+			pOrder[opaqueCount++] = i;
+		}
+	}
+	int transparentIndex = opaqueCount;
+	for (int i = 0; i < m_itemCount; i++)
+	{
+		if (m_pItems[i].bTransparent == true)
+		{
+			pOrder[transparentIndex++] = i;
+		}
+	}
+
+	const DRAW_ITEM* pItems = m_pItems;
+	std::sort(pOrder, pOrder + opaqueCount,
+		[pItems](int first, int second)
+		{
+			if (pItems[first].variantFlags != pItems[second].variantFlags)
+			{
+				return(pItems[first].variantFlags < pItems[second].variantFlags);
+			}
+			return(pItems[first].viewDistance < pItems[second].viewDistance);
+		});
+	std::sort(pOrder + opaqueCount, pOrder + m_itemCount,
+		[pItems](int first, int second) { return(pItems[first].viewDistance > pItems[second].viewDistance); });
+
+	list.pItems = m_pItems;
+	list.pOrder = pOrder;
+	list.itemCount = m_itemCount;
+	list.opaqueCount = opaqueCount;
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for writing the draws of a finished
+ *  list into the command and record buffers and drawing its
+ *  two queues.  The opaque queue is drawn without blending,
+ *  and the transparent queue is blended without writing the
+ *  depth.
+ ***********************************************************/
+void IndirectDraws::Submit(const DRAW_LIST& list, int lightCount)
+{
+	m_submitCount = 0;
+	m_stateChanges = 0;
+	m_triangleCount = 0;
+	m_pBoundShader = NULL;
+	if ((list.itemCount == 0) || (NULL == m_pMeshBuffer) || (NULL == m_pShaderVariants))
+	{
+		return;
+	}
+
+	// the region of the frame may still be read by the GPU
+	m_pRingBuffer->BeginFrame();
+
+	size_t commandBytes = list.itemCount * sizeof(DRAW_COMMAND);
+	size_t recordBytes = list.itemCount * sizeof(DRAW_RECORD);
+	if (m_recordAlignment == 0)
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_recordAlignment = std::max(alignment, (GLint)sizeof(GLuint));
+	}
+
+	// the commands and records are written straight into the
+	// frame's region of the ring buffer, in order
+	if (m_pRingBuffer->Reserve(commandBytes + m_recordAlignment + recordBytes, m_recordAlignment) == false)
+	{
+		m_pRingBuffer->EndFrame();
+		return;
+	}
+	size_t recordOffset = 0;
+	m_pCommands = (DRAW_COMMAND*)m_pRingBuffer->Allocate(commandBytes, sizeof(GLuint), m_commandOffset);
+	m_pRecords = (DRAW_RECORD*)m_pRingBuffer->Allocate(recordBytes, m_recordAlignment, recordOffset);
+
+	// the command and the record of a draw share the same index
+	for (int i = 0; i < list.itemCount; i++)
+	{
+		const DRAW_ITEM& item = list.pItems[list.pOrder[i]];
+		const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(item.meshID);
+
+		m_pCommands[i].count = item.indexCount;
+		m_pCommands[i].instanceCount = m_viewCount;
+		m_pCommands[i].firstIndex = range.firstIndex + item.firstIndex;
+		m_pCommands[i].baseVertex = (GLint)range.firstVertex;
+		m_pCommands[i].baseInstance = 0;
+		m_pRecords[i] = item.record;
+		m_triangleCount += (item.indexCount / 3) * (unsigned long long)m_viewCount;
+	}
+
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_RECORD_BINDING, m_pRingBuffer->GetBuffer(), recordOffset, recordBytes);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_pRingBuffer->GetBuffer());
+
+	m_pMeshBuffer->Bind();
+	// the record range, the indirect buffer and the mesh buffer
+	m_stateChanges += 3;
+
+	// each view clips its instances to its part of the target
+	if (m_viewCount > 1)
+	{
+		for (int i = 0; i < VIEW_CLIP_PLANES; i++)
+		{
+			glEnable(GL_CLIP_DISTANCE0 + i);
+		}
+		m_stateChanges += VIEW_CLIP_PLANES;
+	}
+
+	// opaque queue - blending is only paid for by transparent draws
+	glDisable(GL_BLEND);
+	m_stateChanges++;
+	if (m_bDepthPrepass == true)
+	{
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		DrawRange(list, 0, list.opaqueCount, lightCount);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+		// only the nearest fragment of each pixel is shaded
+		glDepthFunc(GL_LEQUAL);
+		glDepthMask(GL_FALSE);
+		m_stateChanges += 4;
+	}
+
+	if (m_bCountOverdraw == true)
+	{
+		BeginOverdrawQuery();
+	}
+
+	DrawRange(list, 0, list.opaqueCount, lightCount);
+
+	// transparent queue
+	if (list.opaqueCount < list.itemCount)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+		DrawRange(list, list.opaqueCount, list.itemCount, lightCount);
+		glDisable(GL_BLEND);
+		m_stateChanges += 4;
+	}
+
+	if (m_bCountOverdraw == true)
+	{
+		glEndQuery(GL_SAMPLES_PASSED);
+	}
+
+	if (m_viewCount > 1)
+	{
+		for (int i = 0; i < VIEW_CLIP_PLANES; i++)
+		{
+			glDisable(GL_CLIP_DISTANCE0 + i);
+		}
+	}
+
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+	glBindVertexArray(0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	// the region is written again three frames from now, after
+	// the GPU has passed this fence
+	m_pRingBuffer->EndFrame();
+}
+
+/***********************************************************
+ *  SetViewCount()
+ *
+ *  This method is used for setting the number of views the
+ *  draws are submitted for.  Each draw command gets one
+ *  instance per view, so the commands, records and culling
+ *  of a frame are shared by all of its views.
+ ***********************************************************/
+void IndirectDraws::SetViewCount(int viewCount)
+{
+	m_viewCount = std::max(viewCount, 1);
+}
+
+/***********************************************************
+ *  SetDepthPrepass()
+ *
+ *  This method is used for enabling a depth-only pass over
+ *  the opaque draws, so the shading pass only runs the
+ *  fragment shader once per pixel.
+ ***********************************************************/
+void IndirectDraws::SetDepthPrepass(bool bDepthPrepass)
+{
+	m_bDepthPrepass = bDepthPrepass;
+}
+
+/***********************************************************
+ *  SetOverdrawCounter()
+ *
+ *  This method is used for enabling the count of samples
+ *  that pass the depth test in the shading passes.
+ ***********************************************************/
+void IndirectDraws::SetOverdrawCounter(bool bCountOverdraw)
+{
+	m_bCountOverdraw = bCountOverdraw;
+	m_overdrawFrame = 0;
+	m_overdraw = 0.0f;
+}
+
+/***********************************************************
+ *  GetOverdraw()
+ *
+ *  This method is used for getting the shaded samples per
+ *  pixel of the last frame the GPU finished.  A value of 1
+ *  means every pixel was shaded exactly once.
+ ***********************************************************/
+float IndirectDraws::GetOverdraw()
+{
+	return(m_overdraw);
+}
+
+/***********************************************************
+ *  GetRingBuffer()
+ *
+ *  This method is used for getting the ring buffer the
+ *  commands and records are streamed through.
+ ***********************************************************/
+RingBuffer* IndirectDraws::GetRingBuffer()
+{
+	return(m_pRingBuffer);
+}
+
+/***********************************************************
+ *  GetDrawCount()
+ *
+ *  This method is used for getting the number of draws
+ *  added in the current frame.
+ ***********************************************************/
+int IndirectDraws::GetDrawCount()
+{
+	return(m_itemCount);
+}
+
+/***********************************************************
+ *  GetSubmitCount()
+ *
+ *  This method is used for getting the number of multi-draw
+ *  calls issued by the last submission.
+ ***********************************************************/
+int IndirectDraws::GetSubmitCount()
+{
+	return(m_submitCount);
+}
+
+/***********************************************************
+ *  GetStateChangeCount()
+ *
+ *  This method is used for getting the number of program
+ *  switches and render state changes issued by the last
+ *  submission.  A variant used again by a later multi-draw
+ *  call without another one in between is not counted.
+ ***********************************************************/
+int IndirectDraws::GetStateChangeCount()
+{
+	return(m_stateChanges);
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method is used for getting the number of triangles
+ *  drawn by the last submission, counting each view of an
+ *  instanced draw.
+ ***********************************************************/
+unsigned long long IndirectDraws::GetTriangleCount()
+{
+	return(m_triangleCount);
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectdraws.h
+// ============
+// collect the draws of a frame into an indirect command buffer and
+// submit them with multi-draw indirect calls
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuffer.h"
+#include "ShaderVariants.h"
+#include "FrameArena.h"
+#include "RingBuffer.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  IndirectDraws
+ *
+ *  This class contains the code for gathering every draw of
+ *  a frame as a draw command plus a record of its per-draw
+ *  shader values.  The draws are grouped by shader variant
+ *  and each group is submitted with one multi-draw call,
+ *  where the shaders fetch their record by draw ID.  Opaque
+ *  draws go first, front to back without blending, then
+ *  the transparent draws back to front with blending.
+ *  The draw lists live in the frame arena, so collecting
+ *  and sorting the draws does not touch the heap, and the
+ *  commands and records are written straight into a mapped
+ *  ring buffer the GPU reads them from.
+ *  Collecting and sorting make a finished draw list without
+ *  touching OpenGL, so they can run on the main thread while
+ *  the render thread submits the list of the last frame.
+ ***********************************************************/
+class IndirectDraws
+{
+public:
+	// constructor
+	IndirectDraws(MeshBuffer* pMeshBuffer, ShaderVariants* pShaderVariants);
+	// destructor
+	~IndirectDraws();
+
+	// per-draw shader values - the layout must match the
+	// std430 DrawRecord struct in the GLSL shaders
+	struct DRAW_RECORD
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		// the w components hold ambient strength and shininess
+		glm::vec4 ambientColor;
+		glm::vec4 diffuseColor;
+		glm::vec4 specularColor;
+		glm::vec2 uvScale;
+		int textureSlot;
+		// index of the lightmap coordinate of the mesh's first
+		// vertex, read by the lightmap variants only
+		int lightmapFirst;
+	};
+
+	// layout defined by OpenGL for indirect indexed draws
+	struct DRAW_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	struct DRAW_ITEM
+	{
+		unsigned int variantFlags;
+		int meshID;
+		// part of the mesh's indices that is drawn
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		DRAW_RECORD record;
+		bool bTransparent;
+		// world space center of the mesh, and its squared
+		// distance to the viewer used for sorting
+		glm::vec3 center;
+		float viewDistance;
+	};
+
+	// the sorted draws of a frame - the opaque draws come first
+	// in the order, and the arrays live in the frame arena the
+	// list was collected in
+	struct DRAW_LIST
+	{
+		const DRAW_ITEM* pItems;
+		const int* pOrder;
+		int itemCount;
+		int opaqueCount;
+	};
+
+private:
+	// pointer to the shared mesh buffer
+	MeshBuffer* m_pMeshBuffer;
+	// pointer to shader variants object
+	ShaderVariants* m_pShaderVariants;
+	// memory for the draw list being collected
+	FrameArena* m_pFrameArena;
+
+	// draws added since the frame began
+	DRAW_ITEM* m_pItems;
+	int m_itemCount;
+	int m_itemCapacity;
+	// draws added in the last frame, used for sizing the list
+	// of the next one
+	int m_lastItemCount;
+	// commands and records in submission order, in the mapped
+	// ring buffer
+	DRAW_COMMAND* m_pCommands;
+	DRAW_RECORD* m_pRecords;
+
+	// GPU buffer the commands and records of each frame are
+	// written into, and the offset of the frame's commands
+	RingBuffer* m_pRingBuffer;
+	size_t m_commandOffset;
+	// offset alignment OpenGL needs for binding the records
+	size_t m_recordAlignment;
+
+	// multi-draw calls, program and render state changes, and
+	// triangles of all views issued by the last submission
+	int m_submitCount;
+	int m_stateChanges;
+	unsigned long long m_triangleCount;
+	// program bound by the last multi-draw call of the submission
+	ShaderManager* m_pBoundShader;
+	// lay down the opaque depth before shading the opaque draws
+	bool m_bDepthPrepass;
+	// views every draw is instanced into
+	int m_viewCount;
+
+	// samples passed queries for measuring the overdraw - two are
+	// used so the result of the last frame is read without waiting
+	bool m_bCountOverdraw;
+	GLuint m_overdrawQueries[2];
+	int m_overdrawFrame;
+	float m_overdraw;
+
+	// issue one multi-draw call for each run of the same shader
+	// variant in part of the submission order
+	void DrawRange(const DRAW_LIST& list, int first, int last, int lightCount);
+	// read the finished overdraw query and start the next one
+	void BeginOverdrawQuery();
+
+public:
+	// start collecting the draws of a new frame in the passed
+	// in frame arena, which must have been reset before
+	void Begin(FrameArena* pFrameArena);
+	// add a draw of a mesh from the shared mesh buffer to the
+	// opaque or the transparent queue
+	void AddDraw(int meshID, unsigned int variantFlags, const DRAW_RECORD& record, bool bTransparent);
+	// add a draw of part of the indices of a mesh, centered on
+	// the passed in world space position
+	void AddDrawRange(int meshID, unsigned int firstIndex, unsigned int indexCount, glm::vec3 center, unsigned int variantFlags, const DRAW_RECORD& record, bool bTransparent);
+	// sort the opaque and the transparent queues by distance to
+	// the viewer into the finished draw list of the frame
+	void Finish(glm::vec3 viewPosition, DRAW_LIST& list);
+	// upload the commands and records of a finished draw list
+	// and submit it - the ring buffer region of the frame may
+	// have to wait for the GPU
+	void Submit(const DRAW_LIST& list, int lightCount);
+
+	// set the number of views each draw is drawn into, as
+	// one instance per view
+	void SetViewCount(int viewCount);
+	// enable a depth-only pass over the opaque draws
+	void SetDepthPrepass(bool bDepthPrepass);
+	// enable counting the shaded samples per pixel
+	void SetOverdrawCounter(bool bCountOverdraw);
+	// shaded samples per pixel of the last finished frame
+	float GetOverdraw();
+
+	// ring buffer holding the commands and records, for its
+	// fence wait statistics
+	RingBuffer* GetRingBuffer();
+
+	// draws added in the current frame
+	int GetDrawCount();
+	// multi-draw calls issued by the last submission
+	int GetSubmitCount();
+	// program and render state changes issued by the last
+	// submission
+	int GetStateChangeCount();
+	// triangles drawn by the last submission, over all views
+	unsigned long long GetTriangleCount();
+};
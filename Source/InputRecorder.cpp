@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.cpp
+// ============
+// record the input that moves the camera to a file, and replay it at a
+// fixed timestep so benchmark runs see exactly the same frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// first line of a recording, with its format version
+	const char* const RECORDING_HEADER = "INPUT_RECORDING 1";
+	// the camera is stepped as if every frame took this long
+	const float FIXED_TIMESTEP = 1.0f / 60.0f;
+	// camera distance below which a replayed frame matches the
+	// recorded one
+	const float CAMERA_TOLERANCE = 1e-4f;
+
+	// percentile of sorted frame times
+	double Percentile(const std::vector<double>& sorted, double fraction)
+	{
+		if (sorted.empty() == true)
+		{
+			return(0.0);
+		}
+
+		size_t index = (size_t)std::lround(fraction * (double)(sorted.size() - 1));
+		return(sorted[std::min(index, sorted.size() - 1)]);
+	}
+}
+
+/***********************************************************
+ *  InputRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InputRecorder::InputRecorder()
+{
+	m_mode = RECORDER_OFF;
+	m_frame = 0;
+	m_maxCameraError = 0.0f;
+	m_firstDivergentFrame = -1;
+	m_bTimingStarted = false;
+}
+
+/***********************************************************
+ *  ~InputRecorder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InputRecorder::~InputRecorder()
+{
+	if (m_file.is_open() == true)
+	{
+		m_file.close();
+	}
+	m_frames.clear();
+	m_events.clear();
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method is used for creating the recording file.
+ *  The values are written with enough digits to read back
+ *  exactly the same floats and doubles.
+ ***********************************************************/
+bool InputRecorder::StartRecording(const char* path)
+{
+	m_file.open(path, std::ios::trunc);
+	if (m_file.is_open() == false)
+	{
+		std::cout << "Could not create input recording: " << path << std::endl;
+		return(false);
+	}
+
+	m_file << RECORDING_HEADER << "\n" << std::setprecision(17);
+	m_path = path;
+	m_mode = RECORDER_RECORD;
+	m_frame = 0;
+
+	std::cout << "Recording input to " << m_path << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  StartReplay()
+ *
+ *  This method is used for loading a recording to replay.
+ *  Each frame line collects the cursor and scroll events
+ *  written before it, and the camera line after it.
+ ***********************************************************/
+bool InputRecorder::StartReplay(const char* path)
+{
+	std::ifstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not open input recording: " << path << std::endl;
+		return(false);
+	}
+
+	std::string line;
+	std::getline(file, line);
+	if (line.compare(0, std::string(RECORDING_HEADER).size(), RECORDING_HEADER) != 0)
+	{
+		std::cout << "Not an input recording: " << path << std::endl;
+		return(false);
+	}
+
+	m_frames.clear();
+	m_events.clear();
+	int pendingEvents = 0;
+	bool bValid = true;
+
+	while ((bValid == true) && std::getline(file, line))
+	{
+		std::istringstream values(line);
+		char tag = 0;
+		values >> tag;
+
+		if ((tag == 'M') || (tag == 'S'))
+		{
+			INPUT_EVENT event;
+			event.type = (tag == 'M') ? INPUT_CURSOR : INPUT_SCROLL;
+			values >> event.x >> event.y;
+			m_events.push_back(event);
+			pendingEvents++;
+		}
+		else if (tag == 'F')
+		{
+			INPUT_FRAME frame;
+			int number = 0;
+			values >> number >> frame.time >> frame.keys;
+			frame.firstEvent = (int)m_events.size() - pendingEvents;
+			frame.eventCount = pendingEvents;
+			frame.camera = CAMERA_STATE();
+			m_frames.push_back(frame);
+			pendingEvents = 0;
+		}
+		else if ((tag == 'C') && (m_frames.empty() == false))
+		{
+			CAMERA_STATE& camera = m_frames.back().camera;
+			values >> camera.position.x >> camera.position.y >> camera.position.z
+				>> camera.front.x >> camera.front.y >> camera.front.z
+				>> camera.up.x >> camera.up.y >> camera.up.z
+				>> camera.yaw >> camera.pitch >> camera.zoom >> camera.movementSpeed;
+		}
+		else if (tag != 0)
+		{
+			bValid = false;
+		}
+
+		if (values.fail() == true)
+		{
+			bValid = false;
+		}
+	}
+
+	if ((bValid == false) || (m_frames.empty() == true))
+	{
+		std::cout << "Input recording is damaged or empty: " << path << std::endl;
+		m_frames.clear();
+		m_events.clear();
+		return(false);
+	}
+
+	// the timings are stored without growing during the replay
+	m_frameMilliseconds.reserve(m_frames.size());
+	m_gpuMilliseconds.reserve(m_frames.size());
+
+	m_path = path;
+	m_mode = RECORDER_REPLAY;
+	m_frame = 0;
+	m_maxCameraError = 0.0f;
+	m_firstDivergentFrame = -1;
+
+	std::cout << "Replaying " << m_frames.size() << " frames of input from " << m_path << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsRecording()
+ *
+ *  This method is used for checking whether input is being
+ *  recorded.
+ ***********************************************************/
+bool InputRecorder::IsRecording()
+{
+	return(m_mode == RECORDER_RECORD);
+}
+
+/***********************************************************
+ *  IsReplaying()
+ *
+ *  This method is used for checking whether input is being
+ *  replayed.
+ ***********************************************************/
+bool InputRecorder::IsReplaying()
+{
+	return(m_mode == RECORDER_REPLAY);
+}
+
+/***********************************************************
+ *  GetTimestep()
+ *
+ *  This method is used for getting the seconds the camera
+ *  moves by on each recorded or replayed frame.
+ ***********************************************************/
+float InputRecorder::GetTimestep()
+{
+	return(FIXED_TIMESTEP);
+}
+
+/***********************************************************
+ *  RecordCursor()
+ *
+ *  This method is used for writing a cursor position event.
+ *  It belongs to the next frame that is recorded.
+ ***********************************************************/
+void InputRecorder::RecordCursor(double x, double y)
+{
+	if (m_mode == RECORDER_RECORD)
+	{
+		m_file << "M " << x << " " << y << "\n";
+	}
+}
+
+/***********************************************************
+ *  RecordScroll()
+ *
+ *  This method is used for writing a scroll event.  It
+ *  belongs to the next frame that is recorded.
+ ***********************************************************/
+void InputRecorder::RecordScroll(double x, double y)
+{
+	if (m_mode == RECORDER_RECORD)
+	{
+		m_file << "S " << x << " " << y << "\n";
+	}
+}
+
+/***********************************************************
+ *  RecordFrame()
+ *
+ *  This method is used for writing the start of a frame,
+ *  its wall clock time and the keys held in it.
+ ***********************************************************/
+void InputRecorder::RecordFrame(double time, unsigned int keys)
+{
+	if (m_mode == RECORDER_RECORD)
+	{
+		m_file << "F " << m_frame << " " << time << " " << keys << "\n";
+		m_frame++;
+	}
+}
+
+/***********************************************************
+ *  RecordCamera()
+ *
+ *  This method is used for writing the camera a recorded
+ *  frame ended with, for checking the replay against it.
+ ***********************************************************/
+void InputRecorder::RecordCamera(const CAMERA_STATE& camera)
+{
+	if (m_mode == RECORDER_RECORD)
+	{
+		m_file << "C " << camera.position.x << " " << camera.position.y << " " << camera.position.z
+			<< " " << camera.front.x << " " << camera.front.y << " " << camera.front.z
+			<< " " << camera.up.x << " " << camera.up.y << " " << camera.up.z
+			<< " " << camera.yaw << " " << camera.pitch << " " << camera.zoom
+			<< " " << camera.movementSpeed << "\n";
+	}
+}
+
+/***********************************************************
+ *  ReplayFrame()
+ *
+ *  This method is used for getting the held keys and the
+ *  events of the next replayed frame.  It fails once every
+ *  recorded frame was replayed.
+ ***********************************************************/
+bool InputRecorder::ReplayFrame(unsigned int& keys, const INPUT_EVENT*& pEvents, int& eventCount)
+{
+	keys = 0;
+	pEvents = NULL;
+	eventCount = 0;
+	if ((m_mode != RECORDER_REPLAY) || (m_frame >= (int)m_frames.size()))
+	{
+		return(false);
+	}
+
+	const INPUT_FRAME& frame = m_frames[m_frame];
+	keys = frame.keys;
+	eventCount = frame.eventCount;
+	if (eventCount > 0)
+	{
+		pEvents = &m_events[frame.firstEvent];
+	}
+	m_frame++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CheckCamera()
+ *
+ *  This method is used for comparing the camera of the
+ *  frame just replayed with the one that was recorded.
+ ***********************************************************/
+void InputRecorder::CheckCamera(const CAMERA_STATE& camera)
+{
+	if ((m_mode != RECORDER_REPLAY) || (m_frame <= 0) || (m_frame > (int)m_frames.size()))
+	{
+		return;
+	}
+
+	const CAMERA_STATE& recorded = m_frames[m_frame - 1].camera;
+	float error = std::max(
+		glm::length(camera.position - recorded.position),
+		glm::length(camera.front - recorded.front));
+	error = std::max(error, std::fabs(camera.zoom - recorded.zoom));
+
+	m_maxCameraError = std::max(m_maxCameraError, error);
+	if ((error > CAMERA_TOLERANCE) && (m_firstDivergentFrame < 0))
+	{
+		m_firstDivergentFrame = m_frame - 1;
+	}
+}
+
+/***********************************************************
+ *  EndFrameTiming()
+ *
+ *  This method is used for storing the time of the frame
+ *  that was just shown.  The wall time is measured between
+ *  the calls, so the first call only starts the clock.
+ ***********************************************************/
+void InputRecorder::EndFrameTiming(double gpuMilliseconds)
+{
+	if (m_mode != RECORDER_REPLAY)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if ((m_bTimingStarted == true) && (m_frameMilliseconds.size() < m_frameMilliseconds.capacity()))
+	{
+		m_frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(now - m_lastFrameTime).count());
+		m_gpuMilliseconds.push_back(gpuMilliseconds);
+	}
+	m_lastFrameTime = now;
+	m_bTimingStarted = true;
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for closing the recording, or for
+ *  writing the replayed frame timings to the passed in CSV
+ *  file and printing their summary and the camera check.
+ ***********************************************************/
+void InputRecorder::Finish(const char* timingPath)
+{
+	if (m_mode == RECORDER_RECORD)
+	{
+		m_file.close();
+		std::cout << "Recorded " << m_frame << " frames of input to " << m_path << std::endl;
+	}
+	else if (m_mode == RECORDER_REPLAY)
+	{
+		std::ofstream file(timingPath, std::ios::trunc);
+		if (file.is_open() == true)
+		{
+			file << "frame,frame_ms,gpu_ms\n";
+			for (size_t i = 0; i < m_frameMilliseconds.size(); i++)
+			{
+				file << (i + 1) << "," << m_frameMilliseconds[i] << "," << m_gpuMilliseconds[i] << "\n";
+			}
+		}
+		else
+		{
+			std::cout << "Could not write replay timings: " << timingPath << std::endl;
+		}
+
+		std::vector<double> sorted = m_frameMilliseconds;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0.0;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			total += sorted[i];
+		}
+
+		std::cout << "Replay: " << m_frame << " of " << m_frames.size() << " frames";
+		if (sorted.empty() == false)
+		{
+			std::cout << ", mean " << (total / sorted.size()) << " ms"
+				<< ", median " << Percentile(sorted, 0.5) << " ms"
+				<< ", 95th " << Percentile(sorted, 0.95) << " ms"
+				<< ", 99th " << Percentile(sorted, 0.99) << " ms"
+				<< ", worst " << sorted.back() << " ms";
+		}
+		std::cout << std::endl;
+
+		if (m_firstDivergentFrame < 0)
+		{
+			std::cout << "Replayed camera matched the recording, largest error " << m_maxCameraError << std::endl;
+		}
+		else
+		{
+			std::cout << "Replayed camera left the recorded path at frame " << m_firstDivergentFrame
+				<< ", largest error " << m_maxCameraError << std::endl;
+		}
+	}
+
+	m_mode = RECORDER_OFF;
+}
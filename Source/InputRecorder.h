@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.h
+// ============
+// record the input that moves the camera to a file, and replay it at a
+// fixed timestep so benchmark runs see exactly the same frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  InputRecorder
+ *
+ *  This class contains the code for recording and replaying
+ *  the camera input of a run.  While recording, every frame
+ *  writes the keys that were held, the cursor and scroll
+ *  events that arrived before it, and the camera state it
+ *  ended with.  The camera is stepped by a fixed timestep in
+ *  both modes instead of the measured frame time, so a
+ *  replay reaches the same camera state on every frame no
+ *  matter how fast it runs.  The replay compares the camera
+ *  against the recorded one, and times every frame so the
+ *  runs of two builds can be compared.
+ ***********************************************************/
+class InputRecorder
+{
+public:
+	// constructor
+	InputRecorder();
+	// destructor
+	~InputRecorder();
+
+	// the camera values a frame ends with
+	struct CAMERA_STATE
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		float yaw;
+		float pitch;
+		float zoom;
+		float movementSpeed;
+	};
+
+	enum INPUT_EVENT_TYPE
+	{
+		INPUT_CURSOR,
+		INPUT_SCROLL
+	};
+
+	// a cursor position or scroll offset, in the order GLFW
+	// delivered them
+	struct INPUT_EVENT
+	{
+		INPUT_EVENT_TYPE type;
+		double x;
+		double y;
+	};
+
+private:
+	enum RECORDER_MODE
+	{
+		RECORDER_OFF,
+		RECORDER_RECORD,
+		RECORDER_REPLAY
+	};
+
+	// a replayed frame - its events are a range of m_events
+	struct INPUT_FRAME
+	{
+		double time;
+		unsigned int keys;
+		int firstEvent;
+		int eventCount;
+		CAMERA_STATE camera;
+	};
+
+	RECORDER_MODE m_mode;
+	std::string m_path;
+	// the file being recorded
+	std::ofstream m_file;
+	// frames written or replayed so far
+	int m_frame;
+
+	// the loaded recording
+	std::vector<INPUT_FRAME> m_frames;
+	std::vector<INPUT_EVENT> m_events;
+
+	// largest distance between the replayed and recorded camera,
+	// and the first frame it was off by more than the tolerance
+	float m_maxCameraError;
+	int m_firstDivergentFrame;
+
+	// wall time and smoothed GPU time of every replayed frame
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+	bool m_bTimingStarted;
+	std::vector<double> m_frameMilliseconds;
+	std::vector<double> m_gpuMilliseconds;
+
+public:
+	// start writing a recording, or load one to replay
+	bool StartRecording(const char* path);
+	bool StartReplay(const char* path);
+
+	bool IsRecording();
+	bool IsReplaying();
+	// seconds the camera is stepped by on every recorded or
+	// replayed frame
+	float GetTimestep();
+
+	// recording - write the events as they arrive, and each
+	// frame's held keys and final camera
+	void RecordCursor(double x, double y);
+	void RecordScroll(double x, double y);
+	void RecordFrame(double time, unsigned int keys);
+	void RecordCamera(const CAMERA_STATE& camera);
+
+	// replay - get the keys and events of the next frame, which
+	// fails once the recording has ended
+	bool ReplayFrame(unsigned int& keys, const INPUT_EVENT*& pEvents, int& eventCount);
+	// compare the camera of the replayed frame with the recorded one
+	void CheckCamera(const CAMERA_STATE& camera);
+	// time the replayed frame that was just shown
+	void EndFrameTiming(double gpuMilliseconds);
+
+	// close the recording, or write the frame timings of the
+	// replay as CSV and print their summary
+	void Finish(const char* timingPath);
+};
@@ -0,0 +1,952 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapper.cpp
+// ============
+// bake the diffuse lighting of the static surfaces into a lightmap
+// atlas with a multi-threaded CPU ray tracer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Lightmapper.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// width and height of the lightmap atlas in texels
+	const int ATLAS_SIZE = 1024;
+	// texels per world unit the surfaces are baked at, lowered
+	// until every triangle fits into the atlas
+	const float MAX_TEXELS_PER_UNIT = 16.0f;
+	const float MIN_TEXELS_PER_UNIT = 0.5f;
+	// smallest and largest cell of a triangle, including the one
+	// texel border that keeps the filtering inside the cell
+	const int MIN_CELL_SIZE = 4;
+	const int MAX_CELL_SIZE = 128;
+	// rays toward points of each light's sphere - the fraction
+	// that reaches the light softens the shadow edges
+	const int SHADOW_SAMPLES = 8;
+	const float LIGHT_RADIUS = 0.5f;
+	// hemisphere rays for the ambient occlusion, and how far an
+	// occluder darkens the ambient light
+	const int OCCLUSION_SAMPLES = 16;
+	const float OCCLUSION_DISTANCE = 2.0f;
+	// distance the rays start off the surface, and the closest
+	// hit that counts, so a surface does not shadow itself
+	const float RAY_OFFSET = 0.002f;
+	const float RAY_MIN_DISTANCE = 0.0001f;
+	// triangles in a leaf of the bounding volume hierarchy
+	const int BVH_LEAF_SIZE = 4;
+	const int BVH_MAX_DEPTH = 64;
+	// shader storage binding of the lightmap coordinates, next
+	// to the draw records at binding 0
+	const int LIGHTMAP_COORDINATE_BINDING = 1;
+	// header of the cache file - the version changes with the
+	// layout of the file or the way the texels are baked
+	const unsigned int CACHE_MAGIC = 0x50414D4C;
+	const unsigned int CACHE_VERSION = 1;
+
+	// xorshift generator - every texel seeds its own, so a bake
+	// gives the same texels on any number of threads
+	unsigned int NextRandom(unsigned int& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return(state);
+	}
+
+	// random float from 0 up to 1
+	float RandomFloat(unsigned int& state)
+	{
+		return((float)(NextRandom(state) >> 8) * (1.0f / 16777216.0f));
+	}
+
+	// add bytes to a 64-bit FNV-1a hash
+	void HashBytes(unsigned long long& hash, const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	// slab test of a ray against a bounding box
+	bool RayHitsBox(glm::vec3 origin, glm::vec3 inverseDirection, glm::vec3 boundsMin, glm::vec3 boundsMax, float maxDistance)
+	{
+		glm::vec3 toMin = (boundsMin - origin) * inverseDirection;
+		glm::vec3 toMax = (boundsMax - origin) * inverseDirection;
+		glm::vec3 entry = glm::min(toMin, toMax);
+		glm::vec3 exit = glm::max(toMin, toMax);
+		float enter = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+		float leave = std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+
+		return(enter <= leave);
+	}
+}
+
+/***********************************************************
+ *  Lightmapper()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Lightmapper::Lightmapper()
+{
+	m_atlasSize = ATLAS_SIZE;
+	m_texelsPerUnit = MAX_TEXELS_PER_UNIT;
+	m_nextTriangle = 0;
+	m_threadCount = 0;
+	m_finishedThreads = 0;
+	m_bBakeStarted = false;
+	m_cacheKey = 0;
+	m_bFromCache = false;
+	m_bKeepTexels = false;
+	m_bakeMilliseconds = 0.0;
+	m_texture = 0;
+	m_coordinateBuffer = 0;
+}
+
+/***********************************************************
+ *  ~Lightmapper()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Lightmapper::~Lightmapper()
+{
+	JoinBakeThreads();
+	DestroyGLObjects();
+	Clear();
+	m_lights.clear();
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for setting the light sources that
+ *  are baked into the lightmap.
+ ***********************************************************/
+void Lightmapper::SetLights(const BAKE_LIGHT* pLights, int lightCount)
+{
+	m_lights.assign(pLights, pLights + std::max(lightCount, 0));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting the added surfaces,
+ *  before they are added again for a new bake.
+ ***********************************************************/
+void Lightmapper::Clear()
+{
+	m_surfaces.clear();
+	m_triangles.clear();
+	m_coordinates.clear();
+	m_nodes.clear();
+	m_nodeTriangles.clear();
+	m_texels.clear();
+}
+
+/***********************************************************
+ *  AddSurface()
+ *
+ *  This method is used for adding the world space triangles
+ *  of a surface.  Each triangle must have its own three
+ *  vertices, as every vertex gets the lightmap coordinate
+ *  of one triangle's cell.  The returned index of the first
+ *  coordinate matches the surface's first vertex.
+ ***********************************************************/
+int Lightmapper::AddSurface(const MESH_VERTEX* pVertices, unsigned int vertexCount, glm::vec3 ambientColor, glm::vec3 diffuseColor)
+{
+	SURFACE surface;
+	surface.ambientColor = ambientColor;
+	surface.diffuseColor = diffuseColor;
+	surface.firstTriangle = (int)m_triangles.size();
+	surface.triangleCount = (int)(vertexCount / 3);
+
+	for (int i = 0; i < surface.triangleCount; i++)
+	{
+		BAKE_TRIANGLE triangle;
+		for (int j = 0; j < 3; j++)
+		{
+			triangle.positions[j] = pVertices[i * 3 + j].position;
+			triangle.normals[j] = pVertices[i * 3 + j].normal;
+		}
+		triangle.surfaceIndex = (int)m_surfaces.size();
+		triangle.cellX = 0;
+		triangle.cellY = 0;
+		triangle.cellSize = MIN_CELL_SIZE;
+		m_triangles.push_back(triangle);
+	}
+	m_surfaces.push_back(surface);
+	m_coordinates.resize(m_triangles.size() * 3, glm::vec2(0.0f));
+
+	return(surface.firstTriangle * 3);
+}
+
+/***********************************************************
+ *  PackAtlas()
+ *
+ *  This method is used for sizing each triangle's cell by
+ *  its edges at the passed in density, and packing the cells
+ *  into shelves of the atlas, largest first.
+ ***********************************************************/
+bool Lightmapper::PackAtlas(float texelsPerUnit)
+{
+	std::vector<int> order(m_triangles.size());
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		// the two edges from the first corner run along the
+		// sides of the cell
+		BAKE_TRIANGLE& triangle = m_triangles[i];
+		float edge = std::max(
+			glm::length(triangle.positions[1] - triangle.positions[0]),
+			glm::length(triangle.positions[2] - triangle.positions[0]));
+		int cellSize = (int)std::ceil(edge * texelsPerUnit) + 2;
+		triangle.cellSize = std::min(std::max(cellSize, MIN_CELL_SIZE), MAX_CELL_SIZE);
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int first, int second)
+		{ return(m_triangles[first].cellSize > m_triangles[second].cellSize); });
+
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+	for (int i = 0; i < order.size(); i++)
+	{
+		BAKE_TRIANGLE& triangle = m_triangles[order[i]];
+		if (x + triangle.cellSize > m_atlasSize)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (y + triangle.cellSize > m_atlasSize)
+		{
+			return(false);
+		}
+
+		triangle.cellX = x;
+		triangle.cellY = y;
+		x += triangle.cellSize;
+		shelfHeight = std::max(shelfHeight, triangle.cellSize);
+	}
+
+	m_texelsPerUnit = texelsPerUnit;
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCoordinates()
+ *
+ *  This method is used for mapping each triangle onto the
+ *  inside of its cell - the first corner to one corner of
+ *  the cell, and the other two along its sides.
+ ***********************************************************/
+void Lightmapper::WriteCoordinates()
+{
+	float texelSize = 1.0f / (float)m_atlasSize;
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		const BAKE_TRIANGLE& triangle = m_triangles[i];
+		float left = (float)(triangle.cellX + 1) * texelSize;
+		float bottom = (float)(triangle.cellY + 1) * texelSize;
+		float inner = (float)(triangle.cellSize - 2) * texelSize;
+
+		m_coordinates[i * 3 + 0] = glm::vec2(left, bottom);
+		m_coordinates[i * 3 + 1] = glm::vec2(left + inner, bottom);
+		m_coordinates[i * 3 + 2] = glm::vec2(left, bottom + inner);
+	}
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for building the hierarchy over a
+ *  range of the triangle order, splitting it at the median
+ *  centroid along its longest axis.  The index of the new
+ *  node is returned.
+ ***********************************************************/
+int Lightmapper::BuildNode(int first, int count)
+{
+	int nodeIndex = (int)m_nodes.size();
+	m_nodes.push_back(BVH_NODE());
+
+	glm::vec3 boundsMin = m_triangles[m_nodeTriangles[first]].positions[0];
+	glm::vec3 boundsMax = boundsMin;
+	glm::vec3 centroidMin = glm::vec3(INFINITY);
+	glm::vec3 centroidMax = glm::vec3(-INFINITY);
+	for (int i = first; i < first + count; i++)
+	{
+		const BAKE_TRIANGLE& triangle = m_triangles[m_nodeTriangles[i]];
+		for (int j = 0; j < 3; j++)
+		{
+			boundsMin = glm::min(boundsMin, triangle.positions[j]);
+			boundsMax = glm::max(boundsMax, triangle.positions[j]);
+		}
+		glm::vec3 centroid = (triangle.positions[0] + triangle.positions[1] + triangle.positions[2]) / 3.0f;
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+	m_nodes[nodeIndex].boundsMin = boundsMin;
+	m_nodes[nodeIndex].boundsMax = boundsMax;
+
+	if (count <= BVH_LEAF_SIZE)
+	{
+		m_nodes[nodeIndex].first = first;
+		m_nodes[nodeIndex].count = count;
+		return(nodeIndex);
+	}
+
+	glm::vec3 extent = centroidMax - centroidMin;
+	int axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	int middle = first + count / 2;
+	std::nth_element(
+		m_nodeTriangles.begin() + first,
+		m_nodeTriangles.begin() + middle,
+		m_nodeTriangles.begin() + first + count,
+		[this, axis](int firstTriangle, int secondTriangle)
+		{
+			const BAKE_TRIANGLE& a = m_triangles[firstTriangle];
+			const BAKE_TRIANGLE& b = m_triangles[secondTriangle];
+			return((a.positions[0][axis] + a.positions[1][axis] + a.positions[2][axis]) <
+				(b.positions[0][axis] + b.positions[1][axis] + b.positions[2][axis]));
+		});
+
+	// the left child is built right after its parent
+	BuildNode(first, middle - first);
+	int right = BuildNode(middle, first + count - middle);
+	m_nodes[nodeIndex].first = right;
+	m_nodes[nodeIndex].count = 0;
+
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used for checking whether a ray hits any
+ *  triangle closer than maxDistance.  The search stops at
+ *  the first hit, as only the visibility is needed.
+ ***********************************************************/
+bool Lightmapper::IsOccluded(glm::vec3 origin, glm::vec3 direction, float maxDistance) const
+{
+	if (m_nodes.size() == 0)
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection = glm::vec3(1.0f) / direction;
+	int stack[BVH_MAX_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		int nodeIndex = stack[--stackSize];
+		const BVH_NODE& node = m_nodes[nodeIndex];
+		if (RayHitsBox(origin, inverseDirection, node.boundsMin, node.boundsMax, maxDistance) == false)
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			if (stackSize + 2 <= BVH_MAX_DEPTH)
+			{
+				stack[stackSize++] = nodeIndex + 1;
+				stack[stackSize++] = node.first;
+			}
+			continue;
+		}
+
+		// Moller-Trumbore ray and triangle intersection
+		for (int i = node.first; i < node.first + node.count; i++)
+		{
+			const BAKE_TRIANGLE& triangle = m_triangles[m_nodeTriangles[i]];
+			glm::vec3 edge1 = triangle.positions[1] - triangle.positions[0];
+			glm::vec3 edge2 = triangle.positions[2] - triangle.positions[0];
+			glm::vec3 p = glm::cross(direction, edge2);
+			float determinant = glm::dot(edge1, p);
+			if (std::fabs(determinant) < 1e-9f)
+			{
+				continue;
+			}
+
+			float inverseDeterminant = 1.0f / determinant;
+			glm::vec3 t = origin - triangle.positions[0];
+			float u = glm::dot(t, p) * inverseDeterminant;
+			if ((u < 0.0f) || (u > 1.0f))
+			{
+				continue;
+			}
+			glm::vec3 q = glm::cross(t, edge1);
+			float v = glm::dot(direction, q) * inverseDeterminant;
+			if ((v < 0.0f) || (u + v > 1.0f))
+			{
+				continue;
+			}
+
+			float distance = glm::dot(edge2, q) * inverseDeterminant;
+			if ((distance > RAY_MIN_DISTANCE) && (distance < maxDistance))
+			{
+				return(true);
+			}
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  BakeTriangle()
+ *
+ *  This method is used for baking every texel of a
+ *  triangle's cell.  The texels outside of the triangle
+ *  take the closest point on it, which fills the border
+ *  the filtering reads from.  The ambient light is darkened
+ *  by the hemisphere rays that hit something, and the light
+ *  of each source by the rays toward it that are blocked.
+ ***********************************************************/
+void Lightmapper::BakeTriangle(int triangleIndex)
+{
+	const BAKE_TRIANGLE& triangle = m_triangles[triangleIndex];
+	const SURFACE& surface = m_surfaces[triangle.surfaceIndex];
+	float inner = (float)(triangle.cellSize - 2);
+
+	for (int y = 0; y < triangle.cellSize; y++)
+	{
+		for (int x = 0; x < triangle.cellSize; x++)
+		{
+			// barycentric weights of the texel center, clamped
+			// onto the triangle
+			float u = std::max(((float)x - 0.5f) / inner, 0.0f);
+			float v = std::max(((float)y - 0.5f) / inner, 0.0f);
+			if (u + v > 1.0f)
+			{
+				float sum = u + v;
+				u /= sum;
+				v /= sum;
+			}
+			float w = 1.0f - u - v;
+
+			glm::vec3 position = w * triangle.positions[0] + u * triangle.positions[1] + v * triangle.positions[2];
+			glm::vec3 normal = glm::normalize(w * triangle.normals[0] + u * triangle.normals[1] + v * triangle.normals[2]);
+			glm::vec3 origin = position + normal * RAY_OFFSET;
+
+			unsigned int seed = ((unsigned int)triangleIndex * 73856093u) ^ ((unsigned int)x * 19349663u) ^ ((unsigned int)y * 83492791u);
+			seed = (seed == 0) ? 1u : seed;
+
+			// cosine weighted directions around the normal
+			glm::vec3 tangent = glm::normalize(glm::cross((std::fabs(normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), normal));
+			glm::vec3 bitangent = glm::cross(normal, tangent);
+			int openRays = 0;
+			for (int i = 0; i < OCCLUSION_SAMPLES; i++)
+			{
+				float angle = 6.2831853f * RandomFloat(seed);
+				float radiusSquared = RandomFloat(seed);
+				float radius = std::sqrt(radiusSquared);
+				glm::vec3 direction = tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) +
+					normal * std::sqrt(1.0f - radiusSquared);
+				if (IsOccluded(origin, direction, OCCLUSION_DISTANCE) == false)
+				{
+					openRays++;
+				}
+			}
+			float occlusion = (float)openRays / (float)OCCLUSION_SAMPLES;
+
+			glm::vec3 ambient = glm::vec3(0.0f);
+			glm::vec3 diffuse = glm::vec3(0.0f);
+			for (int i = 0; i < m_lights.size(); i++)
+			{
+				const BAKE_LIGHT& light = m_lights[i];
+				ambient += light.ambientColor * occlusion;
+
+				// the same diffuse term as the light model in the
+				// fragment shader
+				float impact = std::max(glm::dot(normal, glm::normalize(light.position - position)), 0.0f);
+				if (impact <= 0.0f)
+				{
+					continue;
+				}
+
+				int visibleRays = 0;
+				for (int j = 0; j < SHADOW_SAMPLES; j++)
+				{
+					glm::vec3 offset;
+					do
+					{
+						offset = glm::vec3(RandomFloat(seed), RandomFloat(seed), RandomFloat(seed)) * 2.0f - glm::vec3(1.0f);
+					} while (glm::dot(offset, offset) > 1.0f);
+
+					glm::vec3 toLight = light.position + offset * LIGHT_RADIUS - origin;
+					float distance = glm::length(toLight);
+					if ((distance > 0.0f) && (IsOccluded(origin, toLight / distance, distance) == false))
+					{
+						visibleRays++;
+					}
+				}
+				diffuse += impact * light.diffuseColor * ((float)visibleRays / (float)SHADOW_SAMPLES);
+			}
+
+			m_texels[(triangle.cellY + y) * m_atlasSize + triangle.cellX + x] =
+				glm::vec4(ambient * surface.ambientColor + diffuse * surface.diffuseColor, 1.0f);
+		}
+	}
+}
+
+/***********************************************************
+ *  BakeThread()
+ *
+ *  This method is run by each bake thread.  The triangles
+ *  are taken one at a time, so the threads stay busy when
+ *  the cells differ in size.  Every thread writes only the
+ *  cells of its own triangles.
+ ***********************************************************/
+void Lightmapper::BakeThread()
+{
+	int triangleCount = (int)m_triangles.size();
+	int triangleIndex = m_nextTriangle.fetch_add(1);
+	while (triangleIndex < triangleCount)
+	{
+		BakeTriangle(triangleIndex);
+		triangleIndex = m_nextTriangle.fetch_add(1);
+	}
+	m_finishedThreads.fetch_add(1);
+}
+
+/***********************************************************
+ *  JoinBakeThreads()
+ *
+ *  This method is used for waiting until the threads of the
+ *  started bake have taken their last triangle.
+ ***********************************************************/
+void Lightmapper::JoinBakeThreads()
+{
+	for (int i = 0; i < m_bakeThreads.size(); i++)
+	{
+		m_bakeThreads[i].join();
+	}
+	m_bakeThreads.clear();
+}
+
+/***********************************************************
+ *  HashInputs()
+ *
+ *  This method is used for hashing the lights, materials
+ *  and triangles with the bake settings.  A cache file with
+ *  a different hash was baked for another scene.
+ ***********************************************************/
+unsigned long long Lightmapper::HashInputs()
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	const float settings[] = { m_texelsPerUnit, LIGHT_RADIUS, OCCLUSION_DISTANCE, RAY_OFFSET,
+		(float)SHADOW_SAMPLES, (float)OCCLUSION_SAMPLES, (float)m_atlasSize };
+	HashBytes(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+	HashBytes(hash, settings, sizeof(settings));
+
+	for (int i = 0; i < m_lights.size(); i++)
+	{
+		HashBytes(hash, &m_lights[i].position, sizeof(glm::vec3));
+		HashBytes(hash, &m_lights[i].ambientColor, sizeof(glm::vec3));
+		HashBytes(hash, &m_lights[i].diffuseColor, sizeof(glm::vec3));
+	}
+	for (int i = 0; i < m_surfaces.size(); i++)
+	{
+		HashBytes(hash, &m_surfaces[i].ambientColor, sizeof(glm::vec3));
+		HashBytes(hash, &m_surfaces[i].diffuseColor, sizeof(glm::vec3));
+		HashBytes(hash, &m_surfaces[i].triangleCount, sizeof(int));
+	}
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		HashBytes(hash, m_triangles[i].positions, sizeof(m_triangles[i].positions));
+		HashBytes(hash, m_triangles[i].normals, sizeof(m_triangles[i].normals));
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  LoadCache()
+ *
+ *  This method is used for reading the baked texels from
+ *  the cache file.  It fails when the file is missing or
+ *  was baked from different inputs.
+ ***********************************************************/
+bool Lightmapper::LoadCache(const char* cachePath, unsigned long long key)
+{
+	std::ifstream file(cachePath, std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	unsigned long long fileKey = 0;
+	file.read((char*)&magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&fileKey, sizeof(fileKey));
+	if ((!file) || (magic != CACHE_MAGIC) || (version != CACHE_VERSION) || (fileKey != key))
+	{
+		std::cout << "Lightmap: " << cachePath << " is out of date, baking again" << std::endl;
+		return(false);
+	}
+
+	// only the texels of the cells are stored, in triangle order
+	m_texels.assign((size_t)m_atlasSize * m_atlasSize, glm::vec4(0.0f));
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		const BAKE_TRIANGLE& triangle = m_triangles[i];
+		for (int y = 0; y < triangle.cellSize; y++)
+		{
+			file.read((char*)&m_texels[(triangle.cellY + y) * m_atlasSize + triangle.cellX], triangle.cellSize * sizeof(glm::vec4));
+		}
+	}
+
+	if (!file)
+	{
+		std::cout << "Lightmap: " << cachePath << " is truncated, baking again" << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveCache()
+ *
+ *  This method is used for writing the baked texels to the
+ *  cache file, so the next run can skip the bake.
+ ***********************************************************/
+void Lightmapper::SaveCache(const char* cachePath, unsigned long long key)
+{
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Lightmap: could not write " << cachePath << std::endl;
+		return;
+	}
+
+	file.write((const char*)&CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write((const char*)&CACHE_VERSION, sizeof(CACHE_VERSION));
+	file.write((const char*)&key, sizeof(key));
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		const BAKE_TRIANGLE& triangle = m_triangles[i];
+		for (int y = 0; y < triangle.cellSize; y++)
+		{
+			file.write((const char*)&m_texels[(triangle.cellY + y) * m_atlasSize + triangle.cellX], triangle.cellSize * sizeof(glm::vec4));
+		}
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for making the lightmap of the added
+ *  surfaces on one thread per core, and waiting for it.
+ ***********************************************************/
+bool Lightmapper::Bake(const char* cachePath)
+{
+	if (BeginBake(cachePath, (int)std::thread::hardware_concurrency()) == false)
+	{
+		return(false);
+	}
+
+	return(FinishBake());
+}
+
+/***********************************************************
+ *  BeginBake()
+ *
+ *  This method is used for starting the lightmap of the
+ *  added surfaces.  The cells are packed and the coordinates
+ *  set first, then the texels are read from the cache file,
+ *  or the hierarchy is built and the bake threads started.
+ *  The threads only touch this lightmapper's copies of the
+ *  triangles, so the caller goes on while they trace.
+ ***********************************************************/
+bool Lightmapper::BeginBake(const char* cachePath, int threadCount)
+{
+	if ((m_triangles.size() == 0) || (m_bBakeStarted == true))
+	{
+		return(false);
+	}
+
+	float texelsPerUnit = MAX_TEXELS_PER_UNIT;
+	while (PackAtlas(texelsPerUnit) == false)
+	{
+		texelsPerUnit *= 0.75f;
+		if (texelsPerUnit < MIN_TEXELS_PER_UNIT)
+		{
+			std::cout << "Lightmap: " << m_triangles.size() << " triangles do not fit into the atlas" << std::endl;
+			return(false);
+		}
+	}
+	WriteCoordinates();
+
+	m_bakeStart = std::chrono::steady_clock::now();
+	m_cachePath = (NULL != cachePath) ? cachePath : "";
+	m_cacheKey = 0;
+	m_bFromCache = false;
+	if (m_cachePath.empty() == false)
+	{
+		m_cacheKey = HashInputs();
+		m_bFromCache = LoadCache(m_cachePath.c_str(), m_cacheKey);
+	}
+
+	m_bBakeStarted = true;
+	m_finishedThreads = 0;
+	if (m_bFromCache == true)
+	{
+		return(true);
+	}
+
+	m_texels.assign((size_t)m_atlasSize * m_atlasSize, glm::vec4(0.0f));
+
+	m_nodes.clear();
+	m_nodeTriangles.resize(m_triangles.size());
+	for (int i = 0; i < m_nodeTriangles.size(); i++)
+	{
+		m_nodeTriangles[i] = i;
+	}
+	BuildNode(0, (int)m_nodeTriangles.size());
+
+	m_threadCount = std::max(threadCount, 1);
+	m_nextTriangle = 0;
+	for (int i = 0; i < m_threadCount; i++)
+	{
+		m_bakeThreads.push_back(std::thread(&Lightmapper::BakeThread, this));
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsBakeFinished()
+ *
+ *  This method is used for checking whether every thread of
+ *  the started bake has run out of triangles.
+ ***********************************************************/
+bool Lightmapper::IsBakeFinished()
+{
+	return((m_bBakeStarted == true) && (m_finishedThreads == (int)m_bakeThreads.size()));
+}
+
+/***********************************************************
+ *  FinishBake()
+ *
+ *  This method is used for waiting for the started bake,
+ *  writing its texels to the cache file and uploading the
+ *  lightmap.
+ ***********************************************************/
+bool Lightmapper::FinishBake()
+{
+	if (m_bBakeStarted == false)
+	{
+		return(false);
+	}
+
+	JoinBakeThreads();
+	m_bBakeStarted = false;
+	if ((m_bFromCache == false) && (m_cachePath.empty() == false))
+	{
+		SaveCache(m_cachePath.c_str(), m_cacheKey);
+	}
+	m_bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_bakeStart).count();
+
+	Upload();
+
+	// only the GPU copy is needed from now on, unless the
+	// texels are also drawn on the CPU
+	if (m_bKeepTexels == false)
+	{
+		std::vector<glm::vec4>().swap(m_texels);
+	}
+	std::vector<BVH_NODE>().swap(m_nodes);
+	std::vector<int>().swap(m_nodeTriangles);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for creating the lightmap texture
+ *  and the buffer of the lightmap coordinates.  The texture
+ *  is created on its own unit so the bound scene textures
+ *  are left alone.
+ ***********************************************************/
+void Lightmapper::Upload()
+{
+	DestroyGLObjects();
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, m_atlasSize, m_atlasSize, 0, GL_RGBA, GL_FLOAT, m_texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GpuResources::Track(GpuResources::RESOURCE_TEXTURE, m_texture,
+		GpuResources::GetTextureBytes(m_atlasSize, m_atlasSize, 8, false), "Lightmapper atlas");
+
+	glGenBuffers(1, &m_coordinateBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_coordinateBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(m_coordinates.size() * sizeof(glm::vec2)), m_coordinates.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, m_coordinateBuffer,
+		m_coordinates.size() * sizeof(glm::vec2), "Lightmapper coordinates");
+}
+
+/***********************************************************
+ *  DestroyGLObjects()
+ *
+ *  This method is used for freeing the lightmap texture and
+ *  the coordinate buffer.
+ ***********************************************************/
+void Lightmapper::DestroyGLObjects()
+{
+	if (m_texture != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_TEXTURE, m_texture);
+		glDeleteTextures(1, &m_texture);
+		m_texture = 0;
+	}
+	if (m_coordinateBuffer != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_coordinateBuffer);
+		glDeleteBuffers(1, &m_coordinateBuffer);
+		m_coordinateBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the lightmap to its
+ *  texture unit and the coordinates to their storage
+ *  binding, where the lightmap shader variants read them.
+ ***********************************************************/
+void Lightmapper::Bind()
+{
+	if (m_texture == 0)
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHTMAP_COORDINATE_BINDING, m_coordinateBuffer);
+}
+
+/***********************************************************
+ *  SetKeepTexels()
+ *
+ *  This method is used for keeping the baked texels in
+ *  memory after they were uploaded, for the software
+ *  rasterizer.
+ ***********************************************************/
+void Lightmapper::SetKeepTexels(bool bKeepTexels)
+{
+	m_bKeepTexels = bKeepTexels;
+}
+
+/***********************************************************
+ *  GetTexels()
+ *
+ *  This method is used for getting the texels of the
+ *  uploaded lightmap, the first row at coordinate 0.
+ ***********************************************************/
+const glm::vec4* Lightmapper::GetTexels()
+{
+	if ((m_texture == 0) || (m_texels.empty() == true))
+	{
+		return(NULL);
+	}
+
+	return(m_texels.data());
+}
+
+/***********************************************************
+ *  GetAtlasSize()
+ *
+ *  This method is used for getting the texels along each
+ *  side of the lightmap.
+ ***********************************************************/
+int Lightmapper::GetAtlasSize()
+{
+	return(m_atlasSize);
+}
+
+/***********************************************************
+ *  GetCoordinates()
+ *
+ *  This method is used for getting the lightmap coordinate
+ *  of every surface vertex, as uploaded for the shaders.
+ ***********************************************************/
+const glm::vec2* Lightmapper::GetCoordinates()
+{
+	if ((m_texture == 0) || (m_coordinates.empty() == true))
+	{
+		return(NULL);
+	}
+
+	return(m_coordinates.data());
+}
+
+/***********************************************************
+ *  GetCoordinateCount()
+ *
+ *  This method is used for getting the number of lightmap
+ *  coordinates.
+ ***********************************************************/
+int Lightmapper::GetCoordinateCount()
+{
+	return((int)m_coordinates.size());
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing how much of the atlas
+ *  the cells use and how long the lightmap took.
+ ***********************************************************/
+void Lightmapper::PrintReport()
+{
+	size_t usedTexels = 0;
+	for (int i = 0; i < m_triangles.size(); i++)
+	{
+		usedTexels += (size_t)m_triangles[i].cellSize * m_triangles[i].cellSize;
+	}
+	float atlasUse = 100.0f * (float)usedTexels / (float)((size_t)m_atlasSize * m_atlasSize);
+
+	std::cout << "Lightmap: " << m_triangles.size() << " triangles of " << m_surfaces.size() << " surfaces in a "
+		<< m_atlasSize << "x" << m_atlasSize << " atlas (" << atlasUse << "% used) at " << m_texelsPerUnit
+		<< " texels/unit, ";
+	if (m_bFromCache == true)
+	{
+		std::cout << "loaded from the cache in " << m_bakeMilliseconds << " ms" << std::endl;
+	}
+	else
+	{
+		std::cout << "baked in " << m_bakeMilliseconds << " ms on " << m_threadCount << " threads" << std::endl;
+	}
+}
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapper.h
+// ============
+// bake the diffuse lighting of the static surfaces into a lightmap
+// atlas with a multi-threaded CPU ray tracer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeGeometry.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  Lightmapper
+ *
+ *  This class contains the code for computing the lighting
+ *  of the objects that never move once, instead of for every
+ *  fragment of every frame.  Each triangle of a surface gets
+ *  its own square cell of a shared atlas texture, and every
+ *  texel of the cell traces rays against all the surfaces -
+ *  jittered rays toward each light for soft shadows, and
+ *  hemisphere rays for ambient occlusion.  The texels hold
+ *  the finished ambient and diffuse light of the surface's
+ *  material, so the shaders only fetch them.  The result is
+ *  cached in a file and baked again only when the lights or
+ *  the static geometry change.  A bake can also be left to
+ *  run on background threads while the old lightmap is
+ *  still drawn.
+ ***********************************************************/
+class Lightmapper
+{
+public:
+	// constructor
+	Lightmapper();
+	// destructor
+	~Lightmapper();
+
+	// the part of a light source the diffuse bake uses
+	struct BAKE_LIGHT
+	{
+		glm::vec3 position;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+	};
+
+	// texture unit of the lightmap, after the texture slots of
+	// the scene - checked against ShaderVariants::MAX_TEXTURE_SLOTS
+	// by SceneManager
+	static const int LIGHTMAP_TEXTURE_UNIT = 15;
+
+private:
+	// triangles lit with the same material
+	struct SURFACE
+	{
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		int firstTriangle;
+		int triangleCount;
+	};
+
+	struct BAKE_TRIANGLE
+	{
+		glm::vec3 positions[3];
+		glm::vec3 normals[3];
+		int surfaceIndex;
+		// square cell of the atlas holding the triangle, in texels
+		int cellX;
+		int cellY;
+		int cellSize;
+	};
+
+	// node of the bounding volume hierarchy over the triangles -
+	// the left child of an inner node follows it, and the right
+	// child or the first triangle of a leaf is in first
+	struct BVH_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		int first;
+		// triangles of a leaf, zero for an inner node
+		int count;
+	};
+
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<SURFACE> m_surfaces;
+	std::vector<BAKE_TRIANGLE> m_triangles;
+	// lightmap coordinate of every surface vertex
+	std::vector<glm::vec2> m_coordinates;
+
+	// the hierarchy and the triangle order of its leaves
+	std::vector<BVH_NODE> m_nodes;
+	std::vector<int> m_nodeTriangles;
+
+	// baked atlas texels
+	int m_atlasSize;
+	float m_texelsPerUnit;
+	std::vector<glm::vec4> m_texels;
+
+	// next triangle for a bake thread to take
+	std::atomic<int> m_nextTriangle;
+	int m_threadCount;
+	// threads of the started bake, and how many of them have
+	// run out of triangles
+	std::vector<std::thread> m_bakeThreads;
+	std::atomic<int> m_finishedThreads;
+	bool m_bBakeStarted;
+	// cache file and hash of the started bake, empty when it
+	// is not cached, and when the bake started
+	std::string m_cachePath;
+	unsigned long long m_cacheKey;
+	std::chrono::steady_clock::time_point m_bakeStart;
+	// statistics of the last bake
+	bool m_bFromCache;
+	// keep the baked texels in memory after the upload, for
+	// drawing without a GPU
+	bool m_bKeepTexels;
+	double m_bakeMilliseconds;
+
+	// the lightmap and the coordinates on the GPU
+	GLuint m_texture;
+	GLuint m_coordinateBuffer;
+
+	// give every triangle a cell of the atlas at the passed in
+	// density, failing when they do not fit
+	bool PackAtlas(float texelsPerUnit);
+	// write the lightmap coordinates of the packed cells
+	void WriteCoordinates();
+	// build the hierarchy over a range of the triangle order
+	int BuildNode(int first, int count);
+	// check whether a ray hits any triangle before maxDistance
+	bool IsOccluded(glm::vec3 origin, glm::vec3 direction, float maxDistance) const;
+	// trace the rays of every texel of a triangle's cell
+	void BakeTriangle(int triangleIndex);
+	// take triangles and bake them until none are left
+	void BakeThread();
+	// wait for the threads of the started bake
+	void JoinBakeThreads();
+
+	// hash of everything the baked texels depend on
+	unsigned long long HashInputs();
+	// read and write the baked texels
+	bool LoadCache(const char* cachePath, unsigned long long key);
+	void SaveCache(const char* cachePath, unsigned long long key);
+	// copy the texels and coordinates into the GPU objects
+	void Upload();
+	// free the GPU objects
+	void DestroyGLObjects();
+
+public:
+	// set the light sources the surfaces are lit by
+	void SetLights(const BAKE_LIGHT* pLights, int lightCount);
+	// forget the surfaces added so far - not while a started
+	// bake is running
+	void Clear();
+	// add a surface whose triangles each have their own three
+	// vertices, and get the index of its first lightmap
+	// coordinate - the surfaces also cast the shadows
+	int AddSurface(const MESH_VERTEX* pVertices, unsigned int vertexCount, glm::vec3 ambientColor, glm::vec3 diffuseColor);
+	// bake the surfaces, or load the texels from the cache file
+	// when nothing changed, and upload the lightmap
+	bool Bake(const char* cachePath);
+	// start baking the surfaces on the passed in number of
+	// background threads, or load the texels from the cache
+	// file - a NULL path bakes without the cache
+	bool BeginBake(const char* cachePath, int threadCount);
+	// check whether the started bake has all its texels,
+	// without waiting for it
+	bool IsBakeFinished();
+	// wait for the started bake, then save and upload the
+	// lightmap - it calls OpenGL, unlike the two above
+	bool FinishBake();
+	// bind the lightmap and the coordinates for drawing
+	void Bind();
+
+	// keep the texels in memory after the upload - set before
+	// the lightmap is baked
+	void SetKeepTexels(bool bKeepTexels);
+	// the uploaded texels and coordinates, for drawing without
+	// a GPU - NULL before the lightmap was uploaded, and the
+	// texels also when they are not kept
+	const glm::vec4* GetTexels();
+	int GetAtlasSize();
+	const glm::vec2* GetCoordinates();
+	int GetCoordinateCount();
+
+	// print the atlas use and how the lightmap was made
+	void PrintReport();
+};
@@ -1,177 +1,590 @@
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE, atoi
+#include <cstring>          // strcmp
+#include <algorithm>        // std::max
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderVariants.h"
+#include "DynamicResolution.h"
+#include "AllocationCounter.h"
+#include "TransformBatch.h"
+#include "FrameCapture.h"
+#include "GpuResources.h"
+#include "InputRecorder.h"
+#include "RenderThread.h"
+#include "AssetPack.h"
+#include "StartupGraph.h"
+#include "PerfHud.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader variants object for compiling and selecting the
+	// specialized shader programs
+	ShaderVariants* g_ShaderVariants = nullptr;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+	// dynamic resolution object for rendering the scene offscreen
+	// at a scale that holds the target frame time
+	DynamicResolution* g_DynamicResolution = nullptr;
+	// frame capture object for writing the shown frames to disk,
+	// only created by the capture options
+	FrameCapture* g_FrameCapture = nullptr;
+	// input recorder object for recording the camera input, or
+	// replaying it for a repeatable benchmark
+	InputRecorder* g_InputRecorder = nullptr;
+	// render thread object that owns the OpenGL context and draws
+	// the frame packets built by the main loop
+	RenderThread* g_RenderThread = nullptr;
+	// asset pack object the textures, shaders and meshes are read
+	// from in place, when the archive exists
+	AssetPack* g_AssetPack = nullptr;
+	// startup graph object that runs the initialization steps and
+	// times them until the first frame
+	StartupGraph* g_StartupGraph = nullptr;
+	// performance overlay object drawn over the shown frames,
+	// only created by the overlay option
+	PerfHud* g_PerfHud = nullptr;
+
+	// frame time the kiosks need to hold, 60 frames per second
+	const float TARGET_FRAME_MILLISECONDS = 1000.0f / 60.0f;
+	// lowest fraction of the window resolution that is rendered
+	const float MIN_RESOLUTION_SCALE = 0.5f;
+
+	// command line option that renders a fixed number of frames
+	// and fails when any steady frame allocated from the heap
+	const char* const CHECK_ALLOCATIONS_OPTION = "--check-allocations";
+	// frames the shader variants and the frame arena are given
+	// to settle before frames are checked
+	const int ALLOCATION_WARMUP_FRAMES = 10;
+	// frames checked by the allocation check
+	const int ALLOCATION_CHECK_FRAMES = 600;
+	// command line option that times the transform kernels
+	// and exits without opening a window
+	const char* const BENCHMARK_TRANSFORMS_OPTION = "--benchmark-transforms";
+	// command line options that write every shown frame as a TGA
+	// image, or append it to one raw video file - the images
+	// can be given another prefix after the option
+	const char* const CAPTURE_IMAGES_OPTION = "--capture-images";
+	const char* const RECORD_VIDEO_OPTION = "--record-video";
+	// prefix of the captured images, and the raw video file
+	const char* const CAPTURE_IMAGES_PATH = "capture";
+	const char* const RECORD_VIDEO_PATH = "capture.bgra";
+	// command line options that record the camera input, or
+	// replay it and write the time of every frame - both can
+	// be followed by the recording's path
+	const char* const RECORD_INPUT_OPTION = "--record-input";
+	const char* const REPLAY_INPUT_OPTION = "--replay-input";
+	const char* const INPUT_RECORDING_PATH = "input.rec";
+	const char* const REPLAY_TIMING_PATH = "replay_timing.csv";
+	// command line options that replicate the desk into a grid
+	// of the passed in number of desks, generated from a seed,
+	// with a fraction of the objects moving - at most
+	// StressScene::MAX_DESKS (100000) desks are placed, and
+	// larger counts are reduced to it
+	const char* const STRESS_DESKS_OPTION = "--stress-desks";
+	const char* const STRESS_SEED_OPTION = "--stress-seed";
+	const char* const STRESS_MOVING_OPTION = "--stress-moving";
+	const unsigned int STRESS_DEFAULT_SEED = 330;
+	// command line option that imports an OBJ or glTF file with
+	// the mesh importer, prints its timing and places the model
+	// on the desk
+	const char* const IMPORT_MESH_OPTION = "--import-mesh";
+	// GLSL source files of the shader variants
+	const char* const VERTEX_SHADER_PATH = "Shaders/vertexShader.glsl";
+	const char* const FRAGMENT_SHADER_PATH = "Shaders/fragmentShader.glsl";
+	// archive of every asset file, read instead of the loose files
+	// when it exists
+	const char* const ASSET_PACK_PATH = "assets.pack";
+	// command line option that writes the asset pack from the
+	// loose files and exits, and the one that ignores the pack
+	const char* const BUILD_ASSET_PACK_OPTION = "--build-asset-pack";
+	const char* const LOOSE_ASSETS_OPTION = "--loose-assets";
+	// Chrome trace of the startup steps, written once the first
+	// frame is queued
+	const char* const STARTUP_TRACE_PATH = "startup_trace.json";
+	// command line option that draws the frame times and render
+	// counters over the scene - off by default, so captures and
+	// replays show only the scene
+	const char* const PERF_HUD_OPTION = "--hud";
+	// command line option that counts the samples shaded per
+	// pixel with an occlusion query every frame and prints it
+	// with the other render counters every 300 frames - off by
+	// default, so normal runs pay for neither
+	const char* const DEBUG_COUNTERS_OPTION = "--debug-counters";
+	// command line option that draws the scene with the CPU
+	// software rasterizer, optionally followed by its number
+	// of threads - every core by default
+	const char* const SOFTWARE_RASTER_OPTION = "--software-raster";
+	// command line option that compares two captured images,
+	// such as an OpenGL and a software rasterizer capture of
+	// the same replay, and exits - the images match when at
+	// most 2% of the pixels differ by more than 24 levels
+	const char* const COMPARE_IMAGES_OPTION = "--compare-images";
+	const int IMAGE_COMPARE_TOLERANCE = 24;
+	const float IMAGE_COMPARE_MAX_FRACTION = 0.02f;
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	StressScene::SETTINGS stressSettings;
+	stressSettings.deskCount = 0;
+	stressSettings.seed = STRESS_DEFAULT_SEED;
+	stressSettings.movingFraction = 0.0f;
+	bool bLooseAssets = false;
+	bool bSoftwareRaster = false;
+	int softwareRasterThreads = 0;
+	const char* pImportMeshPath = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], BENCHMARK_TRANSFORMS_OPTION) == 0)
+		{
+			TransformBatch::RunBenchmark();
+			return(EXIT_SUCCESS);
+		}
+		else if ((strcmp(argv[i], COMPARE_IMAGES_OPTION) == 0) && (i + 2 < argc))
+		{
+			bool bMatch = FrameCapture::CompareImages(argv[i + 1], argv[i + 2], IMAGE_COMPARE_TOLERANCE, IMAGE_COMPARE_MAX_FRACTION);
+			return((bMatch == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		else if (strcmp(argv[i], BUILD_ASSET_PACK_OPTION) == 0)
+		{
+			std::vector<std::string> assetFiles;
+			assetFiles.push_back(VERTEX_SHADER_PATH);
+			assetFiles.push_back(FRAGMENT_SHADER_PATH);
+			SceneManager::GetAssetFiles(assetFiles);
+			return((AssetPack::Build(ASSET_PACK_PATH, assetFiles) == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		else if (strcmp(argv[i], LOOSE_ASSETS_OPTION) == 0)
+		{
+			bLooseAssets = true;
+		}
+		else if ((strcmp(argv[i], STRESS_DESKS_OPTION) == 0) && (i + 1 < argc))
+		{
+			stressSettings.deskCount = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], STRESS_SEED_OPTION) == 0) && (i + 1 < argc))
+		{
+			stressSettings.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], STRESS_MOVING_OPTION) == 0) && (i + 1 < argc))
+		{
+			stressSettings.movingFraction = (float)atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], IMPORT_MESH_OPTION) == 0) && (i + 1 < argc))
+		{
+			pImportMeshPath = argv[++i];
+		}
+		else if (strcmp(argv[i], SOFTWARE_RASTER_OPTION) == 0)
+		{
+			bSoftwareRaster = true;
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				softwareRasterThreads = atoi(argv[++i]);
+			}
+		}
+	}
+
+	// the startup steps run as a graph timed from here - the
+	// asset files are read and decoded on worker threads while
+	// the window and the OpenGL context are created
+	g_StartupGraph = new StartupGraph();
+
+	// the manager objects call no OpenGL when created, so they
+	// exist before the steps that use them are scheduled
+	g_ShaderVariants = new ShaderVariants(
+		VERTEX_SHADER_PATH,
+		FRAGMENT_SHADER_PATH);
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderVariants);
+	// try to create a new scene manager object
+	g_SceneManager = new SceneManager(g_ShaderVariants);
+	if (stressSettings.deskCount > 0)
+	{
+		g_SceneManager->SetStressScene(stressSettings);
+	}
+	if (NULL != pImportMeshPath)
+	{
+		g_SceneManager->SetImportedMesh(pImportMeshPath);
+	}
+	if (bSoftwareRaster == true)
+	{
+		g_SceneManager->SetRenderBackend(SceneManager::BACKEND_SOFTWARE, softwareRasterThreads);
+	}
+
+	// if GLFW fails initialization, then terminate the application
+	int glfwTask = g_StartupGraph->AddTask("InitializeGLFW", StartupGraph::TASK_GL, []()
+	{
+		return(InitializeGLFW());
+	});
+	// try to create the main display window
+	int windowTask = g_StartupGraph->AddTask("CreateDisplayWindow", StartupGraph::TASK_GL, []()
+	{
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+		return(NULL != g_Window);
+	});
+	g_StartupGraph->AddDependency(windowTask, glfwTask);
+	// if GLEW fails initialization, then terminate the application
+	int glewTask = g_StartupGraph->AddTask("InitializeGLEW", StartupGraph::TASK_GL, []()
+	{
+		return(InitializeGLEW());
+	});
+	g_StartupGraph->AddDependency(glewTask, windowTask);
+
+	// map the asset pack once - the assets are read from it in
+	// place, and the loose files are only used without it
+	int assetTask = g_StartupGraph->AddTask("OpenAssetPack", StartupGraph::TASK_WORKER, [bLooseAssets]()
+	{
+		if (bLooseAssets == false)
+		{
+			g_AssetPack = new AssetPack();
+			if (g_AssetPack->Open(ASSET_PACK_PATH) == false)
+			{
+				std::cout << "Asset pack: " << ASSET_PACK_PATH << " not found, loading the loose files" << std::endl;
+				delete g_AssetPack;
+				g_AssetPack = NULL;
+			}
+		}
+		g_ShaderVariants->SetAssetPack(g_AssetPack);
+		g_SceneManager->SetAssetPack(g_AssetPack);
+		return(true);
+	});
+	// the variants are compiled from the GLSL source the first
+	// time a draw needs them, and the source is read ahead
+	int shaderTask = g_StartupGraph->AddTask("LoadShaderSource", StartupGraph::TASK_WORKER, []()
+	{
+		g_ShaderVariants->LoadSource();
+		return(true);
+	});
+	g_StartupGraph->AddDependency(shaderTask, assetTask);
+
+	// prepare the 3D scene once the context exists
+	g_SceneManager->AddPrepareTasks(g_StartupGraph, glewTask, assetTask);
+
+	if (g_StartupGraph->Run() == false)
+	{
+		g_StartupGraph->PrintTrace();
+		return(EXIT_FAILURE);
+	}
+
+	// the GPU time is held a little under the frame time, leaving
+	// room for the upscale and the buffer swap
+	g_DynamicResolution = new DynamicResolution();
+	g_DynamicResolution->SetTargetFrameTime(TARGET_FRAME_MILLISECONDS * 0.85f);
+	g_DynamicResolution->SetScaleRange(MIN_RESOLUTION_SCALE, 1.0f);
+
+	bool bCheckAllocations = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], CHECK_ALLOCATIONS_OPTION) == 0)
+		{
+			bCheckAllocations = true;
+		}
+		else if ((strcmp(argv[i], PERF_HUD_OPTION) == 0) && (NULL == g_PerfHud))
+		{
+			g_PerfHud = new PerfHud(g_ShaderVariants);
+		}
+		else if (strcmp(argv[i], DEBUG_COUNTERS_OPTION) == 0)
+		{
+			g_SceneManager->SetDebugCounters(true);
+		}
+		else if ((strcmp(argv[i], CAPTURE_IMAGES_OPTION) == 0) && (NULL == g_FrameCapture))
+		{
+			const char* path = CAPTURE_IMAGES_PATH;
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				path = argv[++i];
+			}
+			g_FrameCapture = new FrameCapture(FrameCapture::CAPTURE_IMAGES, path);
+		}
+		else if ((strcmp(argv[i], RECORD_VIDEO_OPTION) == 0) && (NULL == g_FrameCapture))
+		{
+			g_FrameCapture = new FrameCapture(FrameCapture::CAPTURE_VIDEO, RECORD_VIDEO_PATH);
+		}
+		else if (((strcmp(argv[i], RECORD_INPUT_OPTION) == 0) || (strcmp(argv[i], REPLAY_INPUT_OPTION) == 0)) &&
+			(NULL == g_InputRecorder))
+		{
+			bool bReplay = (strcmp(argv[i], REPLAY_INPUT_OPTION) == 0);
+			const char* path = INPUT_RECORDING_PATH;
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				path = argv[++i];
+			}
+
+			g_InputRecorder = new InputRecorder();
+			bool bStarted = (bReplay == true) ? g_InputRecorder->StartReplay(path) : g_InputRecorder->StartRecording(path);
+			if (bStarted == false)
+			{
+				return(EXIT_FAILURE);
+			}
+			g_ViewManager->SetInputRecorder(g_InputRecorder);
+
+			// the replay renders every frame at full resolution and
+			// as fast as it can, so the runs of two builds draw the
+			// same pixels and their frame times can be compared
+			if (bReplay == true)
+			{
+				g_DynamicResolution->SetScaleRange(1.0f, 1.0f);
+				glfwSwapInterval(0);
+			}
+		}
+	}
+	int frameCount = 0;
+	int allocatingFrames = 0;
+
+	// the OpenGL context moves to the render thread, which draws
+	// the frames built by this loop
+	g_RenderThread = new RenderThread(g_Window, g_SceneManager, g_DynamicResolution);
+	g_RenderThread->SetFrameCapture(g_FrameCapture);
+	g_RenderThread->SetInputRecorder(g_InputRecorder);
+	g_RenderThread->SetPerfHud(g_PerfHud);
+	g_RenderThread->Start();
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// follow the size of the window's framebuffer
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+
+		// nothing is drawn while the window is minimized
+		if ((framebufferWidth <= 0) || (framebufferHeight <= 0))
+		{
+			glfwWaitEvents();
+			continue;
+		}
+
+		// wait for a packet the render thread is done with
+		SceneManager::FRAME_PACKET* pPacket = g_RenderThread->AcquirePacket();
+		pPacket->framebufferWidth = framebufferWidth;
+		pPacket->framebufferHeight = framebufferHeight;
+
+		// heap allocations of the frame are counted from here
+		// until the packet is queued, plus the ones the render
+		// thread made the last time it drew the packet
+		unsigned long long frameAllocations = AllocationCounter::GetThreadCount();
+
+		// convert from 3D object space to 2D view
+		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetSceneViews(
+			g_ViewManager->GetViewProjections(),
+			g_ViewManager->GetViewRects(),
+			g_ViewManager->GetViewPositions(),
+			g_ViewManager->GetViewCount());
+		// the M key slides the speaker along the desk, which
+		// edits the static batches and bakes the lightmap again
+		if (g_ViewManager->IsKeyPressed(GLFW_KEY_M) == true)
+		{
+			g_SceneManager->MoveEditableObjects();
+		}
+
+		// collect the visible draws of the 3D scene and hand
+		// them to the render thread
+		g_SceneManager->BuildFrame(*pPacket);
+		frameAllocations = AllocationCounter::GetThreadCount() - frameAllocations + pPacket->renderAllocations;
+		g_RenderThread->QueuePacket(pPacket);
+
+		frameCount++;
+		// the startup ends with the first queued frame
+		if (NULL != g_StartupGraph)
+		{
+			g_StartupGraph->MarkFirstFrame();
+			g_StartupGraph->PrintTrace();
+			g_StartupGraph->WriteTrace(STARTUP_TRACE_PATH);
+			delete g_StartupGraph;
+			g_StartupGraph = NULL;
+		}
+		if ((bCheckAllocations == true) && (frameCount > ALLOCATION_WARMUP_FRAMES))
+		{
+			if (frameAllocations > 0)
+			{
+				std::cout << "Frame " << frameCount << " made " << frameAllocations << " heap allocations" << std::endl;
+				allocatingFrames++;
+			}
+			if (frameCount >= ALLOCATION_WARMUP_FRAMES + ALLOCATION_CHECK_FRAMES)
+			{
+				glfwSetWindowShouldClose(g_Window, true);
+			}
+		}
+
+		// query the latest GLFW events
+		glfwPollEvents();
+	}
+
+	// draw the frames still queued and take the context back
+	// for freeing the OpenGL objects
+	if (NULL != g_RenderThread)
+	{
+		g_RenderThread->Stop();
+		g_RenderThread->PrintReport();
+		delete g_RenderThread;
+		g_RenderThread = NULL;
+	}
+
+	// close the recording, or report the replayed frame times
+	if (NULL != g_InputRecorder)
+	{
+		g_ViewManager->SetInputRecorder(NULL);
+		g_InputRecorder->Finish(REPLAY_TIMING_PATH);
+		delete g_InputRecorder;
+		g_InputRecorder = NULL;
+	}
+
+	// write out the frames still in flight while the context
+	// is alive
+	if (NULL != g_FrameCapture)
+	{
+		g_FrameCapture->Finish();
+		g_FrameCapture->PrintReport();
+		delete g_FrameCapture;
+		g_FrameCapture = NULL;
+	}
+
+	// the overlay frees its OpenGL objects while the context
+	// is alive
+	if (NULL != g_PerfHud)
+	{
+		delete g_PerfHud;
+		g_PerfHud = NULL;
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_StartupGraph)
+	{
+		delete g_StartupGraph;
+		g_StartupGraph = NULL;
+	}
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderVariants)
+	{
+		delete g_ShaderVariants;
+		g_ShaderVariants = NULL;
+	}
+	// the shader variants read their source in place, so the
+	// pack is unmapped after them
+	if (NULL != g_AssetPack)
+	{
+		g_AssetPack->PrintReport();
+		delete g_AssetPack;
+		g_AssetPack = NULL;
+	}
+
+	// every OpenGL object is freed by its owner by now - the
+	// ones left are reported and freed before the context goes
+	GpuResources::ReleaseLeaks();
+
+	// the allocation check fails when any steady frame allocated
+	if (bCheckAllocations == true)
+	{
+		std::cout << "Allocation check: " << allocatingFrames << " of "
+			<< std::max(frameCount - ALLOCATION_WARMUP_FRAMES, 0) << " frames allocated from the heap" << std::endl;
+		if (allocatingFrames > 0)
+		{
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// Terminates the program successfully
+	exit(EXIT_SUCCESS); 
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
 }
\ No newline at end of file
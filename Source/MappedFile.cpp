@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file read-only into memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+#else
+	m_fileDescriptor = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the passed in file into
+ *  memory for reading.
+ ***********************************************************/
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open file:" << filename << std::endl;
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(fileHandle, &fileSize) == FALSE) || (fileSize.QuadPart == 0))
+	{
+		CloseHandle(fileHandle);
+		std::cout << "Could not map empty file:" << filename << std::endl;
+		return(false);
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		CloseHandle(fileHandle);
+		std::cout << "Could not map file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (m_pData == NULL)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		std::cout << "Could not map file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int fileDescriptor = open(filename, O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		std::cout << "Could not open file:" << filename << std::endl;
+		return(false);
+	}
+
+	struct stat fileInfo;
+	if ((fstat(fileDescriptor, &fileInfo) != 0) || (fileInfo.st_size == 0))
+	{
+		close(fileDescriptor);
+		std::cout << "Could not map empty file:" << filename << std::endl;
+		return(false);
+	}
+
+	void* pMapped = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (pMapped == MAP_FAILED)
+	{
+		close(fileDescriptor);
+		std::cout << "Could not map file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_fileDescriptor = fileDescriptor;
+	m_pData = (const unsigned char*)pMapped;
+	m_size = (size_t)fileInfo.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping and closing the file.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != NULL)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_mappingHandle != NULL)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+	if (m_fileHandle != NULL)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+	m_mappingHandle = NULL;
+	m_fileHandle = NULL;
+#else
+	if (m_pData != NULL)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+	}
+	m_fileDescriptor = -1;
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting the start of the mapped
+ *  file contents.
+ ***********************************************************/
+const unsigned char* MappedFile::GetData()
+{
+	return(m_pData);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method is used for getting the size of the mapped
+ *  file in bytes.
+ ***********************************************************/
+size_t MappedFile::GetSize()
+{
+	return(m_size);
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether a file is
+ *  currently mapped.
+ ***********************************************************/
+bool MappedFile::IsOpen()
+{
+	return(m_pData != NULL);
+}
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class contains the code for mapping the contents of
+ *  a file into the address space, so it can be read in place
+ *  without copying.  Pages are only loaded when touched.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+private:
+	// start and size of the mapped contents
+	const unsigned char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+
+public:
+	// map the passed in file, closing any mapped file first
+	bool Open(const char* filename);
+	// unmap and close the file
+	void Close();
+
+	const unsigned char* GetData();
+	size_t GetSize();
+	bool IsOpen();
+};
@@ -0,0 +1,707 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbuffer.cpp
+// ============
+// suballocate the geometry of every mesh from one shared vertex and
+// index buffer with a single vertex layout
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshBuffer.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// starting size of the shared buffers
+	const unsigned int INITIAL_VERTEX_CAPACITY = 16384;
+	const unsigned int INITIAL_INDEX_CAPACITY = 65536;
+	// largest value of the normalized position components
+	const float POSITION_SCALE = 65535.0f;
+
+	/***********************************************************
+	 *  FloatToHalf()
+	 *
+	 *  Convert a float into the bits of a half float, rounding
+	 *  to the nearest value.
+	 ***********************************************************/
+	unsigned short FloatToHalf(float value)
+	{
+		unsigned int bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		unsigned int sign = (bits >> 16) & 0x8000u;
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		unsigned int mantissa = bits & 0x7FFFFFu;
+
+		if (exponent <= 0)
+		{
+			// too small even for a denormal half
+			if (exponent < -10)
+			{
+				return((unsigned short)sign);
+			}
+			mantissa |= 0x800000u;
+			unsigned int shift = (unsigned int)(14 - exponent);
+			unsigned int half = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1u)
+			{
+				half++;
+			}
+			return((unsigned short)(sign | half));
+		}
+		if (exponent >= 31)
+		{
+			// infinity, or NaN when the mantissa is set
+			return((unsigned short)(sign | 0x7C00u | ((((bits >> 23) & 0xFF) == 0xFF) && mantissa ? 0x200u : 0u)));
+		}
+
+		unsigned int half = sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+		// round to nearest - a carry into the exponent is correct
+		if (mantissa & 0x1000u)
+		{
+			half++;
+		}
+		return((unsigned short)half);
+	}
+
+	/***********************************************************
+	 *  EncodeNormal()
+	 *
+	 *  Encode a unit vector with the octahedral mapping into
+	 *  two normalized shorts.
+	 ***********************************************************/
+	void EncodeNormal(glm::vec3 normal, short encoded[2])
+	{
+		float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+		if (sum <= 0.0f)
+		{
+			encoded[0] = 0;
+			encoded[1] = 0;
+			return;
+		}
+
+		float x = normal.x / sum;
+		float y = normal.y / sum;
+		// fold the lower half of the octahedron over the upper half
+		if (normal.z < 0.0f)
+		{
+			float foldedX = (1.0f - std::fabs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::fabs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		encoded[0] = (short)std::lround(glm::clamp(x, -1.0f, 1.0f) * 32767.0f);
+		encoded[1] = (short)std::lround(glm::clamp(y, -1.0f, 1.0f) * 32767.0f);
+	}
+}
+
+/***********************************************************
+ *  MeshBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshBuffer::MeshBuffer(bool bCompactVertices)
+{
+	m_bCompactVertices = bCompactVertices;
+	m_vertexStride = bCompactVertices ? sizeof(COMPACT_VERTEX) : sizeof(MESH_VERTEX);
+	m_bCpuCopy = false;
+	m_vao = 0;
+	m_vbo = 0;
+	m_ibo = 0;
+	m_vertexCapacity = 0;
+	m_indexCapacity = 0;
+	m_vertexTop = 0;
+	m_indexTop = 0;
+}
+
+/***********************************************************
+ *  ~MeshBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshBuffer::~MeshBuffer()
+{
+	if (m_vao != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_VERTEX_ARRAY, m_vao);
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_vbo);
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_ibo);
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ibo);
+	}
+	m_vao = 0;
+	m_vbo = 0;
+	m_ibo = 0;
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the shared buffers and
+ *  setting up the one vertex layout used by every mesh.
+ ***********************************************************/
+void MeshBuffer::CreateBuffers()
+{
+	glGenVertexArrays(1, &m_vao);
+	glBindVertexArray(m_vao);
+	GpuResources::Track(GpuResources::RESOURCE_VERTEX_ARRAY, m_vao, 0, "MeshBuffer");
+
+	m_vertexCapacity = INITIAL_VERTEX_CAPACITY;
+	glGenBuffers(1, &m_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_vertexCapacity * m_vertexStride, NULL, GL_STATIC_DRAW);
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, m_vbo, (size_t)m_vertexCapacity * m_vertexStride, "MeshBuffer vertices");
+
+	m_indexCapacity = INITIAL_INDEX_CAPACITY;
+	glGenBuffers(1, &m_ibo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, m_ibo, m_indexCapacity * sizeof(unsigned int), "MeshBuffer indices");
+
+	// the attribute formats are separate from the buffer binding,
+	// so the buffer can be replaced when it grows
+	if (m_bCompactVertices == true)
+	{
+		glVertexAttribFormat(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(COMPACT_VERTEX, position));
+		glVertexAttribFormat(1, 2, GL_SHORT, GL_TRUE, offsetof(COMPACT_VERTEX, normal));
+		glVertexAttribFormat(2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(COMPACT_VERTEX, textureCoordinate));
+	}
+	else
+	{
+		glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(MESH_VERTEX, position));
+		glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(MESH_VERTEX, normal));
+		glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(MESH_VERTEX, textureCoordinate));
+	}
+	for (GLuint attribute = 0; attribute < 3; attribute++)
+	{
+		glVertexAttribBinding(attribute, 0);
+		glEnableVertexAttribArray(attribute);
+	}
+	glBindVertexBuffer(0, m_vbo, 0, m_vertexStride);
+
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for finding room for a range of the
+ *  passed in size.  Released ranges are reused first, then
+ *  the range is taken from the end of the used part.
+ ***********************************************************/
+bool MeshBuffer::Allocate(std::vector<FREE_BLOCK>& freeList, unsigned int& top, unsigned int capacity, unsigned int count, unsigned int& first)
+{
+	for (int i = 0; i < freeList.size(); i++)
+	{
+		if (freeList[i].count >= count)
+		{
+			first = freeList[i].first;
+			freeList[i].first += count;
+			freeList[i].count -= count;
+			if (freeList[i].count == 0)
+			{
+				freeList.erase(freeList.begin() + i);
+			}
+			return(true);
+		}
+	}
+
+	if (top + count > capacity)
+	{
+		return(false);
+	}
+
+	first = top;
+	top += count;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for returning a range to the free
+ *  list.  Neighboring free ranges are merged, and a free
+ *  range at the end of the used part lowers the top.
+ ***********************************************************/
+void MeshBuffer::Release(std::vector<FREE_BLOCK>& freeList, unsigned int& top, unsigned int first, unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// keep the list sorted so neighbors are next to each other
+	int index = 0;
+	while ((index < freeList.size()) && (freeList[index].first < first))
+	{
+		index++;
+	}
+
+	FREE_BLOCK block;
+	block.first = first;
+	block.count = count;
+	freeList.insert(freeList.begin() + index, block);
+
+	if ((index + 1 < freeList.size()) && (freeList[index].first + freeList[index].count == freeList[index + 1].first))
+	{
+		freeList[index].count += freeList[index + 1].count;
+		freeList.erase(freeList.begin() + index + 1);
+	}
+	if ((index > 0) && (freeList[index - 1].first + freeList[index - 1].count == freeList[index].first))
+	{
+		freeList[index - 1].count += freeList[index].count;
+		freeList.erase(freeList.begin() + index);
+		index--;
+	}
+
+	if (freeList[index].first + freeList[index].count == top)
+	{
+		top = freeList[index].first;
+		freeList.erase(freeList.begin() + index);
+	}
+}
+
+/***********************************************************
+ *  GrowBuffer()
+ *
+ *  This method is used for replacing a shared buffer with a
+ *  larger one.  The used contents are copied on the GPU.
+ ***********************************************************/
+void MeshBuffer::GrowBuffer(GLenum target, GLuint& buffer, unsigned int& capacity, unsigned int elementSize, unsigned int required)
+{
+	unsigned int newCapacity = capacity;
+	while (newCapacity < required)
+	{
+		newCapacity *= 2;
+	}
+
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity * elementSize, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)capacity * elementSize);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, newBuffer, (size_t)newCapacity * elementSize,
+		(target == GL_ARRAY_BUFFER) ? "MeshBuffer vertices" : "MeshBuffer indices");
+	GpuResources::Release(GpuResources::RESOURCE_BUFFER, buffer);
+	glDeleteBuffers(1, &buffer);
+
+	buffer = newBuffer;
+	capacity = newCapacity;
+
+	// attach the new buffer to the shared vertex array
+	glBindVertexArray(m_vao);
+	if (target == GL_ARRAY_BUFFER)
+	{
+		glBindVertexBuffer(0, buffer, 0, m_vertexStride);
+	}
+	else
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+	}
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  QuantizeVertices()
+ *
+ *  This method is used for converting vertices into the
+ *  compact format within the bounds of their mesh.  It
+ *  fails when a position is outside of the bounds.
+ ***********************************************************/
+bool MeshBuffer::QuantizeVertices(const MESH_VERTEX* vertices, unsigned int vertexCount, const MESH_RANGE& range)
+{
+	// allow for the rounding of positions on the bounds
+	const float TOLERANCE = 0.5f / POSITION_SCALE;
+
+	m_compactVertices.resize(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const MESH_VERTEX& vertex = vertices[i];
+		COMPACT_VERTEX& compact = m_compactVertices[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float normalized = (vertex.position[axis] - range.boundsMin[axis]) / range.boundsExtent[axis];
+			if ((normalized < -TOLERANCE) || (normalized > 1.0f + TOLERANCE))
+			{
+				return(false);
+			}
+			compact.position[axis] = (unsigned short)std::lround(glm::clamp(normalized, 0.0f, 1.0f) * POSITION_SCALE);
+		}
+		compact.position[3] = 0;
+
+		EncodeNormal(vertex.normal, compact.normal);
+		compact.textureCoordinate[0] = FloatToHalf(vertex.textureCoordinate.x);
+		compact.textureCoordinate[1] = FloatToHalf(vertex.textureCoordinate.y);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteVertices()
+ *
+ *  This method is used for uploading vertices into the
+ *  vertex buffer in the format the buffer holds.  Compact
+ *  vertices must already be in m_compactVertices.
+ ***********************************************************/
+void MeshBuffer::WriteVertices(unsigned int firstVertex, unsigned int vertexCount, const MESH_VERTEX* vertices, const MESH_RANGE& range)
+{
+	const void* pSource = vertices;
+	if (m_bCompactVertices == true)
+	{
+		pSource = m_compactVertices.data();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferSubData(
+		GL_ARRAY_BUFFER,
+		(GLintptr)(range.firstVertex + firstVertex) * m_vertexStride,
+		(GLsizeiptr)vertexCount * m_vertexStride,
+		pSource);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (m_bCpuCopy == true)
+	{
+		unsigned int first = range.firstVertex + firstVertex;
+		if (m_cpuVertices.size() < first + vertexCount)
+		{
+			m_cpuVertices.resize(first + vertexCount);
+		}
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			MESH_VERTEX& copy = m_cpuVertices[first + i];
+			copy = vertices[i];
+			if (m_bCompactVertices == true)
+			{
+				copy.position = (vertices[i].position - range.boundsMin) / range.boundsExtent;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for copying the passed in mesh into
+ *  the shared buffers and getting the ID of its range.
+ ***********************************************************/
+int MeshBuffer::AddMesh(const MESH_DATA& mesh)
+{
+	return(AddMesh(mesh.vertices.data(), (unsigned int)mesh.vertices.size(), mesh.indices.data(), (unsigned int)mesh.indices.size()));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for copying the passed in vertices
+ *  and indices into the shared buffers and getting the ID
+ *  of their range.
+ ***********************************************************/
+int MeshBuffer::AddMesh(const MESH_VERTEX* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	if (m_vao == 0)
+	{
+		CreateBuffers();
+	}
+
+	MESH_RANGE range;
+	range.vertexCount = vertexCount;
+	range.indexCount = indexCount;
+	range.boundsMin = glm::vec3(0.0f);
+	range.boundsExtent = glm::vec3(1.0f);
+	range.localMin = glm::vec3(0.0f);
+	range.localMax = glm::vec3(0.0f);
+	range.center = glm::vec3(0.0f);
+	range.radius = 0.0f;
+
+	if (vertexCount > 0)
+	{
+		glm::vec3 boundsMax = vertices[0].position;
+		glm::vec3 boundsMin = vertices[0].position;
+		for (unsigned int i = 1; i < vertexCount; i++)
+		{
+			boundsMin = glm::min(boundsMin, vertices[i].position);
+			boundsMax = glm::max(boundsMax, vertices[i].position);
+		}
+		range.localMin = boundsMin;
+		range.localMax = boundsMax;
+		range.center = (boundsMin + boundsMax) * 0.5f;
+		range.radius = glm::length(boundsMax - range.center);
+
+		if (m_bCompactVertices == true)
+		{
+			// one scale for all the axes keeps the dequantization a
+			// uniform scale, so the normals need no correction
+			glm::vec3 size = boundsMax - boundsMin;
+			range.boundsMin = boundsMin;
+			range.boundsExtent = glm::vec3(std::max(std::max(size.x, size.y), std::max(size.z, 1e-6f)));
+
+			QuantizeVertices(vertices, vertexCount, range);
+		}
+	}
+
+	if (Allocate(m_freeVertices, m_vertexTop, m_vertexCapacity, vertexCount, range.firstVertex) == false)
+	{
+		GrowBuffer(GL_ARRAY_BUFFER, m_vbo, m_vertexCapacity, m_vertexStride, m_vertexTop + vertexCount);
+		Allocate(m_freeVertices, m_vertexTop, m_vertexCapacity, vertexCount, range.firstVertex);
+	}
+	if (Allocate(m_freeIndices, m_indexTop, m_indexCapacity, indexCount, range.firstIndex) == false)
+	{
+		GrowBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo, m_indexCapacity, sizeof(unsigned int), m_indexTop + indexCount);
+		Allocate(m_freeIndices, m_indexTop, m_indexCapacity, indexCount, range.firstIndex);
+	}
+
+	WriteVertices(0, vertexCount, vertices, range);
+	// the index buffer is bound through a copy target so the
+	// binding of the shared vertex array is not disturbed
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_ibo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)range.firstIndex * sizeof(unsigned int), (GLsizeiptr)indexCount * sizeof(unsigned int), indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	if (m_bCpuCopy == true)
+	{
+		if (m_cpuIndices.size() < range.firstIndex + indexCount)
+		{
+			m_cpuIndices.resize(range.firstIndex + indexCount);
+		}
+		std::copy(indices, indices + indexCount, m_cpuIndices.begin() + range.firstIndex);
+	}
+
+	int meshID = -1;
+	if (m_freeMeshIDs.size() > 0)
+	{
+		meshID = m_freeMeshIDs.back();
+		m_freeMeshIDs.pop_back();
+		m_meshes[meshID] = range;
+	}
+	else
+	{
+		m_meshes.push_back(range);
+		meshID = (int)m_meshes.size() - 1;
+	}
+
+	return(meshID);
+}
+
+/***********************************************************
+ *  RemoveMesh()
+ *
+ *  This method is used for releasing the range of a mesh so
+ *  it can be reused by later meshes.
+ ***********************************************************/
+void MeshBuffer::RemoveMesh(int meshID)
+{
+	if ((meshID < 0) || (meshID >= m_meshes.size()))
+	{
+		return;
+	}
+
+	MESH_RANGE& range = m_meshes[meshID];
+	Release(m_freeVertices, m_vertexTop, range.firstVertex, range.vertexCount);
+	Release(m_freeIndices, m_indexTop, range.firstIndex, range.indexCount);
+
+	range.vertexCount = 0;
+	range.indexCount = 0;
+	m_freeMeshIDs.push_back(meshID);
+}
+
+/***********************************************************
+ *  UpdateVertices()
+ *
+ *  This method is used for overwriting part of the vertices
+ *  of a mesh, without changing the size of its range.
+ *  Compact vertices must stay within the bounds the mesh
+ *  was added with, otherwise the mesh has to be added again.
+ ***********************************************************/
+bool MeshBuffer::UpdateVertices(int meshID, unsigned int firstVertex, unsigned int vertexCount, const MESH_VERTEX* vertices)
+{
+	if ((meshID < 0) || (meshID >= m_meshes.size()))
+	{
+		return(false);
+	}
+
+	const MESH_RANGE& range = m_meshes[meshID];
+	if (firstVertex + vertexCount > range.vertexCount)
+	{
+		return(false);
+	}
+
+	if ((m_bCompactVertices == true) && (QuantizeVertices(vertices, vertexCount, range) == false))
+	{
+		return(false);
+	}
+
+	WriteVertices(firstVertex, vertexCount, vertices, range);
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetMeshRange()
+ *
+ *  This method is used for getting the range of the shared
+ *  buffers that holds a mesh.
+ ***********************************************************/
+const MeshBuffer::MESH_RANGE& MeshBuffer::GetMeshRange(int meshID)
+{
+	return(m_meshes[meshID]);
+}
+
+/***********************************************************
+ *  GetDequantizeMatrix()
+ *
+ *  This method is used for getting the matrix that moves
+ *  the normalized compact positions of a mesh back to its
+ *  bounds.  It is applied before the model matrix.
+ ***********************************************************/
+glm::mat4 MeshBuffer::GetDequantizeMatrix(int meshID)
+{
+	glm::mat4 dequantize = glm::mat4(1.0f);
+	if ((m_bCompactVertices == false) || (meshID < 0) || (meshID >= m_meshes.size()))
+	{
+		return(dequantize);
+	}
+
+	const MESH_RANGE& range = m_meshes[meshID];
+	dequantize[0][0] = range.boundsExtent.x;
+	dequantize[1][1] = range.boundsExtent.y;
+	dequantize[2][2] = range.boundsExtent.z;
+	dequantize[3] = glm::vec4(range.boundsMin, 1.0f);
+
+	return(dequantize);
+}
+
+/***********************************************************
+ *  SetCpuCopy()
+ *
+ *  This method is used for keeping a copy of the vertices
+ *  and indices in memory, for drawing without a GPU.  The
+ *  meshes added before it is set are not copied.
+ ***********************************************************/
+void MeshBuffer::SetCpuCopy(bool bCpuCopy)
+{
+	m_bCpuCopy = bCpuCopy;
+	if (bCpuCopy == false)
+	{
+		m_cpuVertices.clear();
+		m_cpuIndices.clear();
+	}
+}
+
+/***********************************************************
+ *  GetCpuVertices()
+ *
+ *  This method is used for getting the kept copy of the
+ *  vertex buffer, at the offsets of the mesh ranges.
+ ***********************************************************/
+const MESH_VERTEX* MeshBuffer::GetCpuVertices()
+{
+	if (m_cpuVertices.empty() == true)
+	{
+		return(NULL);
+	}
+
+	return(m_cpuVertices.data());
+}
+
+/***********************************************************
+ *  GetCpuIndices()
+ *
+ *  This method is used for getting the kept copy of the
+ *  index buffer, at the offsets of the mesh ranges.
+ ***********************************************************/
+const unsigned int* MeshBuffer::GetCpuIndices()
+{
+	if (m_cpuIndices.empty() == true)
+	{
+		return(NULL);
+	}
+
+	return(m_cpuIndices.data());
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the shared vertex array,
+ *  which serves every mesh draw.
+ ***********************************************************/
+void MeshBuffer::Bind()
+{
+	glBindVertexArray(m_vao);
+}
+
+/***********************************************************
+ *  IsCompact()
+ *
+ *  This method is used for checking whether the vertices
+ *  are stored in the compact format.
+ ***********************************************************/
+bool MeshBuffer::IsCompact()
+{
+	return(m_bCompactVertices);
+}
+
+/***********************************************************
+ *  GetUsedBytes()
+ *
+ *  This method is used for getting the number of bytes of
+ *  vertex and index data held by the meshes.
+ ***********************************************************/
+size_t MeshBuffer::GetUsedBytes()
+{
+	size_t usedBytes = 0;
+	for (int i = 0; i < m_meshes.size(); i++)
+	{
+		usedBytes += (size_t)m_meshes[i].vertexCount * m_vertexStride;
+		usedBytes += m_meshes[i].indexCount * sizeof(unsigned int);
+	}
+
+	return(usedBytes);
+}
+
+/***********************************************************
+ *  GetCapacityBytes()
+ *
+ *  This method is used for getting the number of bytes
+ *  allocated for the shared buffers on the GPU.
+ ***********************************************************/
+size_t MeshBuffer::GetCapacityBytes()
+{
+	return((size_t)m_vertexCapacity * m_vertexStride + (size_t)m_indexCapacity * sizeof(unsigned int));
+}
+
+/***********************************************************
+ *  PrintMemoryReport()
+ *
+ *  This method is used for printing the bytes per vertex
+ *  and the vertex memory of all the meshes in the float
+ *  format and in the compact format.
+ ***********************************************************/
+void MeshBuffer::PrintMemoryReport()
+{
+	size_t vertexCount = 0;
+	for (int i = 0; i < m_meshes.size(); i++)
+	{
+		vertexCount += m_meshes[i].vertexCount;
+	}
+
+	size_t floatBytes = vertexCount * sizeof(MESH_VERTEX);
+	size_t compactBytes = vertexCount * sizeof(COMPACT_VERTEX);
+
+	std::cout << "Vertex memory: " << vertexCount << " vertices, "
+		<< sizeof(MESH_VERTEX) << " bytes/vertex float = " << floatBytes << " bytes, "
+		<< sizeof(COMPACT_VERTEX) << " bytes/vertex compact = " << compactBytes << " bytes, "
+		<< "using " << (m_bCompactVertices ? "compact" : "float") << " vertices" << std::endl;
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbuffer.h
+// ============
+// suballocate the geometry of every mesh from one shared vertex and
+// index buffer with a single vertex layout
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeGeometry.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  MeshBuffer
+ *
+ *  This class contains the code for storing all the meshes
+ *  in one vertex array object, so drawing different meshes
+ *  never changes the vertex array bindings.  Each mesh gets
+ *  a range of the shared buffers, addressed through the
+ *  base vertex and first index of its draw command.  The
+ *  vertices can be stored quantized to half the size.
+ ***********************************************************/
+class MeshBuffer
+{
+public:
+	// constructor - compact vertices are quantized to 16 bytes
+	MeshBuffer(bool bCompactVertices);
+	// destructor
+	~MeshBuffer();
+
+	// range of the shared buffers used by a mesh - the indices
+	// are relative to the first vertex of the mesh
+	struct MESH_RANGE
+	{
+		unsigned int firstVertex;
+		unsigned int vertexCount;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		// bounds the compact positions are quantized within
+		glm::vec3 boundsMin;
+		glm::vec3 boundsExtent;
+		// bounding box and bounding sphere of the mesh in its
+		// model space
+		glm::vec3 localMin;
+		glm::vec3 localMax;
+		glm::vec3 center;
+		float radius;
+	};
+
+	// quantized vertex - positions are normalized within the mesh
+	// bounds, the normal is octahedral encoded, and the texture
+	// coordinate is stored as half floats
+	struct COMPACT_VERTEX
+	{
+		unsigned short position[4];
+		short normal[2];
+		unsigned short textureCoordinate[2];
+	};
+
+private:
+	// a released range that can be reused by a later mesh
+	struct FREE_BLOCK
+	{
+		unsigned int first;
+		unsigned int count;
+	};
+
+	// whether the vertices are stored as COMPACT_VERTEX
+	bool m_bCompactVertices;
+	unsigned int m_vertexStride;
+	// quantized vertices waiting to be uploaded
+	std::vector<COMPACT_VERTEX> m_compactVertices;
+	// copy of the buffers kept in memory for the software
+	// rasterizer, at the same offsets - compact positions are
+	// kept normalized within the mesh bounds, like the buffer
+	bool m_bCpuCopy;
+	std::vector<MESH_VERTEX> m_cpuVertices;
+	std::vector<unsigned int> m_cpuIndices;
+
+	// the shared vertex array and buffers
+	GLuint m_vao;
+	GLuint m_vbo;
+	GLuint m_ibo;
+	// allocated size of the buffers, in vertices and indices
+	unsigned int m_vertexCapacity;
+	unsigned int m_indexCapacity;
+	// end of the used part of the buffers
+	unsigned int m_vertexTop;
+	unsigned int m_indexTop;
+	// released ranges, sorted by their first element
+	std::vector<FREE_BLOCK> m_freeVertices;
+	std::vector<FREE_BLOCK> m_freeIndices;
+	// the mesh ranges, indexed by mesh ID
+	std::vector<MESH_RANGE> m_meshes;
+	std::vector<int> m_freeMeshIDs;
+
+	// create the vertex array and set up the vertex layout
+	void CreateBuffers();
+	// take a range from a free list, or from the end of the buffer
+	bool Allocate(std::vector<FREE_BLOCK>& freeList, unsigned int& top, unsigned int capacity, unsigned int count, unsigned int& first);
+	// give a range back to a free list, merging it with its neighbors
+	void Release(std::vector<FREE_BLOCK>& freeList, unsigned int& top, unsigned int first, unsigned int count);
+	// reallocate a buffer with more room, keeping its contents
+	void GrowBuffer(GLenum target, GLuint& buffer, unsigned int& capacity, unsigned int elementSize, unsigned int required);
+	// quantize vertices within the bounds of a mesh, failing when
+	// a vertex lies outside of them
+	bool QuantizeVertices(const MESH_VERTEX* vertices, unsigned int vertexCount, const MESH_RANGE& range);
+	// upload vertices in the buffer's format
+	void WriteVertices(unsigned int firstVertex, unsigned int vertexCount, const MESH_VERTEX* vertices, const MESH_RANGE& range);
+
+public:
+	// copy a mesh into the shared buffers and get its mesh ID
+	int AddMesh(const MESH_DATA& mesh);
+	int AddMesh(const MESH_VERTEX* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	// release the range of a mesh
+	void RemoveMesh(int meshID);
+	// overwrite part of the vertices of a mesh - fails when the
+	// compact vertices leave the bounds the mesh was added with
+	bool UpdateVertices(int meshID, unsigned int firstVertex, unsigned int vertexCount, const MESH_VERTEX* vertices);
+
+	// get the buffer range of a mesh
+	const MESH_RANGE& GetMeshRange(int meshID);
+	// get the matrix expanding the compact positions of a mesh
+	// into its model space - the identity for float vertices
+	glm::mat4 GetDequantizeMatrix(int meshID);
+	// bind the shared vertex array for drawing
+	void Bind();
+	bool IsCompact();
+
+	// keep a copy of the geometry in memory - set before the
+	// first mesh is added
+	void SetCpuCopy(bool bCpuCopy);
+	// the kept copy, or NULL when there is none
+	const MESH_VERTEX* GetCpuVertices();
+	const unsigned int* GetCpuIndices();
+
+	// bytes of vertex and index data in use
+	size_t GetUsedBytes();
+	// bytes allocated for the shared buffers
+	size_t GetCapacityBytes();
+	// print the vertex memory of the meshes in the float and
+	// compact vertex formats
+	void PrintMemoryReport();
+};
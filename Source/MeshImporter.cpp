@@ -0,0 +1,1762 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.cpp
+// ============
+// import triangle meshes from OBJ and glTF/GLB files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshImporter.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// OBJ files smaller than this are parsed on one thread
+	const size_t PARALLEL_PARSE_BYTES = 1 << 20;
+	// simulated post-transform cache size for the optimization
+	const int VERTEX_CACHE_SIZE = 32;
+	// cache size used for reporting the ACMR
+	const int REPORT_CACHE_SIZE = 16;
+
+	/***********************************************************
+	 *  ElapsedMilliseconds()
+	 *
+	 *  Get the milliseconds passed since the passed in time.
+	 ***********************************************************/
+	double ElapsedMilliseconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		return(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
+	/***********************************************************
+	 *  EndsWith()
+	 *
+	 *  Check a file name extension, ignoring the letter case.
+	 ***********************************************************/
+	bool EndsWith(const std::string& text, const char* suffix)
+	{
+		size_t suffixLength = strlen(suffix);
+		if (text.size() < suffixLength)
+		{
+			return(false);
+		}
+
+		for (size_t i = 0; i < suffixLength; i++)
+		{
+			if (tolower(text[text.size() - suffixLength + i]) != suffix[i])
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/*** OBJ parsing *************************************************/
+	/******************************************************************/
+
+	// a face corner as indices into the position, texture
+	// coordinate and normal lists - negative values are relative
+	// to the chunk that parsed them, see EncodeIndex()
+	struct OBJ_CORNER
+	{
+		int position;
+		int uv;
+		int normal;
+	};
+
+	// the data parsed from one chunk of an OBJ file
+	struct OBJ_CHUNK
+	{
+		const char* pBegin;
+		const char* pEnd;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+		// three corners per triangle
+		std::vector<OBJ_CORNER> corners;
+		// first element of each list across the whole file
+		int positionBase;
+		int uvBase;
+		int normalBase;
+	};
+
+	// value marking a missing texture coordinate or normal
+	const int NO_INDEX = 0x7fffffff;
+	// bias of the encoded relative indices, which keeps them
+	// negative even when they point before their chunk
+	const int RELATIVE_INDEX_BIAS = INT_MIN / 2;
+
+	// powers of ten that are exact as doubles
+	const double g_PowersOfTen[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	inline bool IsDigit(char c)
+	{
+		return((c >= '0') && (c <= '9'));
+	}
+
+	inline const char* SkipSpaces(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	inline const char* SkipLine(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && (*p != '\n'))
+		{
+			p++;
+		}
+		return((p < pEnd) ? p + 1 : pEnd);
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  Parse a decimal number without the locale handling of
+	 *  strtof, which dominates the time of text mesh parsing.
+	 ***********************************************************/
+	const char* ParseFloat(const char* p, const char* pEnd, float& value)
+	{
+		p = SkipSpaces(p, pEnd);
+
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		double mantissa = 0.0;
+		int exponent = 0;
+		while ((p < pEnd) && IsDigit(*p))
+		{
+			mantissa = mantissa * 10.0 + (*p - '0');
+			p++;
+		}
+		if ((p < pEnd) && (*p == '.'))
+		{
+			p++;
+			while ((p < pEnd) && IsDigit(*p))
+			{
+				mantissa = mantissa * 10.0 + (*p - '0');
+				exponent--;
+				p++;
+			}
+		}
+		if ((p < pEnd) && ((*p == 'e') || (*p == 'E')))
+		{
+			p++;
+			bool bNegativeExponent = false;
+			if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+			{
+				bNegativeExponent = (*p == '-');
+				p++;
+			}
+			int power = 0;
+			while ((p < pEnd) && IsDigit(*p))
+			{
+				power = power * 10 + (*p - '0');
+				p++;
+			}
+			exponent += bNegativeExponent ? -power : power;
+		}
+
+		if (exponent < 0)
+		{
+			mantissa = (exponent >= -22) ? mantissa / g_PowersOfTen[-exponent] : mantissa * std::pow(10.0, exponent);
+		}
+		else if (exponent > 0)
+		{
+			mantissa = (exponent <= 22) ? mantissa * g_PowersOfTen[exponent] : mantissa * std::pow(10.0, exponent);
+		}
+
+		value = (float)(bNegative ? -mantissa : mantissa);
+		return(p);
+	}
+
+	/***********************************************************
+	 *  ParseInt()
+	 *
+	 *  Parse a signed decimal integer.
+	 ***********************************************************/
+	const char* ParseInt(const char* p, const char* pEnd, int& value)
+	{
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		int result = 0;
+		while ((p < pEnd) && IsDigit(*p))
+		{
+			result = result * 10 + (*p - '0');
+			p++;
+		}
+
+		value = bNegative ? -result : result;
+		return(p);
+	}
+
+	/***********************************************************
+	 *  EncodeIndex()
+	 *
+	 *  Convert an OBJ index into a zero based index.  Positive
+	 *  indices are already absolute.  Negative indices count
+	 *  back from the elements read so far, which a chunk only
+	 *  knows locally.  Their offset from the start of the
+	 *  chunk, which is negative when they point into an
+	 *  earlier chunk, is stored biased by RELATIVE_INDEX_BIAS
+	 *  until the chunk bases are known.
+	 ***********************************************************/
+	inline int EncodeIndex(int objIndex, int localCount)
+	{
+		if (objIndex > 0)
+		{
+			return(objIndex - 1);
+		}
+		if (objIndex < 0)
+		{
+			// offsets beyond the bias can only point before the
+			// file, and still resolve to a dropped index
+			int offset = std::max(localCount + objIndex, RELATIVE_INDEX_BIAS + 1);
+			return(RELATIVE_INDEX_BIAS + offset);
+		}
+		return(NO_INDEX);
+	}
+
+	/***********************************************************
+	 *  ResolveIndex()
+	 *
+	 *  Convert an encoded index into an absolute index once
+	 *  the base of its chunk is known.
+	 ***********************************************************/
+	inline int ResolveIndex(int encoded, int chunkBase)
+	{
+		if ((encoded == NO_INDEX) || (encoded >= 0))
+		{
+			return(encoded);
+		}
+		return(chunkBase + (encoded - RELATIVE_INDEX_BIAS));
+	}
+
+	/***********************************************************
+	 *  ParseOBJChunk()
+	 *
+	 *  Parse the vertex attributes and faces of a range of
+	 *  whole lines of an OBJ file.  Polygons are split into
+	 *  triangle fans.
+	 ***********************************************************/
+	void ParseOBJChunk(OBJ_CHUNK* pChunk)
+	{
+		const char* p = pChunk->pBegin;
+		const char* pEnd = pChunk->pEnd;
+		std::vector<OBJ_CORNER> polygon;
+
+		while (p < pEnd)
+		{
+			p = SkipSpaces(p, pEnd);
+			if (p >= pEnd)
+			{
+				break;
+			}
+
+			if ((p[0] == 'v') && (p + 1 < pEnd) && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				glm::vec3 position;
+				p = ParseFloat(p + 2, pEnd, position.x);
+				p = ParseFloat(p, pEnd, position.y);
+				p = ParseFloat(p, pEnd, position.z);
+				pChunk->positions.push_back(position);
+			}
+			else if ((p[0] == 'v') && (p + 2 < pEnd) && (p[1] == 't'))
+			{
+				glm::vec2 uv;
+				p = ParseFloat(p + 2, pEnd, uv.x);
+				p = ParseFloat(p, pEnd, uv.y);
+				pChunk->uvs.push_back(uv);
+			}
+			else if ((p[0] == 'v') && (p + 2 < pEnd) && (p[1] == 'n'))
+			{
+				glm::vec3 normal;
+				p = ParseFloat(p + 2, pEnd, normal.x);
+				p = ParseFloat(p, pEnd, normal.y);
+				p = ParseFloat(p, pEnd, normal.z);
+				pChunk->normals.push_back(normal);
+			}
+			else if ((p[0] == 'f') && (p + 1 < pEnd) && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				polygon.clear();
+				p += 2;
+				while (true)
+				{
+					p = SkipSpaces(p, pEnd);
+					if ((p >= pEnd) || (*p == '\n') || ((IsDigit(*p) == false) && (*p != '-')))
+					{
+						break;
+					}
+
+					int value = 0;
+					OBJ_CORNER corner;
+					p = ParseInt(p, pEnd, value);
+					corner.position = EncodeIndex(value, (int)pChunk->positions.size());
+					corner.uv = NO_INDEX;
+					corner.normal = NO_INDEX;
+
+					if ((p < pEnd) && (*p == '/'))
+					{
+						p++;
+						if ((p < pEnd) && (*p != '/'))
+						{
+							p = ParseInt(p, pEnd, value);
+							corner.uv = EncodeIndex(value, (int)pChunk->uvs.size());
+						}
+						if ((p < pEnd) && (*p == '/'))
+						{
+							p++;
+							p = ParseInt(p, pEnd, value);
+							corner.normal = EncodeIndex(value, (int)pChunk->normals.size());
+						}
+					}
+					polygon.push_back(corner);
+				}
+
+				for (int i = 2; i < polygon.size(); i++)
+				{
+					pChunk->corners.push_back(polygon[0]);
+					pChunk->corners.push_back(polygon[i - 1]);
+					pChunk->corners.push_back(polygon[i]);
+				}
+			}
+
+			// skip the rest of the line, including comments, groups
+			// and material statements that are not used
+			p = SkipLine(p, pEnd);
+		}
+	}
+
+	/***********************************************************
+	 *  CornerHash()
+	 *
+	 *  Hash a resolved face corner for vertex deduplication.
+	 ***********************************************************/
+	inline unsigned int CornerHash(const OBJ_CORNER& corner)
+	{
+		unsigned int hash = (unsigned int)corner.position * 0x9E3779B1u;
+		hash ^= (unsigned int)corner.uv * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+		hash ^= (unsigned int)corner.normal * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+		return(hash);
+	}
+
+	/*** glTF parsing ************************************************/
+	/******************************************************************/
+
+	// a parsed JSON value - only what glTF needs
+	struct JSON_VALUE
+	{
+		enum TYPE
+		{
+			JSON_NULL,
+			JSON_BOOL,
+			JSON_NUMBER,
+			JSON_STRING,
+			JSON_ARRAY,
+			JSON_OBJECT
+		};
+
+		TYPE type;
+		double number;
+		std::string text;
+		std::vector<JSON_VALUE> items;
+		std::vector<std::string> keys;
+
+		JSON_VALUE()
+		{
+			type = JSON_NULL;
+			number = 0.0;
+		}
+
+		// get an object member by key, or NULL
+		const JSON_VALUE* Find(const char* key) const
+		{
+			for (int i = 0; i < keys.size(); i++)
+			{
+				if (keys[i].compare(key) == 0)
+				{
+					return(&items[i]);
+				}
+			}
+			return(NULL);
+		}
+
+		// get a numeric object member, or the default value
+		double Number(const char* key, double defaultValue) const
+		{
+			const JSON_VALUE* pValue = Find(key);
+			if ((NULL == pValue) || (pValue->type != JSON_NUMBER))
+			{
+				return(defaultValue);
+			}
+			return(pValue->number);
+		}
+	};
+
+	/***********************************************************
+	 *  ParseJSON()
+	 *
+	 *  Recursively parse a JSON value.  Returns NULL when the
+	 *  text is malformed.
+	 ***********************************************************/
+	const char* ParseJSON(const char* p, const char* pEnd, JSON_VALUE& value)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')))
+		{
+			p++;
+		}
+		if (p >= pEnd)
+		{
+			return(NULL);
+		}
+
+		if ((*p == '{') || (*p == '['))
+		{
+			bool bObject = (*p == '{');
+			char closing = bObject ? '}' : ']';
+			value.type = bObject ? JSON_VALUE::JSON_OBJECT : JSON_VALUE::JSON_ARRAY;
+			p++;
+
+			while (p < pEnd)
+			{
+				while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n') || (*p == ',')))
+				{
+					p++;
+				}
+				if ((p < pEnd) && (*p == closing))
+				{
+					return(p + 1);
+				}
+
+				if (bObject)
+				{
+					JSON_VALUE key;
+					p = ParseJSON(p, pEnd, key);
+					if ((NULL == p) || (key.type != JSON_VALUE::JSON_STRING))
+					{
+						return(NULL);
+					}
+					while ((p < pEnd) && (*p != ':'))
+					{
+						p++;
+					}
+					p++;
+					value.keys.push_back(key.text);
+				}
+
+				value.items.push_back(JSON_VALUE());
+				p = ParseJSON(p, pEnd, value.items.back());
+				if (NULL == p)
+				{
+					return(NULL);
+				}
+			}
+			return(NULL);
+		}
+
+		if (*p == '"')
+		{
+			value.type = JSON_VALUE::JSON_STRING;
+			p++;
+			while ((p < pEnd) && (*p != '"'))
+			{
+				// escapes are kept as is - glTF keys and URIs do not need them
+				if ((*p == '\\') && (p + 1 < pEnd))
+				{
+					value.text += *p++;
+				}
+				value.text += *p++;
+			}
+			return((p < pEnd) ? p + 1 : NULL);
+		}
+
+		if ((*p == 't') || (*p == 'f') || (*p == 'n'))
+		{
+			value.type = (*p == 'n') ? JSON_VALUE::JSON_NULL : JSON_VALUE::JSON_BOOL;
+			value.number = (*p == 't') ? 1.0 : 0.0;
+			while ((p < pEnd) && (*p >= 'a') && (*p <= 'z'))
+			{
+				p++;
+			}
+			return(p);
+		}
+
+		float number = 0.0f;
+		value.type = JSON_VALUE::JSON_NUMBER;
+		const char* pNext = ParseFloat(p, pEnd, number);
+		value.number = number;
+		return((pNext == p) ? NULL : pNext);
+	}
+
+	/***********************************************************
+	 *  DecodeBase64()
+	 *
+	 *  Decode the payload of a base64 data URI.
+	 ***********************************************************/
+	void DecodeBase64(const std::string& text, std::vector<unsigned char>& bytes)
+	{
+		unsigned int accumulator = 0;
+		int bits = 0;
+
+		bytes.clear();
+		bytes.reserve(text.size() * 3 / 4);
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			char c = text[i];
+			int sextet = -1;
+			if ((c >= 'A') && (c <= 'Z')) sextet = c - 'A';
+			else if ((c >= 'a') && (c <= 'z')) sextet = c - 'a' + 26;
+			else if ((c >= '0') && (c <= '9')) sextet = c - '0' + 52;
+			else if (c == '+') sextet = 62;
+			else if (c == '/') sextet = 63;
+			else continue;
+
+			accumulator = (accumulator << 6) | (unsigned int)sextet;
+			bits += 6;
+			if (bits >= 8)
+			{
+				bits -= 8;
+				bytes.push_back((unsigned char)((accumulator >> bits) & 0xFF));
+			}
+		}
+	}
+
+	// a typed view of accessor data inside a glTF buffer
+	struct ACCESSOR_VIEW
+	{
+		const unsigned char* pData;
+		size_t stride;
+		size_t count;
+		int componentType;
+		int components;
+		bool bNormalized;
+	};
+
+	// glTF component types
+	const int GLTF_BYTE = 5120;
+	const int GLTF_UNSIGNED_BYTE = 5121;
+	const int GLTF_SHORT = 5122;
+	const int GLTF_UNSIGNED_SHORT = 5123;
+	const int GLTF_UNSIGNED_INT = 5125;
+	const int GLTF_FLOAT = 5126;
+
+	inline int ComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case GLTF_BYTE:
+		case GLTF_UNSIGNED_BYTE:
+			return(1);
+		case GLTF_SHORT:
+		case GLTF_UNSIGNED_SHORT:
+			return(2);
+		default:
+			return(4);
+		}
+	}
+
+	/***********************************************************
+	 *  ReadComponent()
+	 *
+	 *  Read one component of an accessor element as a float,
+	 *  applying the normalization of integer types.
+	 ***********************************************************/
+	inline float ReadComponent(const ACCESSOR_VIEW& view, size_t element, int component)
+	{
+		const unsigned char* p = view.pData + element * view.stride + component * ComponentSize(view.componentType);
+		float value = 0.0f;
+
+		switch (view.componentType)
+		{
+		case GLTF_FLOAT:
+			memcpy(&value, p, sizeof(float));
+			return(value);
+		case GLTF_UNSIGNED_BYTE:
+			return(view.bNormalized ? *p / 255.0f : (float)*p);
+		case GLTF_BYTE:
+			return(view.bNormalized ? std::max((signed char)*p / 127.0f, -1.0f) : (float)(signed char)*p);
+		case GLTF_UNSIGNED_SHORT:
+		{
+			unsigned short data = 0;
+			memcpy(&data, p, sizeof(data));
+			return(view.bNormalized ? data / 65535.0f : (float)data);
+		}
+		case GLTF_SHORT:
+		{
+			short data = 0;
+			memcpy(&data, p, sizeof(data));
+			return(view.bNormalized ? std::max(data / 32767.0f, -1.0f) : (float)data);
+		}
+		case GLTF_UNSIGNED_INT:
+		{
+			unsigned int data = 0;
+			memcpy(&data, p, sizeof(data));
+			return((float)data);
+		}
+		}
+
+		return(value);
+	}
+
+	/***********************************************************
+	 *  ReadIndex()
+	 *
+	 *  Read an element of an index accessor.
+	 ***********************************************************/
+	inline unsigned int ReadIndex(const ACCESSOR_VIEW& view, size_t element)
+	{
+		const unsigned char* p = view.pData + element * view.stride;
+		if (view.componentType == GLTF_UNSIGNED_BYTE)
+		{
+			return(*p);
+		}
+		if (view.componentType == GLTF_UNSIGNED_SHORT)
+		{
+			unsigned short data = 0;
+			memcpy(&data, p, sizeof(data));
+			return(data);
+		}
+
+		unsigned int data = 0;
+		memcpy(&data, p, sizeof(data));
+		return(data);
+	}
+
+	// a primitive to convert, with its world transform
+	struct GLTF_JOB
+	{
+		ACCESSOR_VIEW positions;
+		ACCESSOR_VIEW normals;
+		ACCESSOR_VIEW uvs;
+		ACCESSOR_VIEW indices;
+		bool bHasNormals;
+		bool bHasUVs;
+		bool bHasIndices;
+		glm::mat4 transform;
+		// where the output of the job goes in the merged mesh
+		size_t firstVertex;
+		size_t firstIndex;
+	};
+
+	/***********************************************************
+	 *  ConvertGLTFJob()
+	 *
+	 *  Convert the accessors of one primitive into the shared
+	 *  vertex layout, writing into the job's output range.
+	 ***********************************************************/
+	void ConvertGLTFJob(const GLTF_JOB* pJob, MESH_DATA* pMesh)
+	{
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(pJob->transform)));
+
+		for (size_t i = 0; i < pJob->positions.count; i++)
+		{
+			MESH_VERTEX& vertex = pMesh->vertices[pJob->firstVertex + i];
+			glm::vec3 position = glm::vec3(
+				ReadComponent(pJob->positions, i, 0),
+				ReadComponent(pJob->positions, i, 1),
+				ReadComponent(pJob->positions, i, 2));
+			vertex.position = glm::vec3(pJob->transform * glm::vec4(position, 1.0f));
+
+			if (pJob->bHasNormals)
+			{
+				glm::vec3 normal = glm::vec3(
+					ReadComponent(pJob->normals, i, 0),
+					ReadComponent(pJob->normals, i, 1),
+					ReadComponent(pJob->normals, i, 2));
+				vertex.normal = glm::normalize(normalMatrix * normal);
+			}
+			else
+			{
+				vertex.normal = glm::vec3(0.0f);
+			}
+
+			// glTF puts the texture origin at the top left, while the
+			// textures are loaded flipped to the OpenGL convention
+			if (pJob->bHasUVs)
+			{
+				vertex.textureCoordinate = glm::vec2(ReadComponent(pJob->uvs, i, 0), 1.0f - ReadComponent(pJob->uvs, i, 1));
+			}
+			else
+			{
+				vertex.textureCoordinate = glm::vec2(0.0f);
+			}
+		}
+
+		size_t indexCount = pJob->bHasIndices ? pJob->indices.count : pJob->positions.count;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			unsigned int index = pJob->bHasIndices ? ReadIndex(pJob->indices, i) : (unsigned int)i;
+			if (index >= pJob->positions.count)
+			{
+				index = 0;
+			}
+			pMesh->indices[pJob->firstIndex + i] = (unsigned int)pJob->firstVertex + index;
+		}
+	}
+
+	/***********************************************************
+	 *  NodeTransform()
+	 *
+	 *  Get the local transform of a glTF node, from either its
+	 *  matrix or its translation, rotation and scale.
+	 ***********************************************************/
+	glm::mat4 NodeTransform(const JSON_VALUE& node)
+	{
+		glm::mat4 transform = glm::mat4(1.0f);
+
+		const JSON_VALUE* pMatrix = node.Find("matrix");
+		if ((NULL != pMatrix) && (pMatrix->items.size() == 16))
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				transform[i / 4][i % 4] = (float)pMatrix->items[i].number;
+			}
+			return(transform);
+		}
+
+		glm::vec3 translation = glm::vec3(0.0f);
+		glm::vec4 rotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+		const JSON_VALUE* pValue = node.Find("translation");
+		if ((NULL != pValue) && (pValue->items.size() == 3))
+		{
+			translation = glm::vec3((float)pValue->items[0].number, (float)pValue->items[1].number, (float)pValue->items[2].number);
+		}
+		pValue = node.Find("rotation");
+		if ((NULL != pValue) && (pValue->items.size() == 4))
+		{
+			rotation = glm::vec4((float)pValue->items[0].number, (float)pValue->items[1].number, (float)pValue->items[2].number, (float)pValue->items[3].number);
+		}
+		pValue = node.Find("scale");
+		if ((NULL != pValue) && (pValue->items.size() == 3))
+		{
+			scale = glm::vec3((float)pValue->items[0].number, (float)pValue->items[1].number, (float)pValue->items[2].number);
+		}
+
+		// rotation matrix from the unit quaternion
+		float x = rotation.x;
+		float y = rotation.y;
+		float z = rotation.z;
+		float w = rotation.w;
+		transform[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f) * scale.x;
+		transform[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f) * scale.y;
+		transform[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f) * scale.z;
+		transform[3] = glm::vec4(translation, 1.0f);
+
+		return(transform);
+	}
+
+	/***********************************************************
+	 *  CollectMeshInstances()
+	 *
+	 *  Walk the node hierarchy and collect every mesh with its
+	 *  world transform.
+	 ***********************************************************/
+	void CollectMeshInstances(const JSON_VALUE& nodes, int nodeIndex, glm::mat4 parent, int depth, std::vector<std::pair<int, glm::mat4> >& instances)
+	{
+		// guard against malformed files with cycles
+		if ((nodeIndex < 0) || (nodeIndex >= nodes.items.size()) || (depth > 64))
+		{
+			return;
+		}
+
+		const JSON_VALUE& node = nodes.items[nodeIndex];
+		glm::mat4 world = parent * NodeTransform(node);
+
+		int meshIndex = (int)node.Number("mesh", -1.0);
+		if (meshIndex >= 0)
+		{
+			instances.push_back(std::make_pair(meshIndex, world));
+		}
+
+		const JSON_VALUE* pChildren = node.Find("children");
+		if (NULL != pChildren)
+		{
+			for (int i = 0; i < pChildren->items.size(); i++)
+			{
+				CollectMeshInstances(nodes, (int)pChildren->items[i].number, world, depth + 1, instances);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  GenerateNormals()
+	 *
+	 *  Give the vertices without a normal the area weighted
+	 *  average normal of the triangles sharing their position.
+	 ***********************************************************/
+	void GenerateNormals(MESH_DATA& mesh, const std::vector<int>& positionOf, int positionCount)
+	{
+		std::vector<glm::vec3> accumulated(positionCount, glm::vec3(0.0f));
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const glm::vec3& a = mesh.vertices[mesh.indices[i]].position;
+			const glm::vec3& b = mesh.vertices[mesh.indices[i + 1]].position;
+			const glm::vec3& c = mesh.vertices[mesh.indices[i + 2]].position;
+			glm::vec3 faceNormal = glm::cross(b - a, c - a);
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				accumulated[positionOf[mesh.indices[i + corner]]] += faceNormal;
+			}
+		}
+
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			if (mesh.vertices[i].normal == glm::vec3(0.0f))
+			{
+				glm::vec3 normal = accumulated[positionOf[i]];
+				float length = glm::length(normal);
+				mesh.vertices[i].normal = (length > 0.0f) ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  MeshImporter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshImporter::MeshImporter()
+{
+	m_threadCount = 0;
+	m_pAssetPack = NULL;
+	memset(&m_lastStats, 0, sizeof(m_lastStats));
+}
+
+/***********************************************************
+ *  ~MeshImporter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshImporter::~MeshImporter()
+{
+}
+
+/***********************************************************
+ *  SetThreadCount()
+ *
+ *  This method is used for setting the number of threads
+ *  used for parsing.  Zero uses one thread per core.
+ ***********************************************************/
+void MeshImporter::SetThreadCount(int threadCount)
+{
+	m_threadCount = std::max(threadCount, 0);
+}
+
+/***********************************************************
+ *  SetAssetPack()
+ *
+ *  This method is used for setting the asset pack the mesh
+ *  files and their buffers are read from.  Files missing
+ *  from the pack are still mapped from disk.
+ ***********************************************************/
+void MeshImporter::SetAssetPack(AssetPack* pAssetPack)
+{
+	m_pAssetPack = pAssetPack;
+}
+
+/***********************************************************
+ *  GetLastStats()
+ *
+ *  This method is used for getting the timing and size of
+ *  the last import.
+ ***********************************************************/
+const MeshImporter::IMPORT_STATS& MeshImporter::GetLastStats()
+{
+	return(m_lastStats);
+}
+
+/***********************************************************
+ *  ImportMesh()
+ *
+ *  This method is used for importing the mesh stored in the
+ *  passed in file.  The file is read in place from the asset
+ *  pack, or memory-mapped, and parsed, then the vertices are
+ *  deduplicated and the triangles are optimized for the
+ *  vertex cache.
+ ***********************************************************/
+bool MeshImporter::ImportMesh(const char* filename, MESH_DATA& mesh)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	std::string name = filename;
+	MappedFile file;
+	const unsigned char* pData = NULL;
+	size_t size = 0;
+	bool bReturn = false;
+
+	memset(&m_lastStats, 0, sizeof(m_lastStats));
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	if ((NULL == m_pAssetPack) || (m_pAssetPack->Find(filename, &pData, &size) == false))
+	{
+		if (file.Open(filename) == false)
+		{
+			return(false);
+		}
+		pData = file.GetData();
+		size = file.GetSize();
+	}
+	m_lastStats.fileBytes = size;
+
+	if (EndsWith(name, ".obj"))
+	{
+		bReturn = ImportOBJ((const char*)pData, size, mesh);
+	}
+	else if (EndsWith(name, ".gltf") || EndsWith(name, ".glb"))
+	{
+		bReturn = ImportGLTF(filename, pData, size, mesh);
+	}
+	else
+	{
+		std::cout << "Not implemented to import mesh file:" << filename << std::endl;
+	}
+
+	if ((bReturn == false) || (mesh.indices.size() == 0))
+	{
+		std::cout << "Could not import mesh:" << filename << std::endl;
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		return(false);
+	}
+
+	std::chrono::high_resolution_clock::time_point optimizeStart = std::chrono::high_resolution_clock::now();
+	m_lastStats.acmrBefore = CalculateACMR(mesh.indices, (unsigned int)mesh.vertices.size(), REPORT_CACHE_SIZE);
+	OptimizeVertexCache(mesh);
+	m_lastStats.acmrAfter = CalculateACMR(mesh.indices, (unsigned int)mesh.vertices.size(), REPORT_CACHE_SIZE);
+	m_lastStats.optimizeMilliseconds = ElapsedMilliseconds(optimizeStart);
+
+	m_lastStats.vertexCount = (unsigned int)mesh.vertices.size();
+	m_lastStats.triangleCount = (unsigned int)mesh.indices.size() / 3;
+	m_lastStats.totalMilliseconds = ElapsedMilliseconds(start);
+
+	std::cout << "Imported mesh:" << filename
+		<< ", vertices:" << m_lastStats.vertexCount
+		<< ", triangles:" << m_lastStats.triangleCount
+		<< ", threads:" << m_lastStats.threadCount
+		<< ", parse:" << m_lastStats.parseMilliseconds << "ms"
+		<< ", dedupe:" << m_lastStats.dedupeMilliseconds << "ms"
+		<< ", optimize:" << m_lastStats.optimizeMilliseconds << "ms"
+		<< ", total:" << m_lastStats.totalMilliseconds << "ms"
+		<< ", ACMR:" << m_lastStats.acmrBefore << " -> " << m_lastStats.acmrAfter << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportOBJ()
+ *
+ *  This method is used for parsing an OBJ file.  The text is
+ *  split on line boundaries into one chunk per thread, the
+ *  chunks are parsed in parallel, and the face corners are
+ *  then resolved and deduplicated into indexed vertices.
+ ***********************************************************/
+bool MeshImporter::ImportOBJ(const char* pText, size_t size, MESH_DATA& mesh)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	int threadCount = m_threadCount;
+	if (threadCount == 0)
+	{
+		threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+	}
+	if (size < PARALLEL_PARSE_BYTES)
+	{
+		threadCount = 1;
+	}
+	m_lastStats.threadCount = threadCount;
+
+	// split the text into chunks that start at the beginning of a line
+	std::vector<OBJ_CHUNK> chunks(threadCount);
+	const char* pEnd = pText + size;
+	const char* pBegin = pText;
+	for (int i = 0; i < threadCount; i++)
+	{
+		const char* pChunkEnd = (i == threadCount - 1) ? pEnd : pText + (size / threadCount) * (i + 1);
+		if (pChunkEnd < pBegin)
+		{
+			pChunkEnd = pBegin;
+		}
+		pChunkEnd = SkipLine(pChunkEnd, pEnd);
+		if (i == threadCount - 1)
+		{
+			pChunkEnd = pEnd;
+		}
+		chunks[i].pBegin = pBegin;
+		chunks[i].pEnd = pChunkEnd;
+		pBegin = pChunkEnd;
+	}
+
+	if (threadCount == 1)
+	{
+		ParseOBJChunk(&chunks[0]);
+	}
+	else
+	{
+		std::vector<std::thread> threads;
+		for (int i = 0; i < threadCount; i++)
+		{
+			threads.push_back(std::thread(ParseOBJChunk, &chunks[i]));
+		}
+		for (int i = 0; i < threadCount; i++)
+		{
+			threads[i].join();
+		}
+	}
+
+	// the chunk bases turn the local indices into file indices
+	int positionCount = 0;
+	int uvCount = 0;
+	int normalCount = 0;
+	size_t cornerCount = 0;
+	for (int i = 0; i < threadCount; i++)
+	{
+		chunks[i].positionBase = positionCount;
+		chunks[i].uvBase = uvCount;
+		chunks[i].normalBase = normalCount;
+		positionCount += (int)chunks[i].positions.size();
+		uvCount += (int)chunks[i].uvs.size();
+		normalCount += (int)chunks[i].normals.size();
+		cornerCount += chunks[i].corners.size();
+	}
+	m_lastStats.parseMilliseconds = ElapsedMilliseconds(start);
+
+	if ((positionCount == 0) || (cornerCount == 0))
+	{
+		return(false);
+	}
+
+	std::chrono::high_resolution_clock::time_point dedupeStart = std::chrono::high_resolution_clock::now();
+
+	// open addressing table from resolved corner to vertex index
+	size_t tableSize = 1;
+	while (tableSize < cornerCount * 2)
+	{
+		tableSize <<= 1;
+	}
+	std::vector<OBJ_CORNER> tableKeys(tableSize);
+	std::vector<unsigned int> tableValues(tableSize, 0xFFFFFFFFu);
+	std::vector<int> positionOf;
+	bool bMissingNormals = false;
+
+	mesh.indices.reserve(cornerCount);
+	mesh.vertices.reserve(std::min(cornerCount, (size_t)positionCount * 2));
+	positionOf.reserve(mesh.vertices.capacity());
+
+	for (int c = 0; c < threadCount; c++)
+	{
+		const OBJ_CHUNK& chunk = chunks[c];
+		for (size_t i = 0; i + 2 < chunk.corners.size(); i += 3)
+		{
+			OBJ_CORNER triangle[3];
+			bool bValid = true;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				triangle[corner].position = ResolveIndex(chunk.corners[i + corner].position, chunk.positionBase);
+				triangle[corner].uv = ResolveIndex(chunk.corners[i + corner].uv, chunk.uvBase);
+				triangle[corner].normal = ResolveIndex(chunk.corners[i + corner].normal, chunk.normalBase);
+
+				// drop references outside of the parsed lists
+				if ((triangle[corner].position < 0) || (triangle[corner].position >= positionCount))
+				{
+					bValid = false;
+				}
+				if ((triangle[corner].uv != NO_INDEX) && ((triangle[corner].uv < 0) || (triangle[corner].uv >= uvCount)))
+				{
+					triangle[corner].uv = NO_INDEX;
+				}
+				if ((triangle[corner].normal != NO_INDEX) && ((triangle[corner].normal < 0) || (triangle[corner].normal >= normalCount)))
+				{
+					triangle[corner].normal = NO_INDEX;
+				}
+			}
+			if (bValid == false)
+			{
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const OBJ_CORNER& key = triangle[corner];
+				size_t slot = CornerHash(key) & (tableSize - 1);
+
+				while ((tableValues[slot] != 0xFFFFFFFFu) &&
+					((tableKeys[slot].position != key.position) || (tableKeys[slot].uv != key.uv) || (tableKeys[slot].normal != key.normal)))
+				{
+					slot = (slot + 1) & (tableSize - 1);
+				}
+
+				if (tableValues[slot] == 0xFFFFFFFFu)
+				{
+					// find the chunk holding each attribute of the new vertex
+					MESH_VERTEX vertex;
+					int chunkIndex = threadCount - 1;
+					while (chunks[chunkIndex].positionBase > key.position)
+					{
+						chunkIndex--;
+					}
+					vertex.position = chunks[chunkIndex].positions[key.position - chunks[chunkIndex].positionBase];
+
+					vertex.textureCoordinate = glm::vec2(0.0f);
+					if (key.uv != NO_INDEX)
+					{
+						chunkIndex = threadCount - 1;
+						while (chunks[chunkIndex].uvBase > key.uv)
+						{
+							chunkIndex--;
+						}
+						vertex.textureCoordinate = chunks[chunkIndex].uvs[key.uv - chunks[chunkIndex].uvBase];
+					}
+
+					vertex.normal = glm::vec3(0.0f);
+					if (key.normal != NO_INDEX)
+					{
+						chunkIndex = threadCount - 1;
+						while (chunks[chunkIndex].normalBase > key.normal)
+						{
+							chunkIndex--;
+						}
+						vertex.normal = chunks[chunkIndex].normals[key.normal - chunks[chunkIndex].normalBase];
+					}
+					else
+					{
+						bMissingNormals = true;
+					}
+
+					tableKeys[slot] = key;
+					tableValues[slot] = (unsigned int)mesh.vertices.size();
+					mesh.vertices.push_back(vertex);
+					positionOf.push_back(key.position);
+				}
+
+				mesh.indices.push_back(tableValues[slot]);
+			}
+		}
+	}
+
+	if (bMissingNormals)
+	{
+		GenerateNormals(mesh, positionOf, positionCount);
+	}
+	m_lastStats.dedupeMilliseconds = ElapsedMilliseconds(dedupeStart);
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportGLTF()
+ *
+ *  This method is used for importing the triangle meshes of
+ *  a glTF or GLB file.  The binary buffers are read in place
+ *  from the mapped files, and the primitives are converted
+ *  in parallel into their own range of the merged mesh.
+ ***********************************************************/
+bool MeshImporter::ImportGLTF(const char* filename, const unsigned char* pData, size_t size, MESH_DATA& mesh)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	const char* pJson = (const char*)pData;
+	size_t jsonSize = size;
+	const unsigned char* pBinary = NULL;
+	size_t binarySize = 0;
+
+	// a GLB container holds a JSON chunk followed by a binary chunk
+	if ((size >= 12) && (memcmp(pData, "glTF", 4) == 0))
+	{
+		size_t offset = 12;
+		pJson = NULL;
+		while (offset + 8 <= size)
+		{
+			unsigned int chunkLength = 0;
+			unsigned int chunkType = 0;
+			memcpy(&chunkLength, pData + offset, 4);
+			memcpy(&chunkType, pData + offset + 4, 4);
+			if (offset + 8 + chunkLength > size)
+			{
+				break;
+			}
+
+			if (chunkType == 0x4E4F534Au)
+			{
+				pJson = (const char*)pData + offset + 8;
+				jsonSize = chunkLength;
+			}
+			else if (chunkType == 0x004E4942u)
+			{
+				pBinary = pData + offset + 8;
+				binarySize = chunkLength;
+			}
+			offset += 8 + ((chunkLength + 3) & ~3u);
+		}
+
+		if (NULL == pJson)
+		{
+			std::cout << "GLB file has no JSON chunk:" << filename << std::endl;
+			return(false);
+		}
+	}
+
+	JSON_VALUE document;
+	if (NULL == ParseJSON(pJson, pJson + jsonSize, document))
+	{
+		std::cout << "Could not parse glTF JSON:" << filename << std::endl;
+		return(false);
+	}
+
+	const JSON_VALUE* pBuffers = document.Find("buffers");
+	const JSON_VALUE* pViews = document.Find("bufferViews");
+	const JSON_VALUE* pAccessors = document.Find("accessors");
+	const JSON_VALUE* pMeshes = document.Find("meshes");
+	if ((NULL == pBuffers) || (NULL == pViews) || (NULL == pAccessors) || (NULL == pMeshes))
+	{
+		std::cout << "glTF file has no mesh data:" << filename << std::endl;
+		return(false);
+	}
+
+	// resolve each buffer to bytes - external files are read
+	// from the asset pack, or stay mapped until the conversion
+	// is finished
+	std::string folder = filename;
+	size_t slash = folder.find_last_of("/\\");
+	folder = (slash == std::string::npos) ? std::string() : folder.substr(0, slash + 1);
+
+	int bufferCount = (int)pBuffers->items.size();
+	std::vector<MappedFile> bufferFiles(bufferCount);
+	std::vector<std::vector<unsigned char> > decodedBuffers(bufferCount);
+	std::vector<const unsigned char*> bufferData(bufferCount, (const unsigned char*)NULL);
+	std::vector<size_t> bufferSizes(bufferCount, 0);
+
+	for (int i = 0; i < bufferCount; i++)
+	{
+		const JSON_VALUE* pUri = pBuffers->items[i].Find("uri");
+		if (NULL == pUri)
+		{
+			bufferData[i] = pBinary;
+			bufferSizes[i] = binarySize;
+		}
+		else if (pUri->text.compare(0, 5, "data:") == 0)
+		{
+			size_t comma = pUri->text.find(',');
+			if (comma != std::string::npos)
+			{
+				DecodeBase64(pUri->text.substr(comma + 1), decodedBuffers[i]);
+				bufferData[i] = decodedBuffers[i].data();
+				bufferSizes[i] = decodedBuffers[i].size();
+			}
+		}
+		else if ((NULL != m_pAssetPack) &&
+			(m_pAssetPack->Find((folder + pUri->text).c_str(), &bufferData[i], &bufferSizes[i]) == true))
+		{
+			continue;
+		}
+		else if (bufferFiles[i].Open((folder + pUri->text).c_str()))
+		{
+			bufferData[i] = bufferFiles[i].GetData();
+			bufferSizes[i] = bufferFiles[i].GetSize();
+		}
+	}
+
+	// look up an accessor, checking that it lies inside its buffer
+	auto GetAccessor = [&](int accessorIndex, int components, ACCESSOR_VIEW& view) -> bool
+	{
+		if ((accessorIndex < 0) || (accessorIndex >= pAccessors->items.size()))
+		{
+			return(false);
+		}
+		const JSON_VALUE& accessor = pAccessors->items[accessorIndex];
+		int viewIndex = (int)accessor.Number("bufferView", -1.0);
+		if ((viewIndex < 0) || (viewIndex >= pViews->items.size()))
+		{
+			return(false);
+		}
+		const JSON_VALUE& bufferView = pViews->items[viewIndex];
+		int bufferIndex = (int)bufferView.Number("buffer", -1.0);
+		if ((bufferIndex < 0) || (bufferIndex >= bufferCount) || (NULL == bufferData[bufferIndex]))
+		{
+			return(false);
+		}
+
+		view.componentType = (int)accessor.Number("componentType", GLTF_FLOAT);
+		view.components = components;
+		view.count = (size_t)accessor.Number("count", 0.0);
+		const JSON_VALUE* pNormalized = accessor.Find("normalized");
+		view.bNormalized = (NULL != pNormalized) && (pNormalized->number != 0.0);
+
+		size_t elementSize = (size_t)ComponentSize(view.componentType) * components;
+		view.stride = (size_t)bufferView.Number("byteStride", 0.0);
+		if (view.stride == 0)
+		{
+			view.stride = elementSize;
+		}
+
+		size_t offset = (size_t)bufferView.Number("byteOffset", 0.0) + (size_t)accessor.Number("byteOffset", 0.0);
+		if ((view.count > 0) && (offset + (view.count - 1) * view.stride + elementSize > bufferSizes[bufferIndex]))
+		{
+			return(false);
+		}
+		view.pData = bufferData[bufferIndex] + offset;
+
+		return(true);
+	};
+
+	// collect the mesh instances of the default scene
+	std::vector<std::pair<int, glm::mat4> > instances;
+	const JSON_VALUE* pNodes = document.Find("nodes");
+	const JSON_VALUE* pScenes = document.Find("scenes");
+	if ((NULL != pNodes) && (NULL != pScenes) && (pScenes->items.size() > 0))
+	{
+		int sceneIndex = (int)document.Number("scene", 0.0);
+		if ((sceneIndex < 0) || (sceneIndex >= pScenes->items.size()))
+		{
+			sceneIndex = 0;
+		}
+		const JSON_VALUE* pRoots = pScenes->items[sceneIndex].Find("nodes");
+		if (NULL != pRoots)
+		{
+			for (int i = 0; i < pRoots->items.size(); i++)
+			{
+				CollectMeshInstances(*pNodes, (int)pRoots->items[i].number, glm::mat4(1.0f), 0, instances);
+			}
+		}
+	}
+	if (instances.size() == 0)
+	{
+		for (int i = 0; i < pMeshes->items.size(); i++)
+		{
+			instances.push_back(std::make_pair(i, glm::mat4(1.0f)));
+		}
+	}
+
+	// one job per triangle primitive, laid out back to back
+	std::vector<GLTF_JOB> jobs;
+	size_t vertexTotal = 0;
+	size_t indexTotal = 0;
+	for (int i = 0; i < instances.size(); i++)
+	{
+		if ((instances[i].first < 0) || (instances[i].first >= pMeshes->items.size()))
+		{
+			continue;
+		}
+		const JSON_VALUE* pPrimitives = pMeshes->items[instances[i].first].Find("primitives");
+		if (NULL == pPrimitives)
+		{
+			continue;
+		}
+
+		for (int p = 0; p < pPrimitives->items.size(); p++)
+		{
+			const JSON_VALUE& primitive = pPrimitives->items[p];
+			const JSON_VALUE* pAttributes = primitive.Find("attributes");
+			// only triangle lists are imported
+			if ((NULL == pAttributes) || ((int)primitive.Number("mode", 4.0) != 4))
+			{
+				continue;
+			}
+
+			GLTF_JOB job;
+			if (GetAccessor((int)pAttributes->Number("POSITION", -1.0), 3, job.positions) == false)
+			{
+				continue;
+			}
+			job.bHasNormals = GetAccessor((int)pAttributes->Number("NORMAL", -1.0), 3, job.normals);
+			job.bHasUVs = GetAccessor((int)pAttributes->Number("TEXCOORD_0", -1.0), 2, job.uvs);
+			job.bHasIndices = GetAccessor((int)primitive.Number("indices", -1.0), 1, job.indices);
+			job.transform = instances[i].second;
+			job.firstVertex = vertexTotal;
+			job.firstIndex = indexTotal;
+
+			vertexTotal += job.positions.count;
+			indexTotal += job.bHasIndices ? job.indices.count : job.positions.count;
+			jobs.push_back(job);
+		}
+	}
+
+	if (jobs.size() == 0)
+	{
+		return(false);
+	}
+
+	mesh.vertices.resize(vertexTotal);
+	mesh.indices.resize(indexTotal - (indexTotal % 3));
+
+	int threadCount = m_threadCount;
+	if (threadCount == 0)
+	{
+		threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+	}
+	threadCount = std::min(threadCount, (int)jobs.size());
+	m_lastStats.threadCount = threadCount;
+
+	// the jobs write to separate ranges, so they need no locking
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++)
+	{
+		threads.push_back(std::thread([&jobs, &mesh, t, threadCount]()
+		{
+			for (int j = t; j < jobs.size(); j += threadCount)
+			{
+				// the final partial triangle of the last job is dropped
+				if (jobs[j].firstIndex < mesh.indices.size())
+				{
+					GLTF_JOB job = jobs[j];
+					size_t available = mesh.indices.size() - job.firstIndex;
+					if (job.bHasIndices && (job.indices.count > available))
+					{
+						job.indices.count = available;
+					}
+					ConvertGLTFJob(&job, &mesh);
+				}
+			}
+		}));
+	}
+	for (int t = 0; t < threadCount; t++)
+	{
+		threads[t].join();
+	}
+	m_lastStats.parseMilliseconds = ElapsedMilliseconds(start);
+
+	std::chrono::high_resolution_clock::time_point dedupeStart = std::chrono::high_resolution_clock::now();
+	DeduplicateVertices(mesh);
+
+	// primitives without normals get smooth normals
+	bool bMissingNormals = false;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		bMissingNormals = bMissingNormals || (jobs[j].bHasNormals == false);
+	}
+	if (bMissingNormals)
+	{
+		std::vector<int> positionOf(mesh.vertices.size());
+		for (size_t i = 0; i < positionOf.size(); i++)
+		{
+			positionOf[i] = (int)i;
+		}
+		GenerateNormals(mesh, positionOf, (int)mesh.vertices.size());
+	}
+	m_lastStats.dedupeMilliseconds = ElapsedMilliseconds(dedupeStart);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DeduplicateVertices()
+ *
+ *  This method is used for merging vertices with identical
+ *  position, normal and texture coordinate, and remapping
+ *  the indices to the merged vertices.
+ ***********************************************************/
+void MeshImporter::DeduplicateVertices(MESH_DATA& mesh)
+{
+	size_t tableSize = 1;
+	while (tableSize < mesh.vertices.size() * 2)
+	{
+		tableSize <<= 1;
+	}
+
+	std::vector<unsigned int> table(tableSize, 0xFFFFFFFFu);
+	std::vector<unsigned int> remap(mesh.vertices.size());
+	std::vector<MESH_VERTEX> unique;
+	unique.reserve(mesh.vertices.size());
+
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		const MESH_VERTEX& vertex = mesh.vertices[i];
+
+		// FNV-1a over the bytes of the vertex
+		const unsigned char* pBytes = (const unsigned char*)&vertex;
+		unsigned int hash = 2166136261u;
+		for (size_t b = 0; b < sizeof(MESH_VERTEX); b++)
+		{
+			hash = (hash ^ pBytes[b]) * 16777619u;
+		}
+
+		size_t slot = hash & (tableSize - 1);
+		while ((table[slot] != 0xFFFFFFFFu) && (memcmp(&unique[table[slot]], &vertex, sizeof(MESH_VERTEX)) != 0))
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == 0xFFFFFFFFu)
+		{
+			table[slot] = (unsigned int)unique.size();
+			unique.push_back(vertex);
+		}
+		remap[i] = table[slot];
+	}
+
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		mesh.indices[i] = remap[mesh.indices[i]];
+	}
+	mesh.vertices.swap(unique);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles so that
+ *  vertices are reused while they are still in the GPU's
+ *  post-transform cache, using Tom Forsyth's linear-speed
+ *  vertex cache optimization.  The vertices are then stored
+ *  in the order they are first referenced.
+ ***********************************************************/
+void MeshImporter::OptimizeVertexCache(MESH_DATA& mesh)
+{
+	const int MAX_VALENCE_SCORE = 32;
+	size_t triangleCount = mesh.indices.size() / 3;
+	size_t vertexCount = mesh.vertices.size();
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// score tables for the position in the cache and for the
+	// number of triangles still using the vertex
+	float cacheScores[VERTEX_CACHE_SIZE];
+	float valenceScores[MAX_VALENCE_SCORE];
+	for (int i = 0; i < VERTEX_CACHE_SIZE; i++)
+	{
+		if (i < 3)
+		{
+			// the last triangle's vertices are scored lower so the
+			// strip does not keep turning back on itself
+			cacheScores[i] = 0.75f;
+		}
+		else
+		{
+			cacheScores[i] = std::pow(1.0f - (float)(i - 3) / (float)(VERTEX_CACHE_SIZE - 3), 1.5f);
+		}
+	}
+	for (int i = 0; i < MAX_VALENCE_SCORE; i++)
+	{
+		valenceScores[i] = (i == 0) ? 0.0f : 2.0f / std::sqrt((float)i);
+	}
+
+	// triangles using each vertex
+	std::vector<unsigned int> activeCount(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		activeCount[mesh.indices[i]]++;
+	}
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + activeCount[v];
+	}
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+	std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int v = mesh.indices[t * 3 + corner];
+			adjacency[fill[v]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount, 0.0f);
+	std::vector<float> triangleScore(triangleCount, 0.0f);
+	std::vector<bool> bEmitted(triangleCount, false);
+
+	auto ScoreVertex = [&](size_t v) -> float
+	{
+		if (activeCount[v] == 0)
+		{
+			return(-1.0f);
+		}
+		float score = (cachePosition[v] >= 0) ? cacheScores[cachePosition[v]] : 0.0f;
+		return(score + valenceScores[std::min(activeCount[v], (unsigned int)MAX_VALENCE_SCORE - 1)]);
+	};
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScore[v] = ScoreVertex(v);
+	}
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScore[t] = vertexScore[mesh.indices[t * 3]] + vertexScore[mesh.indices[t * 3 + 1]] + vertexScore[mesh.indices[t * 3 + 2]];
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+	std::vector<int> cache;
+	std::vector<int> newCache;
+	cache.reserve(VERTEX_CACHE_SIZE + 3);
+	newCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+	int bestTriangle = -1;
+	size_t scanCursor = 0;
+
+	for (size_t emitted = 0; emitted < triangleCount; emitted++)
+	{
+		// when no cached triangle is left, take the best remaining one
+		if (bestTriangle < 0)
+		{
+			float bestScore = -1.0f;
+			while ((scanCursor < triangleCount) && bEmitted[scanCursor])
+			{
+				scanCursor++;
+			}
+			for (size_t t = scanCursor; (t < triangleCount) && (t < scanCursor + 1024); t++)
+			{
+				if ((bEmitted[t] == false) && (triangleScore[t] > bestScore))
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+			if (bestTriangle < 0)
+			{
+				break;
+			}
+		}
+
+		// emit the triangle and move its vertices to the cache front
+		bEmitted[bestTriangle] = true;
+		newCache.clear();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int v = mesh.indices[bestTriangle * 3 + corner];
+			output.push_back(v);
+			newCache.push_back((int)v);
+
+			// remove the triangle from the vertex's active list
+			unsigned int begin = adjacencyOffset[v];
+			unsigned int end = begin + activeCount[v];
+			for (unsigned int a = begin; a < end; a++)
+			{
+				if (adjacency[a] == (unsigned int)bestTriangle)
+				{
+					adjacency[a] = adjacency[end - 1];
+					break;
+				}
+			}
+			activeCount[v]--;
+		}
+		for (int i = 0; i < cache.size(); i++)
+		{
+			int v = cache[i];
+			if ((v != newCache[0]) && (v != newCache[1]) && (v != newCache[2]))
+			{
+				newCache.push_back(v);
+			}
+		}
+		cache.swap(newCache);
+
+		// vertices pushed out of the cache lose their cache score
+		for (int i = 0; i < cache.size(); i++)
+		{
+			cachePosition[cache[i]] = (i < VERTEX_CACHE_SIZE) ? i : -1;
+		}
+
+		// rescore the cached vertices and their remaining triangles,
+		// picking the best of them as the next triangle
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (int i = 0; i < cache.size(); i++)
+		{
+			int v = cache[i];
+			float oldScore = vertexScore[v];
+			vertexScore[v] = ScoreVertex(v);
+			float delta = vertexScore[v] - oldScore;
+
+			unsigned int begin = adjacencyOffset[v];
+			unsigned int end = begin + activeCount[v];
+			for (unsigned int a = begin; a < end; a++)
+			{
+				unsigned int t = adjacency[a];
+				triangleScore[t] += delta;
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+		if (cache.size() > VERTEX_CACHE_SIZE)
+		{
+			cache.resize(VERTEX_CACHE_SIZE);
+		}
+	}
+
+	// store the vertices in the order the triangles use them, so
+	// the vertex fetches also walk memory forward
+	std::vector<unsigned int> remap(vertexCount, 0xFFFFFFFFu);
+	std::vector<MESH_VERTEX> ordered;
+	ordered.reserve(vertexCount);
+	for (size_t i = 0; i < output.size(); i++)
+	{
+		unsigned int v = output[i];
+		if (remap[v] == 0xFFFFFFFFu)
+		{
+			remap[v] = (unsigned int)ordered.size();
+			ordered.push_back(mesh.vertices[v]);
+		}
+		output[i] = remap[v];
+	}
+
+	mesh.vertices.swap(ordered);
+	mesh.indices.swap(output);
+}
+
+/***********************************************************
+ *  CalculateACMR()
+ *
+ *  This method is used for simulating a FIFO post-transform
+ *  cache and getting the average number of vertices that
+ *  are transformed per triangle.
+ ***********************************************************/
+float MeshImporter::CalculateACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, int cacheSize)
+{
+	if (indices.size() < 3)
+	{
+		return(0.0f);
+	}
+
+	// time stamp each vertex entered the cache
+	std::vector<unsigned int> cachedAt(vertexCount, 0);
+	unsigned int clock = 0;
+	unsigned int misses = 0;
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		unsigned int v = indices[i];
+		if ((cachedAt[v] == 0) || (clock - cachedAt[v] >= (unsigned int)cacheSize))
+		{
+			clock++;
+			cachedAt[v] = clock;
+			misses++;
+		}
+	}
+
+	return((float)misses / (float)(indices.size() / 3));
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.h
+// ============
+// import triangle meshes from OBJ and glTF/GLB files
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeGeometry.h"
+#include "AssetPack.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshImporter
+ *
+ *  This class contains the code for importing meshes from
+ *  memory-mapped OBJ, glTF and GLB files.  Large OBJ files
+ *  are parsed in parallel chunks, vertices are deduplicated
+ *  and the triangles are reordered for the post-transform
+ *  vertex cache before the mesh is returned.
+ ***********************************************************/
+class MeshImporter
+{
+public:
+	// constructor
+	MeshImporter();
+	// destructor
+	~MeshImporter();
+
+	// timing and size of an import
+	struct IMPORT_STATS
+	{
+		size_t fileBytes;
+		int threadCount;
+		unsigned int vertexCount;
+		unsigned int triangleCount;
+		double parseMilliseconds;
+		double dedupeMilliseconds;
+		double optimizeMilliseconds;
+		double totalMilliseconds;
+		// average cache misses per triangle before and after
+		// the vertex cache optimization
+		float acmrBefore;
+		float acmrAfter;
+	};
+
+private:
+	// number of threads used for parsing
+	int m_threadCount;
+	// optional archive the files are read from in place
+	AssetPack* m_pAssetPack;
+	// statistics of the last import
+	IMPORT_STATS m_lastStats;
+
+	// parse the text of an OBJ file
+	bool ImportOBJ(const char* pText, size_t size, MESH_DATA& mesh);
+	// parse a glTF JSON document or a GLB container
+	bool ImportGLTF(const char* filename, const unsigned char* pData, size_t size, MESH_DATA& mesh);
+
+public:
+	// import the mesh stored in the passed in file - the format
+	// is chosen by the file extension
+	bool ImportMesh(const char* filename, MESH_DATA& mesh);
+	// set the number of parsing threads, 0 for one per core
+	void SetThreadCount(int threadCount);
+	// read the files from the passed in asset pack when it
+	// holds them
+	void SetAssetPack(AssetPack* pAssetPack);
+	// get the statistics of the last import
+	const IMPORT_STATS& GetLastStats();
+
+	// merge vertices that are exactly equal
+	static void DeduplicateVertices(MESH_DATA& mesh);
+	// reorder the triangles for the post-transform vertex cache
+	// and the vertices in the order they are first used
+	static void OptimizeVertexCache(MESH_DATA& mesh);
+	// calculate the average cache misses per triangle for a
+	// FIFO cache of the passed in size
+	static float CalculateACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, int cacheSize);
+};
@@ -0,0 +1,306 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// skip objects outside of the view frustum or hidden behind large
+// occluders, using a low resolution depth buffer drawn on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// clip space w below which a point is treated as crossing
+	// the camera plane
+	const float NEAR_W = 1e-3f;
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_depth.resize((size_t)width * height, 1.0f);
+	m_viewProjection = glm::mat4(1.0f);
+	m_frustumPlanes.resize(6, glm::vec4(0.0f));
+	m_viewCount = 1;
+	m_stats.tested = 0;
+	m_stats.outsideFrustum = 0;
+	m_stats.occluded = 0;
+	m_stats.occluderTriangles = 0;
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	m_depth.clear();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the depth buffer and
+ *  extracting the frustum planes from the passed in view
+ *  projection matrices.  The depth buffer is drawn from the
+ *  first view, and only used when it is the only one.
+ ***********************************************************/
+void OcclusionCuller::BeginFrame(const glm::mat4* pViewProjections, int viewCount)
+{
+	m_viewCount = std::max(viewCount, 1);
+	m_viewProjection = pViewProjections[0];
+	if (m_viewCount == 1)
+	{
+		std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+	}
+
+	// each plane is the last row plus or minus another row
+	m_frustumPlanes.resize((size_t)m_viewCount * 6);
+	for (int view = 0; view < m_viewCount; view++)
+	{
+		const glm::mat4& viewProjection = pViewProjections[view];
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+		{
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+
+		glm::vec4* pPlanes = &m_frustumPlanes[(size_t)view * 6];
+		pPlanes[0] = rows[3] + rows[0];
+		pPlanes[1] = rows[3] - rows[0];
+		pPlanes[2] = rows[3] + rows[1];
+		pPlanes[3] = rows[3] - rows[1];
+		pPlanes[4] = rows[3] + rows[2];
+		pPlanes[5] = rows[3] - rows[2];
+	}
+
+	m_stats.tested = 0;
+	m_stats.outsideFrustum = 0;
+	m_stats.occluded = 0;
+	m_stats.occluderTriangles = 0;
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method is used for writing the depth of a triangle
+ *  into the pixels whose centers it covers, keeping the
+ *  nearest depth of each pixel.
+ ***********************************************************/
+void OcclusionCuller::RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	// a triangle crossing the camera plane would need clipping -
+	// leaving it out only makes the culling less aggressive
+	if ((a.w < NEAR_W) || (b.w < NEAR_W) || (c.w < NEAR_W))
+	{
+		return;
+	}
+
+	// screen position in pixels and depth from 0 to 1
+	glm::vec3 p0 = glm::vec3((a.x / a.w * 0.5f + 0.5f) * m_width, (a.y / a.w * 0.5f + 0.5f) * m_height, a.z / a.w * 0.5f + 0.5f);
+	glm::vec3 p1 = glm::vec3((b.x / b.w * 0.5f + 0.5f) * m_width, (b.y / b.w * 0.5f + 0.5f) * m_height, b.z / b.w * 0.5f + 0.5f);
+	glm::vec3 p2 = glm::vec3((c.x / c.w * 0.5f + 0.5f) * m_width, (c.y / c.w * 0.5f + 0.5f) * m_height, c.z / c.w * 0.5f + 0.5f);
+
+	float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+	if (std::fabs(area) < 1e-6f)
+	{
+		return;
+	}
+
+	int minX = std::max((int)std::floor(std::min(std::min(p0.x, p1.x), p2.x)), 0);
+	int maxX = std::min((int)std::ceil(std::max(std::max(p0.x, p1.x), p2.x)), m_width - 1);
+	int minY = std::max((int)std::floor(std::min(std::min(p0.y, p1.y), p2.y)), 0);
+	int maxY = std::min((int)std::ceil(std::max(std::max(p0.y, p1.y), p2.y)), m_height - 1);
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+
+	m_stats.occluderTriangles++;
+
+	// both windings occlude, so the edge weights are normalized
+	// by the signed area
+	float inverseArea = 1.0f / area;
+	for (int y = minY; y <= maxY; y++)
+	{
+		float sampleY = y + 0.5f;
+		float* pRow = &m_depth[(size_t)y * m_width];
+
+		for (int x = minX; x <= maxX; x++)
+		{
+			float sampleX = x + 0.5f;
+			float w0 = ((p2.x - p1.x) * (sampleY - p1.y) - (p2.y - p1.y) * (sampleX - p1.x)) * inverseArea;
+			float w1 = ((p0.x - p2.x) * (sampleY - p2.y) - (p0.y - p2.y) * (sampleX - p2.x)) * inverseArea;
+			float w2 = 1.0f - w0 - w1;
+			if ((w0 < 0.0f) || (w1 < 0.0f) || (w2 < 0.0f))
+			{
+				continue;
+			}
+
+			float depth = w0 * p0.z + w1 * p1.z + w2 * p2.z;
+			if (depth < pRow[x])
+			{
+				pRow[x] = depth;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  AddOccluder()
+ *
+ *  This method is used for drawing the triangles of a large
+ *  object into the depth buffer.
+ ***********************************************************/
+void OcclusionCuller::AddOccluder(const MESH_VERTEX* vertices, const unsigned int* indices, unsigned int indexCount)
+{
+	// an object hidden in one view may be seen in another
+	if (m_viewCount > 1)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		RasterizeTriangle(
+			m_viewProjection * glm::vec4(vertices[indices[i]].position, 1.0f),
+			m_viewProjection * glm::vec4(vertices[indices[i + 1]].position, 1.0f),
+			m_viewProjection * glm::vec4(vertices[indices[i + 2]].position, 1.0f));
+	}
+}
+
+/***********************************************************
+ *  IsInFrustum()
+ *
+ *  This method is used for checking a box against the six
+ *  frustum planes of each view.  The box is outside a view
+ *  when its corner furthest along one of the plane normals
+ *  is still behind that plane, and it is kept as soon as
+ *  one view contains it.
+ ***********************************************************/
+bool OcclusionCuller::IsInFrustum(glm::vec3 boundsMin, glm::vec3 boundsMax)
+{
+	for (int view = 0; view < m_viewCount; view++)
+	{
+		const glm::vec4* pPlanes = &m_frustumPlanes[(size_t)view * 6];
+		bool bInside = true;
+		for (int i = 0; (i < 6) && (bInside == true); i++)
+		{
+			const glm::vec4& plane = pPlanes[i];
+			glm::vec3 corner = glm::vec3(
+				(plane.x >= 0.0f) ? boundsMax.x : boundsMin.x,
+				(plane.y >= 0.0f) ? boundsMax.y : boundsMin.y,
+				(plane.z >= 0.0f) ? boundsMax.z : boundsMin.z);
+
+			bInside = (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w >= 0.0f);
+		}
+
+		if (bInside == true)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IsVisible()
+ *
+ *  This method is used for checking whether a box could be
+ *  seen.  The screen rectangle and nearest depth of its
+ *  corners are compared with the occluder depth buffer, and
+ *  the box is hidden only when every covered pixel holds an
+ *  occluder in front of it.
+ ***********************************************************/
+bool OcclusionCuller::IsVisible(glm::vec3 boundsMin, glm::vec3 boundsMax)
+{
+	m_stats.tested++;
+
+	if (IsInFrustum(boundsMin, boundsMax) == false)
+	{
+		m_stats.outsideFrustum++;
+		return(false);
+	}
+
+	// the depth buffer only holds the occluders of one view
+	if (m_viewCount > 1)
+	{
+		return(true);
+	}
+
+	float minX = (float)m_width;
+	float maxX = 0.0f;
+	float minY = (float)m_height;
+	float maxY = 0.0f;
+	float nearestDepth = 1.0f;
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = glm::vec3(
+			(i & 1) ? boundsMax.x : boundsMin.x,
+			(i & 2) ? boundsMax.y : boundsMin.y,
+			(i & 4) ? boundsMax.z : boundsMin.z);
+		glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+
+		// a box reaching behind the camera covers the view
+		if (clip.w < NEAR_W)
+		{
+			return(true);
+		}
+
+		float x = (clip.x / clip.w * 0.5f + 0.5f) * m_width;
+		float y = (clip.y / clip.w * 0.5f + 0.5f) * m_height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::min(nearestDepth, clip.z / clip.w * 0.5f + 0.5f);
+	}
+
+	int beginX = std::max((int)std::floor(minX), 0);
+	int endX = std::min((int)std::ceil(maxX), m_width - 1);
+	int beginY = std::max((int)std::floor(minY), 0);
+	int endY = std::min((int)std::ceil(maxY), m_height - 1);
+	if ((beginX > endX) || (beginY > endY))
+	{
+		m_stats.outsideFrustum++;
+		return(false);
+	}
+
+	for (int y = beginY; y <= endY; y++)
+	{
+		const float* pRow = &m_depth[(size_t)y * m_width];
+		for (int x = beginX; x <= endX; x++)
+		{
+			if (pRow[x] >= nearestDepth)
+			{
+				return(true);
+			}
+		}
+	}
+
+	m_stats.occluded++;
+	return(false);
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the number of tested,
+ *  frustum culled and occluded objects of the frame.
+ ***********************************************************/
+const OcclusionCuller::CULL_STATS& OcclusionCuller::GetStats()
+{
+	return(m_stats);
+}
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// skip objects outside of the view frustum or hidden behind large
+// occluders, using a low resolution depth buffer drawn on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeGeometry.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class contains the code for culling objects before
+ *  they are drawn.  Each frame the large occluders are
+ *  rasterized into a small depth buffer on the CPU, then
+ *  the bounding box of every object is tested against the
+ *  frustum planes and against that depth buffer.  Objects
+ *  whose nearest point is behind the occluders everywhere
+ *  they cover on screen are hidden.  When several views
+ *  are drawn at once, an object is kept when it is inside
+ *  any of their frustums, and the depth buffer is not used.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// constructor
+	OcclusionCuller(int width, int height);
+	// destructor
+	~OcclusionCuller();
+
+	// culling results of a frame
+	struct CULL_STATS
+	{
+		int tested;
+		int outsideFrustum;
+		int occluded;
+		int occluderTriangles;
+	};
+
+private:
+	// size of the depth buffer in pixels
+	int m_width;
+	int m_height;
+	// nearest occluder depth of each pixel, 0 near to 1 far
+	std::vector<float> m_depth;
+	// transform of the first view of the current frame, and
+	// six frustum planes for each view
+	glm::mat4 m_viewProjection;
+	std::vector<glm::vec4> m_frustumPlanes;
+	int m_viewCount;
+	// results of the current frame
+	CULL_STATS m_stats;
+
+	// rasterize one clip space triangle into the depth buffer
+	void RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+public:
+	// clear the depth buffer and set the views of the frame
+	void BeginFrame(const glm::mat4* pViewProjections, int viewCount);
+	// draw the triangles of an occluder given in world space
+	void AddOccluder(const MESH_VERTEX* vertices, const unsigned int* indices, unsigned int indexCount);
+	// check whether a world space box is inside the frustum
+	// of any view
+	bool IsInFrustum(glm::vec3 boundsMin, glm::vec3 boundsMax);
+	// check whether a world space box may be visible - it is
+	// counted as outside of the frustum or occluded when not
+	bool IsVisible(glm::vec3 boundsMin, glm::vec3 boundsMax);
+
+	// get the results of the current frame
+	const CULL_STATS& GetStats();
+};
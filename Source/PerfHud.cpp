@@ -0,0 +1,648 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfhud.cpp
+// ============
+// draw an overlay of frame time graphs and render counters over the shown
+// frame, batched into a single draw from a glyph atlas
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerfHud.h"
+#include "GpuResources.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// size of a glyph of the built-in font, and of its cell in
+	// the atlas, which leaves an empty column and row around it
+	const int GLYPH_WIDTH = 5;
+	const int GLYPH_HEIGHT = 7;
+	const int CELL_WIDTH = 6;
+	const int CELL_HEIGHT = 8;
+	// window pixels per font pixel, kept whole so the nearest
+	// filtered glyphs stay sharp
+	const int TEXT_SCALE = 2;
+	const float LINE_HEIGHT = (float)((GLYPH_HEIGHT + 3) * TEXT_SCALE);
+
+	// placement of the panel from the top left of the window
+	const float PANEL_MARGIN = 8.0f;
+	const float PANEL_PADDING = 6.0f;
+	// bar width and height of the frame time graph, and the
+	// frame time at its top
+	const int BAR_WIDTH = 2;
+	const float GRAPH_HEIGHT = 60.0f;
+	const float GRAPH_MAX_MILLISECONDS = 50.0f;
+	// frame time of 60 frames per second - slower frames are
+	// drawn as slow, and frames over twice that as missed
+	const float TARGET_MILLISECONDS = 1000.0f / 60.0f;
+
+	const int LINE_COUNT = 7;
+	const int LINE_LENGTH = 64;
+
+	const unsigned char BACKGROUND_COLOR[4] = { 0, 0, 0, 168 };
+	const unsigned char TEXT_COLOR[4] = { 235, 235, 235, 255 };
+	const unsigned char GOOD_COLOR[4] = { 80, 200, 90, 255 };
+	const unsigned char SLOW_COLOR[4] = { 235, 200, 60, 255 };
+	const unsigned char MISSED_COLOR[4] = { 235, 70, 60, 255 };
+	const unsigned char GPU_COLOR[4] = { 90, 150, 240, 255 };
+	const unsigned char TARGET_COLOR[4] = { 255, 255, 255, 110 };
+
+	// rows of a glyph from the top, with the leftmost pixel in
+	// the highest of the five used bits - lowercase letters are
+	// drawn with the uppercase glyphs
+	struct HUD_GLYPH
+	{
+		char character;
+		unsigned char rows[GLYPH_HEIGHT];
+	};
+
+	const HUD_GLYPH g_Glyphs[] =
+	{
+		{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+		{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+		{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+		{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+		{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+		{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+		{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+		{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+		{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+		{ 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+		{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+		{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+		{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+		{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+		{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+		{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+		{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+		{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+		{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+		{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+		{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+		{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+		{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+		{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+		{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+		{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+		{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+		{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+		{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+		{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+		{ ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+		{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+		{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+		{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+		{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+		{ '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+		{ '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+		{ ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } }
+	};
+	const int GLYPH_COUNT = sizeof(g_Glyphs) / sizeof(g_Glyphs[0]);
+
+	// the overlay places its quads in window pixels from the top
+	// left, and multiplies the color's alpha by the atlas
+	const char* g_HudVertexSource =
+		"#version 460 core\n"
+		"layout (location = 0) in vec2 inPosition;\n"
+		"layout (location = 1) in vec2 inTexCoord;\n"
+		"layout (location = 2) in vec4 inColor;\n"
+		"uniform vec2 screenSize;\n"
+		"out vec2 fragmentTexCoord;\n"
+		"out vec4 fragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 ndc = inPosition / screenSize * 2.0 - 1.0;\n"
+		"	gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+		"	fragmentTexCoord = inTexCoord;\n"
+		"	fragmentColor = inColor;\n"
+		"}\n";
+	const char* g_HudFragmentSource =
+		"#version 460 core\n"
+		"in vec2 fragmentTexCoord;\n"
+		"in vec4 fragmentColor;\n"
+		"uniform sampler2D atlas;\n"
+		"out vec4 outFragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	outFragmentColor = vec4(fragmentColor.rgb, fragmentColor.a * texture(atlas, fragmentTexCoord).r);\n"
+		"}\n";
+
+	// compile one stage of the overlay program, printing the
+	// log when it fails
+	GLuint CompileHudStage(GLenum stageType, const char* pSource)
+	{
+		GLuint shaderID = glCreateShader(stageType);
+		GLint success = 0;
+
+		glShaderSource(shaderID, 1, &pSource, NULL);
+		glCompileShader(shaderID);
+
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[1024];
+			glGetShaderInfoLog(shaderID, 1024, NULL, infoLog);
+			std::cout << "ERROR::SHADER_COMPILATION_ERROR:\n" << infoLog << std::endl;
+			glDeleteShader(shaderID);
+			return(0);
+		}
+
+		return(shaderID);
+	}
+}
+
+/***********************************************************
+ *  PerfHud()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerfHud::PerfHud(ShaderVariants* pShaderVariants)
+{
+	m_pShaderVariants = pShaderVariants;
+	m_program = 0;
+	m_screenSizeLocation = -1;
+	m_vertexArray = 0;
+	m_vertexBuffer = 0;
+	m_atlas = 0;
+	m_atlasWidth = 0;
+	m_atlasHeight = 0;
+	for (int i = 0; i < 128; i++)
+	{
+		m_glyphCells[i] = -1;
+	}
+	m_solidCell = 0;
+	m_bCreateFailed = false;
+
+	// sized once, so writing the quads of a frame never
+	// allocates
+	m_vertices.resize(MAX_QUADS * 6);
+	m_vertexCount = 0;
+
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		m_frameHistory[i] = 0.0f;
+		m_gpuHistory[i] = 0.0f;
+	}
+	m_historyIndex = 0;
+	m_historyCount = 0;
+	m_bHasLastFrame = false;
+
+	m_cpuMilliseconds = 0.0;
+	m_hudGpuMilliseconds = 0.0f;
+	m_timerQueries[0] = 0;
+	m_timerQueries[1] = 0;
+	m_timerFrame = 0;
+}
+
+/***********************************************************
+ *  ~PerfHud()
+ *
+ *  The destructor for the class - the context must be
+ *  current on the calling thread
+ ***********************************************************/
+PerfHud::~PerfHud()
+{
+	DestroyGLObjects();
+	m_pShaderVariants = NULL;
+}
+
+/***********************************************************
+ *  CreateGLObjects()
+ *
+ *  This method is used for building the glyph atlas, the
+ *  overlay program and the vertex array the quads are
+ *  streamed through.  The atlas has one cell per glyph of
+ *  the built-in font plus a solid cell, so the panel and
+ *  the graph bars are drawn with the same texture as the
+ *  text.
+ ***********************************************************/
+bool PerfHud::CreateGLObjects()
+{
+	m_solidCell = GLYPH_COUNT;
+	m_atlasWidth = (GLYPH_COUNT + 1) * CELL_WIDTH;
+	m_atlasHeight = CELL_HEIGHT;
+
+	std::vector<unsigned char> texels(m_atlasWidth * m_atlasHeight, 0);
+	for (int i = 0; i < GLYPH_COUNT; i++)
+	{
+		const HUD_GLYPH& glyph = g_Glyphs[i];
+		for (int row = 0; row < GLYPH_HEIGHT; row++)
+		{
+			for (int column = 0; column < GLYPH_WIDTH; column++)
+			{
+				if ((glyph.rows[row] & (0x10 >> column)) != 0)
+				{
+					texels[row * m_atlasWidth + i * CELL_WIDTH + column] = 255;
+				}
+			}
+		}
+		m_glyphCells[(int)glyph.character] = i;
+		if ((glyph.character >= 'A') && (glyph.character <= 'Z'))
+		{
+			m_glyphCells[glyph.character - 'A' + 'a'] = i;
+		}
+	}
+	for (int row = 0; row < CELL_HEIGHT; row++)
+	{
+		for (int column = 0; column < CELL_WIDTH; column++)
+		{
+			texels[row * m_atlasWidth + m_solidCell * CELL_WIDTH + column] = 255;
+		}
+	}
+
+	// the atlas has its own unit, so the bound scene textures
+	// and the lightmap are left alone
+	glActiveTexture(GL_TEXTURE0 + HUD_TEXTURE_UNIT);
+	glGenTextures(1, &m_atlas);
+	glBindTexture(GL_TEXTURE_2D, m_atlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_atlasWidth, m_atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GpuResources::Track(GpuResources::RESOURCE_TEXTURE, m_atlas,
+		GpuResources::GetTextureBytes(m_atlasWidth, m_atlasHeight, 1, false), "PerfHud atlas");
+
+	m_program = CompileProgram();
+	if (m_program == 0)
+	{
+		return(false);
+	}
+	m_screenSizeLocation = glGetUniformLocation(m_program, "screenSize");
+	glUseProgram(m_program);
+	glUniform1i(glGetUniformLocation(m_program, "atlas"), HUD_TEXTURE_UNIT);
+	glUseProgram(0);
+
+	glGenBuffers(1, &m_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_vertices.size() * sizeof(HUD_VERTEX)), NULL, GL_STREAM_DRAW);
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, m_vertexBuffer,
+		m_vertices.size() * sizeof(HUD_VERTEX), "PerfHud vertices");
+
+	glGenVertexArrays(1, &m_vertexArray);
+	glBindVertexArray(m_vertexArray);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, x));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, u));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, color));
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GpuResources::Track(GpuResources::RESOURCE_VERTEX_ARRAY, m_vertexArray, 0, "PerfHud vertices");
+
+	glGenQueries(2, m_timerQueries);
+	for (int i = 0; i < 2; i++)
+	{
+		GpuResources::Track(GpuResources::RESOURCE_QUERY, m_timerQueries[i], 0, "PerfHud timers");
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling and linking the
+ *  program the overlay is drawn with.
+ ***********************************************************/
+GLuint PerfHud::CompileProgram()
+{
+	GLuint vertexID = CompileHudStage(GL_VERTEX_SHADER, g_HudVertexSource);
+	GLuint fragmentID = CompileHudStage(GL_FRAGMENT_SHADER, g_HudFragmentSource);
+	if ((vertexID == 0) || (fragmentID == 0))
+	{
+		glDeleteShader(vertexID);
+		glDeleteShader(fragmentID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	GLint success = 0;
+
+	glAttachShader(programID, vertexID);
+	glAttachShader(programID, fragmentID);
+	glLinkProgram(programID);
+
+	glDeleteShader(vertexID);
+	glDeleteShader(fragmentID);
+
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[1024];
+		glGetProgramInfoLog(programID, 1024, NULL, infoLog);
+		std::cout << "ERROR::PROGRAM_LINKING_ERROR:\n" << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	GLint binaryBytes = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+	GpuResources::Track(GpuResources::RESOURCE_PROGRAM, programID, (size_t)binaryBytes, "PerfHud");
+
+	return(programID);
+}
+
+/***********************************************************
+ *  DestroyGLObjects()
+ *
+ *  This method is used for freeing the atlas, the program,
+ *  the vertex array and the timer queries.
+ ***********************************************************/
+void PerfHud::DestroyGLObjects()
+{
+	if (m_timerQueries[0] != 0)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			GpuResources::Release(GpuResources::RESOURCE_QUERY, m_timerQueries[i]);
+		}
+		glDeleteQueries(2, m_timerQueries);
+		m_timerQueries[0] = 0;
+		m_timerQueries[1] = 0;
+	}
+	if (m_vertexArray != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_VERTEX_ARRAY, m_vertexArray);
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+	if (m_vertexBuffer != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_vertexBuffer);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		m_vertexBuffer = 0;
+	}
+	if (m_program != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_PROGRAM, m_program);
+		glDeleteProgram(m_program);
+		m_program = 0;
+	}
+	if (m_atlas != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_TEXTURE, m_atlas);
+		glDeleteTextures(1, &m_atlas);
+		m_atlas = 0;
+	}
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for writing the two triangles of a
+ *  quad with the passed in atlas coordinates.  Quads past
+ *  the capacity of the vertex array are dropped.
+ ***********************************************************/
+void PerfHud::AddQuad(float x, float y, float width, float height, float u0, float v0, float u1, float v1, const unsigned char* color)
+{
+	if (m_vertexCount + 6 > (int)m_vertices.size())
+	{
+		return;
+	}
+
+	const float corners[6][4] =
+	{
+		{ x, y, u0, v0 },
+		{ x, y + height, u0, v1 },
+		{ x + width, y + height, u1, v1 },
+		{ x, y, u0, v0 },
+		{ x + width, y + height, u1, v1 },
+		{ x + width, y, u1, v0 }
+	};
+	for (int i = 0; i < 6; i++)
+	{
+		HUD_VERTEX& vertex = m_vertices[m_vertexCount++];
+		vertex.x = corners[i][0];
+		vertex.y = corners[i][1];
+		vertex.u = corners[i][2];
+		vertex.v = corners[i][3];
+		memcpy(vertex.color, color, 4);
+	}
+}
+
+/***********************************************************
+ *  AddRect()
+ *
+ *  This method is used for writing a rectangle of a single
+ *  color, which samples the middle of the solid cell.
+ ***********************************************************/
+void PerfHud::AddRect(float x, float y, float width, float height, const unsigned char* color)
+{
+	float u = ((float)(m_solidCell * CELL_WIDTH) + CELL_WIDTH * 0.5f) / (float)m_atlasWidth;
+	float v = (CELL_HEIGHT * 0.5f) / (float)m_atlasHeight;
+	AddQuad(x, y, width, height, u, v, u, v, color);
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  This method is used for writing a quad for every glyph
+ *  of a line of text.  Spaces and characters the font does
+ *  not have only move the pen.
+ ***********************************************************/
+float PerfHud::AddText(float x, float y, const char* text, const unsigned char* color)
+{
+	const float advance = (float)((GLYPH_WIDTH + 1) * TEXT_SCALE);
+	float penX = x;
+
+	for (const char* pCharacter = text; *pCharacter != '\0'; pCharacter++)
+	{
+		int cell = m_glyphCells[(unsigned char)*pCharacter & 127];
+		if (cell >= 0)
+		{
+			float u0 = (float)(cell * CELL_WIDTH) / (float)m_atlasWidth;
+			float u1 = (float)(cell * CELL_WIDTH + GLYPH_WIDTH) / (float)m_atlasWidth;
+			float v1 = (float)GLYPH_HEIGHT / (float)m_atlasHeight;
+			AddQuad(penX, y, (float)(GLYPH_WIDTH * TEXT_SCALE), (float)(GLYPH_HEIGHT * TEXT_SCALE), u0, 0.0f, u1, v1, color);
+		}
+		penX += advance;
+	}
+
+	return(penX - x);
+}
+
+/***********************************************************
+ *  AddGraph()
+ *
+ *  This method is used for writing a bar for each kept
+ *  frame, newest on the right.  The frame time bar is
+ *  colored by how it compares to the 60 frames per second
+ *  target, the GPU time of the scene is drawn over its left
+ *  half, and a line marks the target.
+ ***********************************************************/
+void PerfHud::AddGraph(float x, float y, float width, float height)
+{
+	for (int i = 0; i < m_historyCount; i++)
+	{
+		int sample = (m_historyIndex - m_historyCount + i + HISTORY_SIZE) % HISTORY_SIZE;
+		float barX = x + (float)((HISTORY_SIZE - m_historyCount + i) * BAR_WIDTH);
+
+		float frameMilliseconds = m_frameHistory[sample];
+		const unsigned char* color = GOOD_COLOR;
+		if (frameMilliseconds > TARGET_MILLISECONDS * 2.0f)
+		{
+			color = MISSED_COLOR;
+		}
+		else if (frameMilliseconds > TARGET_MILLISECONDS)
+		{
+			color = SLOW_COLOR;
+		}
+
+		float frameHeight = std::fmin(frameMilliseconds / GRAPH_MAX_MILLISECONDS, 1.0f) * height;
+		AddRect(barX, y + height - frameHeight, (float)BAR_WIDTH, frameHeight, color);
+
+		float gpuHeight = std::fmin(m_gpuHistory[sample] / GRAPH_MAX_MILLISECONDS, 1.0f) * height;
+		AddRect(barX, y + height - gpuHeight, (float)(BAR_WIDTH / 2), gpuHeight, GPU_COLOR);
+	}
+
+	float targetY = y + height - (TARGET_MILLISECONDS / GRAPH_MAX_MILLISECONDS) * height;
+	AddRect(x, std::floor(targetY), width, 1.0f, TARGET_COLOR);
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing the overlay over the
+ *  shown frame.  The time since the last call is kept as
+ *  the frame time, the counters are formatted into fixed
+ *  buffers, and every quad of the panel, the text and the
+ *  graph is uploaded and drawn with one call.  The overlay
+ *  binds its own program, so the shader variants are told
+ *  to bind theirs again.
+ ***********************************************************/
+void PerfHud::Render(const FRAME_STATS& stats, int width, int height)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if ((width <= 0) || (height <= 0) || (m_bCreateFailed == true))
+	{
+		return;
+	}
+	if (m_program == 0)
+	{
+		if (CreateGLObjects() == false)
+		{
+			std::cout << "Performance overlay could not be created" << std::endl;
+			DestroyGLObjects();
+			m_bCreateFailed = true;
+			return;
+		}
+	}
+
+	if (m_bHasLastFrame == true)
+	{
+		m_frameHistory[m_historyIndex] = std::chrono::duration<float, std::milli>(start - m_lastFrameTime).count();
+		m_gpuHistory[m_historyIndex] = stats.gpuMilliseconds;
+		m_historyIndex = (m_historyIndex + 1) % HISTORY_SIZE;
+		if (m_historyCount < HISTORY_SIZE)
+		{
+			m_historyCount++;
+		}
+	}
+	m_lastFrameTime = start;
+	m_bHasLastFrame = true;
+
+	// the query of two frames ago is read without waiting
+	GLuint query = m_timerQueries[m_timerFrame % 2];
+	if (m_timerFrame >= 2)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != 0)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+			m_hudGpuMilliseconds = (float)nanoseconds / 1000000.0f;
+		}
+	}
+
+	float frameMilliseconds = 0.0f;
+	if (m_historyCount > 0)
+	{
+		frameMilliseconds = m_frameHistory[(m_historyIndex + HISTORY_SIZE - 1) % HISTORY_SIZE];
+	}
+
+	char lines[LINE_COUNT][LINE_LENGTH];
+	snprintf(lines[0], LINE_LENGTH, "FRAME %6.2f MS  %5.1f FPS",
+		frameMilliseconds, (frameMilliseconds > 0.0f) ? 1000.0f / frameMilliseconds : 0.0f);
+	snprintf(lines[1], LINE_LENGTH, "GPU   %6.2f MS  SCALE %d%%",
+		stats.gpuMilliseconds, (int)std::lround(stats.resolutionScale * 100.0f));
+	snprintf(lines[2], LINE_LENGTH, "DRAWS %d IN %d MULTI-DRAWS", stats.drawCount, stats.multiDrawCount);
+	snprintf(lines[3], LINE_LENGTH, "STATE CHANGES %d", stats.stateChanges);
+	snprintf(lines[4], LINE_LENGTH, "TRIANGLES %llu", stats.triangleCount);
+	snprintf(lines[5], LINE_LENGTH, "GPU MEMORY %.1f MB", (double)stats.gpuBytes / (1024.0 * 1024.0));
+	snprintf(lines[6], LINE_LENGTH, "HUD CPU %.3f MS  GPU %.3f MS", m_cpuMilliseconds, m_hudGpuMilliseconds);
+
+	const float advance = (float)((GLYPH_WIDTH + 1) * TEXT_SCALE);
+	float graphWidth = (float)(HISTORY_SIZE * BAR_WIDTH);
+	float contentWidth = graphWidth;
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		contentWidth = std::fmax(contentWidth, strlen(lines[i]) * advance);
+	}
+
+	float textX = PANEL_MARGIN + PANEL_PADDING;
+	float textY = PANEL_MARGIN + PANEL_PADDING;
+	float graphY = textY + LINE_COUNT * LINE_HEIGHT;
+
+	// the panel goes first, so the text and bars blend over it
+	m_vertexCount = 0;
+	AddRect(PANEL_MARGIN, PANEL_MARGIN, contentWidth + PANEL_PADDING * 2.0f,
+		LINE_COUNT * LINE_HEIGHT + GRAPH_HEIGHT + PANEL_PADDING * 2.0f, BACKGROUND_COLOR);
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		AddText(textX, textY + i * LINE_HEIGHT, lines[i], TEXT_COLOR);
+	}
+	AddGraph(textX, graphY, graphWidth, GRAPH_HEIGHT);
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glUseProgram(m_program);
+	glUniform2f(m_screenSizeLocation, (float)width, (float)height);
+	glActiveTexture(GL_TEXTURE0 + HUD_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_atlas);
+
+	// the buffer is orphaned, so the upload does not wait on
+	// the draw of the last frame
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_vertices.size() * sizeof(HUD_VERTEX)), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(m_vertexCount * sizeof(HUD_VERTEX)), m_vertices.data());
+
+	glBindVertexArray(m_vertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glUseProgram(0);
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_timerFrame++;
+
+	if (NULL != m_pShaderVariants)
+	{
+		m_pShaderVariants->ReleaseActiveVariant();
+	}
+
+	m_cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfhud.h
+// ============
+// draw an overlay of frame time graphs and render counters over the shown
+// frame, batched into a single draw from a glyph atlas
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderVariants.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  PerfHud
+ *
+ *  This class contains the code for showing the cost of the
+ *  frames without an external profiler.  Every frame, the
+ *  text of the counters and the bars of the frame time
+ *  graphs are written as quads into one vertex array, then
+ *  drawn with a single call.  The glyphs of a small built-in
+ *  5x7 font and one solid texel share an atlas, so the text,
+ *  the bars and the background all use the same texture and
+ *  program.  The vertex array is sized once and the text is
+ *  formatted into fixed buffers, so a steady frame does not
+ *  allocate.  The GPU time of the overlay itself is measured
+ *  with a timer query and shown next to its CPU time.
+ ***********************************************************/
+class PerfHud
+{
+public:
+	// constructor
+	PerfHud(ShaderVariants* pShaderVariants);
+	// destructor
+	~PerfHud();
+
+	// counters of the frame being shown
+	struct FRAME_STATS
+	{
+		// smoothed GPU time of the scene, and the fraction of
+		// the window resolution it was rendered at
+		float gpuMilliseconds;
+		float resolutionScale;
+		// draws in the draw list, multi-draw calls they were
+		// submitted with, and the state changes between them
+		int drawCount;
+		int multiDrawCount;
+		int stateChanges;
+		unsigned long long triangleCount;
+		// live bytes of the tracked OpenGL objects
+		size_t gpuBytes;
+	};
+
+	// texture unit the atlas is bound to, after the scene
+	// textures and the lightmap
+	static const int HUD_TEXTURE_UNIT = 16;
+
+private:
+	// frames kept for the graphs
+	static const int HISTORY_SIZE = 120;
+	// quads the overlay can hold
+	static const int MAX_QUADS = 2048;
+
+	// vertex of a quad corner, in window pixels from the top
+	// left, with a normalized color
+	struct HUD_VERTEX
+	{
+		float x;
+		float y;
+		float u;
+		float v;
+		unsigned char color[4];
+	};
+
+	// pointer to shader variants object, told when the overlay
+	// changed the bound program
+	ShaderVariants* m_pShaderVariants;
+
+	GLuint m_program;
+	GLint m_screenSizeLocation;
+	GLuint m_vertexArray;
+	GLuint m_vertexBuffer;
+	GLuint m_atlas;
+	int m_atlasWidth;
+	int m_atlasHeight;
+	// atlas cell of each ASCII character, or -1
+	int m_glyphCells[128];
+	// cell holding the solid texel the bars are drawn with
+	int m_solidCell;
+	bool m_bCreateFailed;
+
+	// quads of the frame being written, sized once
+	std::vector<HUD_VERTEX> m_vertices;
+	int m_vertexCount;
+
+	// frame and GPU times of the last frames, in a ring
+	float m_frameHistory[HISTORY_SIZE];
+	float m_gpuHistory[HISTORY_SIZE];
+	int m_historyIndex;
+	int m_historyCount;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+	bool m_bHasLastFrame;
+
+	// CPU and GPU time of the overlay in the last frame, the
+	// GPU time read from the older of two timer queries
+	double m_cpuMilliseconds;
+	float m_hudGpuMilliseconds;
+	GLuint m_timerQueries[2];
+	int m_timerFrame;
+
+	// build the atlas, the program and the vertex array
+	bool CreateGLObjects();
+	void DestroyGLObjects();
+	GLuint CompileProgram();
+
+	// add a quad with atlas coordinates, a solid rectangle, or
+	// a line of text, and get the width of the text in pixels
+	void AddQuad(float x, float y, float width, float height, float u0, float v0, float u1, float v1, const unsigned char* color);
+	void AddRect(float x, float y, float width, float height, const unsigned char* color);
+	float AddText(float x, float y, const char* text, const unsigned char* color);
+	// add the bars of a graph of the kept frame times
+	void AddGraph(float x, float y, float width, float height);
+
+public:
+	// draw the overlay into the bound framebuffer of the passed
+	// in size - runs on the thread that owns the context
+	void Render(const FRAME_STATS& stats, int width, int height);
+};
\ No newline at end of file
@@ -0,0 +1,432 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderthread.cpp
+// ============
+// own the OpenGL context on a thread of its own that draws the frame
+// packets the main thread builds
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderThread.h"
+#include "AllocationCounter.h"
+#include "GpuResources.h"
+
+#include <chrono>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// starting size of the frame arena of each packet - it
+	// grows to fit the largest frame
+	const size_t FRAME_ARENA_BYTES = 256 * 1024;
+}
+
+/***********************************************************
+ *  RenderThread()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderThread::RenderThread(GLFWwindow* pWindow, SceneManager* pSceneManager, DynamicResolution* pDynamicResolution)
+{
+	m_pWindow = pWindow;
+	m_pSceneManager = pSceneManager;
+	m_pDynamicResolution = pDynamicResolution;
+	m_pFrameCapture = NULL;
+	m_pInputRecorder = NULL;
+	m_pPerfHud = NULL;
+	m_pFrameGraph = NULL;
+	m_scenePass = -1;
+	m_sceneColorTarget = -1;
+	m_sceneDepthTarget = -1;
+	m_pDrawingPacket = NULL;
+	m_bFrameStarted = false;
+
+	for (int i = 0; i < PACKET_COUNT; i++)
+	{
+		m_packets[i] = SceneManager::FRAME_PACKET();
+		m_packets[i].pFrameArena = new FrameArena(FRAME_ARENA_BYTES);
+		m_packets[i].viewCount = 1;
+		m_packets[i].staticEditCount = 0;
+		m_states[i] = PACKET_FREE;
+		m_queue[i] = 0;
+	}
+	m_queueHead = 0;
+	m_queueCount = 0;
+	m_bStopping = false;
+	m_frameCount = 0;
+	m_buildWaitMilliseconds = 0.0;
+	m_renderWaitMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~RenderThread()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderThread::~RenderThread()
+{
+	// the context is current on this thread again after Stop(),
+	// so the graph can free its targets
+	Stop();
+	delete m_pFrameGraph;
+	m_pFrameGraph = NULL;
+	m_pDrawingPacket = NULL;
+	for (int i = 0; i < PACKET_COUNT; i++)
+	{
+		delete m_packets[i].pFrameArena;
+		m_packets[i].pFrameArena = NULL;
+	}
+	m_pWindow = NULL;
+	m_pSceneManager = NULL;
+	m_pDynamicResolution = NULL;
+	m_pFrameCapture = NULL;
+	m_pInputRecorder = NULL;
+	m_pPerfHud = NULL;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the render thread.  A
+ *  context can only be current on one thread, so the calling
+ *  thread lets go of it first.
+ ***********************************************************/
+void RenderThread::Start()
+{
+	if (m_thread.joinable() == true)
+	{
+		return;
+	}
+
+	m_bStopping = false;
+	glfwMakeContextCurrent(NULL);
+	m_thread = std::thread(&RenderThread::ThreadLoop, this);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the render thread once
+ *  the queued packets are drawn.  The OpenGL objects are
+ *  freed on the calling thread afterwards, so the context
+ *  is made current on it again.
+ ***********************************************************/
+void RenderThread::Stop()
+{
+	if (m_thread.joinable() == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+		m_packetQueued.notify_one();
+	}
+	m_thread.join();
+
+	glfwMakeContextCurrent(m_pWindow);
+}
+
+/***********************************************************
+ *  AcquirePacket()
+ *
+ *  This method is used for getting a free packet for the
+ *  main thread to build the next frame into.  When the
+ *  render thread still has every packet, the main thread
+ *  waits, which keeps it at most one frame ahead.
+ ***********************************************************/
+SceneManager::FRAME_PACKET* RenderThread::AcquirePacket()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	int freeIndex = -1;
+	for (int i = 0; (i < PACKET_COUNT) && (freeIndex < 0); i++)
+	{
+		if (m_states[i] == PACKET_FREE)
+		{
+			freeIndex = i;
+		}
+	}
+
+	if (freeIndex < 0)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (freeIndex < 0)
+		{
+			m_packetFreed.wait(lock);
+			for (int i = 0; (i < PACKET_COUNT) && (freeIndex < 0); i++)
+			{
+				if (m_states[i] == PACKET_FREE)
+				{
+					freeIndex = i;
+				}
+			}
+		}
+		m_buildWaitMilliseconds += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+
+	m_states[freeIndex] = PACKET_BUILDING;
+	return(&m_packets[freeIndex]);
+}
+
+/***********************************************************
+ *  QueuePacket()
+ *
+ *  This method is used for handing a built packet to the
+ *  render thread.  The main thread must not change it until
+ *  it gets it back from AcquirePacket().
+ ***********************************************************/
+void RenderThread::QueuePacket(SceneManager::FRAME_PACKET* pPacket)
+{
+	int index = (int)(pPacket - m_packets);
+	if ((index < 0) || (index >= PACKET_COUNT))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_states[index] = PACKET_QUEUED;
+	m_queue[(m_queueHead + m_queueCount) % PACKET_COUNT] = index;
+	m_queueCount++;
+	m_packetQueued.notify_one();
+}
+
+/***********************************************************
+ *  ThreadLoop()
+ *
+ *  This method is run by the render thread.  It takes the
+ *  context, draws the packets in the order they were queued
+ *  and lets go of the context when it is stopped.
+ ***********************************************************/
+void RenderThread::ThreadLoop()
+{
+	glfwMakeContextCurrent(m_pWindow);
+	if (NULL == m_pFrameGraph)
+	{
+		SetupFrameGraph();
+	}
+
+	while (true)
+	{
+		int index = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_queueCount == 0)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				m_packetQueued.wait(lock, [this]() { return((m_queueCount > 0) || (m_bStopping == true)); });
+				m_renderWaitMilliseconds += std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - start).count();
+			}
+			if (m_queueCount == 0)
+			{
+				break;
+			}
+
+			index = m_queue[m_queueHead];
+			m_queueHead = (m_queueHead + 1) % PACKET_COUNT;
+			m_queueCount--;
+			m_states[index] = PACKET_DRAWING;
+		}
+
+		// the allocations of the render thread are handed back to
+		// the main thread with the packet, for the allocation check
+		unsigned long long allocations = AllocationCounter::GetThreadCount();
+		DrawPacket(m_packets[index]);
+		// the static objects edited with the packet are moved
+		// after its draws, also when no frame was started
+		m_pSceneManager->ApplyStaticEdits(m_packets[index]);
+		// a lightmap baked in the background since is drawn from
+		// the next packet on
+		m_pSceneManager->UpdateLightmapRebake();
+		m_packets[index].renderAllocations = AllocationCounter::GetThreadCount() - allocations;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_states[index] = PACKET_FREE;
+		m_frameCount++;
+		m_packetFreed.notify_one();
+	}
+
+	glfwMakeContextCurrent(NULL);
+}
+
+/***********************************************************
+ *  SetupFrameGraph()
+ *
+ *  This method is used for declaring the passes of a frame.
+ *  The scene is drawn into transient color and depth targets
+ *  at the window size, then upscaled into the window, the
+ *  performance overlay is drawn over it, and the shown frame
+ *  is copied for the frame capture.  The passes find the
+ *  packet they draw in m_pDrawingPacket.
+ ***********************************************************/
+void RenderThread::SetupFrameGraph()
+{
+	m_pFrameGraph = new FrameGraph();
+
+	FrameGraph::TARGET_DESC colorDesc = { 1, 1, GL_RGBA8 };
+	FrameGraph::TARGET_DESC depthDesc = { 1, 1, GL_DEPTH_COMPONENT24 };
+	m_sceneColorTarget = m_pFrameGraph->CreateTarget("SceneColor", colorDesc);
+	m_sceneDepthTarget = m_pFrameGraph->CreateTarget("SceneDepth", depthDesc);
+	int windowTarget = m_pFrameGraph->ImportTarget("Window", colorDesc, 0);
+
+	m_scenePass = m_pFrameGraph->AddPass("Scene", FrameGraph::PASS_NONE, [this]()
+	{
+		m_bFrameStarted = m_pDynamicResolution->BeginFrame();
+		if (m_bFrameStarted == true)
+		{
+			// Enable z-depth
+			glEnable(GL_DEPTH_TEST);
+
+			// Clear the frame and z buffers
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			// refresh the 3D scene
+			m_pSceneManager->RenderFrame(*m_pDrawingPacket);
+		}
+	});
+	m_pFrameGraph->WriteTarget(m_scenePass, m_sceneColorTarget);
+	m_pFrameGraph->WriteTarget(m_scenePass, m_sceneDepthTarget);
+
+	int upscalePass = m_pFrameGraph->AddPass("Upscale", FrameGraph::PASS_NONE, [this]()
+	{
+		if (m_bFrameStarted == true)
+		{
+			m_pDynamicResolution->EndFrame(m_pFrameGraph->GetFramebuffer(m_scenePass));
+		}
+	});
+	m_pFrameGraph->ReadTarget(upscalePass, m_sceneColorTarget);
+	m_pFrameGraph->WriteTarget(upscalePass, windowTarget);
+
+	// the overlay is drawn at the window resolution after the
+	// upscale, so it stays sharp and does not count toward the
+	// GPU time the resolution follows
+	if (NULL != m_pPerfHud)
+	{
+		int hudPass = m_pFrameGraph->AddPass("Hud", FrameGraph::PASS_NONE, [this]()
+		{
+			if (m_bFrameStarted == true)
+			{
+				IndirectDraws* pIndirectDraws = m_pSceneManager->GetIndirectDraws();
+				PerfHud::FRAME_STATS stats;
+				stats.gpuMilliseconds = m_pDynamicResolution->GetGPUMilliseconds();
+				stats.resolutionScale = m_pDynamicResolution->GetScale();
+				stats.drawCount = m_pDrawingPacket->draws.itemCount;
+				stats.multiDrawCount = pIndirectDraws->GetSubmitCount();
+				stats.stateChanges = pIndirectDraws->GetStateChangeCount();
+				stats.triangleCount = pIndirectDraws->GetTriangleCount();
+				stats.gpuBytes = GpuResources::GetTotalLiveBytes();
+				m_pPerfHud->Render(stats, m_pDrawingPacket->framebufferWidth, m_pDrawingPacket->framebufferHeight);
+			}
+		});
+		m_pFrameGraph->WriteTarget(hudPass, windowTarget);
+	}
+
+	// copy the shown frame for the encoder thread, without
+	// waiting for the GPU
+	if (NULL != m_pFrameCapture)
+	{
+		int capturePass = m_pFrameGraph->AddPass("Capture", FrameGraph::PASS_SIDE_EFFECT, [this]()
+		{
+			if (m_bFrameStarted == true)
+			{
+				m_pFrameCapture->CaptureFrame(m_pDrawingPacket->framebufferWidth, m_pDrawingPacket->framebufferHeight);
+			}
+		});
+		m_pFrameGraph->ReadTarget(capturePass, windowTarget);
+	}
+}
+
+/***********************************************************
+ *  DrawPacket()
+ *
+ *  This method is used for drawing a frame packet offscreen,
+ *  upscaling it into the window and showing it, by running
+ *  the passes of the frame graph.
+ ***********************************************************/
+void RenderThread::DrawPacket(SceneManager::FRAME_PACKET& packet)
+{
+	// nothing is drawn while the window is minimized
+	if ((packet.framebufferWidth <= 0) || (packet.framebufferHeight <= 0))
+	{
+		return;
+	}
+
+	// follow the size of the window's framebuffer - the graph
+	// allocates its targets again when it changed
+	m_pDynamicResolution->Resize(packet.framebufferWidth, packet.framebufferHeight);
+	FrameGraph::TARGET_DESC colorDesc = { packet.framebufferWidth, packet.framebufferHeight, GL_RGBA8 };
+	FrameGraph::TARGET_DESC depthDesc = { packet.framebufferWidth, packet.framebufferHeight, GL_DEPTH_COMPONENT24 };
+	m_pFrameGraph->SetTargetDesc(m_sceneColorTarget, colorDesc);
+	m_pFrameGraph->SetTargetDesc(m_sceneDepthTarget, depthDesc);
+
+	m_pDrawingPacket = &packet;
+	m_bFrameStarted = false;
+	m_pFrameGraph->Execute();
+	m_pDrawingPacket = NULL;
+
+	if (m_bFrameStarted == false)
+	{
+		return;
+	}
+
+	// Flips the the back buffer with the front buffer every frame.
+	glfwSwapBuffers(m_pWindow);
+
+	if (NULL != m_pInputRecorder)
+	{
+		m_pInputRecorder->EndFrameTiming(m_pDynamicResolution->GetGPUMilliseconds());
+	}
+}
+
+/***********************************************************
+ *  SetFrameCapture()
+ *
+ *  This method is used for setting the frame capture the
+ *  drawn frames are copied into.  Set it before Start().
+ ***********************************************************/
+void RenderThread::SetFrameCapture(FrameCapture* pFrameCapture)
+{
+	m_pFrameCapture = pFrameCapture;
+}
+
+/***********************************************************
+ *  SetInputRecorder()
+ *
+ *  This method is used for setting the input recorder that
+ *  times the replayed frames.  Set it before Start().
+ ***********************************************************/
+void RenderThread::SetInputRecorder(InputRecorder* pInputRecorder)
+{
+	m_pInputRecorder = pInputRecorder;
+}
+
+/***********************************************************
+ *  SetPerfHud()
+ *
+ *  This method is used for setting the performance overlay
+ *  drawn over the shown frames.  Set it before Start().
+ ***********************************************************/
+void RenderThread::SetPerfHud(PerfHud* pPerfHud)
+{
+	m_pPerfHud = pPerfHud;
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the frames drawn and
+ *  how long each thread waited for the other.  A main
+ *  thread that waits a lot is bound by the rendering, and
+ *  a render thread that waits a lot by the frame building.
+ ***********************************************************/
+void RenderThread::PrintReport()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::cout << "Render thread: " << m_frameCount << " frames drawn, main thread waited "
+		<< m_buildWaitMilliseconds << " ms for a free packet, render thread waited "
+		<< m_renderWaitMilliseconds << " ms for a queued packet" << std::endl;
+}
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderthread.h
+// ============
+// own the OpenGL context on a thread of its own that draws the frame
+// packets the main thread builds
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "InputRecorder.h"
+#include "FrameGraph.h"
+#include "PerfHud.h"
+
+#include "GLFW/glfw3.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/***********************************************************
+ *  RenderThread
+ *
+ *  This class contains the code for drawing the frames on a
+ *  thread that owns the OpenGL context, so polling events,
+ *  moving the camera and culling on the main thread overlap
+ *  with submitting the draws and waiting for the buffer swap.
+ *  The two threads share a small pool of frame packets.  The
+ *  main thread takes a free packet, builds the next frame
+ *  into it and queues it, and the render thread draws the
+ *  queued packets in order and gives them back.  With two
+ *  packets the main thread is at most one frame ahead, so
+ *  the input is never more than a frame older than what is
+ *  shown.
+ ***********************************************************/
+class RenderThread
+{
+public:
+	// constructor
+	RenderThread(GLFWwindow* pWindow, SceneManager* pSceneManager, DynamicResolution* pDynamicResolution);
+	// destructor
+	~RenderThread();
+
+	// frame packets shared by the two threads
+	static const int PACKET_COUNT = 2;
+
+private:
+	// owner of a frame packet
+	enum PACKET_STATE
+	{
+		PACKET_FREE,
+		// the main thread is building it
+		PACKET_BUILDING,
+		// waiting for the render thread
+		PACKET_QUEUED,
+		// the render thread is drawing it
+		PACKET_DRAWING
+	};
+
+	GLFWwindow* m_pWindow;
+	SceneManager* m_pSceneManager;
+	DynamicResolution* m_pDynamicResolution;
+	// optional frame capture and input replay timing, both used
+	// on the render thread only
+	FrameCapture* m_pFrameCapture;
+	InputRecorder* m_pInputRecorder;
+	// optional performance overlay, drawn on the render thread
+	PerfHud* m_pPerfHud;
+
+	SceneManager::FRAME_PACKET m_packets[PACKET_COUNT];
+	PACKET_STATE m_states[PACKET_COUNT];
+	// queued packets in the order they were built
+	int m_queue[PACKET_COUNT];
+	int m_queueHead;
+	int m_queueCount;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	// signaled when a packet is queued or the thread is stopped,
+	// and when a drawn packet is given back
+	std::condition_variable m_packetQueued;
+	std::condition_variable m_packetFreed;
+	bool m_bStopping;
+
+	// passes of a frame and the targets they share, declared
+	// once the render thread owns the context
+	FrameGraph* m_pFrameGraph;
+	int m_scenePass;
+	int m_sceneColorTarget;
+	int m_sceneDepthTarget;
+	// the packet the passes draw, and whether the scene pass
+	// started a frame
+	SceneManager::FRAME_PACKET* m_pDrawingPacket;
+	bool m_bFrameStarted;
+
+	// frames drawn, and the time each thread spent waiting for
+	// the other
+	int m_frameCount;
+	double m_buildWaitMilliseconds;
+	double m_renderWaitMilliseconds;
+
+	// draw the queued packets until stopped
+	void ThreadLoop();
+	// declare the passes of a frame
+	void SetupFrameGraph();
+	// draw one frame packet into the window
+	void DrawPacket(SceneManager::FRAME_PACKET& packet);
+
+public:
+	// hand the OpenGL context over from the calling thread and
+	// start drawing on the render thread
+	void Start();
+	// draw the packets still queued, stop the render thread and
+	// make the OpenGL context current on the calling thread again
+	void Stop();
+
+	// get a packet to build the next frame into, waiting while
+	// every packet is queued or being drawn
+	SceneManager::FRAME_PACKET* AcquirePacket();
+	// queue a built packet for drawing
+	void QueuePacket(SceneManager::FRAME_PACKET* pPacket);
+
+	// set the frame capture the drawn frames are copied into
+	void SetFrameCapture(FrameCapture* pFrameCapture);
+	// set the input recorder that times the replayed frames
+	void SetInputRecorder(InputRecorder* pInputRecorder);
+	// set the performance overlay drawn over the shown frames
+	void SetPerfHud(PerfHud* pPerfHud);
+
+	// print the frames drawn and the time the threads waited
+	void PrintReport();
+};
@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.cpp
+// ============
+// persistently mapped GPU buffer split into one region per frame in
+// flight, for streaming the per-draw data without copies
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RingBuffer.h"
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// the buffer stays mapped for writing while the GPU reads it,
+	// and the writes are seen by the GPU without flushing
+	const GLbitfield MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	// how long a fence wait blocks before it is checked again
+	const GLuint64 WAIT_TIMEOUT_NANOSECONDS = 1000000;
+}
+
+/***********************************************************
+ *  RingBuffer()
+ *
+ *  The constructor for the class.  The buffer is created by
+ *  the first frame, once the OpenGL context is current.
+ ***********************************************************/
+RingBuffer::RingBuffer(size_t regionBytes)
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_regionBytes = regionBytes;
+	m_region = 0;
+	m_usedBytes = 0;
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		m_fences[i] = 0;
+	}
+	m_frameCount = 0;
+	m_stallCount = 0;
+	m_lastWaitMilliseconds = 0.0;
+	m_totalWaitMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~RingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RingBuffer::~RingBuffer()
+{
+	DestroyBuffer();
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating the buffer with room
+ *  for every region, and mapping all of it once.
+ ***********************************************************/
+bool RingBuffer::CreateBuffer(size_t regionBytes)
+{
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, regionBytes * REGION_COUNT, NULL, MAP_FLAGS);
+	m_pMapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionBytes * REGION_COUNT, MAP_FLAGS);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (NULL == m_pMapped)
+	{
+		std::cout << "Could not map the ring buffer" << std::endl;
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+		return(false);
+	}
+
+	GpuResources::Track(GpuResources::RESOURCE_BUFFER, m_buffer, regionBytes * REGION_COUNT, "RingBuffer");
+
+	m_regionBytes = regionBytes;
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for unmapping and freeing the buffer
+ *  and its fences.  OpenGL keeps the storage alive until
+ *  the commands already reading it are done.
+ ***********************************************************/
+void RingBuffer::DestroyBuffer()
+{
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+	}
+
+	if (m_buffer != 0)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		GpuResources::Release(GpuResources::RESOURCE_BUFFER, m_buffer);
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+	m_pMapped = NULL;
+}
+
+/***********************************************************
+ *  WaitForRegion()
+ *
+ *  This method is used for waiting on the fence of a region.
+ *  A fence that has already signaled costs nothing, and any
+ *  wait that blocks is counted as a stall and timed.
+ ***********************************************************/
+void RingBuffer::WaitForRegion(int region)
+{
+	if (m_fences[region] == 0)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(m_fences[region], 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		do
+		{
+			result = glClientWaitSync(m_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NANOSECONDS);
+		} while (result == GL_TIMEOUT_EXPIRED);
+
+		m_lastWaitMilliseconds += std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - start).count();
+		m_stallCount++;
+	}
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "Waiting on a ring buffer fence failed" << std::endl;
+	}
+
+	glDeleteSync(m_fences[region]);
+	m_fences[region] = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving to the region of the
+ *  next frame.  The region was last written three frames
+ *  ago, so the wait only blocks when the GPU is that far
+ *  behind.
+ ***********************************************************/
+void RingBuffer::BeginFrame()
+{
+	if (m_buffer == 0)
+	{
+		CreateBuffer(m_regionBytes);
+	}
+
+	m_totalWaitMilliseconds += m_lastWaitMilliseconds;
+	m_lastWaitMilliseconds = 0.0;
+
+	m_region = (m_region + 1) % REGION_COUNT;
+	m_usedBytes = 0;
+	WaitForRegion(m_region);
+	m_frameCount++;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing the fence that tells
+ *  when the GPU has finished the commands of the frame.
+ ***********************************************************/
+void RingBuffer::EndFrame()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	if (m_fences[m_region] != 0)
+	{
+		glDeleteSync(m_fences[m_region]);
+	}
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making sure the passed in bytes
+ *  fit into the rest of the current region.  A frame that
+ *  needs more moves to a new buffer with twice the room,
+ *  which is reported because it should only happen while
+ *  the scene grows.
+ ***********************************************************/
+bool RingBuffer::Reserve(size_t bytes, size_t alignment)
+{
+	size_t offset = (m_usedBytes + alignment - 1) / alignment * alignment;
+	if ((m_buffer != 0) && (offset + bytes <= m_regionBytes))
+	{
+		return(true);
+	}
+
+	size_t regionBytes = std::max(bytes + alignment, m_regionBytes * 2);
+	DestroyBuffer();
+	if (CreateBuffer(regionBytes) == false)
+	{
+		return(false);
+	}
+	m_region = 0;
+	m_usedBytes = 0;
+
+	std::cout << "Ring buffer grown to " << m_regionBytes << " bytes per frame" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for getting mapped memory in the
+ *  region of the current frame.  The memory is written by
+ *  the CPU only, in order, and the returned offset is used
+ *  for binding it.
+ ***********************************************************/
+void* RingBuffer::Allocate(size_t bytes, size_t alignment, size_t& offset)
+{
+	size_t regionOffset = (m_usedBytes + alignment - 1) / alignment * alignment;
+	if ((NULL == m_pMapped) || (regionOffset + bytes > m_regionBytes))
+	{
+		return(NULL);
+	}
+
+	m_usedBytes = regionOffset + bytes;
+	offset = m_region * m_regionBytes + regionOffset;
+
+	return(m_pMapped + offset);
+}
+
+/***********************************************************
+ *  GetBuffer()
+ *
+ *  The following methods are used for getting the buffer
+ *  and the fence wait statistics.
+ ***********************************************************/
+GLuint RingBuffer::GetBuffer()
+{
+	return(m_buffer);
+}
+
+size_t RingBuffer::GetRegionBytes()
+{
+	return(m_regionBytes);
+}
+
+int RingBuffer::GetFrameCount()
+{
+	return(m_frameCount);
+}
+
+int RingBuffer::GetStallCount()
+{
+	return(m_stallCount);
+}
+
+double RingBuffer::GetLastWaitMilliseconds()
+{
+	return(m_lastWaitMilliseconds);
+}
+
+double RingBuffer::GetTotalWaitMilliseconds()
+{
+	return(m_totalWaitMilliseconds + m_lastWaitMilliseconds);
+}
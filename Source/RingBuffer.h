@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.h
+// ============
+// persistently mapped GPU buffer split into one region per frame in
+// flight, for streaming the per-draw data without copies
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+/***********************************************************
+ *  RingBuffer
+ *
+ *  This class contains the code for a GPU buffer that stays
+ *  mapped for its whole life.  It is split into three
+ *  regions, and each frame writes its data into the next
+ *  one while the GPU may still read the other two.  A fence
+ *  is placed after the last command using a region, and the
+ *  frame that comes back to the region waits on it first.
+ *  The time spent waiting is measured, so the frames where
+ *  the CPU got ahead of the GPU show up as stalls.
+ ***********************************************************/
+class RingBuffer
+{
+public:
+	// constructor
+	RingBuffer(size_t regionBytes);
+	// destructor
+	~RingBuffer();
+
+	// frames the GPU may be working on while the CPU writes
+	static const int REGION_COUNT = 3;
+
+private:
+	GLuint m_buffer;
+	// the mapped memory of every region
+	unsigned char* m_pMapped;
+	size_t m_regionBytes;
+	// region of the current frame, and the bytes used in it
+	int m_region;
+	size_t m_usedBytes;
+	// fences placed after the last commands of each region
+	GLsync m_fences[REGION_COUNT];
+
+	// frames begun, fence waits that had to block, and the
+	// time blocked in the last frame and overall
+	int m_frameCount;
+	int m_stallCount;
+	double m_lastWaitMilliseconds;
+	double m_totalWaitMilliseconds;
+
+	// create and map the buffer with the passed in region size
+	bool CreateBuffer(size_t regionBytes);
+	// unmap and free the buffer
+	void DestroyBuffer();
+	// wait until the GPU is done with a region
+	void WaitForRegion(int region);
+
+public:
+	// move to the next region, waiting until the GPU is done
+	// with it
+	void BeginFrame();
+	// place the fence after the commands using the region
+	void EndFrame();
+
+	// make sure the passed in bytes fit in the rest of the
+	// region, growing the buffer between the calls that write
+	// into it - the data written before in the frame is kept
+	// by the old buffer until the GPU is done with it
+	bool Reserve(size_t bytes, size_t alignment);
+	// get mapped memory in the region of the current frame and
+	// its offset into the buffer, or NULL when it does not fit
+	void* Allocate(size_t bytes, size_t alignment, size_t& offset);
+
+	GLuint GetBuffer();
+	size_t GetRegionBytes();
+	int GetFrameCount();
+	// fence waits that blocked since the buffer was created
+	int GetStallCount();
+	double GetLastWaitMilliseconds();
+	double GetTotalWaitMilliseconds();
+};
@@ -1,803 +1,2282 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
- /***********************************************************
-  *  DefineObjectMaterials()
-  *
-  *  This method is used for configuring the various material
-  *  settings for all of the objects within the 3D scene.
-  ***********************************************************/
-void SceneManager::DefineObjectMaterials()
-{
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
-
-	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Lighting%20to%20a%203D%20Scene.pdf?isCourseFile=true&ou=1644154
-
-	// Light Material
-	OBJECT_MATERIAL lightMaterial;
-	lightMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f); // Low ambient color
-	lightMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f); // Neutral diffuse color
-	lightMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f); // Some specular highlights
-	lightMaterial.shininess = 10.0f;
-	lightMaterial.ambientStrength = 0.1f;
-	lightMaterial.tag = "LightMaterial";
-	m_objectMaterials.push_back(lightMaterial);
-
-	// Monitor Material
-	OBJECT_MATERIAL monitorMaterial;
-	monitorMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f); // Low ambient 
-	monitorMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f); // Dark diffuse for material
-	monitorMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.9f); // High specular for screen reflections
-	monitorMaterial.shininess = 32.0f; 
-	monitorMaterial.tag = "MonitorMaterial";
-	m_objectMaterials.push_back(monitorMaterial);
-
-	// Reflective Material for Floor
-	OBJECT_MATERIAL reflectiveMaterial;
-	reflectiveMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f); // Low ambient
-	reflectiveMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f); // Neutral diffuse 
-	reflectiveMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f); // High specular reflections
-	reflectiveMaterial.shininess = 64.0f; // High shininess for reflections
-	reflectiveMaterial.ambientStrength = 0.1f;
-	reflectiveMaterial.tag = "ReflectPlane";
-	m_objectMaterials.push_back(reflectiveMaterial);
-
-	// Desk Material
-	OBJECT_MATERIAL deskMaterial;
-	deskMaterial.ambientColor = glm::vec3(0.6f, 0.3f, 0.1f); // Brown ambient color for desk
-	deskMaterial.diffuseColor = glm::vec3(0.6f, 0.3f, 0.1f); // Brown diffuse 
-	deskMaterial.specularColor = glm::vec3(0.3f, 0.2f, 0.1f); // low specular for desk
-	deskMaterial.shininess = 8.0f; 
-	deskMaterial.tag = "DeskMaterial";
-	m_objectMaterials.push_back(deskMaterial);
-
-	// Monitor Stand Material
-	OBJECT_MATERIAL standMaterial;
-	standMaterial.ambientColor = glm::vec3(0.5f, 0.5f, 0.5f); // Light gray for stand
-	standMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f); // light gray diffuse 
-	standMaterial.specularColor = glm::vec3(0.7f, 0.7f, 0.7f); // specular highlights metal stand
-	standMaterial.shininess = 16.0f; 
-	standMaterial.tag = "StandMaterial";
-	m_objectMaterials.push_back(standMaterial);
-
-	// PS5 Material
-	OBJECT_MATERIAL ps5Material;
-	ps5Material.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f); // Medium dark ambient
-	ps5Material.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f); // Light gray diffuse
-	ps5Material.specularColor = glm::vec3(0.7f, 0.7f, 0.7f); // Moderate specular 
-	ps5Material.shininess = 32.0f; // Balanced shininess 
-	ps5Material.tag = "PS5Material";
-	m_objectMaterials.push_back(ps5Material);
-
-
-	// Speaker Material
-	OBJECT_MATERIAL speakerMaterial;
-	speakerMaterial.ambientColor = glm::vec3(0.9f, 0.9f, 0.9f); // Light ambient
-	speakerMaterial.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f); // white diffuse
-	speakerMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f); // High specular f
-	speakerMaterial.shininess = 64.0f; // High shininess 
-	speakerMaterial.tag = "SpeakerMaterial";
-	m_objectMaterials.push_back(speakerMaterial);
-
-
-}
-
-
-
-/***********************************************************
- *  SetupSceneLights()
- *
- *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
- ***********************************************************/
-void SceneManager::SetupSceneLights()
-{
-	
-
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help                              ***/
-	  // This line of code is NEEDED for telling the shaders to render
-	// the 3D scene with custom lighting, if no light sources have
-	// been added then the display window will be black - to use the 
-	// default OpenGL lighting then comment out the following line
-	
-	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Lighting%20to%20a%203D%20Scene.pdf?isCourseFile=true&ou=1644154
-	// Light Source 1 Gold light covering scene 
-	m_pShaderManager->setVec3Value("lightSources[1].position", 3.0f, 10.0f, -24.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.05f, 0.05f, 0.025f); 
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.5f, 0.4f, 0.2f); 
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.5f, 0.4f, 0.2f); 
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 8.0f); 
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 1.0f);
-
-	// Light Source 2 white light from above
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0f, 20.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.05f, 0.05f, 0.05f); 
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.6f, 0.6f, 0.6f); 
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.5f, 0.5f, 0.5f); 
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 6.0f); 
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.5f);
-
-
-	// Light Source  Light on Monitor
-	m_pShaderManager->setVec3Value("lightSources[3].position", 0.0f, 2.7f, 2.0f); 
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.1f, 0.1f, 0.1f); 
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.7f, 0.7f, 0.7f); 
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.9f, 0.9f, 0.9f); 
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 2.0f); 
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 1.0f);
-
-
-
-
-	m_pShaderManager->setBoolValue("bUseLighting", true);
-
-}
-
-/***********************************************************
-  *  LoadSceneTextures()
-  *
-  *  This method is used for preparing the 3D scene by loading
-  *  the shapes, textures in memory to support the 3D scene
-  *  rendering
-  ***********************************************************/
-void SceneManager::LoadSceneTextures()
-{
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-
-
-
-	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Textures%20to%203D%20Shapes.pdf?isCourseFile=true&ou=1644154
-
-	//textures uploaded in to memory 
-	bool bReturn = false;
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/floor.jpg",
-		"floor");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/knife_handle.jpg",
-		"wood");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/stainless.jpg",
-		"stainless");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/stainless_end.jpg",
-		"stainlessend");
-
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/Galaga.jpg",
-		"game");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/Blackgloss.jpg",
-		"Blackgloss");
-
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/Whitetex.jpg",
-		"Whitetex");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/WhiteMarble.jpg",
-		"Whitemarb");
-
-
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
-	BindGLTextures();
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// define the materials for objects in the scene
-	DefineObjectMaterials();
-	// add and define the light sources for the scene
-	SetupSceneLights();
-	// load the textures for the 3D scene
-	LoadSceneTextures();
-
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	m_basicMeshes->LoadPlaneMesh();
-
-	//added box and cylinder meshes to create the monitor.
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadSphereMesh();
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// Variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-
-
-	/*** PS5 Shapes ************************************************/
-	/******************************************************************/
-
-	// PS5 Body
-	SetShaderMaterial("PS5Material");//Shader material set for ps5
-	scaleXYZ = glm::vec3(0.3f, 1.5f, 0.6f); 
-	positionXYZ = glm::vec3(-2.0f, 2.25f, 0.25f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Blackgloss");
-	m_basicMeshes->DrawBoxMesh(); 
-
-	// PS5 left Panel
-	SetShaderMaterial("PS5Material");
-	scaleXYZ = glm::vec3(0.03f, 1.7f, 0.7f); 
-	positionXYZ = glm::vec3(-2.15f, 2.26f, 0.25f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Whitetex"); 
-	m_basicMeshes->DrawBoxMesh();
-
-	// PS5 right Panel 
-	SetShaderMaterial("PS5Material");
-	scaleXYZ = glm::vec3(0.03f, 1.7f, 0.7f); 
-	positionXYZ = glm::vec3(-1.85f, 2.26f, 0.25f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Whitetex");
-	m_basicMeshes->DrawBoxMesh(); 
-
-	// PS5 Stand 
-	SetShaderMaterial("PS5Material");
-	scaleXYZ = glm::vec3(0.3f, 0.05f, 0.3f); 
-	positionXYZ = glm::vec3(-2.0f, 1.6f, 0.25f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Blackgloss");
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	
-
-
-
-
-	/*** Monitor Shapes ************************************************/
-	/******************************************************************/
-
-	// Monitor Bezel
-	SetShaderMaterial("MonitorMaterial"); // Shader material set for monitor 
-	scaleXYZ = glm::vec3(3.0f, 1.8f, 0.1f);
-	positionXYZ = glm::vec3(0.0f, 2.7f, 0.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//Texture overlap for monitor bezel
-	SetShaderTexture("stainless");
-	SetShaderTexture("stainlessend");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Monitor screen using box shape
-	SetShaderMaterial("MonitorMaterial"); 
-	scaleXYZ = glm::vec3(2.8f, 1.6f, 0.1f);
-	positionXYZ = glm::vec3(0.0f, 2.7f, 0.05f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//image of Galaga for the monitor screen.
-	SetShaderTexture("game");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Stand base using box shape
-	SetShaderMaterial("StandMaterial");//Shader material for stand
-	scaleXYZ = glm::vec3(1.0f, 0.1f, 0.5f);
-	positionXYZ = glm::vec3(0.0f, 1.6f, -0.14f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("stainless");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Stand support using cylinder shape
-	SetShaderMaterial("StandMaterial");
-	scaleXYZ = glm::vec3(0.1f, 0.9f, 0.1f); 
-	positionXYZ = glm::vec3(0.0f, 1.6f, -0.14f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("stainless");
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/*** White Speaker Shape *****************************************/
-   /******************************************************************/
-
-   // Speaker Base 
-	SetShaderMaterial("SpeakerMaterial");//Shader material for Speaker
-	scaleXYZ = glm::vec3(0.2f, 0.05f, 0.2f); 
-	positionXYZ = glm::vec3(-1.3f, 1.63f, 0.3f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Whitemarb");
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Speaker Top
-	SetShaderMaterial("SpeakerMaterial");
-	scaleXYZ = glm::vec3(0.2f, 0.15f, 0.2f);
-	positionXYZ = glm::vec3(-1.3f, 1.73f, 0.3f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderTexture("Whitemarb");
-	m_basicMeshes->DrawSphereMesh();
-
-
-	/*** Desk Shapes ************************************************/
-	/******************************************************************/
-
-	// Desk top using box shape
-	SetShaderMaterial("DeskMaterial");//Shader material set for desk objects
-	scaleXYZ = glm::vec3(6.0f, 0.2f, 2.5f); 
-	positionXYZ = glm::vec3(0.0f, 1.5f, 0.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	// Texture set for plank
-	SetShaderTexture("wood");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Desk legs using box shape
-	SetShaderMaterial("DeskMaterial");
-	scaleXYZ = glm::vec3(0.2f, 1.5f, 0.2f); 
-	// Front left leg
-	positionXYZ = glm::vec3(-2.8f, 0.75f, 1.2f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	// Texture set desk legs 
-	SetShaderTexture("wood");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Front right leg
-	SetShaderMaterial("DeskMaterial");
-	positionXYZ = glm::vec3(2.8f, 0.75f, 1.2f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	// Texture set for right leg
-	SetShaderTexture("wood");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Back left leg
-	SetShaderMaterial("DeskMaterial");
-	positionXYZ = glm::vec3(-2.8f, 0.75f, -1.2f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	// Texture set for back left leg
-	SetShaderTexture("wood");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Back right leg
-	SetShaderMaterial("DeskMaterial");
-	positionXYZ = glm::vec3(2.8f, 0.75f, -1.2f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	// Texture set forback right leg
-	SetShaderTexture("wood");
-	m_basicMeshes->DrawBoxMesh();
-
-
-	
-
-	
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1, 1, 1, 1);
-	SetShaderTexture("floor");
-	SetShaderMaterial("ReflectPlane");//Set shader to reflect light off plane. 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
-}
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "SceneTables.h"
+#include "TransformBatch.h"
+#include "GpuResources.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// store the mesh vertices quantized to half their size
+	const bool g_bCompactVertices = true;
+	// draw the opaque depth before shading the opaque objects
+	const bool g_bDepthPrepass = false;
+	// skip the static objects outside of the view or hidden
+	// behind large occluders
+	const bool g_bOcclusionCulling = true;
+	// size of the CPU depth buffer for the occluders
+	const int OCCLUSION_BUFFER_WIDTH = 200;
+	const int OCCLUSION_BUFFER_HEIGHT = 160;
+	// static objects with a bounding box diagonal of at least
+	// this size are drawn into the occlusion depth buffer
+	const float OCCLUDER_MIN_SIZE = 1.5f;
+	// bake the diffuse lighting of the opaque static objects
+	// into a lightmap instead of lighting them per fragment
+	const bool g_bBakeLightmaps = true;
+	// file the baked lightmap is cached in between runs
+	const char* const LIGHTMAP_CACHE_PATH = "lightmap.cache";
+	// cores left to the main and render threads while the
+	// lightmap is baked again in the background
+	const int REBAKE_SPARE_CORES = 2;
+	// the objects the edit key slides, by their material, and
+	// how far they slide along the desk
+	const int EDITABLE_MATERIAL = SceneTables::FindMaterial("SpeakerMaterial");
+	const glm::vec3 EDITABLE_OBJECT_SLIDE = glm::vec3(0.6f, 0.0f, 0.0f);
+	// names of the basic shapes in the startup trace
+	const char* const g_ShapeNames[SHAPE_MESH_COUNT] = { "box", "plane", "cylinder", "sphere" };
+	// tag of the mesh imported with SetImportedMesh(), and the
+	// size and place it is fit into on the empty end of the desk
+	const char* const IMPORTED_MESH_TAG = "imported";
+	const float IMPORTED_MESH_SIZE = 1.0f;
+	const glm::vec3 IMPORTED_MESH_POSITION = glm::vec3(1.9f, 1.6f, 0.4f);
+	// frames built per second of the stress scene's animation
+	const float STRESS_FRAMES_PER_SECOND = 60.0f;
+	// frames between the printed debug counters, which are only
+	// printed with the debug counters on
+	const int DEBUG_REPORT_FRAMES = 300;
+	// names of the per view uniforms, built once instead of
+	// every frame
+	const char* g_ViewProjectionNames[ShaderVariants::MAX_VIEWS] =
+		{ "viewProjections[0]", "viewProjections[1]", "viewProjections[2]", "viewProjections[3]" };
+	const char* g_ViewRectNames[ShaderVariants::MAX_VIEWS] =
+		{ "viewRects[0]", "viewRects[1]", "viewRects[2]", "viewRects[3]" };
+	const char* g_ViewPositionNames[ShaderVariants::MAX_VIEWS] =
+		{ "viewPositions[0]", "viewPositions[1]", "viewPositions[2]", "viewPositions[3]" };
+
+	// the scene textures must fit the texture slots of the
+	// shaders, and the lightmap is bound to the unit after them
+	static_assert(SceneTables::TEXTURE_COUNT <= ShaderVariants::MAX_TEXTURE_SLOTS, "the scene has more textures than texture slots");
+	static_assert(ShaderVariants::MAX_TEXTURE_SLOTS == Lightmapper::LIGHTMAP_TEXTURE_UNIT, "the lightmap must follow the texture slots");
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderVariants *pShaderVariants)
+{
+	m_pShaderVariants = pShaderVariants;
+	m_pMeshBuffer = new MeshBuffer(g_bCompactVertices);
+	m_pFrameArena = NULL;
+	m_pIndirectDraws = new IndirectDraws(m_pMeshBuffer, m_pShaderVariants);
+	m_pIndirectDraws->SetDepthPrepass(g_bDepthPrepass);
+	m_bDebugCounters = false;
+	m_viewCount = 1;
+	for (int i = 0; i < ShaderVariants::MAX_VIEWS; i++)
+	{
+		m_viewProjections[i] = glm::mat4(1.0f);
+		m_viewRects[i] = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+		m_viewPositions[i] = glm::vec3(0.0f);
+	}
+	m_viewPosition = glm::vec3(0.0f);
+	m_frameCount = 0;
+	m_loadedTextures = 0;
+	for (int i = 0; i < ShaderVariants::MAX_TEXTURE_SLOTS; i++)
+	{
+		m_sceneTextureSlots[i] = -1;
+		m_sceneImages[i].pPixels = NULL;
+		m_sceneImages[i].width = 0;
+		m_sceneImages[i].height = 0;
+		m_sceneImages[i].colorChannels = 0;
+	}
+	m_bUseLighting = false;
+	m_lightCount = 0;
+
+	// default shader values for the draw commands
+	m_drawState.model = glm::mat4(1.0f);
+	m_drawState.scaleXYZ = glm::vec3(1.0f);
+	m_drawState.rotationDegrees = glm::vec3(0.0f);
+	m_drawState.positionXYZ = glm::vec3(0.0f);
+	m_drawState.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	m_drawState.uvScale = glm::vec2(1.0f, 1.0f);
+	m_drawState.bUseTexture = false;
+	m_drawState.textureSlot = 0;
+	m_drawState.materialIndex = -1;
+	m_drawState.lightmapFirst = -1;
+	m_defaultMaterial.ambientStrength = 0.0f;
+	m_defaultMaterial.ambientColor = glm::vec3(0.0f);
+	m_defaultMaterial.diffuseColor = glm::vec3(1.0f);
+	m_defaultMaterial.specularColor = glm::vec3(0.0f);
+	m_defaultMaterial.shininess = 1.0f;
+
+	for (int i = 0; i < SHAPE_MESH_COUNT; i++)
+	{
+		m_shapeMeshIDs[i] = -1;
+	}
+
+	m_pEntityStore = new EntityStore();
+	m_pStaticBatches = new StaticBatches(m_pMeshBuffer);
+	m_pOcclusionCuller = new OcclusionCuller(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+	m_pVisibleObjects = NULL;
+	m_bRecordStatic = false;
+	m_bBatchStatic = true;
+	m_pStressScene = NULL;
+	m_pAssetPack = NULL;
+	m_placementOffset = glm::vec3(0.0f);
+	m_builtFrames = 0;
+	m_queuedEditPackets = 0;
+	m_appliedEditPackets = 0;
+	m_pLightmapper = new Lightmapper();
+	m_pRebakeLightmapper = new Lightmapper();
+	m_bRebaking = false;
+	m_bRebakeQueued = false;
+	m_bEditableObjectsMoved = false;
+	m_renderBackend = BACKEND_OPENGL;
+	m_pSoftwareRasterizer = NULL;
+	m_softwareTexture = 0;
+	m_softwareFramebuffer = 0;
+	m_softwareTextureWidth = 0;
+	m_softwareTextureHeight = 0;
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	m_pShaderVariants = NULL;
+	DestroyGLTextures();
+	DestroySoftwareTarget();
+	delete m_pSoftwareRasterizer;
+	m_pSoftwareRasterizer = NULL;
+	// images decoded by a startup that failed before uploading
+	for (int i = 0; i < ShaderVariants::MAX_TEXTURE_SLOTS; i++)
+	{
+		if (NULL != m_sceneImages[i].pPixels)
+		{
+			stbi_image_free(m_sceneImages[i].pPixels);
+			m_sceneImages[i].pPixels = NULL;
+		}
+	}
+	// the batches release their ranges of the mesh buffer
+	delete m_pStaticBatches;
+	m_pStaticBatches = NULL;
+	delete m_pLightmapper;
+	m_pLightmapper = NULL;
+	// waits for a bake still running in the background
+	delete m_pRebakeLightmapper;
+	m_pRebakeLightmapper = NULL;
+	delete m_pEntityStore;
+	m_pEntityStore = NULL;
+	delete m_pStressScene;
+	m_pStressScene = NULL;
+	delete m_pOcclusionCuller;
+	m_pOcclusionCuller = NULL;
+	delete m_pIndirectDraws;
+	m_pIndirectDraws = NULL;
+	m_pVisibleObjects = NULL;
+	m_pFrameArena = NULL;
+	delete m_pMeshBuffer;
+	m_pMeshBuffer = NULL;
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	TEXTURE_IMAGE image;
+	DecodeImage(filename, image);
+
+	return(UploadGLTexture(filename, tag, image));
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for parsing an image in place from
+ *  the asset pack, or from the specified image file.  The
+ *  image is flipped as set by the last call to
+ *  stbi_set_flip_vertically_on_load(), which must not be
+ *  called while other images are being decoded.
+ ***********************************************************/
+bool SceneManager::DecodeImage(const char* filename, TEXTURE_IMAGE& image)
+{
+	image.pPixels = NULL;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+
+	const unsigned char* pPacked = NULL;
+	size_t packedSize = 0;
+	if ((NULL != m_pAssetPack) && (m_pAssetPack->Find(filename, &pPacked, &packedSize) == true))
+	{
+		image.pPixels = stbi_load_from_memory(
+			pPacked,
+			(int)packedSize,
+			&image.width,
+			&image.height,
+			&image.colorChannels,
+			0);
+	}
+	else
+	{
+		image.pPixels = stbi_load(
+			filename,
+			&image.width,
+			&image.height,
+			&image.colorChannels,
+			0);
+	}
+
+	return(NULL != image.pPixels);
+}
+
+/***********************************************************
+ *  UploadGLTexture()
+ *
+ *  This method is used for copying a decoded image into a
+ *  new OpenGL texture in the next available texture slot.
+ *  The decoded pixels are freed, whether or not the upload
+ *  succeeded.
+ ***********************************************************/
+bool SceneManager::UploadGLTexture(const char* filename, std::string tag, TEXTURE_IMAGE& image)
+{
+	int width = image.width;
+	int height = image.height;
+	int colorChannels = image.colorChannels;
+	GLuint textureID = 0;
+
+	// every texture slot is already used
+	if (m_loadedTextures >= (int)(sizeof(m_textureIDs) / sizeof(m_textureIDs[0])))
+	{
+		std::cout << "No free texture slot for image:" << filename << std::endl;
+		if (NULL != image.pPixels)
+		{
+			stbi_image_free(image.pPixels);
+			image.pPixels = NULL;
+		}
+		return false;
+	}
+
+	// if the image was successfully read from the image file
+	if (image.pPixels)
+	{
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+		glGenTextures(1, &textureID);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// images with an alpha channel are only drawn as transparent
+		// when some texel is actually not opaque
+		bool bHasAlpha = false;
+		if (colorChannels == 4)
+		{
+			for (int i = 3; (i < width * height * 4) && (bHasAlpha == false); i += 4)
+			{
+				bHasAlpha = (image.pPixels[i] < 255);
+			}
+		}
+
+		// if the loaded image is in RGB format
+		if (colorChannels == 3)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pPixels);
+		// if the loaded image is in RGBA format - it supports transparency
+		else if (colorChannels == 4)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pPixels);
+		else
+		{
+			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			stbi_image_free(image.pPixels);
+			image.pPixels = NULL;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glDeleteTextures(1, &textureID);
+			return false;
+		}
+
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// the software rasterizer keeps its own copy in the same slot
+		if (NULL != m_pSoftwareRasterizer)
+		{
+			m_pSoftwareRasterizer->SetTexture(m_loadedTextures, image.pPixels, width, height, colorChannels);
+		}
+
+		// free the image data from local memory
+		stbi_image_free(image.pPixels);
+		image.pPixels = NULL;
+		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+		// RGB textures are padded to four bytes per texel
+		GpuResources::Track(GpuResources::RESOURCE_TEXTURE, textureID,
+			GpuResources::GetTextureBytes(width, height, 4, true), "SceneManager textures");
+
+		// register the loaded texture and associate it with the special tag string
+		m_textureIDs[m_loadedTextures].ID = textureID;
+		m_textureIDs[m_loadedTextures].tag = tag;
+		m_textureIDs[m_loadedTextures].bHasAlpha = bHasAlpha;
+		m_loadedTextures++;
+
+		return true;
+	}
+
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+/***********************************************************
+ *  SetAssetPack()
+ *
+ *  This method is used for setting the asset pack the
+ *  textures and imported meshes are read from.  Files the
+ *  pack does not hold are still loaded from disk.
+ ***********************************************************/
+void SceneManager::SetAssetPack(AssetPack* pAssetPack)
+{
+	m_pAssetPack = pAssetPack;
+}
+
+/***********************************************************
+ *  SetRenderBackend()
+ *
+ *  This method is used for choosing whether OpenGL or the
+ *  software rasterizer draws the scene.  The software
+ *  rasterizer needs a copy of the meshes, textures and
+ *  lightmap in memory, so it is set before the scene is
+ *  prepared.
+ ***********************************************************/
+void SceneManager::SetRenderBackend(RENDER_BACKEND backend, int threadCount)
+{
+	delete m_pSoftwareRasterizer;
+	m_pSoftwareRasterizer = NULL;
+
+	m_renderBackend = backend;
+	if (backend == BACKEND_SOFTWARE)
+	{
+		m_pMeshBuffer->SetCpuCopy(true);
+		m_pLightmapper->SetKeepTexels(true);
+		m_pRebakeLightmapper->SetKeepTexels(true);
+		m_pSoftwareRasterizer = new SoftwareRasterizer(m_pMeshBuffer, threadCount);
+	}
+	else
+	{
+		m_pMeshBuffer->SetCpuCopy(false);
+		m_pLightmapper->SetKeepTexels(false);
+		m_pRebakeLightmapper->SetKeepTexels(false);
+	}
+}
+
+/***********************************************************
+ *  SetDebugCounters()
+ *
+ *  This method is used for turning on the counters that
+ *  cost time every frame, like the samples shaded per pixel,
+ *  which are read with an occlusion query, and the report
+ *  of the render counters printed every few hundred frames.
+ *  They are off in normal runs.
+ ***********************************************************/
+void SceneManager::SetDebugCounters(bool bDebugCounters)
+{
+	m_bDebugCounters = bDebugCounters;
+	m_pIndirectDraws->SetOverdrawCounter(bDebugCounters);
+}
+
+/***********************************************************
+ *  GetAssetFiles()
+ *
+ *  This method is used for adding the files the scene loads
+ *  to the passed in list, for building the asset pack.
+ ***********************************************************/
+void SceneManager::GetAssetFiles(std::vector<std::string>& assetFiles)
+{
+	for (int i = 0; i < SceneTables::TEXTURE_COUNT; i++)
+	{
+		assetFiles.push_back(SceneTables::TEXTURES[i].filename);
+	}
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to
+ *  ShaderVariants::MAX_TEXTURE_SLOTS slots.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_TEXTURE, m_textureIDs[i].ID);
+		glDeleteTextures(1, &m_textureIDs[i].ID);
+		m_textureIDs[i].ID = 0;
+	}
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(const char* tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const char* tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ *  The material is not copied, and NULL is returned when no
+ *  material has the tag.
+ ***********************************************************/
+const SceneManager::OBJECT_MATERIAL* SceneManager::FindMaterial(const char* tag)
+{
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
+	{
+		return(NULL);
+	}
+
+	return(&m_objectMaterials[index]);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material
+ *  in the previously defined materials list that is
+ *  associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const char* tag)
+{
+	int materialIndex = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			materialIndex = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(materialIndex);
+}
+
+/***********************************************************
+ *  GetDrawMaterial()
+ *
+ *  This method is used for getting the material of the
+ *  current draw state, or the default material when none
+ *  was set.
+ ***********************************************************/
+const SceneManager::OBJECT_MATERIAL& SceneManager::GetDrawMaterial()
+{
+	if ((m_drawState.materialIndex < 0) || (m_drawState.materialIndex >= m_objectMaterials.size()))
+	{
+		return(m_defaultMaterial);
+	}
+
+	return(m_objectMaterials[m_drawState.materialIndex]);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.  The offset
+ *  of the stress scene desk being placed is added to the
+ *  position.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	positionXYZ += m_placementOffset;
+
+	m_drawState.scaleXYZ = scaleXYZ;
+	m_drawState.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	m_drawState.positionXYZ = positionXYZ;
+
+	// the model matrix is written in closed form instead of
+	// multiplying the scale, rotation and translation matrices
+	m_drawState.model = TransformBatch::ComposeTransform(
+		scaleXYZ,
+		m_drawState.rotationDegrees,
+		positionXYZ);
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	m_drawState.bUseTexture = false;
+	m_drawState.color = currentColor;
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const char* textureTag)
+{
+	int textureID = -1;
+	textureID = FindTextureSlot(textureTag);
+	if ((m_bRecordStatic == true) && (NULL != m_pStressScene))
+	{
+		textureID = m_pStressScene->PickTexture(textureID, m_loadedTextures);
+	}
+
+	m_drawState.bUseTexture = true;
+	m_drawState.textureSlot = textureID;
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_drawState.uvScale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const char* materialTag)
+{
+	// the draw state only holds the index, so the material
+	// is looked up once and never copied
+	int materialIndex = FindMaterialIndex(materialTag);
+	if ((m_bRecordStatic == true) && (NULL != m_pStressScene))
+	{
+		materialIndex = m_pStressScene->PickMaterial(materialIndex, (int)m_objectMaterials.size());
+	}
+	if (materialIndex >= 0)
+	{
+		m_drawState.materialIndex = materialIndex;
+	}
+}
+
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method is used for passing the values of a light
+ *  source into the shaders.  The position, ambient and
+ *  diffuse colors are also kept for baking the lightmap.
+ ***********************************************************/
+void SceneManager::SetLightSource(
+	int index,
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity)
+{
+	if (index < 0)
+	{
+		return;
+	}
+
+	std::string prefix = "lightSources[" + std::to_string(index) + "].";
+	m_pShaderVariants->SetSharedVec3Value((prefix + "position").c_str(), position);
+	m_pShaderVariants->SetSharedVec3Value((prefix + "ambientColor").c_str(), ambientColor);
+	m_pShaderVariants->SetSharedVec3Value((prefix + "diffuseColor").c_str(), diffuseColor);
+	m_pShaderVariants->SetSharedVec3Value((prefix + "specularColor").c_str(), specularColor);
+	m_pShaderVariants->SetSharedFloatValue((prefix + "focalStrength").c_str(), focalStrength);
+	m_pShaderVariants->SetSharedFloatValue((prefix + "specularIntensity").c_str(), specularIntensity);
+
+	if (index >= m_bakeLights.size())
+	{
+		m_bakeLights.resize(index + 1);
+	}
+	m_bakeLights[index].position = position;
+	m_bakeLights[index].ambientColor = ambientColor;
+	m_bakeLights[index].diffuseColor = diffuseColor;
+
+	if (NULL != m_pSoftwareRasterizer)
+	{
+		SoftwareRasterizer::LIGHT_SOURCE light;
+		light.position = position;
+		light.ambientColor = ambientColor;
+		light.diffuseColor = diffuseColor;
+		light.specularColor = specularColor;
+		light.focalStrength = focalStrength;
+		light.specularIntensity = specularIntensity;
+		m_pSoftwareRasterizer->SetLight(index, light);
+	}
+}
+
+/***********************************************************
+ *  LoadShapeMesh()
+ *
+ *  This method is used for copying the geometry of a basic
+ *  shape into the shared mesh buffer.  Each shape is only
+ *  loaded once, no matter how many times it is drawn.
+ ***********************************************************/
+void SceneManager::LoadShapeMesh(SHAPE_MESH mesh)
+{
+	if (m_shapeMeshIDs[mesh] < 0)
+	{
+		m_shapeMeshIDs[mesh] = m_pMeshBuffer->AddMesh(ShapeGeometry::GetShape(mesh));
+	}
+}
+
+/***********************************************************
+ *  DecodeImportedMesh()
+ *
+ *  This method is used for importing the mesh of the model
+ *  file set with SetImportedMesh() into memory, ahead of its
+ *  upload.  The importer prints its timing and the size of
+ *  the mesh.  No OpenGL is called, so the file is parsed on
+ *  a worker thread while the textures are decoded.
+ ***********************************************************/
+bool SceneManager::DecodeImportedMesh()
+{
+	MeshImporter importer;
+
+	importer.SetAssetPack(m_pAssetPack);
+	return(importer.ImportMesh(m_importFilename.c_str(), m_importedMeshData));
+}
+
+/***********************************************************
+ *  UploadImportedMesh()
+ *
+ *  This method is used for copying the imported mesh into
+ *  the shared mesh buffer.  The mesh is drawn by its tag
+ *  with DrawImportedMesh().
+ ***********************************************************/
+bool SceneManager::UploadImportedMesh(std::string tag)
+{
+	if (m_importedMeshData.indices.size() == 0)
+	{
+		return(false);
+	}
+
+	IMPORTED_MESH imported;
+	imported.tag = tag;
+	imported.meshID = m_pMeshBuffer->AddMesh(m_importedMeshData);
+
+	// the mesh buffer keeps its own copy
+	m_importedMeshData = MESH_DATA();
+
+	if (imported.meshID < 0)
+	{
+		return(false);
+	}
+	m_importedMeshes.push_back(imported);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawImportedMesh()
+ *
+ *  This method is used for drawing an imported mesh with
+ *  the current draw state.
+ ***********************************************************/
+void SceneManager::DrawImportedMesh(const char* tag)
+{
+	for (int i = 0; i < m_importedMeshes.size(); i++)
+	{
+		if (m_importedMeshes[i].tag.compare(tag) == 0)
+		{
+			if (m_bRecordStatic == true)
+			{
+				// imported meshes are not batched, so they are
+				// recorded as entities drawn each frame
+				AddDrawEntity(m_importedMeshes[i].meshID, EntityStore::ENTITY_NONE);
+				return;
+			}
+
+			AddMeshDraw(m_importedMeshes[i].meshID);
+			return;
+		}
+	}
+}
+
+/***********************************************************
+ *  PlaceImportedMesh()
+ *
+ *  This method is used for placing the imported mesh on the
+ *  empty end of the desk.  Model files come in any size and
+ *  origin, so the mesh is scaled until its longest side
+ *  fits and its base is centered on the spot.  It is drawn
+ *  with the default material, as an entity of its own.
+ ***********************************************************/
+void SceneManager::PlaceImportedMesh()
+{
+	for (int i = 0; i < m_importedMeshes.size(); i++)
+	{
+		if (m_importedMeshes[i].tag.compare(IMPORTED_MESH_TAG) != 0)
+		{
+			continue;
+		}
+
+		const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(m_importedMeshes[i].meshID);
+		glm::vec3 extent = range.localMax - range.localMin;
+		float longest = std::max(extent.x, std::max(extent.y, extent.z));
+		float scale = (longest > 0.0f) ? IMPORTED_MESH_SIZE / longest : 1.0f;
+		glm::vec3 base = glm::vec3(
+			(range.localMin.x + range.localMax.x) * 0.5f,
+			range.localMin.y,
+			(range.localMin.z + range.localMax.z) * 0.5f);
+
+		SetTransformations(glm::vec3(scale), 0.0f, 0.0f, 0.0f, IMPORTED_MESH_POSITION - base * scale);
+		m_drawState.materialIndex = -1;
+		m_drawState.bUseTexture = false;
+		m_drawState.textureSlot = 0;
+		m_drawState.color = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f);
+		m_drawState.uvScale = glm::vec2(1.0f, 1.0f);
+
+		DrawImportedMesh(IMPORTED_MESH_TAG);
+		return;
+	}
+}
+
+/***********************************************************
+ *  AddMeshDraw()
+ *
+ *  This method is used for adding a draw of a mesh to the
+ *  frame's indirect draws.  The shader variant is chosen
+ *  from the texture and lighting state, and the held draw
+ *  state becomes the draw's record in the shaders.  Draws
+ *  with a translucent color or texture are transparent.
+ ***********************************************************/
+void SceneManager::AddMeshDraw(int meshID)
+{
+	if (meshID < 0)
+	{
+		return;
+	}
+
+	const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(meshID);
+	AddMeshDraw(meshID, 0, range.indexCount, glm::vec3(m_drawState.model * glm::vec4(range.center, 1.0f)));
+}
+
+/***********************************************************
+ *  AddMeshDraw()
+ *
+ *  This method is used for adding a draw of part of the
+ *  indices of a mesh with the current draw state, centered
+ *  on the passed in world space position.
+ ***********************************************************/
+void SceneManager::AddMeshDraw(int meshID, unsigned int firstIndex, unsigned int indexCount, glm::vec3 center)
+{
+	if ((meshID < 0) || (indexCount == 0))
+	{
+		return;
+	}
+
+	unsigned int flags = ShaderVariants::VARIANT_NONE;
+	if (m_drawState.bUseTexture == true)
+	{
+		flags |= ShaderVariants::VARIANT_TEXTURE;
+	}
+	// the baked lightmap replaces the light model
+	if (m_drawState.lightmapFirst >= 0)
+	{
+		flags |= ShaderVariants::VARIANT_LIGHTMAP;
+	}
+	else if (m_bUseLighting == true)
+	{
+		flags |= ShaderVariants::VARIANT_LIGHTING;
+	}
+
+	const OBJECT_MATERIAL& material = GetDrawMaterial();
+	IndirectDraws::DRAW_RECORD record;
+	record.model = m_drawState.model;
+	record.color = m_drawState.color;
+	record.ambientColor = glm::vec4(material.ambientColor, material.ambientStrength);
+	record.diffuseColor = glm::vec4(material.diffuseColor, material.shininess);
+	record.specularColor = glm::vec4(material.specularColor, 0.0f);
+	record.uvScale = m_drawState.uvScale;
+	record.textureSlot = m_drawState.textureSlot;
+	record.lightmapFirst = m_drawState.lightmapFirst;
+
+	bool bTransparent = false;
+	if (m_drawState.bUseTexture == true)
+	{
+		bTransparent = m_textureIDs[m_drawState.textureSlot].bHasAlpha;
+	}
+	else
+	{
+		bTransparent = (m_drawState.color.a < 1.0f);
+	}
+
+	m_pIndirectDraws->AddDrawRange(meshID, firstIndex, indexCount, center, flags, record, bTransparent);
+}
+
+/***********************************************************
+ *  DrawShapeMesh()
+ *
+ *  This method is used for drawing a basic shape mesh with
+ *  the current draw state.  While the static objects are
+ *  being recorded, the shape is added to the entity store
+ *  as a static entity instead of being drawn - or as an
+ *  entity drawn each frame, when the stress scene picks it
+ *  to move or leaves its desk out of the batches.
+ ***********************************************************/
+void SceneManager::DrawShapeMesh(SHAPE_MESH mesh)
+{
+	if (m_bRecordStatic == true)
+	{
+		if ((NULL != m_pStressScene) && (m_pStressScene->PickMoving() == true))
+		{
+			EntityStore::ENTITY_ID entity = AddDrawEntity(m_shapeMeshIDs[mesh], EntityStore::ENTITY_NONE);
+			m_pStressScene->AddMovingObject(entity, m_drawState.scaleXYZ, m_drawState.rotationDegrees, m_drawState.positionXYZ);
+			return;
+		}
+
+		AddDrawEntity(m_shapeMeshIDs[mesh], (m_bBatchStatic == true) ? EntityStore::ENTITY_STATIC : EntityStore::ENTITY_NONE);
+		return;
+	}
+
+	AddMeshDraw(m_shapeMeshIDs[mesh]);
+}
+
+/***********************************************************
+ *  AddDrawEntity()
+ *
+ *  This method is used for adding an entity that draws the
+ *  passed in mesh with the transform, material, texture and
+ *  color of the current draw state.
+ ***********************************************************/
+EntityStore::ENTITY_ID SceneManager::AddDrawEntity(int meshID, unsigned int flags)
+{
+	if (meshID < 0)
+	{
+		return(EntityStore::INVALID_ENTITY);
+	}
+
+	const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(meshID);
+	EntityStore::ENTITY_ID entity = m_pEntityStore->AddEntity(
+		meshID, range.localMin, range.localMax, flags);
+
+	m_pEntityStore->SetTransform(entity, m_drawState.scaleXYZ, m_drawState.rotationDegrees, m_drawState.positionXYZ);
+	m_pEntityStore->SetMaterial(entity, m_drawState.materialIndex);
+	m_pEntityStore->SetTexture(entity, (m_drawState.bUseTexture == true) ? m_drawState.textureSlot : -1, m_drawState.uvScale);
+	m_pEntityStore->SetColor(entity, m_drawState.color);
+
+	return(entity);
+}
+
+/***********************************************************
+ *  FindShapeMesh()
+ *
+ *  This method is used for finding the basic shape a mesh
+ *  was loaded from.
+ ***********************************************************/
+SHAPE_MESH SceneManager::FindShapeMesh(int meshID)
+{
+	for (int i = 0; i < SHAPE_MESH_COUNT; i++)
+	{
+		if ((meshID >= 0) && (m_shapeMeshIDs[i] == meshID))
+		{
+			return((SHAPE_MESH)i);
+		}
+	}
+
+	return(SHAPE_MESH_COUNT);
+}
+
+/***********************************************************
+ *  BuildStaticBatches()
+ *
+ *  This method is used for recording the static objects
+ *  into the entity store, then walking the entities and
+ *  baking the static shapes into the batches.  Each batched
+ *  entity is linked to its batch object.  A stress scene
+ *  places the objects once for every desk of its grid, but
+ *  only bakes the desk where the one desk stands - the
+ *  others share the shape meshes, each object drawn with
+ *  its own transform, so a desk costs its entities instead
+ *  of thousands of baked vertices.
+ ***********************************************************/
+void SceneManager::BuildStaticBatches()
+{
+	m_bRecordStatic = true;
+	// the imported model sits on the first desk only
+	PlaceImportedMesh();
+	int firstEntity = m_pEntityStore->GetCount();
+	if (NULL == m_pStressScene)
+	{
+		PlaceStaticObjects();
+		FindEditableObjects(firstEntity);
+	}
+	else
+	{
+		// the entities placed before the desks, then each desk,
+		// are culled as one group
+		AddEntityGroup(0);
+
+		int deskCount = m_pStressScene->GetDeskCount();
+		int centerDesk = m_pStressScene->GetCenterDesk();
+		for (int desk = 0; desk < deskCount; desk++)
+		{
+			m_pStressScene->BeginDesk(desk);
+			m_placementOffset = m_pStressScene->GetDeskOffset();
+			m_bBatchStatic = (desk == centerDesk);
+			int firstDeskEntity = m_pEntityStore->GetCount();
+			PlaceStaticObjects();
+			AddEntityGroup(firstDeskEntity);
+
+			if (desk == centerDesk)
+			{
+				FindEditableObjects(firstDeskEntity);
+			}
+			// every desk places as many entities as the first
+			if (desk == 0)
+			{
+				m_pEntityStore->Reserve(m_pEntityStore->GetCount() * deskCount);
+				m_entityGroups.reserve(deskCount + 1);
+			}
+		}
+		m_placementOffset = glm::vec3(0.0f);
+		m_bBatchStatic = true;
+		m_pStressScene->PrintReport();
+	}
+	m_bRecordStatic = false;
+
+	m_pEntityStore->UpdateWorld();
+	UpdateEntityGroupBounds();
+
+	int entityCount = m_pEntityStore->GetCount();
+	const EntityStore::ENTITY_ID* pEntityIDs = m_pEntityStore->GetEntityIDs();
+	const unsigned int* pFlags = m_pEntityStore->GetFlags();
+	const int* pMeshIDs = m_pEntityStore->GetMeshIDs();
+	const int* pMaterialIndices = m_pEntityStore->GetMaterialIndices();
+	const int* pTextureSlots = m_pEntityStore->GetTextureSlots();
+	const glm::vec4* pColors = m_pEntityStore->GetColors();
+	const glm::vec2* pUVScales = m_pEntityStore->GetUVScales();
+	const glm::mat4* pWorldMatrices = m_pEntityStore->GetWorldMatrices();
+	for (int i = 0; i < entityCount; i++)
+	{
+		if ((pFlags[i] & EntityStore::ENTITY_STATIC) == 0)
+		{
+			continue;
+		}
+
+		// only the basic shapes can be baked into the batches
+		SHAPE_MESH shape = FindShapeMesh(pMeshIDs[i]);
+		if (shape == SHAPE_MESH_COUNT)
+		{
+			m_pEntityStore->SetFlags(pEntityIDs[i], pFlags[i] & ~EntityStore::ENTITY_STATIC);
+			continue;
+		}
+
+		StaticBatches::BATCH_KEY key;
+		key.materialIndex = pMaterialIndices[i];
+		key.bUseTexture = (pTextureSlots[i] >= 0);
+		key.textureSlot = (pTextureSlots[i] >= 0) ? pTextureSlots[i] : 0;
+		key.color = pColors[i];
+		key.uvScale = pUVScales[i];
+
+		int objectID = m_pStaticBatches->AddObject(shape, pWorldMatrices[i], key);
+		m_pEntityStore->SetObjectID(pEntityIDs[i], objectID);
+	}
+
+	m_pStaticBatches->Commit();
+
+	std::cout << "Static batching: " << entityCount << " entities, " << m_pStaticBatches->GetObjectCount()
+		<< " objects merged into " << m_pStaticBatches->GetBatchCount() << " batches" << std::endl;
+}
+
+/***********************************************************
+ *  FindEditableObjects()
+ *
+ *  This method is used for keeping the entities of the
+ *  objects the edit key slides, from the objects of the
+ *  first desk just placed from the passed in entity on.
+ *  Every placed object records one entity, in the order of
+ *  the scene tables.
+ ***********************************************************/
+void SceneManager::FindEditableObjects(int firstEntity)
+{
+	const EntityStore::ENTITY_ID* pEntityIDs = m_pEntityStore->GetEntityIDs();
+	const unsigned int* pFlags = m_pEntityStore->GetFlags();
+	for (int i = 0; i < SceneTables::OBJECT_COUNT; i++)
+	{
+		const SceneTables::BAKED_OBJECT& object = SceneTables::OBJECTS.objects[i];
+		// the moving objects of a stress scene are not batched
+		if ((object.materialIndex != EDITABLE_MATERIAL) ||
+			((pFlags[firstEntity + i] & EntityStore::ENTITY_STATIC) == 0))
+		{
+			continue;
+		}
+
+		EDITABLE_OBJECT editable;
+		editable.entity = pEntityIDs[firstEntity + i];
+		editable.scaleXYZ = glm::make_vec3(object.scaleXYZ);
+		editable.rotationDegrees = glm::make_vec3(object.rotationDegrees);
+		editable.positionXYZ = glm::make_vec3(object.positionXYZ) + m_placementOffset;
+		m_editableObjects.push_back(editable);
+	}
+}
+
+/***********************************************************
+ *  AddEntityGroup()
+ *
+ *  This method is used for grouping the entities placed
+ *  from the passed in dense index on, which are culled
+ *  together before any of them is tested on its own.
+ ***********************************************************/
+void SceneManager::AddEntityGroup(int firstEntity)
+{
+	int count = m_pEntityStore->GetCount() - firstEntity;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	ENTITY_GROUP group;
+	group.first = firstEntity;
+	group.count = count;
+	group.boundsMin = glm::vec3(0.0f);
+	group.boundsMax = glm::vec3(0.0f);
+	m_entityGroups.push_back(group);
+}
+
+/***********************************************************
+ *  UpdateEntityGroupBounds()
+ *
+ *  This method is used for setting the box around the world
+ *  bounds of each group's entities.  The entities drawn
+ *  each frame of a stress scene may move, so their bounds
+ *  take in everywhere the stress scene moves them.
+ ***********************************************************/
+void SceneManager::UpdateEntityGroupBounds()
+{
+	const unsigned int* pFlags = m_pEntityStore->GetFlags();
+	const glm::vec3* pBoundsMin = m_pEntityStore->GetBoundsMin();
+	const glm::vec3* pBoundsMax = m_pEntityStore->GetBoundsMax();
+	const glm::mat4* pWorldMatrices = m_pEntityStore->GetWorldMatrices();
+	for (int i = 0; i < m_entityGroups.size(); i++)
+	{
+		// a group always holds at least one entity
+		ENTITY_GROUP& group = m_entityGroups[i];
+		group.boundsMin = pBoundsMin[group.first];
+		group.boundsMax = pBoundsMax[group.first];
+
+		for (int j = group.first; j < group.first + group.count; j++)
+		{
+			glm::vec3 boundsMin = pBoundsMin[j];
+			glm::vec3 boundsMax = pBoundsMax[j];
+			if ((NULL != m_pStressScene) && ((pFlags[j] & EntityStore::ENTITY_STATIC) == 0))
+			{
+				m_pStressScene->GetSweptBounds(glm::vec3(pWorldMatrices[j][3]), boundsMin, boundsMax);
+			}
+			group.boundsMin = glm::min(group.boundsMin, boundsMin);
+			group.boundsMax = glm::max(group.boundsMax, boundsMax);
+		}
+	}
+}
+
+/***********************************************************
+ *  BakeLightmap()
+ *
+ *  This method is used for baking the ambient and diffuse
+ *  light of the opaque static batches with their materials.
+ *  The transparent batches neither receive nor cast baked
+ *  light, and stay lit per fragment like the entities that
+ *  are not batched.  The specular light depends on the view,
+ *  so it is left out of the baked batches.
+ ***********************************************************/
+void SceneManager::BakeLightmap()
+{
+	m_batchLightmaps.assign(m_pStaticBatches->GetBatchCount(), -1);
+	if ((g_bBakeLightmaps == false) || (m_bUseLighting == false))
+	{
+		return;
+	}
+
+	AddLightmapSurfaces(m_pLightmapper, m_batchLightmaps);
+	if (m_pLightmapper->Bake(LIGHTMAP_CACHE_PATH) == false)
+	{
+		m_batchLightmaps.assign(m_pStaticBatches->GetBatchCount(), -1);
+		return;
+	}
+
+	m_pLightmapper->PrintReport();
+}
+
+/***********************************************************
+ *  AddLightmapSurfaces()
+ *
+ *  This method is used for adding the lights and the opaque
+ *  static batches to a lightmapper.  The first lightmap
+ *  coordinate of each batch is set into the passed in list,
+ *  or -1 for the batches left out.
+ ***********************************************************/
+void SceneManager::AddLightmapSurfaces(Lightmapper* pLightmapper, std::vector<int>& batchLightmaps)
+{
+	batchLightmaps.assign(m_pStaticBatches->GetBatchCount(), -1);
+	pLightmapper->Clear();
+	pLightmapper->SetLights(m_bakeLights.data(), std::min(m_lightCount, (int)m_bakeLights.size()));
+	for (int i = 0; i < m_pStaticBatches->GetBatchCount(); i++)
+	{
+		const StaticBatches::BATCH_KEY& key = m_pStaticBatches->GetBatchKey(i);
+		const std::vector<MESH_VERTEX>& vertices = m_pStaticBatches->GetBatchVertices(i);
+		if (((key.bUseTexture == true) ? m_textureIDs[key.textureSlot].bHasAlpha : (key.color.a < 1.0f)) ||
+			(vertices.size() == 0))
+		{
+			continue;
+		}
+
+		const OBJECT_MATERIAL& material = ((key.materialIndex < 0) || (key.materialIndex >= m_objectMaterials.size())) ?
+			m_defaultMaterial : m_objectMaterials[key.materialIndex];
+		batchLightmaps[i] = pLightmapper->AddSurface(
+			vertices.data(), (unsigned int)vertices.size(), material.ambientColor, material.diffuseColor);
+	}
+}
+
+/***********************************************************
+ *  StartLightmapRebake()
+ *
+ *  This method is used for baking the lightmap of the
+ *  edited static batches on background threads, while the
+ *  old lightmap is still drawn.  The edits only move
+ *  objects, so every batch keeps its vertices in place and
+ *  gets the same first coordinates as before - the drawn
+ *  frames can read the old lightmap until the new one is
+ *  swapped in.  Edits made while a bake runs are baked
+ *  once it is done.
+ ***********************************************************/
+void SceneManager::StartLightmapRebake()
+{
+	// nothing to bake again when the startup bake was left
+	// out or failed
+	if (NULL == m_pLightmapper->GetCoordinates())
+	{
+		return;
+	}
+	if (m_bRebaking == true)
+	{
+		m_bRebakeQueued = true;
+		return;
+	}
+
+	// an edited layout is not written over the cache of the
+	// scene as it starts
+	AddLightmapSurfaces(m_pRebakeLightmapper, m_rebakeLightmaps);
+	int threadCount = (int)std::thread::hardware_concurrency() - REBAKE_SPARE_CORES;
+	m_bRebaking = m_pRebakeLightmapper->BeginBake(NULL, std::max(threadCount, 1));
+}
+
+/***********************************************************
+ *  UpdateLightmapRebake()
+ *
+ *  This method is used for uploading the lightmap baked in
+ *  the background once its threads are done, and drawing
+ *  it from then on.  The render thread checks it after each
+ *  packet, so the bake is spread over the frames drawn in
+ *  the meantime.
+ ***********************************************************/
+void SceneManager::UpdateLightmapRebake()
+{
+	if ((m_bRebaking == false) || (m_pRebakeLightmapper->IsBakeFinished() == false))
+	{
+		return;
+	}
+
+	m_bRebaking = false;
+	if (m_pRebakeLightmapper->FinishBake() == true)
+	{
+		std::swap(m_pLightmapper, m_pRebakeLightmapper);
+		m_pLightmapper->PrintReport();
+	}
+
+	if (m_bRebakeQueued == true)
+	{
+		m_bRebakeQueued = false;
+		StartLightmapRebake();
+	}
+}
+
+/***********************************************************
+ *  CullStaticObjects()
+ *
+ *  This method is used for finding the static objects that
+ *  cannot be seen in the current frame.  The large opaque
+ *  objects are drawn into the CPU depth buffer first, then
+ *  every object is tested against the frustum and it.
+ ***********************************************************/
+void SceneManager::CullStaticObjects()
+{
+	int objectCount = m_pStaticBatches->GetObjectCount();
+	m_pVisibleObjects = m_pFrameArena->AllocateArray<bool>(objectCount);
+	if (g_bOcclusionCulling == false)
+	{
+		std::fill(m_pVisibleObjects, m_pVisibleObjects + objectCount, true);
+		HideStaticEntities();
+		return;
+	}
+
+	m_pOcclusionCuller->BeginFrame(m_viewProjections, m_viewCount);
+
+	// the occluders only hide objects when a single view is drawn
+	for (int i = 0; (m_viewCount == 1) && (i < m_pStaticBatches->GetBatchCount()); i++)
+	{
+		// the scene shows through transparent objects
+		const StaticBatches::BATCH_KEY& key = m_pStaticBatches->GetBatchKey(i);
+		if ((key.bUseTexture == true) ? m_textureIDs[key.textureSlot].bHasAlpha : (key.color.a < 1.0f))
+		{
+			continue;
+		}
+
+		const std::vector<int>& objectIDs = m_pStaticBatches->GetBatchObjects(i);
+		const std::vector<MESH_VERTEX>& vertices = m_pStaticBatches->GetBatchVertices(i);
+		const std::vector<unsigned int>& indices = m_pStaticBatches->GetBatchIndices(i);
+		for (int j = 0; j < objectIDs.size(); j++)
+		{
+			const StaticBatches::STATIC_OBJECT& object = m_pStaticBatches->GetObject(objectIDs[j]);
+			if ((glm::length(object.boundsMax - object.boundsMin) >= OCCLUDER_MIN_SIZE) &&
+				(m_pOcclusionCuller->IsInFrustum(object.boundsMin, object.boundsMax) == true))
+			{
+				m_pOcclusionCuller->AddOccluder(vertices.data(), &indices[object.firstIndex], object.indexCount);
+			}
+		}
+	}
+
+	for (int i = 0; i < objectCount; i++)
+	{
+		const StaticBatches::STATIC_OBJECT& object = m_pStaticBatches->GetObject(i);
+		m_pVisibleObjects[i] = m_pOcclusionCuller->IsVisible(object.boundsMin, object.boundsMax);
+	}
+
+	HideStaticEntities();
+}
+
+/***********************************************************
+ *  HideStaticEntities()
+ *
+ *  This method is used for leaving the batch objects of the
+ *  hidden static entities out of the current frame.
+ ***********************************************************/
+void SceneManager::HideStaticEntities()
+{
+	int entityCount = m_pEntityStore->GetCount();
+	const unsigned int* pFlags = m_pEntityStore->GetFlags();
+	const int* pObjectIDs = m_pEntityStore->GetObjectIDs();
+	for (int i = 0; i < entityCount; i++)
+	{
+		if (((pFlags[i] & EntityStore::ENTITY_HIDDEN) != 0) && (pObjectIDs[i] >= 0))
+		{
+			m_pVisibleObjects[pObjectIDs[i]] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  RenderStaticBatches()
+ *
+ *  This method is used for adding the draws of the visible
+ *  static objects.  Neighboring visible objects of a batch
+ *  share one draw command.  The vertices are already in
+ *  world space, so the batches use an identity model matrix.
+ ***********************************************************/
+void SceneManager::RenderStaticBatches()
+{
+	CullStaticObjects();
+
+	for (int i = 0; i < m_pStaticBatches->GetBatchCount(); i++)
+	{
+		const StaticBatches::BATCH_KEY& key = m_pStaticBatches->GetBatchKey(i);
+
+		m_drawState.model = glm::mat4(1.0f);
+		m_drawState.bUseTexture = key.bUseTexture;
+		m_drawState.textureSlot = key.textureSlot;
+		m_drawState.color = key.color;
+		m_drawState.uvScale = key.uvScale;
+		m_drawState.materialIndex = key.materialIndex;
+		m_drawState.lightmapFirst = (i < m_batchLightmaps.size()) ? m_batchLightmaps[i] : -1;
+
+		// draw each run of visible objects, centered on its bounds
+		const std::vector<int>& objectIDs = m_pStaticBatches->GetBatchObjects(i);
+		int first = 0;
+		while (first < objectIDs.size())
+		{
+			if (m_pVisibleObjects[objectIDs[first]] == false)
+			{
+				first++;
+				continue;
+			}
+
+			const StaticBatches::STATIC_OBJECT& firstObject = m_pStaticBatches->GetObject(objectIDs[first]);
+			glm::vec3 boundsMin = firstObject.boundsMin;
+			glm::vec3 boundsMax = firstObject.boundsMax;
+			unsigned int indexCount = 0;
+			int last = first;
+			while ((last < objectIDs.size()) && (m_pVisibleObjects[objectIDs[last]] == true))
+			{
+				const StaticBatches::STATIC_OBJECT& object = m_pStaticBatches->GetObject(objectIDs[last]);
+				boundsMin = glm::min(boundsMin, object.boundsMin);
+				boundsMax = glm::max(boundsMax, object.boundsMax);
+				indexCount += object.indexCount;
+				last++;
+			}
+
+			AddMeshDraw(m_pStaticBatches->GetBatchMesh(i), firstObject.firstIndex, indexCount, (boundsMin + boundsMax) * 0.5f);
+			first = last;
+		}
+	}
+
+	// the other draws are lit per fragment
+	m_drawState.lightmapFirst = -1;
+}
+
+/***********************************************************
+ *  RenderEntities()
+ *
+ *  This method is used for adding the draws of the entities
+ *  that are not in the static batches, in one pass over the
+ *  packed component arrays.  The entities of a group that
+ *  cannot be seen are skipped with one test, like a whole
+ *  desk of a stress scene.
+ ***********************************************************/
+void SceneManager::RenderEntities()
+{
+	// nothing is built unless an entity was added or moved
+	m_pEntityStore->UpdateWorld();
+
+	if (m_entityGroups.empty() == true)
+	{
+		RenderEntityRange(0, m_pEntityStore->GetCount());
+		return;
+	}
+
+	for (int i = 0; i < m_entityGroups.size(); i++)
+	{
+		const ENTITY_GROUP& group = m_entityGroups[i];
+		if ((g_bOcclusionCulling == true) &&
+			(m_pOcclusionCuller->IsVisible(group.boundsMin, group.boundsMax) == false))
+		{
+			continue;
+		}
+
+		RenderEntityRange(group.first, group.count);
+	}
+}
+
+/***********************************************************
+ *  RenderEntityRange()
+ *
+ *  This method is used for adding the draws of a range of
+ *  the entities that are not in the static batches.
+ *  Entities outside of the view or behind the occluders are
+ *  skipped.
+ ***********************************************************/
+void SceneManager::RenderEntityRange(int first, int count)
+{
+	const unsigned int* pFlags = m_pEntityStore->GetFlags();
+	const glm::vec3* pBoundsMin = m_pEntityStore->GetBoundsMin();
+	const glm::vec3* pBoundsMax = m_pEntityStore->GetBoundsMax();
+	const int* pMeshIDs = m_pEntityStore->GetMeshIDs();
+	const int* pMaterialIndices = m_pEntityStore->GetMaterialIndices();
+	const int* pTextureSlots = m_pEntityStore->GetTextureSlots();
+	const glm::vec4* pColors = m_pEntityStore->GetColors();
+	const glm::vec2* pUVScales = m_pEntityStore->GetUVScales();
+	const glm::mat4* pWorldMatrices = m_pEntityStore->GetWorldMatrices();
+	for (int i = first; i < first + count; i++)
+	{
+		if ((pFlags[i] & (EntityStore::ENTITY_STATIC | EntityStore::ENTITY_HIDDEN)) != 0)
+		{
+			continue;
+		}
+		if ((g_bOcclusionCulling == true) &&
+			(m_pOcclusionCuller->IsVisible(pBoundsMin[i], pBoundsMax[i]) == false))
+		{
+			continue;
+		}
+
+		m_drawState.model = pWorldMatrices[i];
+		m_drawState.bUseTexture = (pTextureSlots[i] >= 0);
+		m_drawState.textureSlot = (pTextureSlots[i] >= 0) ? pTextureSlots[i] : 0;
+		m_drawState.color = pColors[i];
+		m_drawState.uvScale = pUVScales[i];
+		m_drawState.materialIndex = pMaterialIndices[i];
+
+		AddMeshDraw(pMeshIDs[i]);
+	}
+}
+
+/***********************************************************
+ *  EditStaticObject()
+ *
+ *  This method is used for moving a static object after the
+ *  batches were built.  The entity IDs follow the order the
+ *  shapes are drawn in PlaceStaticObjects().  The batches
+ *  are shared with the render thread, so the move is only
+ *  queued for the next packet.
+ ***********************************************************/
+void SceneManager::EditStaticObject(
+	EntityStore::ENTITY_ID entity,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	int denseIndex = m_pEntityStore->GetDenseIndex(entity);
+	if (denseIndex < 0)
+	{
+		return;
+	}
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	m_pEntityStore->SetTransform(entity, scaleXYZ, m_drawState.rotationDegrees, positionXYZ);
+
+	int objectID = m_pEntityStore->GetObjectIDs()[denseIndex];
+	if (objectID >= 0)
+	{
+		STATIC_EDIT edit;
+		edit.objectID = objectID;
+		edit.model = m_drawState.model;
+		m_pendingEdits.push_back(edit);
+	}
+}
+
+/***********************************************************
+ *  ApplyStaticEdits()
+ *
+ *  This method is used for moving the static objects that
+ *  were edited for a packet, once its draws were submitted.
+ *  The changed batches are uploaded and the lightmap is
+ *  started baking again, and the main thread waiting to
+ *  build the next frame is released.
+ ***********************************************************/
+void SceneManager::ApplyStaticEdits(FRAME_PACKET& packet)
+{
+	if (packet.staticEditCount == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < packet.staticEditCount; i++)
+	{
+		m_pStaticBatches->SetObjectTransform(packet.pStaticEdits[i].objectID, packet.pStaticEdits[i].model);
+	}
+
+	// the moved objects change the light and shadows of the
+	// others, so the whole lightmap is baked again - in the
+	// background, as a bake takes far longer than a frame
+	m_pStaticBatches->Commit();
+	StartLightmapRebake();
+
+	packet.pStaticEdits = NULL;
+	packet.staticEditCount = 0;
+
+	std::lock_guard<std::mutex> lock(m_editMutex);
+	m_appliedEditPackets++;
+	m_editsApplied.notify_one();
+}
+
+/***********************************************************
+ *  MoveEditableObjects()
+ *
+ *  This method is used for sliding the editable objects of
+ *  the first desk along it, and back the next time.  The
+ *  objects move through EditStaticObject() like any other
+ *  edit of the static objects.
+ ***********************************************************/
+void SceneManager::MoveEditableObjects()
+{
+	m_bEditableObjectsMoved = !m_bEditableObjectsMoved;
+	glm::vec3 slide = (m_bEditableObjectsMoved == true) ? EDITABLE_OBJECT_SLIDE : glm::vec3(0.0f);
+
+	for (int i = 0; i < m_editableObjects.size(); i++)
+	{
+		const EDITABLE_OBJECT& editable = m_editableObjects[i];
+		EditStaticObject(
+			editable.entity,
+			editable.scaleXYZ,
+			editable.rotationDegrees.x,
+			editable.rotationDegrees.y,
+			editable.rotationDegrees.z,
+			editable.positionXYZ + slide);
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+ /***********************************************************
+  *  DefineObjectMaterials()
+  *
+  *  This method is used for configuring the various material
+  *  settings for all of the objects within the 3D scene.
+  ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	/*** STUDENTS - add the code BELOW for defining object materials. ***/
+	/*** There is no limit to the number of object materials that can ***/
+	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
+
+	// the materials are listed in SceneTables::MATERIALS, and
+	// the baked objects refer to them by their index there
+	m_objectMaterials.reserve(m_objectMaterials.size() + SceneTables::MATERIAL_COUNT);
+	for (int i = 0; i < SceneTables::MATERIAL_COUNT; i++)
+	{
+		const SceneTables::SCENE_MATERIAL& sceneMaterial = SceneTables::MATERIALS[i];
+
+		OBJECT_MATERIAL material;
+		material.ambientColor = glm::make_vec3(sceneMaterial.ambientColor);
+		material.diffuseColor = glm::make_vec3(sceneMaterial.diffuseColor);
+		material.specularColor = glm::make_vec3(sceneMaterial.specularColor);
+		material.shininess = sceneMaterial.shininess;
+		material.ambientStrength = sceneMaterial.ambientStrength;
+		material.tag = sceneMaterial.tag;
+		m_objectMaterials.push_back(material);
+	}
+}
+
+
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  There are up to 4 light sources.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	
+
+	/*** STUDENTS - add the code BELOW for setting up light sources ***/
+	/*** Up to four light sources can be defined. Refer to the code ***/
+	/*** in the OpenGL Sample for help                              ***/
+	  // This line of code is NEEDED for telling the shaders to render
+	// the 3D scene with custom lighting, if no light sources have
+	// been added then the display window will be black - to use the 
+	// default OpenGL lighting then comment out the following line
+	
+	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Lighting%20to%20a%203D%20Scene.pdf?isCourseFile=true&ou=1644154
+	// Light Source 1 Gold light covering scene 
+	SetLightSource(0,
+		glm::vec3(3.0f, 10.0f, -24.0f),
+		glm::vec3(0.05f, 0.05f, 0.025f),
+		glm::vec3(0.5f, 0.4f, 0.2f),
+		glm::vec3(0.5f, 0.4f, 0.2f),
+		8.0f,
+		1.0f);
+
+	// Light Source 2 white light from above
+	SetLightSource(1,
+		glm::vec3(0.0f, 20.0f, 0.0f),
+		glm::vec3(0.05f, 0.05f, 0.05f),
+		glm::vec3(0.6f, 0.6f, 0.6f),
+		glm::vec3(0.5f, 0.5f, 0.5f),
+		6.0f,
+		0.5f);
+
+
+	// Light Source  Light on Monitor
+	SetLightSource(2,
+		glm::vec3(0.0f, 2.7f, 2.0f),
+		glm::vec3(0.1f, 0.1f, 0.1f),
+		glm::vec3(0.7f, 0.7f, 0.7f),
+		glm::vec3(0.9f, 0.9f, 0.9f),
+		2.0f,
+		1.0f);
+
+
+
+
+	// the lit shader variants are specialized for the number
+	// of light sources that were set up above
+	m_lightCount = 3;
+	m_bUseLighting = true;
+
+}
+
+/***********************************************************
+  *  LoadSceneTextures()
+  *
+  *  This method is used for preparing the 3D scene by loading
+  *  the shapes, textures in memory to support the 3D scene
+  *  rendering
+  ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	/*** STUDENTS - add the code BELOW for loading the textures that ***/
+	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
+	/*** 15 textures can be loaded per scene. Refer to the code in   ***/
+	/*** the OpenGL Sample for help.                                 ***/
+
+
+
+	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Textures%20to%203D%20Shapes.pdf?isCourseFile=true&ou=1644154
+
+	//textures decoded in to memory, then uploaded - the files and
+	//tags are listed in SceneTables::TEXTURES, which the asset
+	//pack also uses
+	stbi_set_flip_vertically_on_load(true);
+	for (int i = 0; i < SceneTables::TEXTURE_COUNT; i++)
+	{
+		DecodeSceneTexture(i);
+	}
+	UploadSceneTextures();
+}
+
+/***********************************************************
+ *  DecodeSceneTexture()
+ *
+ *  This method is used for decoding the image of a scene
+ *  texture ahead of its upload.  No OpenGL is called, so the
+ *  images can be decoded on several threads at once.
+ ***********************************************************/
+void SceneManager::DecodeSceneTexture(int index)
+{
+	DecodeImage(SceneTables::TEXTURES[index].filename, m_sceneImages[index]);
+}
+
+/***********************************************************
+ *  UploadSceneTextures()
+ *
+ *  This method is used for uploading the decoded scene
+ *  textures in the order of the scene tables, so they get
+ *  the same slots however the decodes were scheduled, and
+ *  keeping the slot each one landed in for the baked
+ *  objects.
+ ***********************************************************/
+void SceneManager::UploadSceneTextures()
+{
+	bool bReturn = false;
+	for (int i = 0; i < SceneTables::TEXTURE_COUNT; i++)
+	{
+		bReturn = UploadGLTexture(
+			SceneTables::TEXTURES[i].filename,
+			SceneTables::TEXTURES[i].tag,
+			m_sceneImages[i]);
+		m_sceneTextureSlots[i] = (bReturn == true) ? m_loadedTextures - 1 : -1;
+	}
+
+
+	// after the texture image data is loaded into memory, the
+	// loaded textures need to be bound to texture slots - there
+	// are a total of ShaderVariants::MAX_TEXTURE_SLOTS available
+	// slots for scene textures
+	BindGLTextures();
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+
+/***********************************************************
+ *  SetStressScene()
+ *
+ *  This method is used for replicating the static objects
+ *  into a grid of varied desks generated from a seed, for
+ *  measuring how the frame scales with the size of the
+ *  scene.  It is set before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetStressScene(const StressScene::SETTINGS& settings)
+{
+	delete m_pStressScene;
+	m_pStressScene = new StressScene(settings);
+}
+
+/***********************************************************
+ *  SetImportedMesh()
+ *
+ *  This method is used for setting a model file that is
+ *  imported with the fast mesh importer and placed on the
+ *  desk.  It is set before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetImportedMesh(const char* filename)
+{
+	m_importFilename = filename;
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering.  The steps run as a startup graph of their
+ *  own, on the thread that owns the OpenGL context.
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	StartupGraph graph;
+	AddPrepareTasks(&graph, -1, -1);
+	graph.Run();
+}
+
+/***********************************************************
+ *  AddPrepareTasks()
+ *
+ *  This method is used for adding the steps that prepare
+ *  the 3D scene to a startup graph.  The materials, lights,
+ *  image decodes and shape generation have no OpenGL calls
+ *  and run on the worker threads as soon as their inputs
+ *  are ready, and only the uploads, batching and lightmap
+ *  run on the GL thread.  The uploads keep the order of the
+ *  serial startup, so the texture slots and mesh IDs do not
+ *  depend on which worker finished first.
+ ***********************************************************/
+int SceneManager::AddPrepareTasks(StartupGraph* pGraph, int contextTask, int assetTask)
+{
+	// the images are flipped to the OpenGL origin - the flag
+	// is global to stb_image, so it is set before any decode
+	stbi_set_flip_vertically_on_load(true);
+
+	// define the materials for objects in the scene
+	int materialsTask = pGraph->AddTask("DefineObjectMaterials", StartupGraph::TASK_WORKER, [this]()
+	{
+		DefineObjectMaterials();
+		return(true);
+	});
+	// add and define the light sources for the scene
+	int lightsTask = pGraph->AddTask("SetupSceneLights", StartupGraph::TASK_WORKER, [this]()
+	{
+		SetupSceneLights();
+		return(true);
+	});
+
+	// the textures are decoded one per task, and uploaded
+	// together once the context exists
+	int texturesTask = pGraph->AddTask("UploadSceneTextures", StartupGraph::TASK_GL, [this]()
+	{
+		UploadSceneTextures();
+		return(true);
+	});
+	pGraph->AddDependency(texturesTask, contextTask);
+	for (int i = 0; i < SceneTables::TEXTURE_COUNT; i++)
+	{
+		int decodeTask = pGraph->AddTask(std::string("Decode ") + SceneTables::TEXTURES[i].tag, StartupGraph::TASK_WORKER, [this, i]()
+		{
+			DecodeSceneTexture(i);
+			return(true);
+		});
+		pGraph->AddDependency(decodeTask, assetTask);
+		pGraph->AddDependency(texturesTask, decodeTask);
+	}
+
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene - all of them share one buffer
+	int meshesTask = pGraph->AddTask("LoadShapeMeshes", StartupGraph::TASK_GL, [this]()
+	{
+		LoadShapeMesh(PLANE_MESH);
+
+		//added box and cylinder meshes to create the monitor.
+		LoadShapeMesh(BOX_MESH);
+		LoadShapeMesh(CYLINDER_MESH);
+		LoadShapeMesh(SPHERE_MESH);
+		return(true);
+	});
+	pGraph->AddDependency(meshesTask, contextTask);
+	for (int i = 0; i < SHAPE_MESH_COUNT; i++)
+	{
+		SHAPE_MESH mesh = (SHAPE_MESH)i;
+		int generateTask = pGraph->AddTask(std::string("Generate ") + g_ShapeNames[i], StartupGraph::TASK_WORKER, [mesh]()
+		{
+			ShapeGeometry::GetShape(mesh);
+			return(true);
+		});
+		pGraph->AddDependency(meshesTask, generateTask);
+	}
+
+	// the optional model file is parsed on a worker, and
+	// uploaded after the basic shapes so their mesh IDs do not
+	// change - a file that fails to import is left out
+	int importTask = -1;
+	if (m_importFilename.empty() == false)
+	{
+		int decodeTask = pGraph->AddTask("ImportMesh", StartupGraph::TASK_WORKER, [this]()
+		{
+			DecodeImportedMesh();
+			return(true);
+		});
+		pGraph->AddDependency(decodeTask, assetTask);
+
+		importTask = pGraph->AddTask("UploadImportedMesh", StartupGraph::TASK_GL, [this]()
+		{
+			UploadImportedMesh(IMPORTED_MESH_TAG);
+			return(true);
+		});
+		pGraph->AddDependency(importTask, decodeTask);
+		pGraph->AddDependency(importTask, meshesTask);
+	}
+
+	// the objects that never move are merged into one
+	// batch per material and texture
+	int batchesTask = pGraph->AddTask("BuildStaticBatches", StartupGraph::TASK_GL, [this]()
+	{
+		BuildStaticBatches();
+		return(true);
+	});
+	pGraph->AddDependency(batchesTask, materialsTask);
+	pGraph->AddDependency(batchesTask, lightsTask);
+	pGraph->AddDependency(batchesTask, texturesTask);
+	pGraph->AddDependency(batchesTask, meshesTask);
+	pGraph->AddDependency(batchesTask, importTask);
+
+	// the lighting of the opaque batches is baked once, or read
+	// from the cache written by an earlier run
+	int lightmapTask = pGraph->AddTask("BakeLightmap", StartupGraph::TASK_GL, [this]()
+	{
+		BakeLightmap();
+		m_pMeshBuffer->PrintMemoryReport();
+		return(true);
+	});
+	pGraph->AddDependency(lightmapTask, batchesTask);
+
+	return(lightmapTask);
+}
+
+/***********************************************************
+ *  BuildFrame()
+ *
+ *  This method is used for building the frame packet of the
+ *  3D scene - the visible static objects and entities are
+ *  collected and sorted into its draw list, next to the
+ *  views and shader values the draws need.  Nothing here
+ *  calls OpenGL, so the main thread builds the next frame
+ *  while the render thread draws the last one - unless the
+ *  last one moved static objects, which the render thread
+ *  must finish first.
+ ***********************************************************/
+void SceneManager::BuildFrame(FRAME_PACKET& packet)
+{
+	// the static batches and the lightmap are read below, so
+	// the edits queued with an earlier packet must be applied
+	{
+		std::unique_lock<std::mutex> lock(m_editMutex);
+		m_editsApplied.wait(lock, [this]() { return(m_appliedEditPackets == m_queuedEditPackets); });
+	}
+
+	// the transient data the packet held last time is released
+	// at once, so the steady frames do not allocate from the heap
+	m_pFrameArena = packet.pFrameArena;
+	m_pFrameArena->Reset();
+	m_pIndirectDraws->Begin(m_pFrameArena);
+
+	// the moving objects of a stress scene are timed by the
+	// frames built, so a replay moves them the same way
+	if (NULL != m_pStressScene)
+	{
+		m_pStressScene->Animate(m_pEntityStore, m_builtFrames / STRESS_FRAMES_PER_SECOND);
+	}
+	m_builtFrames++;
+
+	// draw the visible static objects - at most one draw
+	// command per run of visible objects in each batch
+	RenderStaticBatches();
+	// draw the entities that are not batched, walking the
+	// entity store from start to end
+	RenderEntities();
+
+	// sort the frame's draws, opaque front to back and
+	// transparent back to front
+	m_pIndirectDraws->Finish(m_viewPosition, packet.draws);
+
+	packet.viewCount = m_viewCount;
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		packet.viewProjections[i] = m_viewProjections[i];
+		packet.viewRects[i] = m_viewRects[i];
+		packet.viewPositions[i] = m_viewPositions[i];
+	}
+	packet.lightCount = m_lightCount;
+	packet.cullStats = m_pOcclusionCuller->GetStats();
+
+	// the static objects edited since the last packet move after
+	// this one is drawn
+	packet.pStaticEdits = NULL;
+	packet.staticEditCount = (int)m_pendingEdits.size();
+	if (packet.staticEditCount > 0)
+	{
+		STATIC_EDIT* pEdits = m_pFrameArena->AllocateArray<STATIC_EDIT>(m_pendingEdits.size());
+		std::copy(m_pendingEdits.begin(), m_pendingEdits.end(), pEdits);
+		packet.pStaticEdits = pEdits;
+		m_pendingEdits.clear();
+		std::lock_guard<std::mutex> lock(m_editMutex);
+		m_queuedEditPackets++;
+	}
+
+	m_pFrameArena = NULL;
+	m_pVisibleObjects = NULL;
+}
+
+/***********************************************************
+ *  RenderFrame()
+ *
+ *  This method is used for drawing a built frame packet.
+ *  The view values are set into every shader variant, and
+ *  the draws are submitted with one multi-draw call per
+ *  shader variant.
+ ***********************************************************/
+void SceneManager::RenderFrame(FRAME_PACKET& packet)
+{
+	if (m_renderBackend == BACKEND_SOFTWARE)
+	{
+		RenderSoftwareFrame(packet);
+		return;
+	}
+
+	// set the projection times view, the covered part of the
+	// target and the camera position of each view into every
+	// shader variant for proper rendering
+	for (int i = 0; i < packet.viewCount; i++)
+	{
+		m_pShaderVariants->SetSharedMat4Value(g_ViewProjectionNames[i], packet.viewProjections[i]);
+		m_pShaderVariants->SetSharedVec4Value(g_ViewRectNames[i], packet.viewRects[i]);
+		m_pShaderVariants->SetSharedVec3Value(g_ViewPositionNames[i], packet.viewPositions[i]);
+	}
+
+	// bound every frame, as textures created since then were
+	// bound on the active unit
+	m_pLightmapper->Bind();
+
+	m_pIndirectDraws->SetViewCount(packet.viewCount);
+	m_pIndirectDraws->Submit(packet.draws, packet.lightCount);
+
+	m_frameCount++;
+	if ((m_bDebugCounters == true) && ((m_frameCount % DEBUG_REPORT_FRAMES) == 0))
+	{
+		std::cout << "Overdraw: " << m_pIndirectDraws->GetOverdraw() << " samples per pixel" << std::endl;
+		// the CPU only waits on the ring buffer fences when it
+		// gets three frames ahead of the GPU
+		RingBuffer* pRingBuffer = m_pIndirectDraws->GetRingBuffer();
+		std::cout << "Ring buffer: " << pRingBuffer->GetStallCount() << " stalls in "
+			<< pRingBuffer->GetFrameCount() << " frames, "
+			<< pRingBuffer->GetTotalWaitMilliseconds() << " ms waited" << std::endl;
+		if (g_bOcclusionCulling == true)
+		{
+			const OcclusionCuller::CULL_STATS& stats = packet.cullStats;
+			std::cout << "Culling: " << stats.tested << " static objects, "
+				<< stats.outsideFrustum << " outside the frustum, "
+				<< stats.occluded << " occluded, "
+				<< stats.occluderTriangles << " occluder triangles" << std::endl;
+		}
+		// video memory that keeps growing in a long running
+		// process points at a leak
+		GpuResources::PrintUsage();
+	}
+}
+
+/***********************************************************
+ *  RenderSoftwareFrame()
+ *
+ *  This method is used for drawing a built frame packet on
+ *  the CPU with the software rasterizer, at the size of the
+ *  viewport the frame was started with.  The finished frame
+ *  is uploaded into a texture and copied into the bound
+ *  framebuffer, which is the only OpenGL work of the frame.
+ ***********************************************************/
+void SceneManager::RenderSoftwareFrame(FRAME_PACKET& packet)
+{
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	int width = viewport[2];
+	int height = viewport[3];
+	if ((width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	// the lightmap is read where the lightmapper keeps it, as
+	// it is swapped for the one baked after static edits
+	m_pSoftwareRasterizer->SetLightmap(
+		m_pLightmapper->GetTexels(),
+		m_pLightmapper->GetAtlasSize(),
+		m_pLightmapper->GetCoordinates(),
+		m_pLightmapper->GetCoordinateCount());
+	m_pSoftwareRasterizer->Render(
+		packet.draws,
+		packet.viewCount,
+		packet.viewProjections,
+		packet.viewRects,
+		packet.viewPositions,
+		packet.lightCount,
+		width,
+		height);
+
+	if ((m_softwareTexture == 0) || (width != m_softwareTextureWidth) || (height != m_softwareTextureHeight))
+	{
+		DestroySoftwareTarget();
+
+		glGenTextures(1, &m_softwareTexture);
+		glBindTexture(GL_TEXTURE_2D, m_softwareTexture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		GpuResources::Track(GpuResources::RESOURCE_TEXTURE, m_softwareTexture,
+			GpuResources::GetTextureBytes(width, height, 4, false), "SceneManager software frame");
+
+		glGenFramebuffers(1, &m_softwareFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_softwareFramebuffer);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_softwareTexture, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		GpuResources::Track(GpuResources::RESOURCE_FRAMEBUFFER, m_softwareFramebuffer, 0, "SceneManager software frame");
+
+		m_softwareTextureWidth = width;
+		m_softwareTextureHeight = height;
+	}
+
+	// the rows of the color buffer are padded
+	glBindTexture(GL_TEXTURE_2D, m_softwareTexture);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, m_pSoftwareRasterizer->GetStride());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, m_pSoftwareRasterizer->GetColorBuffer());
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// copy into whichever framebuffer the frame is drawn into
+	GLint drawFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_softwareFramebuffer);
+	glBlitFramebuffer(
+		0, 0, width, height,
+		viewport[0], viewport[1], viewport[0] + width, viewport[1] + height,
+		GL_COLOR_BUFFER_BIT,
+		GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)drawFramebuffer);
+
+	m_frameCount++;
+	if ((m_bDebugCounters == true) && ((m_frameCount % DEBUG_REPORT_FRAMES) == 0))
+	{
+		m_pSoftwareRasterizer->PrintReport();
+		GpuResources::PrintUsage();
+	}
+}
+
+/***********************************************************
+ *  DestroySoftwareTarget()
+ *
+ *  This method is used for freeing the texture and the
+ *  framebuffer the software frames are shown through.
+ ***********************************************************/
+void SceneManager::DestroySoftwareTarget()
+{
+	if (m_softwareFramebuffer != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_FRAMEBUFFER, m_softwareFramebuffer);
+		glDeleteFramebuffers(1, &m_softwareFramebuffer);
+		m_softwareFramebuffer = 0;
+	}
+	if (m_softwareTexture != 0)
+	{
+		GpuResources::Release(GpuResources::RESOURCE_TEXTURE, m_softwareTexture);
+		glDeleteTextures(1, &m_softwareTexture);
+		m_softwareTexture = 0;
+	}
+	m_softwareTextureWidth = 0;
+	m_softwareTextureHeight = 0;
+}
+
+/***********************************************************
+ *  GetIndirectDraws()
+ *
+ *  This method is used for getting the indirect draws the
+ *  frames are submitted with, whose counters describe the
+ *  last submitted frame.
+ ***********************************************************/
+IndirectDraws* SceneManager::GetIndirectDraws()
+{
+	return(m_pIndirectDraws);
+}
+
+/***********************************************************
+ *  SetSceneViews()
+ *
+ *  This method is used for setting the views of the frame.
+ *  The objects are culled once against all of them and each
+ *  draw is instanced into every view.  The draws are sorted
+ *  by their distance to the camera of the first view.
+ ***********************************************************/
+void SceneManager::SetSceneViews(const glm::mat4* pViewProjections, const glm::vec4* pViewRects, const glm::vec3* pViewPositions, int viewCount)
+{
+	m_viewCount = std::min(std::max(viewCount, 1), (int)ShaderVariants::MAX_VIEWS);
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		m_viewProjections[i] = pViewProjections[i];
+		m_viewRects[i] = pViewRects[i];
+		m_viewPositions[i] = pViewPositions[i];
+	}
+	m_viewPosition = m_viewPositions[0];
+}
+
+/***********************************************************
+ *  PlaceStaticObjects()
+ *
+ *  This method is used for drawing the basic 3D shapes that
+ *  never move.  It runs once while the scene is prepared,
+ *  and the drawn shapes are recorded into the static
+ *  batches.  The shapes are read from the objects baked into
+ *  SceneTables, whose world matrices and material and
+ *  texture indices were computed by the compiler.
+ ***********************************************************/
+void SceneManager::PlaceStaticObjects()
+{
+	for (int i = 0; i < SceneTables::OBJECT_COUNT; i++)
+	{
+		const SceneTables::BAKED_OBJECT& object = SceneTables::OBJECTS.objects[i];
+
+		// the offset of the stress scene desk only moves the
+		// translation column of the baked matrix
+		m_drawState.scaleXYZ = glm::make_vec3(object.scaleXYZ);
+		m_drawState.rotationDegrees = glm::make_vec3(object.rotationDegrees);
+		m_drawState.positionXYZ = glm::make_vec3(object.positionXYZ) + m_placementOffset;
+		m_drawState.model = glm::make_mat4(object.model);
+		m_drawState.model[3] += glm::vec4(m_placementOffset, 0.0f);
+
+		int materialIndex = object.materialIndex;
+		int textureSlot = m_sceneTextureSlots[object.textureIndex];
+		if ((m_bRecordStatic == true) && (NULL != m_pStressScene))
+		{
+			materialIndex = m_pStressScene->PickMaterial(materialIndex, (int)m_objectMaterials.size());
+			textureSlot = m_pStressScene->PickTexture(textureSlot, m_loadedTextures);
+		}
+
+		m_drawState.materialIndex = materialIndex;
+		m_drawState.bUseTexture = true;
+		m_drawState.textureSlot = textureSlot;
+		m_drawState.color = glm::vec4(1.0f);
+		m_drawState.uvScale = glm::vec2(1.0f, 1.0f);
+
+		DrawShapeMesh(object.mesh);
+	}
+}
\ No newline at end of file
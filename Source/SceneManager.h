@@ -1,117 +1,471 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.h
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	struct OBJECT_MATERIAL
-	{
-		float ambientStrength;
-		glm::vec3 ambientColor;
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-	
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
-	void RenderScene();
-	// loads textures from image files
-	void LoadSceneTextures();
-
-	// pre-set light sources for 3D scene
-	void SetupSceneLights();
-	// pre-define the object materials for lighting
-	void DefineObjectMaterials();
-
-
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.h
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderVariants.h"
+#include "MeshBuffer.h"
+#include "IndirectDraws.h"
+#include "StaticBatches.h"
+#include "MeshImporter.h"
+#include "OcclusionCuller.h"
+#include "FrameArena.h"
+#include "EntityStore.h"
+#include "Lightmapper.h"
+#include "StressScene.h"
+#include "AssetPack.h"
+#include "StartupGraph.h"
+#include "SoftwareRasterizer.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderVariants *pShaderVariants);
+	// destructor
+	~SceneManager();
+
+	// what draws the scene - the software rasterizer runs on
+	// the CPU, and OpenGL only shows its frames
+	enum RENDER_BACKEND
+	{
+		BACKEND_OPENGL,
+		BACKEND_SOFTWARE
+	};
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+		// whether any texel is not fully opaque
+		bool bHasAlpha;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		float ambientStrength;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	struct IMPORTED_MESH
+	{
+		std::string tag;
+		int meshID;
+	};
+
+	// new world matrix of an edited static object
+	struct STATIC_EDIT
+	{
+		int objectID;
+		glm::mat4 model;
+	};
+
+	// everything the render thread needs for drawing a frame -
+	// it is built on the main thread and not changed while it
+	// is being drawn
+	struct FRAME_PACKET
+	{
+		// memory of the draw list, reset when the packet is built
+		FrameArena* pFrameArena;
+		// size of the window's framebuffer the frame is drawn for
+		int framebufferWidth;
+		int framebufferHeight;
+		// views of the frame and their shader values
+		int viewCount;
+		glm::mat4 viewProjections[ShaderVariants::MAX_VIEWS];
+		glm::vec4 viewRects[ShaderVariants::MAX_VIEWS];
+		glm::vec3 viewPositions[ShaderVariants::MAX_VIEWS];
+		int lightCount;
+		// visible draws with their per-draw values, sorted
+		IndirectDraws::DRAW_LIST draws;
+		// culling counts of the frame, for the debug report
+		OcclusionCuller::CULL_STATS cullStats;
+		// static objects edited since the last packet, moved by
+		// the render thread once the packet is drawn
+		const STATIC_EDIT* pStaticEdits;
+		int staticEditCount;
+		// heap allocations the render thread made drawing it
+		unsigned long long renderAllocations;
+	};
+
+private:
+	// shader values for the next draw command, held until
+	// the draw so the matching shader variant can be chosen
+	struct DRAW_STATE
+	{
+		glm::mat4 model;
+		// the transform the model matrix was built from
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		bool bUseTexture;
+		int textureSlot;
+		// index into the defined materials, or -1 for the
+		// default material
+		int materialIndex;
+		// first lightmap coordinate of the mesh, or -1 when the
+		// draw runs the light model
+		int lightmapFirst;
+	};
+
+	// image decoded from a file, before it is uploaded
+	struct TEXTURE_IMAGE
+	{
+		unsigned char* pPixels;
+		int width;
+		int height;
+		int colorChannels;
+	};
+
+	// pointer to shader variants object
+	ShaderVariants* m_pShaderVariants;
+	// shared vertex and index buffer holding every mesh
+	MeshBuffer* m_pMeshBuffer;
+	// mesh IDs of the loaded basic shapes
+	int m_shapeMeshIDs[SHAPE_MESH_COUNT];
+	// meshes imported from model files
+	std::vector<IMPORTED_MESH> m_importedMeshes;
+	// optional model file placed on the desk, and its mesh
+	// imported ahead of the upload
+	std::string m_importFilename;
+	MESH_DATA m_importedMeshData;
+	// transient data of the frame being built - the arena of
+	// its frame packet
+	FrameArena* m_pFrameArena;
+	// draw commands collected for the current frame
+	IndirectDraws* m_pIndirectDraws;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info
+	TEXTURE_INFO m_textureIDs[ShaderVariants::MAX_TEXTURE_SLOTS];
+	// texture slot each scene texture was loaded into, or -1,
+	// by its index in the baked scene tables
+	int m_sceneTextureSlots[ShaderVariants::MAX_TEXTURE_SLOTS];
+	// scene texture images decoded ahead of their upload, by
+	// their index in the baked scene tables
+	TEXTURE_IMAGE m_sceneImages[ShaderVariants::MAX_TEXTURE_SLOTS];
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// material of the draws without a defined material
+	OBJECT_MATERIAL m_defaultMaterial;
+	// shader values for the next draw command
+	DRAW_STATE m_drawState;
+	// whether the light model is applied to the scene
+	bool m_bUseLighting;
+	// number of light sources set up for the scene
+	int m_lightCount;
+	// the light sources as the lightmap bakes them
+	std::vector<Lightmapper::BAKE_LIGHT> m_bakeLights;
+	// baked lighting of the opaque static batches
+	Lightmapper* m_pLightmapper;
+	// first lightmap coordinate of each static batch, or -1
+	// for the batches lit per fragment
+	std::vector<int> m_batchLightmaps;
+	// lightmap baked in the background after static edits,
+	// swapped with the drawn one once it is uploaded, and
+	// whether more edits arrived while it was baking - render
+	// thread only
+	Lightmapper* m_pRebakeLightmapper;
+	std::vector<int> m_rebakeLightmaps;
+	bool m_bRebaking;
+	bool m_bRebakeQueued;
+	// views of the current frame, all drawn by the same draws,
+	// and the camera position the draws are sorted by
+	int m_viewCount;
+	glm::mat4 m_viewProjections[ShaderVariants::MAX_VIEWS];
+	glm::vec4 m_viewRects[ShaderVariants::MAX_VIEWS];
+	glm::vec3 m_viewPositions[ShaderVariants::MAX_VIEWS];
+	glm::vec3 m_viewPosition;
+	// frames rendered, used for the periodic debug reports
+	int m_frameCount;
+	// the objects of the scene, walked linearly when drawing
+	EntityStore* m_pEntityStore;
+	// merged buffers of the objects that never move
+	StaticBatches* m_pStaticBatches;
+	// frustum and occlusion tests of the static objects
+	OcclusionCuller* m_pOcclusionCuller;
+	// visibility of each static object in the current frame,
+	// allocated from the frame arena
+	bool* m_pVisibleObjects;
+	// true while the static objects are being recorded
+	// into the entity store instead of drawn
+	bool m_bRecordStatic;
+	// whether the recorded static shapes are baked into the
+	// batches, or stay entities drawn with their own transform
+	bool m_bBatchStatic;
+	// range of the entity arrays placed together, like the
+	// objects of a stress scene desk, with the box around
+	// everywhere they can be - the entities are never removed
+	// once the scene is prepared, so the ranges hold
+	struct ENTITY_GROUP
+	{
+		int first;
+		int count;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+	std::vector<ENTITY_GROUP> m_entityGroups;
+	// optional grid of varied desks placed instead of the one
+	// desk, and the offset of the desk being placed
+	StressScene* m_pStressScene;
+	glm::vec3 m_placementOffset;
+	// optional archive the assets are read from in place
+	AssetPack* m_pAssetPack;
+	// frames built, which time the moving objects
+	int m_builtFrames;
+	// static objects edited since the last packet was built
+	std::vector<STATIC_EDIT> m_pendingEdits;
+	// packets built with static edits, and the ones whose edits
+	// the render thread has applied - the next frame is built
+	// only after the edits were applied
+	int m_queuedEditPackets;
+	int m_appliedEditPackets;
+	std::mutex m_editMutex;
+	std::condition_variable m_editsApplied;
+	// a static object the edit key slides along the desk, with
+	// the placement it slides from
+	struct EDITABLE_OBJECT
+	{
+		EntityStore::ENTITY_ID entity;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+	};
+	std::vector<EDITABLE_OBJECT> m_editableObjects;
+	bool m_bEditableObjectsMoved;
+	// count the overdraw, which costs a query every frame, and
+	// print the render counters every few hundred frames
+	bool m_bDebugCounters;
+	// what draws the scene, and the optional CPU rasterizer
+	// with the texture its frames are shown through
+	RENDER_BACKEND m_renderBackend;
+	SoftwareRasterizer* m_pSoftwareRasterizer;
+	GLuint m_softwareTexture;
+	GLuint m_softwareFramebuffer;
+	int m_softwareTextureWidth;
+	int m_softwareTextureHeight;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, std::string tag);
+	// decode an image file, or its copy in the asset pack -
+	// calls no OpenGL, so it can run on any thread
+	bool DecodeImage(const char* filename, TEXTURE_IMAGE& image);
+	// upload a decoded image into the next texture slot and
+	// free its pixels
+	bool UploadGLTexture(const char* filename, std::string tag, TEXTURE_IMAGE& image);
+	// decode one scene texture, and upload the decoded ones in
+	// the order of the scene tables
+	void DecodeSceneTexture(int index);
+	void UploadSceneTextures();
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(const char* tag);
+	int FindTextureSlot(const char* tag);
+	// find a defined material by tag
+	const OBJECT_MATERIAL* FindMaterial(const char* tag);
+	int FindMaterialIndex(const char* tag);
+	// get the material of the current draw state
+	const OBJECT_MATERIAL& GetDrawMaterial();
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		const char* textureTag);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		const char* materialTag);
+
+	// set a light source into the shaders and keep it for
+	// the lightmap bake
+	void SetLightSource(
+		int index,
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity);
+
+	// load a basic shape into the shared mesh buffer
+	void LoadShapeMesh(SHAPE_MESH mesh);
+	// add a draw of a mesh with the current draw state to
+	// the frame's indirect draws
+	void AddMeshDraw(int meshID);
+	// add a draw of part of the indices of a mesh
+	void AddMeshDraw(int meshID, unsigned int firstIndex, unsigned int indexCount, glm::vec3 center);
+	// draw the basic shape mesh with the current draw state,
+	// or record it as a static object while batching
+	void DrawShapeMesh(SHAPE_MESH mesh);
+	// add an entity drawing a mesh with the current draw state
+	EntityStore::ENTITY_ID AddDrawEntity(int meshID, unsigned int flags);
+	// find the basic shape loaded as a mesh, or
+	// SHAPE_MESH_COUNT for the imported meshes
+	SHAPE_MESH FindShapeMesh(int meshID);
+
+	// import the mesh of the model file into memory - calls
+	// no OpenGL, so it can run on a worker thread
+	bool DecodeImportedMesh();
+	// copy the imported mesh into the shared mesh buffer
+	bool UploadImportedMesh(std::string tag);
+	// draw an imported mesh with the current draw state
+	void DrawImportedMesh(const char* tag);
+	// place the imported mesh on the desk, scaled to fit
+	void PlaceImportedMesh();
+
+	// record the static objects as entities and bake them
+	// into merged batches
+	void BuildStaticBatches();
+	// group the entities placed from the passed in one on
+	void AddEntityGroup(int firstEntity);
+	// set the box around each group of entities
+	void UpdateEntityGroupBounds();
+	// keep the entities of the first desk's editable objects
+	void FindEditableObjects(int firstEntity);
+	// add the opaque static batches to a lightmapper, with the
+	// first lightmap coordinate of each batch
+	void AddLightmapSurfaces(Lightmapper* pLightmapper, std::vector<int>& batchLightmaps);
+	// bake the lighting of the opaque static batches, or load
+	// it from the cache when nothing changed
+	void BakeLightmap();
+	// start baking the lightmap of the edited batches in the
+	// background, or queue it behind the running bake
+	void StartLightmapRebake();
+	// find the static objects hidden in the current frame
+	void CullStaticObjects();
+	// leave the hidden static entities out of the frame
+	void HideStaticEntities();
+	// draw the visible objects of each static batch with the
+	// batch's shader state
+	void RenderStaticBatches();
+	// draw the visible entities that are not batched
+	void RenderEntities();
+	// draw the visible entities of a range of the arrays
+	void RenderEntityRange(int first, int count);
+	// draw a built packet with the software rasterizer and
+	// copy it into the bound framebuffer
+	void RenderSoftwareFrame(FRAME_PACKET& packet);
+	// free the texture the software frames are shown through
+	void DestroySoftwareTarget();
+
+public:
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	// add the steps of PrepareScene() to a startup graph, after
+	// the passed in tasks that create the context and open the
+	// asset pack, and get the task that finishes the scene
+	int AddPrepareTasks(StartupGraph* pGraph, int contextTask, int assetTask);
+	// replicate the static objects into a seeded stress scene -
+	// set it before PrepareScene()
+	void SetStressScene(const StressScene::SETTINGS& settings);
+	// import an OBJ or glTF file and place it on the desk - set
+	// it before PrepareScene()
+	void SetImportedMesh(const char* filename);
+	// read the assets from the passed in asset pack - set it
+	// before PrepareScene()
+	void SetAssetPack(AssetPack* pAssetPack);
+	// choose what draws the scene, with the threads of the
+	// software rasterizer, 0 for every core - set it before
+	// PrepareScene()
+	void SetRenderBackend(RENDER_BACKEND backend, int threadCount);
+	// count the shaded samples per pixel and print the render
+	// counters periodically - set it before the render thread
+	// starts
+	void SetDebugCounters(bool bDebugCounters);
+	// add the files the scene loads to the passed in list
+	static void GetAssetFiles(std::vector<std::string>& assetFiles);
+	// collect the visible draws of the frame into a packet,
+	// without any OpenGL call - runs on the main thread
+	void BuildFrame(FRAME_PACKET& packet);
+	// submit the draws of a built packet - runs on the thread
+	// that owns the OpenGL context
+	void RenderFrame(FRAME_PACKET& packet);
+	// move the static objects edited for a packet, upload the
+	// changed batches and start baking the lightmap again -
+	// runs on the thread that owns the OpenGL context, after
+	// the packet
+	void ApplyStaticEdits(FRAME_PACKET& packet);
+	// upload the lightmap baked after static edits once its
+	// threads are done, without waiting for them - runs on the
+	// thread that owns the OpenGL context, after each packet
+	void UpdateLightmapRebake();
+	// get the indirect draws, for the counters of the last
+	// submission - render thread only
+	IndirectDraws* GetIndirectDraws();
+	// set the views the scene is rendered with - the first
+	// position is the camera the draws are sorted by
+	void SetSceneViews(const glm::mat4* pViewProjections, const glm::vec4* pViewRects, const glm::vec3* pViewPositions, int viewCount);
+	// loads textures from image files
+	void LoadSceneTextures();
+
+	// pre-set light sources for 3D scene
+	void SetupSceneLights();
+	// pre-define the object materials for lighting
+	void DefineObjectMaterials();
+	// place the objects that never move in the 3D scene
+	void PlaceStaticObjects();
+
+	// move a static object after the scene was prepared -
+	// only the edited object is baked again on the render
+	// thread after the next packet is drawn, and the lightmap
+	// is baked again in the background
+	void EditStaticObject(
+		EntityStore::ENTITY_ID entity,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// slide the editable objects of the first desk to their
+	// other spot, through EditStaticObject()
+	void MoveEditableObjects();
+
+
 };
\ No newline at end of file
@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenetables.h
+// ============
+// the built-in scene's textures, materials and objects as constant tables,
+// with the world matrices and lookups of the objects baked at compile time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeGeometry.h"
+
+#include <cstddef>
+#include <utility>
+
+/***********************************************************
+ *  SceneTables
+ *
+ *  This namespace contains the literal description of the
+ *  built-in scene.  The objects are written as placements
+ *  that name their material and texture by tag, and are
+ *  baked by the compiler into a read-only array holding the
+ *  world matrix of every object and the indices of its
+ *  material and texture, so placing the scene at runtime is
+ *  a walk over the array without matrix math or string
+ *  compares.  The world matrices are composed in the order
+ *  translation * rotationX * rotationY * rotationZ * scale,
+ *  the same order TransformBatch builds them in.  Static
+ *  assertions check that every tag names a table entry.
+ ***********************************************************/
+namespace SceneTables
+{
+	// image file of a scene texture and its tag - the asset
+	// pack is built from the same list
+	struct SCENE_TEXTURE
+	{
+		const char* filename;
+		const char* tag;
+	};
+
+	// values of a defined material
+	struct SCENE_MATERIAL
+	{
+		float ambientColor[3];
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+		float ambientStrength;
+		const char* tag;
+	};
+
+	// object of the scene as it is written - rotations are in
+	// degrees around the X, Y and Z axes
+	struct OBJECT_PLACEMENT
+	{
+		SHAPE_MESH mesh;
+		float scaleXYZ[3];
+		float rotationDegrees[3];
+		float positionXYZ[3];
+		const char* materialTag;
+		const char* textureTag;
+	};
+
+	// object of the scene as it is placed - the world matrix
+	// is stored by column, like glm, and the components are
+	// kept for the entity store
+	struct BAKED_OBJECT
+	{
+		SHAPE_MESH mesh;
+		float model[16];
+		float scaleXYZ[3];
+		float rotationDegrees[3];
+		float positionXYZ[3];
+		int materialIndex;
+		int textureIndex;
+	};
+
+	/*** Textures ****************************************************/
+	/******************************************************************/
+
+	constexpr SCENE_TEXTURE TEXTURES[] =
+	{
+		{ "../../Utilities/textures/floor.jpg", "floor" },
+		{ "../../Utilities/textures/knife_handle.jpg", "wood" },
+		{ "../../Utilities/textures/stainless.jpg", "stainless" },
+		{ "../../Utilities/textures/stainless_end.jpg", "stainlessend" },
+		{ "../../Utilities/textures/Galaga.jpg", "game" },
+		{ "../../Utilities/textures/Blackgloss.jpg", "Blackgloss" },
+		{ "../../Utilities/textures/Whitetex.jpg", "Whitetex" },
+		{ "../../Utilities/textures/WhiteMarble.jpg", "Whitemarb" }
+	};
+	constexpr int TEXTURE_COUNT = (int)(sizeof(TEXTURES) / sizeof(TEXTURES[0]));
+
+	/*** Materials ***************************************************/
+	/******************************************************************/
+
+	//Reference:https://learn.snhu.edu/content/enforced/1644154-CS-330-11664.202456-1/course_documents/CS%20330%20Applying%20Lighting%20to%20a%203D%20Scene.pdf?isCourseFile=true&ou=1644154
+
+	constexpr SCENE_MATERIAL MATERIALS[] =
+	{
+		// Light Material - low ambient, neutral diffuse and some
+		// specular highlights
+		{ { 0.1f, 0.1f, 0.1f }, { 0.8f, 0.8f, 0.8f }, { 0.5f, 0.5f, 0.5f }, 10.0f, 0.1f, "LightMaterial" },
+		// Monitor Material - dark diffuse and high specular for
+		// screen reflections
+		{ { 0.1f, 0.1f, 0.1f }, { 0.2f, 0.2f, 0.2f }, { 0.9f, 0.9f, 0.9f }, 32.0f, 0.0f, "MonitorMaterial" },
+		// Reflective Material for Floor - high specular and
+		// shininess for reflections
+		{ { 0.1f, 0.1f, 0.1f }, { 0.8f, 0.8f, 0.8f }, { 1.0f, 1.0f, 1.0f }, 64.0f, 0.1f, "ReflectPlane" },
+		// Desk Material - brown with low specular
+		{ { 0.6f, 0.3f, 0.1f }, { 0.6f, 0.3f, 0.1f }, { 0.3f, 0.2f, 0.1f }, 8.0f, 0.0f, "DeskMaterial" },
+		// Monitor Stand Material - light gray with specular
+		// highlights of the metal stand
+		{ { 0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { 0.7f, 0.7f, 0.7f }, 16.0f, 0.0f, "StandMaterial" },
+		// PS5 Material - medium dark ambient, light gray diffuse
+		// and balanced shininess
+		{ { 0.2f, 0.2f, 0.2f }, { 0.5f, 0.5f, 0.5f }, { 0.7f, 0.7f, 0.7f }, 32.0f, 0.0f, "PS5Material" },
+		// Speaker Material - white with high specular
+		{ { 0.9f, 0.9f, 0.9f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, 64.0f, 0.0f, "SpeakerMaterial" }
+	};
+	constexpr int MATERIAL_COUNT = (int)(sizeof(MATERIALS) / sizeof(MATERIALS[0]));
+
+	/*** Objects *****************************************************/
+	/******************************************************************/
+
+	constexpr OBJECT_PLACEMENT PLACEMENTS[] =
+	{
+		// PS5 body, left and right panels, and stand
+		{ BOX_MESH, { 0.3f, 1.5f, 0.6f }, { 0.0f, 0.0f, 0.0f }, { -2.0f, 2.25f, 0.25f }, "PS5Material", "Blackgloss" },
+		{ BOX_MESH, { 0.03f, 1.7f, 0.7f }, { 0.0f, 0.0f, 0.0f }, { -2.15f, 2.26f, 0.25f }, "PS5Material", "Whitetex" },
+		{ BOX_MESH, { 0.03f, 1.7f, 0.7f }, { 0.0f, 0.0f, 0.0f }, { -1.85f, 2.26f, 0.25f }, "PS5Material", "Whitetex" },
+		{ CYLINDER_MESH, { 0.3f, 0.05f, 0.3f }, { 0.0f, 0.0f, 0.0f }, { -2.0f, 1.6f, 0.25f }, "PS5Material", "Blackgloss" },
+
+		// monitor bezel, Galaga screen, stand base and support
+		{ BOX_MESH, { 3.0f, 1.8f, 0.1f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 2.7f, 0.0f }, "MonitorMaterial", "stainlessend" },
+		{ BOX_MESH, { 2.8f, 1.6f, 0.1f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 2.7f, 0.05f }, "MonitorMaterial", "game" },
+		{ BOX_MESH, { 1.0f, 0.1f, 0.5f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.6f, -0.14f }, "StandMaterial", "stainless" },
+		{ CYLINDER_MESH, { 0.1f, 0.9f, 0.1f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.6f, -0.14f }, "StandMaterial", "stainless" },
+
+		// white speaker base and top
+		{ CYLINDER_MESH, { 0.2f, 0.05f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { -1.3f, 1.63f, 0.3f }, "SpeakerMaterial", "Whitemarb" },
+		{ SPHERE_MESH, { 0.2f, 0.15f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { -1.3f, 1.73f, 0.3f }, "SpeakerMaterial", "Whitemarb" },
+
+		// desk top, then the front left, front right, back left
+		// and back right legs
+		{ BOX_MESH, { 6.0f, 0.2f, 2.5f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.5f, 0.0f }, "DeskMaterial", "wood" },
+		{ BOX_MESH, { 0.2f, 1.5f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { -2.8f, 0.75f, 1.2f }, "DeskMaterial", "wood" },
+		{ BOX_MESH, { 0.2f, 1.5f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { 2.8f, 0.75f, 1.2f }, "DeskMaterial", "wood" },
+		{ BOX_MESH, { 0.2f, 1.5f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { -2.8f, 0.75f, -1.2f }, "DeskMaterial", "wood" },
+		{ BOX_MESH, { 0.2f, 1.5f, 0.2f }, { 0.0f, 0.0f, 0.0f }, { 2.8f, 0.75f, -1.2f }, "DeskMaterial", "wood" },
+
+		// floor plane reflecting the light
+		{ PLANE_MESH, { 20.0f, 1.0f, 10.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, "ReflectPlane", "floor" }
+	};
+	constexpr int OBJECT_COUNT = (int)(sizeof(PLACEMENTS) / sizeof(PLACEMENTS[0]));
+
+	/*** Baking ******************************************************/
+	/******************************************************************/
+
+	// whether two tags are the same
+	constexpr bool TagsEqual(const char* pFirst, const char* pSecond)
+	{
+		while ((*pFirst != '\0') && (*pFirst == *pSecond))
+		{
+			pFirst++;
+			pSecond++;
+		}
+		return(*pFirst == *pSecond);
+	}
+
+	// index of the texture or material with the passed in
+	// tag, or -1
+	constexpr int FindTexture(const char* tag)
+	{
+		for (int i = 0; i < TEXTURE_COUNT; i++)
+		{
+			if (TagsEqual(TEXTURES[i].tag, tag) == true)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+	constexpr int FindMaterial(const char* tag)
+	{
+		for (int i = 0; i < MATERIAL_COUNT; i++)
+		{
+			if (TagsEqual(MATERIALS[i].tag, tag) == true)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+
+	// sine and cosine of an angle in degrees, from their
+	// Taylor series after folding the angle into -180 to 180
+	constexpr double SinCosDegrees(double degrees, bool bCosine)
+	{
+		const double PI = 3.14159265358979323846;
+		while (degrees > 180.0)
+		{
+			degrees -= 360.0;
+		}
+		while (degrees < -180.0)
+		{
+			degrees += 360.0;
+		}
+
+		double x = degrees * PI / 180.0;
+		double term = (bCosine == true) ? 1.0 : x;
+		double sum = term;
+		for (int n = (bCosine == true) ? 1 : 2; n < 40; n += 2)
+		{
+			term *= -x * x / (double)(n * (n + 1));
+			sum += term;
+		}
+		return(sum);
+	}
+
+	// bake one placement - the columns match the closed form
+	// TransformBatch writes
+	constexpr BAKED_OBJECT BakeObject(const OBJECT_PLACEMENT& placement)
+	{
+		double sinX = SinCosDegrees(placement.rotationDegrees[0], false);
+		double cosX = SinCosDegrees(placement.rotationDegrees[0], true);
+		double sinY = SinCosDegrees(placement.rotationDegrees[1], false);
+		double cosY = SinCosDegrees(placement.rotationDegrees[1], true);
+		double sinZ = SinCosDegrees(placement.rotationDegrees[2], false);
+		double cosZ = SinCosDegrees(placement.rotationDegrees[2], true);
+		double scaleX = placement.scaleXYZ[0];
+		double scaleY = placement.scaleXYZ[1];
+		double scaleZ = placement.scaleXYZ[2];
+
+		BAKED_OBJECT baked = {};
+		baked.mesh = placement.mesh;
+
+		baked.model[0] = (float)(cosY * cosZ * scaleX);
+		baked.model[1] = (float)((cosX * sinZ + sinX * sinY * cosZ) * scaleX);
+		baked.model[2] = (float)((sinX * sinZ - cosX * sinY * cosZ) * scaleX);
+		baked.model[3] = 0.0f;
+		baked.model[4] = (float)(-cosY * sinZ * scaleY);
+		baked.model[5] = (float)((cosX * cosZ - sinX * sinY * sinZ) * scaleY);
+		baked.model[6] = (float)((sinX * cosZ + cosX * sinY * sinZ) * scaleY);
+		baked.model[7] = 0.0f;
+		baked.model[8] = (float)(sinY * scaleZ);
+		baked.model[9] = (float)(-sinX * cosY * scaleZ);
+		baked.model[10] = (float)(cosX * cosY * scaleZ);
+		baked.model[11] = 0.0f;
+		baked.model[12] = placement.positionXYZ[0];
+		baked.model[13] = placement.positionXYZ[1];
+		baked.model[14] = placement.positionXYZ[2];
+		baked.model[15] = 1.0f;
+
+		for (int i = 0; i < 3; i++)
+		{
+			baked.scaleXYZ[i] = placement.scaleXYZ[i];
+			baked.rotationDegrees[i] = placement.rotationDegrees[i];
+			baked.positionXYZ[i] = placement.positionXYZ[i];
+		}
+
+		baked.materialIndex = FindMaterial(placement.materialTag);
+		baked.textureIndex = FindTexture(placement.textureTag);
+
+		return(baked);
+	}
+
+	// array of the baked objects, returned by value so the
+	// whole table is one constant expression
+	struct BAKED_TABLE
+	{
+		BAKED_OBJECT objects[OBJECT_COUNT];
+	};
+
+	template<std::size_t... INDICES>
+	constexpr BAKED_TABLE BakeTable(std::index_sequence<INDICES...>)
+	{
+		return(BAKED_TABLE{ { BakeObject(PLACEMENTS[INDICES])... } });
+	}
+
+	constexpr BAKED_TABLE OBJECTS = BakeTable(std::make_index_sequence<OBJECT_COUNT>());
+
+	/*** Consistency *************************************************/
+	/******************************************************************/
+
+	// whether every texture and material tag is unique
+	constexpr bool TextureTagsUnique()
+	{
+		for (int i = 0; i < TEXTURE_COUNT; i++)
+		{
+			if (FindTexture(TEXTURES[i].tag) != i)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+	constexpr bool MaterialTagsUnique()
+	{
+		for (int i = 0; i < MATERIAL_COUNT; i++)
+		{
+			if (FindMaterial(MATERIALS[i].tag) != i)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	// whether every object names a defined material and a
+	// scene texture, draws a basic shape and has no zero scale
+	constexpr bool ObjectsValid()
+	{
+		for (int i = 0; i < OBJECT_COUNT; i++)
+		{
+			const BAKED_OBJECT& object = OBJECTS.objects[i];
+			if ((object.materialIndex < 0) || (object.textureIndex < 0) ||
+				(object.mesh < 0) || (object.mesh >= SHAPE_MESH_COUNT) ||
+				(object.scaleXYZ[0] == 0.0f) || (object.scaleXYZ[1] == 0.0f) || (object.scaleXYZ[2] == 0.0f))
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	static_assert(TextureTagsUnique() == true, "two scene textures have the same tag");
+	static_assert(MaterialTagsUnique() == true, "two scene materials have the same tag");
+	static_assert(ObjectsValid() == true, "a scene object names a missing material or texture, or has a zero scale");
+}
\ No newline at end of file
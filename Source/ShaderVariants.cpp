@@ -0,0 +1,520 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compile and cache specialized shader programs for each combination
+// of texturing, lighting and active light count
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+#include "GpuResources.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// the light count is packed above the feature flags in the variant key
+	const int LIGHT_COUNT_SHIFT = 8;
+	// offset of each multi-draw call into the draw records
+	const char* g_FirstDrawName = "firstDraw";
+
+	// get the length of the source up to and including the line
+	// of the version directive, or 0 without one
+	size_t FindVersionLineEnd(const char* pSource, size_t sourceSize, bool& bNeedsNewline)
+	{
+		static const char VERSION[] = "#version";
+		const char* pEnd = pSource + sourceSize;
+		const char* pVersion = std::search(pSource, pEnd, VERSION, VERSION + sizeof(VERSION) - 1);
+		bNeedsNewline = false;
+		if (pVersion == pEnd)
+		{
+			return(0);
+		}
+
+		const char* pLineEnd = std::find(pVersion, pEnd, '\n');
+		if (pLineEnd == pEnd)
+		{
+			bNeedsNewline = true;
+			return(sourceSize);
+		}
+
+		return((size_t)(pLineEnd - pSource) + 1);
+	}
+}
+
+/***********************************************************
+ *  ShaderVariants()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderVariants::ShaderVariants(const char* vertexShaderFile, const char* fragmentShaderFile)
+{
+	m_vertexShaderFile = vertexShaderFile;
+	m_fragmentShaderFile = fragmentShaderFile;
+	m_pAssetPack = NULL;
+	m_pVertexText = NULL;
+	m_vertexTextSize = 0;
+	m_pFragmentText = NULL;
+	m_fragmentTextSize = 0;
+	m_bSourceLoaded = false;
+	m_pActiveVariant = NULL;
+	m_activeKey = 0;
+	m_sharedVersion = 0;
+}
+
+/***********************************************************
+ *  ~ShaderVariants()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderVariants::~ShaderVariants()
+{
+	std::map<unsigned int, SHADER_VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); it++)
+	{
+		if (NULL != it->second.pShader)
+		{
+			GpuResources::Release(GpuResources::RESOURCE_PROGRAM, it->second.pShader->m_programID);
+			glDeleteProgram(it->second.pShader->m_programID);
+			it->second.pShader->m_programID = 0;
+			delete it->second.pShader;
+			it->second.pShader = NULL;
+		}
+	}
+	m_variants.clear();
+	m_failedKeys.clear();
+	m_pActiveVariant = NULL;
+}
+
+/***********************************************************
+ *  SetAssetPack()
+ *
+ *  This method is used for setting the asset pack the GLSL
+ *  source is read from, instead of the loose files.
+ ***********************************************************/
+void ShaderVariants::SetAssetPack(AssetPack* pAssetPack)
+{
+	m_pAssetPack = pAssetPack;
+}
+
+/***********************************************************
+ *  LoadSource()
+ *
+ *  This method is used for loading the GLSL source before
+ *  the first variant is compiled, so the files are read
+ *  while the window and context are still being created.
+ ***********************************************************/
+bool ShaderVariants::LoadSource()
+{
+	if (m_bSourceLoaded == true)
+	{
+		return(true);
+	}
+
+	return(LoadSourceFiles());
+}
+
+/***********************************************************
+ *  LoadSourceFiles()
+ *
+ *  This method is used for finding the GLSL source code.
+ *  Source in the asset pack is compiled straight from the
+ *  archive, and otherwise the files are read into memory.
+ *  The source is only found once, no matter how many
+ *  variants are compiled from it.
+ ***********************************************************/
+bool ShaderVariants::LoadSourceFiles()
+{
+	const unsigned char* pVertexData = NULL;
+	const unsigned char* pFragmentData = NULL;
+	if ((NULL != m_pAssetPack) &&
+		(m_pAssetPack->Find(m_vertexShaderFile.c_str(), &pVertexData, &m_vertexTextSize) == true) &&
+		(m_pAssetPack->Find(m_fragmentShaderFile.c_str(), &pFragmentData, &m_fragmentTextSize) == true))
+	{
+		m_pVertexText = (const char*)pVertexData;
+		m_pFragmentText = (const char*)pFragmentData;
+		m_bSourceLoaded = true;
+		return(true);
+	}
+
+	std::ifstream vertexFile(m_vertexShaderFile.c_str());
+	std::ifstream fragmentFile(m_fragmentShaderFile.c_str());
+
+	if ((!vertexFile.is_open()) || (!fragmentFile.is_open()))
+	{
+		std::cout << "Could not open shader files:" << m_vertexShaderFile << ", " << m_fragmentShaderFile << std::endl;
+		return(false);
+	}
+
+	std::stringstream vertexStream;
+	std::stringstream fragmentStream;
+	vertexStream << vertexFile.rdbuf();
+	fragmentStream << fragmentFile.rdbuf();
+
+	m_vertexSource = vertexStream.str();
+	m_fragmentSource = fragmentStream.str();
+	m_pVertexText = m_vertexSource.data();
+	m_vertexTextSize = m_vertexSource.size();
+	m_pFragmentText = m_fragmentSource.data();
+	m_fragmentTextSize = m_fragmentSource.size();
+	m_bSourceLoaded = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileStage()
+ *
+ *  This method is used for compiling a single shader stage
+ *  and reporting any compilation errors.  GLSL requires the
+ *  version directive to come first, so the variant defines
+ *  are passed as a separate string between the version line
+ *  and the rest of the source, which is never copied.
+ ***********************************************************/
+GLuint ShaderVariants::CompileStage(GLenum stageType, const char* pSource, size_t sourceSize, const std::string& defines)
+{
+	GLuint shaderID = glCreateShader(stageType);
+	GLint success = 0;
+
+	bool bNeedsNewline = false;
+	size_t versionEnd = FindVersionLineEnd(pSource, sourceSize, bNeedsNewline);
+	const char* sourceParts[4] = { pSource, (bNeedsNewline == true) ? "\n" : "", defines.c_str(), pSource + versionEnd };
+	GLint partLengths[4] = { (GLint)versionEnd, (bNeedsNewline == true) ? 1 : 0, (GLint)defines.size(), (GLint)(sourceSize - versionEnd) };
+
+	glShaderSource(shaderID, 4, sourceParts, partLengths);
+	glCompileShader(shaderID);
+
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[1024];
+		glGetShaderInfoLog(shaderID, 1024, NULL, infoLog);
+		std::cout << "ERROR::SHADER_COMPILATION_ERROR:\n" << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  CompileVariant()
+ *
+ *  This method is used for compiling and linking the shader
+ *  program specialized for the passed in flags and number
+ *  of active light sources.
+ ***********************************************************/
+GLuint ShaderVariants::CompileVariant(unsigned int flags, int lightCount)
+{
+	std::string defines;
+
+	if ((flags & VARIANT_TEXTURE) != 0)
+	{
+		defines += "#define USE_TEXTURE\n";
+	}
+	if ((flags & VARIANT_LIGHTING) != 0)
+	{
+		defines += "#define USE_LIGHTING\n";
+	}
+	if ((flags & VARIANT_COMPACT_VERTICES) != 0)
+	{
+		defines += "#define COMPACT_VERTICES\n";
+	}
+	if ((flags & VARIANT_LIGHTMAP) != 0)
+	{
+		defines += "#define USE_LIGHTMAP\n";
+	}
+	defines += "#define NUM_LIGHTS " + std::to_string(lightCount) + "\n";
+	defines += "#define MAX_TEXTURE_SLOTS " + std::to_string(MAX_TEXTURE_SLOTS) + "\n";
+
+	GLuint vertexID = CompileStage(GL_VERTEX_SHADER, m_pVertexText, m_vertexTextSize, defines);
+	GLuint fragmentID = CompileStage(GL_FRAGMENT_SHADER, m_pFragmentText, m_fragmentTextSize, defines);
+	if ((vertexID == 0) || (fragmentID == 0))
+	{
+		glDeleteShader(vertexID);
+		glDeleteShader(fragmentID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	GLint success = 0;
+
+	glAttachShader(programID, vertexID);
+	glAttachShader(programID, fragmentID);
+	glLinkProgram(programID);
+
+	// the stages are no longer needed once they are linked
+	glDeleteShader(vertexID);
+	glDeleteShader(fragmentID);
+
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[1024];
+		glGetProgramInfoLog(programID, 1024, NULL, infoLog);
+		std::cout << "ERROR::PROGRAM_LINKING_ERROR:\n" << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	// the size of the program binary stands in for the driver's
+	// memory of the program
+	GLint binaryBytes = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+	GpuResources::Track(GpuResources::RESOURCE_PROGRAM, programID, (size_t)binaryBytes, "ShaderVariants");
+
+	std::cout << "Compiled shader variant: texture=" << ((flags & VARIANT_TEXTURE) != 0)
+		<< ", lighting=" << ((flags & VARIANT_LIGHTING) != 0)
+		<< ", compact=" << ((flags & VARIANT_COMPACT_VERTICES) != 0)
+		<< ", lightmap=" << ((flags & VARIANT_LIGHTMAP) != 0)
+		<< ", lights=" << lightCount << std::endl;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  ApplySharedUniforms()
+ *
+ *  This method is used for uploading the shared uniform
+ *  values that changed since the variant was last active.
+ *  The variant's program must be bound.  The locations of
+ *  uniforms shared since the last upload are looked up once
+ *  and kept with the variant.
+ ***********************************************************/
+void ShaderVariants::ApplySharedUniforms(SHADER_VARIANT& variant)
+{
+	if (variant.sharedVersion == m_sharedVersion)
+	{
+		return;
+	}
+
+	for (int i = (int)variant.sharedLocations.size(); i < m_sharedUniforms.size(); i++)
+	{
+		variant.sharedLocations.push_back(
+			glGetUniformLocation(variant.pShader->m_programID, m_sharedUniforms[i].name.c_str()));
+	}
+
+	for (int i = 0; i < m_sharedUniforms.size(); i++)
+	{
+		SHARED_UNIFORM& uniform = m_sharedUniforms[i];
+		GLint location = variant.sharedLocations[i];
+		if ((uniform.version > variant.sharedVersion) && (location >= 0))
+		{
+			switch (uniform.type)
+			{
+			case SHARED_FLOAT:
+				glUniform1f(location, uniform.floatValue);
+				break;
+			case SHARED_VEC3:
+				glUniform3fv(location, 1, glm::value_ptr(uniform.vec3Value));
+				break;
+			case SHARED_VEC4:
+				glUniform4fv(location, 1, glm::value_ptr(uniform.vec4Value));
+				break;
+			case SHARED_MAT4:
+				glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(uniform.mat4Value));
+				break;
+			}
+		}
+	}
+
+	variant.sharedVersion = m_sharedVersion;
+}
+
+/***********************************************************
+ *  UseVariant()
+ *
+ *  This method is used for activating the shader variant
+ *  for the passed in flags and light count.  Variants are
+ *  compiled the first time they are needed and then shared
+ *  by every draw with the same state.  A variant that fails
+ *  to build is reported once and NULL is returned for it, so
+ *  the caller skips its draws.  The location of the offset
+ *  of the multi-draws is passed back with the shader.
+ ***********************************************************/
+ShaderManager* ShaderVariants::UseVariant(unsigned int flags, int lightCount, GLint& firstDrawLocation)
+{
+	// the light count only matters when the lighting is on
+	if ((flags & VARIANT_LIGHTING) == 0)
+	{
+		lightCount = 0;
+	}
+
+	unsigned int key = flags | (lightCount << LIGHT_COUNT_SHIFT);
+
+	// the requested variant is already bound
+	if ((NULL != m_pActiveVariant) && (m_activeKey == key))
+	{
+		ApplySharedUniforms(*m_pActiveVariant);
+		firstDrawLocation = m_pActiveVariant->firstDrawLocation;
+		return(m_pActiveVariant->pShader);
+	}
+
+	std::map<unsigned int, SHADER_VARIANT>::iterator it = m_variants.find(key);
+	if (it == m_variants.end())
+	{
+		if ((m_bSourceLoaded == false) && (LoadSourceFiles() == false))
+		{
+			return(NULL);
+		}
+
+		// a variant that failed once fails the same way again
+		if (m_failedKeys.find(key) != m_failedKeys.end())
+		{
+			return(NULL);
+		}
+
+		SHADER_VARIANT variant;
+		variant.pShader = new ShaderManager();
+		variant.pShader->m_programID = CompileVariant(flags, lightCount);
+		variant.sharedVersion = 0;
+
+		if (variant.pShader->m_programID == 0)
+		{
+			delete variant.pShader;
+			m_failedKeys.insert(key);
+			std::cout << "Skipping draws of shader variant: texture=" << ((flags & VARIANT_TEXTURE) != 0)
+				<< ", lighting=" << ((flags & VARIANT_LIGHTING) != 0)
+				<< ", compact=" << ((flags & VARIANT_COMPACT_VERTICES) != 0)
+				<< ", lightmap=" << ((flags & VARIANT_LIGHTMAP) != 0)
+				<< ", lights=" << lightCount << std::endl;
+			return(NULL);
+		}
+
+		variant.firstDrawLocation = glGetUniformLocation(variant.pShader->m_programID, g_FirstDrawName);
+
+		it = m_variants.insert(std::make_pair(key, variant)).first;
+	}
+
+	m_pActiveVariant = &it->second;
+	m_activeKey = key;
+
+	m_pActiveVariant->pShader->use();
+	ApplySharedUniforms(*m_pActiveVariant);
+	firstDrawLocation = m_pActiveVariant->firstDrawLocation;
+
+	return(m_pActiveVariant->pShader);
+}
+
+/***********************************************************
+ *  GetActiveVariant()
+ *
+ *  This method is used for getting the currently bound
+ *  shader variant.
+ ***********************************************************/
+ShaderManager* ShaderVariants::GetActiveVariant()
+{
+	if (NULL == m_pActiveVariant)
+	{
+		return(NULL);
+	}
+
+	return(m_pActiveVariant->pShader);
+}
+
+/***********************************************************
+ *  ReleaseActiveVariant()
+ *
+ *  This method is used for forgetting the bound variant
+ *  when code outside of this class bound its own program,
+ *  since UseVariant() skips binding the variant it thinks
+ *  is still active.
+ ***********************************************************/
+void ShaderVariants::ReleaseActiveVariant()
+{
+	m_pActiveVariant = NULL;
+}
+
+/***********************************************************
+ *  FindSharedUniform()
+ *
+ *  This method is used for getting the shared uniform
+ *  associated with the passed in name, adding it to the
+ *  list if it was not set before.
+ ***********************************************************/
+ShaderVariants::SHARED_UNIFORM& ShaderVariants::FindSharedUniform(const char* name, SHARED_TYPE type)
+{
+	for (int i = 0; i < m_sharedUniforms.size(); i++)
+	{
+		if (m_sharedUniforms[i].name.compare(name) == 0)
+		{
+			return(m_sharedUniforms[i]);
+		}
+	}
+
+	SHARED_UNIFORM uniform;
+	uniform.name = name;
+	uniform.type = type;
+	uniform.floatValue = 0.0f;
+	uniform.version = 0;
+	m_sharedUniforms.push_back(uniform);
+
+	return(m_sharedUniforms.back());
+}
+
+/***********************************************************
+ *  SetSharedFloatValue()
+ *
+ *  This method is used for setting a float uniform that is
+ *  shared by all the shader variants.
+ ***********************************************************/
+void ShaderVariants::SetSharedFloatValue(const char* name, float value)
+{
+	SHARED_UNIFORM& uniform = FindSharedUniform(name, SHARED_FLOAT);
+	uniform.floatValue = value;
+	uniform.version = ++m_sharedVersion;
+}
+
+/***********************************************************
+ *  SetSharedVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform that is
+ *  shared by all the shader variants.
+ ***********************************************************/
+void ShaderVariants::SetSharedVec3Value(const char* name, glm::vec3 value)
+{
+	SHARED_UNIFORM& uniform = FindSharedUniform(name, SHARED_VEC3);
+	uniform.vec3Value = value;
+	uniform.version = ++m_sharedVersion;
+}
+
+/***********************************************************
+ *  SetSharedVec4Value()
+ *
+ *  This method is used for setting a vec4 uniform that is
+ *  shared by all the shader variants.
+ ***********************************************************/
+void ShaderVariants::SetSharedVec4Value(const char* name, glm::vec4 value)
+{
+	SHARED_UNIFORM& uniform = FindSharedUniform(name, SHARED_VEC4);
+	uniform.vec4Value = value;
+	uniform.version = ++m_sharedVersion;
+}
+
+/***********************************************************
+ *  SetSharedMat4Value()
+ *
+ *  This method is used for setting a mat4 uniform that is
+ *  shared by all the shader variants.
+ ***********************************************************/
+void ShaderVariants::SetSharedMat4Value(const char* name, glm::mat4 value)
+{
+	SHARED_UNIFORM& uniform = FindSharedUniform(name, SHARED_MAT4);
+	uniform.mat4Value = value;
+	uniform.version = ++m_sharedVersion;
+}
+
+/***********************************************************
+ *  GetCompiledCount()
+ *
+ *  This method is used for getting the number of shader
+ *  variants that have been compiled so far.
+ ***********************************************************/
+int ShaderVariants::GetCompiledCount()
+{
+	return((int)m_variants.size());
+}
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compile and cache specialized shader programs for each combination
+// of texturing, lighting and active light count
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "AssetPack.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+/***********************************************************
+ *  ShaderVariants
+ *
+ *  This class contains the code for building specialized
+ *  shader programs from one set of GLSL source files by
+ *  injecting preprocessor defines, so the shaders do not
+ *  have to branch on uniform flags for every fragment.
+ ***********************************************************/
+class ShaderVariants
+{
+public:
+	// constructor
+	ShaderVariants(const char* vertexShaderFile, const char* fragmentShaderFile);
+	// destructor
+	~ShaderVariants();
+
+	// feature flags used for selecting a shader variant
+	enum VARIANT_FLAGS
+	{
+		VARIANT_NONE = 0,
+		VARIANT_TEXTURE = 1 << 0,
+		VARIANT_LIGHTING = 1 << 1,
+		VARIANT_COMPACT_VERTICES = 1 << 2,
+		VARIANT_LIGHTMAP = 1 << 3
+	};
+
+	// views the shaders can draw in one pass, as instances of
+	// each draw - must match MAX_VIEWS in the GLSL shaders
+	static const int MAX_VIEWS = 4;
+	// texture slots the shaders sample, defined into every
+	// variant as MAX_TEXTURE_SLOTS - the lightmap is bound to
+	// the unit after them, the last of the 16 units OpenGL
+	// guarantees for a shader stage
+	static const int MAX_TEXTURE_SLOTS = 15;
+
+private:
+	// types of the uniforms shared by every variant
+	enum SHARED_TYPE
+	{
+		SHARED_FLOAT,
+		SHARED_VEC3,
+		SHARED_VEC4,
+		SHARED_MAT4
+	};
+
+	struct SHARED_UNIFORM
+	{
+		std::string name;
+		SHARED_TYPE type;
+		float floatValue;
+		glm::vec3 vec3Value;
+		glm::vec4 vec4Value;
+		glm::mat4 mat4Value;
+		unsigned int version;
+	};
+
+	struct SHADER_VARIANT
+	{
+		ShaderManager* pShader;
+		unsigned int sharedVersion;
+		// location of the offset of each multi-draw into the
+		// draw records, looked up once when the variant is built
+		GLint firstDrawLocation;
+		// location of each shared uniform in the program, by
+		// its index - looked up the first time it is uploaded
+		std::vector<GLint> sharedLocations;
+	};
+
+	// paths of the GLSL source files
+	std::string m_vertexShaderFile;
+	std::string m_fragmentShaderFile;
+	// optional archive the source is read from in place
+	AssetPack* m_pAssetPack;
+	// GLSL source code read from the loose files
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	// the source compiled from, in the archive or the strings
+	const char* m_pVertexText;
+	size_t m_vertexTextSize;
+	const char* m_pFragmentText;
+	size_t m_fragmentTextSize;
+	bool m_bSourceLoaded;
+
+	// compiled variants, keyed by flags and light count
+	std::map<unsigned int, SHADER_VARIANT> m_variants;
+	// keys of the variants that failed to build, so they are
+	// not compiled and reported again on every draw
+	std::set<unsigned int> m_failedKeys;
+	// the variant that is currently bound
+	SHADER_VARIANT* m_pActiveVariant;
+	unsigned int m_activeKey;
+
+	// uniform values that every variant must share, like the
+	// view, projection and light sources
+	std::vector<SHARED_UNIFORM> m_sharedUniforms;
+	unsigned int m_sharedVersion;
+
+	// find the GLSL source in the asset pack, or read the
+	// source files into memory
+	bool LoadSourceFiles();
+	// compile and link a variant program
+	GLuint CompileVariant(unsigned int flags, int lightCount);
+	// compile a single shader stage with the variant defines
+	// after the version directive
+	GLuint CompileStage(GLenum stageType, const char* pSource, size_t sourceSize, const std::string& defines);
+	// upload the shared uniforms changed since the variant was last used
+	void ApplySharedUniforms(SHADER_VARIANT& variant);
+	// find or add a shared uniform by name
+	SHARED_UNIFORM& FindSharedUniform(const char* name, SHARED_TYPE type);
+
+public:
+	// read the GLSL source from the passed in asset pack - set it
+	// before the first variant is used
+	void SetAssetPack(AssetPack* pAssetPack);
+	// find or read the GLSL source ahead of the first variant -
+	// it calls no OpenGL, so it can run on any thread
+	bool LoadSource();
+
+	// get the variant for the passed in state, compiling it on
+	// first use, and make it the active shader program - NULL
+	// when the variant could not be built
+	ShaderManager* UseVariant(unsigned int flags, int lightCount, GLint& firstDrawLocation);
+	// get the currently active variant
+	ShaderManager* GetActiveVariant();
+	// forget the active variant after another program was bound,
+	// so the next UseVariant() binds its program again
+	void ReleaseActiveVariant();
+
+	// set uniform values that are shared by all variants
+	void SetSharedFloatValue(const char* name, float value);
+	void SetSharedVec3Value(const char* name, glm::vec3 value);
+	void SetSharedVec4Value(const char* name, glm::vec4 value);
+	void SetSharedMat4Value(const char* name, glm::mat4 value);
+
+	// number of variants compiled so far
+	int GetCompiledCount();
+};
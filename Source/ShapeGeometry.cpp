@@ -0,0 +1,237 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegeometry.cpp
+// ============
+// build the vertex and index data of the basic shapes in system memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShapeGeometry.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// tessellation of the round shapes
+	const int CYLINDER_SLICES = 36;
+	const int SPHERE_STACKS = 18;
+	const int SPHERE_SLICES = 36;
+	const float PI = 3.14159265358979f;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Append a vertex to the mesh and return its index.
+	 ***********************************************************/
+	unsigned int AddVertex(MESH_DATA& mesh, glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
+	{
+		MESH_VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.textureCoordinate = uv;
+		mesh.vertices.push_back(vertex);
+
+		return((unsigned int)mesh.vertices.size() - 1);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  Append a four sided face as two triangles.
+	 ***********************************************************/
+	void AddQuad(MESH_DATA& mesh, glm::vec3 corner, glm::vec3 edgeU, glm::vec3 edgeV, glm::vec3 normal)
+	{
+		unsigned int first = AddVertex(mesh, corner, normal, glm::vec2(0.0f, 0.0f));
+		AddVertex(mesh, corner + edgeU, normal, glm::vec2(1.0f, 0.0f));
+		AddVertex(mesh, corner + edgeU + edgeV, normal, glm::vec2(1.0f, 1.0f));
+		AddVertex(mesh, corner + edgeV, normal, glm::vec2(0.0f, 1.0f));
+
+		mesh.indices.push_back(first);
+		mesh.indices.push_back(first + 1);
+		mesh.indices.push_back(first + 2);
+		mesh.indices.push_back(first);
+		mesh.indices.push_back(first + 2);
+		mesh.indices.push_back(first + 3);
+	}
+}
+
+/***********************************************************
+ *  GetShape()
+ *
+ *  This method is used for getting the geometry of a basic
+ *  shape.  The geometry is generated on the first request
+ *  and kept for the lifetime of the application.
+ ***********************************************************/
+const MESH_DATA& ShapeGeometry::GetShape(SHAPE_MESH mesh)
+{
+	static MESH_DATA shapes[SHAPE_MESH_COUNT];
+	static bool bBuilt[SHAPE_MESH_COUNT] = { false };
+
+	if (bBuilt[mesh] == false)
+	{
+		switch (mesh)
+		{
+		case BOX_MESH:
+			BuildBox(shapes[mesh]);
+			break;
+		case PLANE_MESH:
+			BuildPlane(shapes[mesh]);
+			break;
+		case CYLINDER_MESH:
+			BuildCylinder(shapes[mesh], CYLINDER_SLICES);
+			break;
+		case SPHERE_MESH:
+			BuildSphere(shapes[mesh], SPHERE_STACKS, SPHERE_SLICES);
+			break;
+		default:
+			break;
+		}
+		bBuilt[mesh] = true;
+	}
+
+	return(shapes[mesh]);
+}
+
+/***********************************************************
+ *  BuildBox()
+ *
+ *  This method is used for generating a unit box centered
+ *  on the origin, with separate vertices for each face so
+ *  the normals stay flat.
+ ***********************************************************/
+void ShapeGeometry::BuildBox(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// front and back faces
+	AddQuad(mesh, glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	AddQuad(mesh, glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	// left and right faces
+	AddQuad(mesh, glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
+	AddQuad(mesh, glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	// top and bottom faces
+	AddQuad(mesh, glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	AddQuad(mesh, glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+}
+
+/***********************************************************
+ *  BuildPlane()
+ *
+ *  This method is used for generating a flat plane facing
+ *  up, covering -1 to 1 on the X and Z axes.
+ ***********************************************************/
+void ShapeGeometry::BuildPlane(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	AddQuad(mesh, glm::vec3(-1.0f, 0.0f, 1.0f), glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/***********************************************************
+ *  BuildCylinder()
+ *
+ *  This method is used for generating a closed cylinder
+ *  with a radius of 1, standing on the origin and reaching
+ *  up to a height of 1.
+ ***********************************************************/
+void ShapeGeometry::BuildCylinder(MESH_DATA& mesh, int slices)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// bottom and top caps
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float height = (float)cap;
+		glm::vec3 normal = glm::vec3(0.0f, (cap == 0) ? -1.0f : 1.0f, 0.0f);
+		unsigned int center = AddVertex(mesh, glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+
+		for (int i = 0; i <= slices; i++)
+		{
+			float angle = 2.0f * PI * (float)i / (float)slices;
+			float x = std::cos(angle);
+			float z = std::sin(angle);
+			AddVertex(mesh, glm::vec3(x, height, z), normal, glm::vec2(0.5f + x * 0.5f, 0.5f + z * 0.5f));
+		}
+
+		for (int i = 0; i < slices; i++)
+		{
+			mesh.indices.push_back(center);
+			// keep the winding counter-clockwise when seen from outside
+			if (cap == 0)
+			{
+				mesh.indices.push_back(center + 1 + i);
+				mesh.indices.push_back(center + 2 + i);
+			}
+			else
+			{
+				mesh.indices.push_back(center + 2 + i);
+				mesh.indices.push_back(center + 1 + i);
+			}
+		}
+	}
+
+	// sides
+	unsigned int first = (unsigned int)mesh.vertices.size();
+	for (int i = 0; i <= slices; i++)
+	{
+		float angle = 2.0f * PI * (float)i / (float)slices;
+		float x = std::cos(angle);
+		float z = std::sin(angle);
+		float u = (float)i / (float)slices;
+		AddVertex(mesh, glm::vec3(x, 0.0f, z), glm::vec3(x, 0.0f, z), glm::vec2(u, 0.0f));
+		AddVertex(mesh, glm::vec3(x, 1.0f, z), glm::vec3(x, 0.0f, z), glm::vec2(u, 1.0f));
+	}
+	for (int i = 0; i < slices; i++)
+	{
+		unsigned int bottom = first + i * 2;
+		mesh.indices.push_back(bottom);
+		mesh.indices.push_back(bottom + 1);
+		mesh.indices.push_back(bottom + 3);
+		mesh.indices.push_back(bottom);
+		mesh.indices.push_back(bottom + 3);
+		mesh.indices.push_back(bottom + 2);
+	}
+}
+
+/***********************************************************
+ *  BuildSphere()
+ *
+ *  This method is used for generating a sphere with a radius
+ *  of 1 centered on the origin.
+ ***********************************************************/
+void ShapeGeometry::BuildSphere(MESH_DATA& mesh, int stacks, int slices)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = PI * (float)stack / (float)stacks;
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = 2.0f * PI * (float)slice / (float)slices;
+			glm::vec3 normal = glm::vec3(
+				std::sin(phi) * std::cos(theta),
+				std::cos(phi),
+				std::sin(phi) * std::sin(theta));
+			AddVertex(mesh, normal, normal, glm::vec2((float)slice / (float)slices, 1.0f - (float)stack / (float)stacks));
+		}
+	}
+
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int slice = 0; slice < slices; slice++)
+		{
+			unsigned int top = stack * (slices + 1) + slice;
+			unsigned int bottom = top + slices + 1;
+			mesh.indices.push_back(top);
+			mesh.indices.push_back(top + 1);
+			mesh.indices.push_back(bottom);
+			mesh.indices.push_back(bottom);
+			mesh.indices.push_back(top + 1);
+			mesh.indices.push_back(bottom + 1);
+		}
+	}
+}
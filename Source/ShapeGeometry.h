@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegeometry.h
+// ============
+// build the vertex and index data of the basic shapes in system memory
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// basic shape meshes that can be drawn
+enum SHAPE_MESH
+{
+	BOX_MESH,
+	PLANE_MESH,
+	CYLINDER_MESH,
+	SPHERE_MESH,
+	SHAPE_MESH_COUNT
+};
+
+// vertex layout shared by all the meshes - position, normal
+// and texture coordinate, matching shader locations 0, 1 and 2
+struct MESH_VERTEX
+{
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 textureCoordinate;
+};
+
+struct MESH_DATA
+{
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<unsigned int> indices;
+};
+
+/***********************************************************
+ *  ShapeGeometry
+ *
+ *  This class contains the code for generating the basic
+ *  shapes in system memory with the same dimensions as the
+ *  ShapeMeshes GPU meshes, so they can be transformed and
+ *  merged on the CPU.
+ ***********************************************************/
+class ShapeGeometry
+{
+public:
+	// get the generated geometry of a basic shape - each shape
+	// is only generated once
+	static const MESH_DATA& GetShape(SHAPE_MESH mesh);
+
+	// unit box centered on the origin
+	static void BuildBox(MESH_DATA& mesh);
+	// plane from -1 to 1 on the X and Z axes
+	static void BuildPlane(MESH_DATA& mesh);
+	// cylinder with radius 1 from Y 0 to Y 1
+	static void BuildCylinder(MESH_DATA& mesh, int slices);
+	// sphere with radius 1 centered on the origin
+	static void BuildSphere(MESH_DATA& mesh, int stacks, int slices);
+};
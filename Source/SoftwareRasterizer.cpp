@@ -0,0 +1,1050 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.cpp
+// ============
+// draw the frame's draw list on the CPU with a tiled, multithreaded
+// rasterizer that follows the light model of the GLSL shaders
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// the four pixel coverage test is compiled in when the compiler
+// targets SSE2 - x64 always has it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SOFTWARE_RASTER_SSE
+#endif
+
+#if defined(SOFTWARE_RASTER_SSE)
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// most threads a frame is split over
+	const int MAX_THREADS = 64;
+	// vertex positions are snapped to a 1/256 pixel grid, like
+	// the subpixel precision of a GPU
+	const float SUBPIXEL_SCALE = 256.0f;
+	// the scene pass clears to opaque black and the far plane -
+	// the color bytes are R, G, B, A in memory
+	const unsigned int CLEAR_COLOR = 0xFF000000;
+	const float CLEAR_DEPTH = 1.0f;
+
+	// offsets of the interpolated values of a vertex
+	const int ATTRIBUTE_POSITION = 0;
+	const int ATTRIBUTE_NORMAL = 3;
+	const int ATTRIBUTE_TEXTURE = 6;
+	const int ATTRIBUTE_LIGHTMAP = 8;
+
+	// a texture coordinate far outside of the texture, or not
+	// a number, is read at the origin
+	const float MAX_TEXTURE_COORDINATE = 1.0e6f;
+
+	// wrap a texel index into the texture, for repeating textures
+	inline int WrapIndex(int index, int size)
+	{
+		index %= size;
+		return((index < 0) ? index + size : index);
+	}
+
+	inline int ClampIndex(int index, int size)
+	{
+		return((index < 0) ? 0 : ((index >= size) ? size - 1 : index));
+	}
+
+	// convert a color to RGBA8, rounded like an unsigned
+	// normalized framebuffer
+	inline unsigned int PackColor(glm::vec4 color)
+	{
+		glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + glm::vec4(0.5f);
+		return((unsigned int)clamped.r |
+			((unsigned int)clamped.g << 8) |
+			((unsigned int)clamped.b << 16) |
+			((unsigned int)clamped.a << 24));
+	}
+
+	inline glm::vec4 UnpackColor(unsigned int packed)
+	{
+		return(glm::vec4(
+			(float)(packed & 0xFF),
+			(float)((packed >> 8) & 0xFF),
+			(float)((packed >> 16) & 0xFF),
+			(float)(packed >> 24)) * (1.0f / 255.0f));
+	}
+
+	inline glm::vec4 FetchTexel(const unsigned char* pTexels, int width, int x, int y)
+	{
+		const unsigned char* pTexel = pTexels + ((size_t)y * width + x) * 4;
+		return(glm::vec4(pTexel[0], pTexel[1], pTexel[2], pTexel[3]) * (1.0f / 255.0f));
+	}
+}
+
+/***********************************************************
+ *  SoftwareRasterizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareRasterizer::SoftwareRasterizer(MeshBuffer* pMeshBuffer, int threadCount)
+{
+	m_pMeshBuffer = pMeshBuffer;
+
+	for (int i = 0; i < MAX_LIGHTS; i++)
+	{
+		m_lights[i].position = glm::vec3(0.0f);
+		m_lights[i].ambientColor = glm::vec3(0.0f);
+		m_lights[i].diffuseColor = glm::vec3(0.0f);
+		m_lights[i].specularColor = glm::vec3(0.0f);
+		m_lights[i].focalStrength = 1.0f;
+		m_lights[i].specularIntensity = 0.0f;
+	}
+	for (int i = 0; i < MAX_TEXTURE_SLOTS; i++)
+	{
+		m_textures[i].width = 0;
+		m_textures[i].height = 0;
+	}
+	m_pLightmapTexels = NULL;
+	m_lightmapSize = 0;
+	m_pLightmapCoordinates = NULL;
+	m_lightmapCoordinateCount = 0;
+
+	m_width = 0;
+	m_height = 0;
+	m_stride = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
+
+	m_pList = NULL;
+	m_viewCount = 1;
+	for (int i = 0; i < ShaderVariants::MAX_VIEWS; i++)
+	{
+		m_viewProjections[i] = glm::mat4(1.0f);
+		m_viewRects[i] = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+		m_viewPositions[i] = glm::vec3(0.0f);
+	}
+	m_lightCount = 0;
+	m_triangleCount = 0;
+	m_nextTile = 0;
+
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	m_threadCount = std::max(std::min(threadCount, MAX_THREADS), 1);
+	m_threadTriangles.resize(m_threadCount);
+
+	m_phase = PHASE_SETUP;
+	m_generation = 0;
+	m_busyCount = 0;
+	m_bStopping = false;
+
+	m_frameCount = 0;
+	m_totalTriangles = 0;
+	m_setupMilliseconds = 0.0;
+	m_rasterMilliseconds = 0.0;
+
+	// the calling thread of Render() is thread 0
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&SoftwareRasterizer::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~SoftwareRasterizer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	m_pMeshBuffer = NULL;
+	m_pList = NULL;
+	m_pLightmapTexels = NULL;
+	m_pLightmapCoordinates = NULL;
+}
+
+/***********************************************************
+ *  SetLight()
+ *
+ *  This method is used for setting a light source of the
+ *  Phong light model.
+ ***********************************************************/
+void SoftwareRasterizer::SetLight(int index, const LIGHT_SOURCE& light)
+{
+	if ((index < 0) || (index >= MAX_LIGHTS))
+	{
+		return;
+	}
+
+	m_lights[index] = light;
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method is used for copying a decoded image into a
+ *  texture slot as RGBA8.  Images without an alpha channel
+ *  are read as opaque, like the OpenGL RGB textures.
+ ***********************************************************/
+bool SoftwareRasterizer::SetTexture(int slot, const unsigned char* pPixels, int width, int height, int colorChannels)
+{
+	if ((slot < 0) || (slot >= MAX_TEXTURE_SLOTS) || (NULL == pPixels) ||
+		(width <= 0) || (height <= 0) || ((colorChannels != 3) && (colorChannels != 4)))
+	{
+		return(false);
+	}
+
+	RASTER_TEXTURE& texture = m_textures[slot];
+	texture.width = width;
+	texture.height = height;
+	texture.texels.resize((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		texture.texels[i * 4 + 0] = pPixels[i * colorChannels + 0];
+		texture.texels[i * 4 + 1] = pPixels[i * colorChannels + 1];
+		texture.texels[i * 4 + 2] = pPixels[i * colorChannels + 2];
+		texture.texels[i * 4 + 3] = (colorChannels == 4) ? pPixels[i * 4 + 3] : 255;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetLightmap()
+ *
+ *  This method is used for setting the baked lightmap and
+ *  the lightmap coordinate of every baked vertex.  The data
+ *  stays owned by the lightmapper.
+ ***********************************************************/
+void SoftwareRasterizer::SetLightmap(const glm::vec4* pTexels, int size, const glm::vec2* pCoordinates, int coordinateCount)
+{
+	m_pLightmapTexels = pTexels;
+	m_lightmapSize = (NULL != pTexels) ? size : 0;
+	m_pLightmapCoordinates = pCoordinates;
+	m_lightmapCoordinateCount = (NULL != pCoordinates) ? coordinateCount : 0;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for sizing the color and depth
+ *  buffers and the tile bins when the frame size changed.
+ ***********************************************************/
+void SoftwareRasterizer::Resize(int width, int height)
+{
+	if ((width == m_width) && (height == m_height))
+	{
+		return;
+	}
+
+	m_width = width;
+	m_height = height;
+	// padded rows let the four pixel steps run past the last
+	// pixel without leaving the row
+	m_stride = (width + 3) & ~3;
+	m_color.assign((size_t)m_stride * height, CLEAR_COLOR);
+	m_depth.assign((size_t)m_stride * height, CLEAR_DEPTH);
+	m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_bins.clear();
+	m_bins.resize((size_t)m_threadCount * m_tilesX * m_tilesY);
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing a sorted draw list.  The
+ *  values shared by each draw are set up first, then the
+ *  threads set up and bin their part of the triangles, and
+ *  last the threads rasterize the tiles.
+ ***********************************************************/
+void SoftwareRasterizer::Render(
+	const IndirectDraws::DRAW_LIST& list,
+	int viewCount,
+	const glm::mat4* pViewProjections,
+	const glm::vec4* pViewRects,
+	const glm::vec3* pViewPositions,
+	int lightCount,
+	int width,
+	int height)
+{
+	if ((width <= 0) || (height <= 0) || (NULL == m_pMeshBuffer))
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	Resize(width, height);
+
+	m_pList = &list;
+	m_viewCount = std::max(std::min(viewCount, (int)ShaderVariants::MAX_VIEWS), 1);
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		m_viewProjections[i] = pViewProjections[i];
+		m_viewRects[i] = pViewRects[i];
+		m_viewPositions[i] = pViewPositions[i];
+	}
+	m_lightCount = std::max(std::min(lightCount, (int)MAX_LIGHTS), 0);
+
+	// the draws keep the order of the list, and their triangles
+	// are numbered over all views
+	if (m_drawSetups.size() < (size_t)list.itemCount)
+	{
+		m_drawSetups.resize(list.itemCount);
+	}
+	int triangleCount = 0;
+	for (int i = 0; i < list.itemCount; i++)
+	{
+		const IndirectDraws::DRAW_ITEM& item = list.pItems[list.pOrder[i]];
+		DRAW_SETUP& setup = m_drawSetups[i];
+
+		setup.pItem = &item;
+		setup.normalMatrix = glm::transpose(glm::inverse(glm::mat3(item.record.model)));
+		setup.pTexture = NULL;
+		int slot = item.record.textureSlot;
+		if (((item.variantFlags & ShaderVariants::VARIANT_TEXTURE) != 0) &&
+			(slot >= 0) && (slot < MAX_TEXTURE_SLOTS) && (m_textures[slot].width > 0))
+		{
+			setup.pTexture = &m_textures[slot];
+		}
+		setup.firstTriangle = triangleCount;
+		triangleCount += (int)(item.indexCount / 3) * m_viewCount;
+	}
+	m_triangleCount = triangleCount;
+
+	RunPhase(PHASE_SETUP);
+	std::chrono::steady_clock::time_point setupEnd = std::chrono::steady_clock::now();
+
+	m_nextTile = 0;
+	RunPhase(PHASE_RASTER);
+	std::chrono::steady_clock::time_point rasterEnd = std::chrono::steady_clock::now();
+
+	m_pList = NULL;
+	m_frameCount++;
+	m_totalTriangles += (unsigned long long)triangleCount;
+	m_setupMilliseconds += std::chrono::duration<double, std::milli>(setupEnd - start).count();
+	m_rasterMilliseconds += std::chrono::duration<double, std::milli>(rasterEnd - setupEnd).count();
+}
+
+/***********************************************************
+ *  RunPhase()
+ *
+ *  This method is used for running a step of the frame on
+ *  every thread, including the calling one, and waiting
+ *  until all of them finished it.
+ ***********************************************************/
+void SoftwareRasterizer::RunPhase(RASTER_PHASE phase)
+{
+	if (m_threadCount > 1)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_phase = phase;
+		m_busyCount = m_threadCount - 1;
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	RunPhaseOn(phase, 0);
+
+	if (m_threadCount > 1)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_finished.wait(lock, [this]() { return(m_busyCount == 0); });
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by the worker threads.  Each one
+ *  waits for the next step, runs its part of it and reports
+ *  back, until the rasterizer is destroyed.
+ ***********************************************************/
+void SoftwareRasterizer::WorkerLoop(int threadIndex)
+{
+	int generation = 0;
+
+	while (true)
+	{
+		RASTER_PHASE phase = PHASE_SETUP;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, generation]() { return((m_bStopping == true) || (m_generation != generation)); });
+			if (m_bStopping == true)
+			{
+				return;
+			}
+			generation = m_generation;
+			phase = m_phase;
+		}
+
+		RunPhaseOn(phase, threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_busyCount--;
+		if (m_busyCount == 0)
+		{
+			m_finished.notify_one();
+		}
+	}
+}
+
+/***********************************************************
+ *  RunPhaseOn()
+ *
+ *  This method is used for running the part of a step that
+ *  belongs to a thread.
+ ***********************************************************/
+void SoftwareRasterizer::RunPhaseOn(RASTER_PHASE phase, int threadIndex)
+{
+	switch (phase)
+	{
+	case PHASE_SETUP:
+		SetupTriangles(threadIndex);
+		break;
+	case PHASE_RASTER:
+		RasterizeTiles();
+		break;
+	}
+}
+
+/***********************************************************
+ *  SetupTriangles()
+ *
+ *  This method is used for setting up the thread's share of
+ *  the triangles.  Each thread takes one contiguous range of
+ *  the triangles in draw list order, so reading the bins of
+ *  the threads in order keeps the order of the draws.
+ ***********************************************************/
+void SoftwareRasterizer::SetupTriangles(int threadIndex)
+{
+	int tileCount = m_tilesX * m_tilesY;
+	m_threadTriangles[threadIndex].clear();
+	for (int i = 0; i < tileCount; i++)
+	{
+		m_bins[(size_t)threadIndex * tileCount + i].clear();
+	}
+
+	int first = (int)((long long)m_triangleCount * threadIndex / m_threadCount);
+	int last = (int)((long long)m_triangleCount * (threadIndex + 1) / m_threadCount);
+	if (first >= last)
+	{
+		return;
+	}
+
+	// the last draw starting at or before the first triangle -
+	// draws without triangles start where the next one does
+	int itemCount = m_pList->itemCount;
+	int drawIndex = (int)(std::upper_bound(m_drawSetups.begin(), m_drawSetups.begin() + itemCount, first,
+		[](int triangle, const DRAW_SETUP& setup) { return(triangle < setup.firstTriangle); }) - m_drawSetups.begin()) - 1;
+
+	for (int triangle = first; triangle < last; triangle++)
+	{
+		while ((drawIndex + 1 < itemCount) && (m_drawSetups[drawIndex + 1].firstTriangle <= triangle))
+		{
+			drawIndex++;
+		}
+
+		const DRAW_SETUP& setup = m_drawSetups[drawIndex];
+		int viewTriangles = (int)(setup.pItem->indexCount / 3);
+		int local = triangle - setup.firstTriangle;
+		SetupTriangle(threadIndex, drawIndex, local / viewTriangles, local % viewTriangles);
+	}
+}
+
+/***********************************************************
+ *  SetupTriangle()
+ *
+ *  This method is used for transforming the corners of one
+ *  triangle of a draw into a view, the same way the vertex
+ *  shader does, and clipping it against the near plane.
+ *  The sides of the view are handled by the scissor of its
+ *  rectangle when the triangle is binned.
+ ***********************************************************/
+void SoftwareRasterizer::SetupTriangle(int threadIndex, int drawIndex, int viewIndex, int triangle)
+{
+	const DRAW_SETUP& setup = m_drawSetups[drawIndex];
+	const IndirectDraws::DRAW_ITEM& item = *setup.pItem;
+	const MeshBuffer::MESH_RANGE& range = m_pMeshBuffer->GetMeshRange(item.meshID);
+	const MESH_VERTEX* pVertices = m_pMeshBuffer->GetCpuVertices();
+	const unsigned int* pIndices = m_pMeshBuffer->GetCpuIndices();
+	if ((NULL == pVertices) || (NULL == pIndices))
+	{
+		return;
+	}
+
+	bool bLighting = ((item.variantFlags & ShaderVariants::VARIANT_LIGHTING) != 0);
+	bool bLightmap = ((item.variantFlags & ShaderVariants::VARIANT_LIGHTMAP) != 0) && (item.record.lightmapFirst >= 0);
+
+	CLIP_VERTEX corners[3];
+	for (int i = 0; i < 3; i++)
+	{
+		unsigned int vertexIndex = pIndices[range.firstIndex + item.firstIndex + triangle * 3 + i];
+		const MESH_VERTEX& vertex = pVertices[range.firstVertex + vertexIndex];
+		CLIP_VERTEX& corner = corners[i];
+
+		glm::vec4 worldPosition = item.record.model * glm::vec4(vertex.position, 1.0f);
+		corner.position = m_viewProjections[viewIndex] * worldPosition;
+
+		glm::vec3 normal = (bLighting == true) ? setup.normalMatrix * vertex.normal : vertex.normal;
+		glm::vec2 lightmapCoordinate = glm::vec2(0.0f);
+		int coordinateIndex = item.record.lightmapFirst + (int)vertexIndex;
+		if ((bLightmap == true) && (coordinateIndex < m_lightmapCoordinateCount))
+		{
+			lightmapCoordinate = m_pLightmapCoordinates[coordinateIndex];
+		}
+
+		corner.attributes[ATTRIBUTE_POSITION + 0] = worldPosition.x;
+		corner.attributes[ATTRIBUTE_POSITION + 1] = worldPosition.y;
+		corner.attributes[ATTRIBUTE_POSITION + 2] = worldPosition.z;
+		corner.attributes[ATTRIBUTE_NORMAL + 0] = normal.x;
+		corner.attributes[ATTRIBUTE_NORMAL + 1] = normal.y;
+		corner.attributes[ATTRIBUTE_NORMAL + 2] = normal.z;
+		corner.attributes[ATTRIBUTE_TEXTURE + 0] = vertex.textureCoordinate.x;
+		corner.attributes[ATTRIBUTE_TEXTURE + 1] = vertex.textureCoordinate.y;
+		corner.attributes[ATTRIBUTE_LIGHTMAP + 0] = lightmapCoordinate.x;
+		corner.attributes[ATTRIBUTE_LIGHTMAP + 1] = lightmapCoordinate.y;
+	}
+
+	// distance to the near plane, where z = -w
+	float distances[3];
+	int insideCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		distances[i] = corners[i].position.z + corners[i].position.w;
+		if (distances[i] >= 0.0f)
+		{
+			insideCount++;
+		}
+	}
+
+	if (insideCount == 3)
+	{
+		EmitTriangle(threadIndex, drawIndex, viewIndex, corners[0], corners[1], corners[2]);
+		return;
+	}
+	if (insideCount == 0)
+	{
+		return;
+	}
+
+	// one plane cuts a triangle into at most a quad
+	CLIP_VERTEX clipped[4];
+	int clippedCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		int next = (i + 1) % 3;
+		if (distances[i] >= 0.0f)
+		{
+			clipped[clippedCount++] = corners[i];
+		}
+		if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+		{
+			float t = distances[i] / (distances[i] - distances[next]);
+			CLIP_VERTEX& cut = clipped[clippedCount++];
+			cut.position = corners[i].position + (corners[next].position - corners[i].position) * t;
+			for (int a = 0; a < ATTRIBUTE_COUNT; a++)
+			{
+				cut.attributes[a] = corners[i].attributes[a] + (corners[next].attributes[a] - corners[i].attributes[a]) * t;
+			}
+		}
+	}
+
+	for (int i = 2; i < clippedCount; i++)
+	{
+		EmitTriangle(threadIndex, drawIndex, viewIndex, clipped[0], clipped[i - 1], clipped[i]);
+	}
+}
+
+/***********************************************************
+ *  EmitTriangle()
+ *
+ *  This method is used for projecting a clipped triangle
+ *  into the view's rectangle of the frame, setting up its
+ *  edge functions and adding it to the bins of the tiles
+ *  its bounds overlap.  Both windings are drawn, as the
+ *  OpenGL path does not cull faces.
+ ***********************************************************/
+void SoftwareRasterizer::EmitTriangle(int threadIndex, int drawIndex, int viewIndex, const CLIP_VERTEX& v0, const CLIP_VERTEX& v1, const CLIP_VERTEX& v2)
+{
+	const CLIP_VERTEX* pCorners[3] = { &v0, &v1, &v2 };
+	const glm::vec4& rect = m_viewRects[viewIndex];
+
+	float x[3];
+	float y[3];
+	float depth[3];
+	float inverseW[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& position = pCorners[i]->position;
+		if (!(position.w > 0.0f))
+		{
+			return;
+		}
+		inverseW[i] = 1.0f / position.w;
+
+		float ndcX = position.x * inverseW[i] * rect.x + rect.z;
+		float ndcY = position.y * inverseW[i] * rect.y + rect.w;
+		x[i] = std::round((ndcX * 0.5f + 0.5f) * m_width * SUBPIXEL_SCALE) / SUBPIXEL_SCALE;
+		y[i] = std::round((ndcY * 0.5f + 0.5f) * m_height * SUBPIXEL_SCALE) / SUBPIXEL_SCALE;
+		depth[i] = position.z * inverseW[i] * 0.5f + 0.5f;
+	}
+
+	// the corners are put in counterclockwise order, so the
+	// inside of every edge is positive
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (!(area != 0.0f) || !std::isfinite(area))
+	{
+		return;
+	}
+	int order[3] = { 0, 1, 2 };
+	if (area < 0.0f)
+	{
+		order[1] = 2;
+		order[2] = 1;
+		area = -area;
+	}
+
+	// pixels whose centers are inside the view's rectangle
+	float left = ((rect.z - rect.x) * 0.5f + 0.5f) * m_width;
+	float right = ((rect.z + rect.x) * 0.5f + 0.5f) * m_width;
+	float bottom = ((rect.w - rect.y) * 0.5f + 0.5f) * m_height;
+	float top = ((rect.w + rect.y) * 0.5f + 0.5f) * m_height;
+	int scissorMinX = std::max((int)std::ceil(left - 0.5f), 0);
+	int scissorMaxX = std::min((int)std::ceil(right - 0.5f) - 1, m_width - 1);
+	int scissorMinY = std::max((int)std::ceil(bottom - 0.5f), 0);
+	int scissorMaxY = std::min((int)std::ceil(top - 0.5f) - 1, m_height - 1);
+
+	float boundsMinX = std::min(std::min(x[0], x[1]), x[2]);
+	float boundsMaxX = std::max(std::max(x[0], x[1]), x[2]);
+	float boundsMinY = std::min(std::min(y[0], y[1]), y[2]);
+	float boundsMaxY = std::max(std::max(y[0], y[1]), y[2]);
+	// triangles far outside of the frame are rejected before
+	// the bounds are turned into pixels
+	if ((boundsMaxX < 0.0f) || (boundsMaxY < 0.0f) || (boundsMinX > (float)m_width) || (boundsMinY > (float)m_height))
+	{
+		return;
+	}
+
+	RASTER_TRIANGLE raster;
+	raster.minX = std::max((int)std::ceil(std::max(boundsMinX, -1.0f) - 0.5f), scissorMinX);
+	raster.maxX = std::min((int)std::floor(std::min(boundsMaxX, (float)m_width + 1.0f) - 0.5f), scissorMaxX);
+	raster.minY = std::max((int)std::ceil(std::max(boundsMinY, -1.0f) - 0.5f), scissorMinY);
+	raster.maxY = std::min((int)std::floor(std::min(boundsMaxY, (float)m_height + 1.0f) - 0.5f), scissorMaxY);
+	if ((raster.minX > raster.maxX) || (raster.minY > raster.maxY))
+	{
+		return;
+	}
+
+	// edge i is opposite of corner i, and is 1 at the corner
+	for (int i = 0; i < 3; i++)
+	{
+		int a = order[(i + 1) % 3];
+		int b = order[(i + 2) % 3];
+		float dx = x[b] - x[a];
+		float dy = y[b] - y[a];
+
+		raster.edgeX[i] = -dy / area;
+		raster.edgeY[i] = dx / area;
+		raster.edgeConstant[i] = (dy * x[a] - dx * y[a]) / area;
+		// with y up, the left edges go down and the top edges
+		// go left - a pixel center on a shared edge is drawn once
+		raster.bTopLeft[i] = (dy < 0.0f) || ((dy == 0.0f) && (dx < 0.0f));
+
+		int corner = order[i];
+		raster.depth[i] = depth[corner];
+		raster.inverseW[i] = inverseW[corner];
+		for (int attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+		{
+			raster.attributes[i][attribute] = pCorners[corner]->attributes[attribute] * inverseW[corner];
+		}
+	}
+	raster.drawIndex = drawIndex;
+	raster.viewIndex = viewIndex;
+
+	std::vector<RASTER_TRIANGLE>& triangles = m_threadTriangles[threadIndex];
+	int triangleIndex = (int)triangles.size();
+	triangles.push_back(raster);
+
+	int tileCount = m_tilesX * m_tilesY;
+	std::vector<int>* pBins = &m_bins[(size_t)threadIndex * tileCount];
+	for (int tileY = raster.minY / TILE_SIZE; tileY <= raster.maxY / TILE_SIZE; tileY++)
+	{
+		for (int tileX = raster.minX / TILE_SIZE; tileX <= raster.maxX / TILE_SIZE; tileX++)
+		{
+			pBins[tileY * m_tilesX + tileX].push_back(triangleIndex);
+		}
+	}
+}
+
+/***********************************************************
+ *  RasterizeTiles()
+ *
+ *  This method is used for taking tiles until none are
+ *  left.  A tile is cleared, then the bins of every thread
+ *  are drawn into it in thread order, which is the order of
+ *  the draw list.
+ ***********************************************************/
+void SoftwareRasterizer::RasterizeTiles()
+{
+	int tileCount = m_tilesX * m_tilesY;
+
+	while (true)
+	{
+		int tile = m_nextTile.fetch_add(1);
+		if (tile >= tileCount)
+		{
+			return;
+		}
+
+		int tileX = (tile % m_tilesX) * TILE_SIZE;
+		int tileY = (tile / m_tilesX) * TILE_SIZE;
+		int endX = std::min(tileX + TILE_SIZE, m_width);
+		int endY = std::min(tileY + TILE_SIZE, m_height);
+		for (int y = tileY; y < endY; y++)
+		{
+			std::fill(m_color.begin() + (size_t)y * m_stride + tileX, m_color.begin() + (size_t)y * m_stride + endX, CLEAR_COLOR);
+			std::fill(m_depth.begin() + (size_t)y * m_stride + tileX, m_depth.begin() + (size_t)y * m_stride + endX, CLEAR_DEPTH);
+		}
+
+		for (int thread = 0; thread < m_threadCount; thread++)
+		{
+			const std::vector<int>& bin = m_bins[(size_t)thread * tileCount + tile];
+			const std::vector<RASTER_TRIANGLE>& triangles = m_threadTriangles[thread];
+			for (size_t i = 0; i < bin.size(); i++)
+			{
+				RasterizeTriangle(triangles[bin[i]], tileX, tileY);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method is used for drawing the part of a triangle
+ *  inside a tile.  The pixels are stepped four at a time
+ *  from a multiple of four, and the coverage and the depth
+ *  test of the four are done together.  Opaque draws write
+ *  the depth of the passing pixels, and transparent draws
+ *  only test it.  The passing pixels are then shaded one
+ *  at a time.
+ ***********************************************************/
+void SoftwareRasterizer::RasterizeTriangle(const RASTER_TRIANGLE& triangle, int tileX, int tileY)
+{
+	int minX = std::max(triangle.minX, tileX);
+	int maxX = std::min(triangle.maxX, std::min(tileX + TILE_SIZE, m_width) - 1);
+	int minY = std::max(triangle.minY, tileY);
+	int maxY = std::min(triangle.maxY, std::min(tileY + TILE_SIZE, m_height) - 1);
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+
+	bool bWriteDepth = (m_drawSetups[triangle.drawIndex].pItem->bTransparent == false);
+	int startX = minX & ~3;
+
+	float weights[3][4];
+	for (int y = minY; y <= maxY; y++)
+	{
+		float centerY = (float)y + 0.5f;
+		float rowEdges[3];
+		for (int i = 0; i < 3; i++)
+		{
+			rowEdges[i] = triangle.edgeY[i] * centerY + triangle.edgeConstant[i];
+		}
+		float* pDepthRow = &m_depth[(size_t)y * m_stride];
+		unsigned int* pColorRow = &m_color[(size_t)y * m_stride];
+
+		for (int x = startX; x <= maxX; x += 4)
+		{
+			int mask = 0;
+
+#if defined(SOFTWARE_RASTER_SSE)
+			const __m128 zero = _mm_setzero_ps();
+			__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+			__m128i pixelX = _mm_add_epi32(_mm_set1_epi32(x), _mm_set_epi32(3, 2, 1, 0));
+			__m128 covered = _mm_castsi128_ps(_mm_and_si128(
+				_mm_cmpgt_epi32(pixelX, _mm_set1_epi32(minX - 1)),
+				_mm_cmplt_epi32(pixelX, _mm_set1_epi32(maxX + 1))));
+
+			__m128 edges[3];
+			for (int i = 0; i < 3; i++)
+			{
+				edges[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edgeX[i]), centerX), _mm_set1_ps(rowEdges[i]));
+				__m128 inside = _mm_cmpgt_ps(edges[i], zero);
+				if (triangle.bTopLeft[i] == true)
+				{
+					inside = _mm_or_ps(inside, _mm_cmpeq_ps(edges[i], zero));
+				}
+				covered = _mm_and_ps(covered, inside);
+			}
+			if (_mm_movemask_ps(covered) == 0)
+			{
+				continue;
+			}
+
+			__m128 depth = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(edges[0], _mm_set1_ps(triangle.depth[0])),
+				_mm_mul_ps(edges[1], _mm_set1_ps(triangle.depth[1]))),
+				_mm_mul_ps(edges[2], _mm_set1_ps(triangle.depth[2])));
+			__m128 storedDepth = _mm_loadu_ps(pDepthRow + x);
+			covered = _mm_and_ps(covered, _mm_and_ps(
+				_mm_cmplt_ps(depth, storedDepth),
+				_mm_cmple_ps(depth, _mm_set1_ps(1.0f))));
+			mask = _mm_movemask_ps(covered);
+			if (mask == 0)
+			{
+				continue;
+			}
+			if (bWriteDepth == true)
+			{
+				_mm_storeu_ps(pDepthRow + x, _mm_or_ps(_mm_and_ps(covered, depth), _mm_andnot_ps(covered, storedDepth)));
+			}
+			for (int i = 0; i < 3; i++)
+			{
+				_mm_storeu_ps(weights[i], edges[i]);
+			}
+#else
+			for (int lane = 0; lane < 4; lane++)
+			{
+				int pixelX = x + lane;
+				float centerX = (float)pixelX + 0.5f;
+				bool bCovered = (pixelX >= minX) && (pixelX <= maxX);
+				for (int i = 0; i < 3; i++)
+				{
+					weights[i][lane] = triangle.edgeX[i] * centerX + rowEdges[i];
+					bCovered = bCovered && ((weights[i][lane] > 0.0f) || ((weights[i][lane] == 0.0f) && (triangle.bTopLeft[i] == true)));
+				}
+				if (bCovered == false)
+				{
+					continue;
+				}
+
+				float depth = weights[0][lane] * triangle.depth[0] + weights[1][lane] * triangle.depth[1] + weights[2][lane] * triangle.depth[2];
+				if ((depth < pDepthRow[pixelX]) && (depth <= 1.0f))
+				{
+					mask |= (1 << lane);
+					if (bWriteDepth == true)
+					{
+						pDepthRow[pixelX] = depth;
+					}
+				}
+			}
+#endif
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if ((mask & (1 << lane)) != 0)
+				{
+					ShadePixel(triangle, weights[0][lane], weights[1][lane], weights[2][lane], pColorRow + x + lane);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ShadePixel()
+ *
+ *  This method is used for interpolating the values of the
+ *  corners with perspective correction and shading them
+ *  like the fragment shader variant of the draw - a texture
+ *  or the draw color, then the lightmap, the Phong light
+ *  model or no lighting.  Transparent draws are blended
+ *  with the source alpha.
+ ***********************************************************/
+void SoftwareRasterizer::ShadePixel(const RASTER_TRIANGLE& triangle, float weight0, float weight1, float weight2, unsigned int* pPixel)
+{
+	const DRAW_SETUP& setup = m_drawSetups[triangle.drawIndex];
+	const IndirectDraws::DRAW_ITEM& item = *setup.pItem;
+	const IndirectDraws::DRAW_RECORD& record = item.record;
+
+	float inverseW = weight0 * triangle.inverseW[0] + weight1 * triangle.inverseW[1] + weight2 * triangle.inverseW[2];
+	float w = 1.0f / inverseW;
+	float values[ATTRIBUTE_COUNT];
+	for (int i = 0; i < ATTRIBUTE_COUNT; i++)
+	{
+		values[i] = (weight0 * triangle.attributes[0][i] + weight1 * triangle.attributes[1][i] + weight2 * triangle.attributes[2][i]) * w;
+	}
+
+	glm::vec4 baseColor = record.color;
+	if ((item.variantFlags & ShaderVariants::VARIANT_TEXTURE) != 0)
+	{
+		// an empty slot reads as black, like an unbound texture
+		baseColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		if (NULL != setup.pTexture)
+		{
+			glm::vec2 coordinate(values[ATTRIBUTE_TEXTURE], values[ATTRIBUTE_TEXTURE + 1]);
+			baseColor = SampleTexture(*setup.pTexture, coordinate * record.uvScale);
+		}
+	}
+
+	glm::vec4 color = baseColor;
+	if ((item.variantFlags & ShaderVariants::VARIANT_LIGHTMAP) != 0)
+	{
+		glm::vec3 bakedLight = SampleLightmap(glm::vec2(values[ATTRIBUTE_LIGHTMAP], values[ATTRIBUTE_LIGHTMAP + 1]));
+		color = glm::vec4(bakedLight * glm::vec3(baseColor), baseColor.a);
+	}
+	else if ((item.variantFlags & ShaderVariants::VARIANT_LIGHTING) != 0)
+	{
+		glm::vec3 position(values[ATTRIBUTE_POSITION], values[ATTRIBUTE_POSITION + 1], values[ATTRIBUTE_POSITION + 2]);
+		glm::vec3 lightNormal = glm::normalize(glm::vec3(values[ATTRIBUTE_NORMAL], values[ATTRIBUTE_NORMAL + 1], values[ATTRIBUTE_NORMAL + 2]));
+		glm::vec3 viewDirection = glm::normalize(m_viewPositions[triangle.viewIndex] - position);
+		glm::vec3 phongResult = glm::vec3(0.0f);
+
+		for (int i = 0; i < m_lightCount; i++)
+		{
+			const LIGHT_SOURCE& light = m_lights[i];
+
+			glm::vec3 ambient = light.ambientColor * glm::vec3(record.ambientColor);
+
+			glm::vec3 lightDirection = glm::normalize(light.position - position);
+			float impact = std::max(glm::dot(lightNormal, lightDirection), 0.0f);
+			glm::vec3 diffuse = impact * light.diffuseColor * glm::vec3(record.diffuseColor);
+
+			glm::vec3 reflectDirection = glm::reflect(-lightDirection, lightNormal);
+			float specularComponent = std::pow(std::max(glm::dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+			glm::vec3 specular = light.specularIntensity * specularComponent * light.specularColor * glm::vec3(record.specularColor);
+
+			phongResult += ambient + diffuse + specular;
+		}
+
+		color = glm::vec4(phongResult * glm::vec3(baseColor), baseColor.a);
+	}
+
+	if (item.bTransparent == true)
+	{
+		float alpha = glm::clamp(color.a, 0.0f, 1.0f);
+		color = color * alpha + UnpackColor(*pPixel) * (1.0f - alpha);
+	}
+
+	*pPixel = PackColor(color);
+}
+
+/***********************************************************
+ *  SampleTexture()
+ *
+ *  This method is used for reading a texture with bilinear
+ *  filtering and repeating coordinates, the filtering the
+ *  scene textures are set up with.
+ ***********************************************************/
+glm::vec4 SoftwareRasterizer::SampleTexture(const RASTER_TEXTURE& texture, glm::vec2 coordinate) const
+{
+	float u = coordinate.x * texture.width - 0.5f;
+	float v = coordinate.y * texture.height - 0.5f;
+	if (!(std::fabs(u) < MAX_TEXTURE_COORDINATE) || !(std::fabs(v) < MAX_TEXTURE_COORDINATE))
+	{
+		u = 0.0f;
+		v = 0.0f;
+	}
+
+	float floorU = std::floor(u);
+	float floorV = std::floor(v);
+	float fractionU = u - floorU;
+	float fractionV = v - floorV;
+	int x0 = WrapIndex((int)floorU, texture.width);
+	int y0 = WrapIndex((int)floorV, texture.height);
+	int x1 = WrapIndex(x0 + 1, texture.width);
+	int y1 = WrapIndex(y0 + 1, texture.height);
+
+	const unsigned char* pTexels = texture.texels.data();
+	glm::vec4 bottom = glm::mix(FetchTexel(pTexels, texture.width, x0, y0), FetchTexel(pTexels, texture.width, x1, y0), fractionU);
+	glm::vec4 top = glm::mix(FetchTexel(pTexels, texture.width, x0, y1), FetchTexel(pTexels, texture.width, x1, y1), fractionU);
+
+	return(glm::mix(bottom, top, fractionV));
+}
+
+/***********************************************************
+ *  SampleLightmap()
+ *
+ *  This method is used for reading the baked light with
+ *  bilinear filtering and coordinates clamped to the edges,
+ *  as the lightmap texture is set up.
+ ***********************************************************/
+glm::vec3 SoftwareRasterizer::SampleLightmap(glm::vec2 coordinate) const
+{
+	if ((NULL == m_pLightmapTexels) || (m_lightmapSize <= 0))
+	{
+		return(glm::vec3(0.0f));
+	}
+
+	float u = glm::clamp(coordinate.x, 0.0f, 1.0f) * m_lightmapSize - 0.5f;
+	float v = glm::clamp(coordinate.y, 0.0f, 1.0f) * m_lightmapSize - 0.5f;
+	if (!(u == u) || !(v == v))
+	{
+		return(glm::vec3(0.0f));
+	}
+
+	float floorU = std::floor(u);
+	float floorV = std::floor(v);
+	float fractionU = u - floorU;
+	float fractionV = v - floorV;
+	int x0 = ClampIndex((int)floorU, m_lightmapSize);
+	int y0 = ClampIndex((int)floorV, m_lightmapSize);
+	int x1 = ClampIndex((int)floorU + 1, m_lightmapSize);
+	int y1 = ClampIndex((int)floorV + 1, m_lightmapSize);
+
+	const glm::vec4* pTexels = m_pLightmapTexels;
+	glm::vec3 bottom = glm::mix(glm::vec3(pTexels[y0 * m_lightmapSize + x0]), glm::vec3(pTexels[y0 * m_lightmapSize + x1]), fractionU);
+	glm::vec3 top = glm::mix(glm::vec3(pTexels[y1 * m_lightmapSize + x0]), glm::vec3(pTexels[y1 * m_lightmapSize + x1]), fractionU);
+
+	return(glm::mix(bottom, top, fractionV));
+}
+
+/***********************************************************
+ *  GetColorBuffer()
+ *
+ *  This method is used for getting the RGBA8 pixels of the
+ *  last frame, with the bottom row first.
+ ***********************************************************/
+const unsigned int* SoftwareRasterizer::GetColorBuffer()
+{
+	return(m_color.data());
+}
+
+/***********************************************************
+ *  GetStride()
+ *
+ *  This method is used for getting the number of pixels
+ *  between the starts of two rows of the color buffer.
+ ***********************************************************/
+int SoftwareRasterizer::GetStride()
+{
+	return(m_stride);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the threads the frames
+ *  are split over and the average time of each step.
+ ***********************************************************/
+void SoftwareRasterizer::PrintReport()
+{
+	if (m_frameCount == 0)
+	{
+		return;
+	}
+
+	std::cout << "Software rasterizer: " << m_threadCount << " threads, "
+		<< (m_totalTriangles / m_frameCount) << " triangles per frame, "
+		<< (m_setupMilliseconds / m_frameCount) << " ms setup and "
+		<< (m_rasterMilliseconds / m_frameCount) << " ms raster per frame" << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.h
+// ============
+// draw the frame's draw list on the CPU with a tiled, multithreaded
+// rasterizer that follows the light model of the GLSL shaders
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuffer.h"
+#include "IndirectDraws.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  SoftwareRasterizer
+ *
+ *  This class contains the code for rendering the sorted
+ *  draw list of a frame without a GPU.  It reads the same
+ *  mesh ranges, draw records, textures, light sources and
+ *  lightmap as the shader variants, and shades the pixels
+ *  with the same texture, Phong and lightmap model as the
+ *  fragment shader.  A frame runs in two parallel steps.
+ *  First the triangles are transformed, clipped against the
+ *  near plane and binned into 64 pixel tiles, with each
+ *  thread taking one contiguous part of the draw list.
+ *  Then the threads take whole tiles and rasterize the bins
+ *  of the threads in order, so the draws keep their sorted
+ *  order and no two threads write the same pixel.  The
+ *  coverage and depth of four pixels are tested at once
+ *  with SSE when the compiler targets it.  The color buffer
+ *  holds RGBA8 rows from the bottom up, like an OpenGL
+ *  framebuffer.
+ ***********************************************************/
+class SoftwareRasterizer
+{
+public:
+	// constructor - a thread count of 0 uses every core
+	SoftwareRasterizer(MeshBuffer* pMeshBuffer, int threadCount);
+	// destructor
+	~SoftwareRasterizer();
+
+	// a light source, laid out like LightSource in the shaders
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float focalStrength;
+		float specularIntensity;
+	};
+
+	// most light sources and texture slots, matching the shaders
+	static const int MAX_LIGHTS = 4;
+	static const int MAX_TEXTURE_SLOTS = ShaderVariants::MAX_TEXTURE_SLOTS;
+
+private:
+	// pixels along each side of a tile
+	static const int TILE_SIZE = 64;
+	// interpolated values of a vertex - world position, normal,
+	// texture coordinate and lightmap coordinate
+	static const int ATTRIBUTE_COUNT = 10;
+
+	// the steps a frame runs on every thread
+	enum RASTER_PHASE
+	{
+		PHASE_SETUP,
+		PHASE_RASTER
+	};
+
+	struct RASTER_TEXTURE
+	{
+		int width;
+		int height;
+		// RGBA8 texels, the first row at texture coordinate 0
+		std::vector<unsigned char> texels;
+	};
+
+	// values shared by every triangle of a draw
+	struct DRAW_SETUP
+	{
+		const IndirectDraws::DRAW_ITEM* pItem;
+		// inverse transpose of the model matrix for the normals
+		glm::mat3 normalMatrix;
+		const RASTER_TEXTURE* pTexture;
+		// first triangle of the draw over all views, in the
+		// order of the draw list
+		int firstTriangle;
+	};
+
+	// vertex after the transform, before the perspective divide
+	struct CLIP_VERTEX
+	{
+		glm::vec4 position;
+		float attributes[ATTRIBUTE_COUNT];
+	};
+
+	// a triangle ready for the tiles - the edge functions give
+	// the barycentric weight of the opposite vertex at a pixel
+	// center, and the attributes are divided by w
+	struct RASTER_TRIANGLE
+	{
+		float edgeX[3];
+		float edgeY[3];
+		float edgeConstant[3];
+		// whether a pixel center exactly on the edge is covered
+		bool bTopLeft[3];
+		float depth[3];
+		float inverseW[3];
+		float attributes[3][ATTRIBUTE_COUNT];
+		// covered pixels, inclusive
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		int drawIndex;
+		int viewIndex;
+	};
+
+	MeshBuffer* m_pMeshBuffer;
+
+	LIGHT_SOURCE m_lights[MAX_LIGHTS];
+	RASTER_TEXTURE m_textures[MAX_TEXTURE_SLOTS];
+	// baked lightmap and the coordinates of its vertices, owned
+	// by the lightmapper
+	const glm::vec4* m_pLightmapTexels;
+	int m_lightmapSize;
+	const glm::vec2* m_pLightmapCoordinates;
+	int m_lightmapCoordinateCount;
+
+	// color and depth of the frame, with rows padded to a
+	// multiple of four pixels
+	int m_width;
+	int m_height;
+	int m_stride;
+	std::vector<unsigned int> m_color;
+	std::vector<float> m_depth;
+	int m_tilesX;
+	int m_tilesY;
+
+	// the frame being drawn
+	const IndirectDraws::DRAW_LIST* m_pList;
+	int m_viewCount;
+	glm::mat4 m_viewProjections[ShaderVariants::MAX_VIEWS];
+	glm::vec4 m_viewRects[ShaderVariants::MAX_VIEWS];
+	glm::vec3 m_viewPositions[ShaderVariants::MAX_VIEWS];
+	int m_lightCount;
+	std::vector<DRAW_SETUP> m_drawSetups;
+	int m_triangleCount;
+
+	// triangles set up by each thread, and the bins of each
+	// thread's triangles per tile - kept between frames so a
+	// steady frame does not allocate
+	std::vector<std::vector<RASTER_TRIANGLE>> m_threadTriangles;
+	std::vector<std::vector<int>> m_bins;
+	// next tile for a thread to take
+	std::atomic<int> m_nextTile;
+
+	// worker threads - the thread calling Render() is thread 0
+	int m_threadCount;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_finished;
+	RASTER_PHASE m_phase;
+	int m_generation;
+	int m_busyCount;
+	bool m_bStopping;
+
+	// statistics
+	int m_frameCount;
+	unsigned long long m_totalTriangles;
+	double m_setupMilliseconds;
+	double m_rasterMilliseconds;
+
+	// run a step on every thread and wait for all of them
+	void RunPhase(RASTER_PHASE phase);
+	void WorkerLoop(int threadIndex);
+	void RunPhaseOn(RASTER_PHASE phase, int threadIndex);
+
+	// size the buffers and the bins for the frame
+	void Resize(int width, int height);
+	// transform, clip and bin a part of the triangles
+	void SetupTriangles(int threadIndex);
+	void SetupTriangle(int threadIndex, int drawIndex, int viewIndex, int triangle);
+	void EmitTriangle(int threadIndex, int drawIndex, int viewIndex, const CLIP_VERTEX& v0, const CLIP_VERTEX& v1, const CLIP_VERTEX& v2);
+	// clear a tile and draw its bins
+	void RasterizeTiles();
+	void RasterizeTriangle(const RASTER_TRIANGLE& triangle, int tileX, int tileY);
+	// shade one pixel with the weights of the three vertices
+	void ShadePixel(const RASTER_TRIANGLE& triangle, float weight0, float weight1, float weight2, unsigned int* pPixel);
+
+	// filtered texture reads, as set up for the OpenGL textures
+	glm::vec4 SampleTexture(const RASTER_TEXTURE& texture, glm::vec2 coordinate) const;
+	glm::vec3 SampleLightmap(glm::vec2 coordinate) const;
+
+public:
+	// set a light source of the light model
+	void SetLight(int index, const LIGHT_SOURCE& light);
+	// copy a decoded image into a texture slot
+	bool SetTexture(int slot, const unsigned char* pPixels, int width, int height, int colorChannels);
+	// set the baked lightmap the lightmap draws read
+	void SetLightmap(const glm::vec4* pTexels, int size, const glm::vec2* pCoordinates, int coordinateCount);
+
+	// draw a sorted draw list into a frame of the passed in size
+	void Render(
+		const IndirectDraws::DRAW_LIST& list,
+		int viewCount,
+		const glm::mat4* pViewProjections,
+		const glm::vec4* pViewRects,
+		const glm::vec3* pViewPositions,
+		int lightCount,
+		int width,
+		int height);
+
+	// RGBA8 color of the last frame, and its row length in pixels
+	const unsigned int* GetColorBuffer();
+	int GetStride();
+
+	// print the threads used and the average time of each step
+	void PrintReport();
+};
\ No newline at end of file
@@ -0,0 +1,419 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupgraph.cpp
+// ============
+// run the startup steps as a dependency graph, with the file and CPU work
+// on worker threads, and trace when each step ran
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupGraph.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// worker threads at most - the startup tasks are few, and
+	// the GL thread keeps one core busy
+	const int MAX_WORKERS = 8;
+}
+
+/***********************************************************
+ *  StartupGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StartupGraph::StartupGraph()
+{
+	m_finishedCount = 0;
+	m_bStopping = false;
+	m_workerCount = 0;
+	m_runMilliseconds = 0.0;
+	m_firstFrameMilliseconds = -1.0;
+	m_origin = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  ~StartupGraph()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StartupGraph::~StartupGraph()
+{
+	m_tasks.clear();
+}
+
+/***********************************************************
+ *  GetMilliseconds()
+ *
+ *  This method is used for getting the time since the graph
+ *  was created.
+ ***********************************************************/
+double StartupGraph::GetMilliseconds()
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count());
+}
+
+/***********************************************************
+ *  AddTask()
+ *
+ *  This method is used for adding a task run by the passed
+ *  in function on the passed in thread.  The function
+ *  returns false when the step failed.
+ ***********************************************************/
+int StartupGraph::AddTask(const std::string& name, TASK_THREAD thread, std::function<bool()> run)
+{
+	STARTUP_TASK task;
+	task.name = name;
+	task.thread = thread;
+	task.run = run;
+	task.pendingCount = 0;
+	task.bSkipped = false;
+	task.bSucceeded = false;
+	task.startMilliseconds = 0.0;
+	task.endMilliseconds = 0.0;
+	task.threadIndex = -1;
+	m_tasks.push_back(task);
+
+	return((int)m_tasks.size() - 1);
+}
+
+/***********************************************************
+ *  AddDependency()
+ *
+ *  This method is used for making a task wait until the
+ *  passed in dependency finished.
+ ***********************************************************/
+void StartupGraph::AddDependency(int task, int dependency)
+{
+	if ((task < 0) || (task >= (int)m_tasks.size()) ||
+		(dependency < 0) || (dependency >= (int)m_tasks.size()))
+	{
+		return;
+	}
+
+	m_tasks[dependency].dependents.push_back(task);
+	m_tasks[task].pendingCount++;
+}
+
+/***********************************************************
+ *  HasCycle()
+ *
+ *  This method is used for checking that every task can
+ *  run, by releasing the tasks in dependency order and
+ *  counting the ones reached.
+ ***********************************************************/
+bool StartupGraph::HasCycle()
+{
+	std::vector<int> pendingCounts(m_tasks.size());
+	std::vector<int> ready;
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		pendingCounts[i] = m_tasks[i].pendingCount;
+		if (pendingCounts[i] == 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	int reached = 0;
+	while (ready.empty() == false)
+	{
+		int task = ready.back();
+		ready.pop_back();
+		reached++;
+		for (int i = 0; i < (int)m_tasks[task].dependents.size(); i++)
+		{
+			int dependent = m_tasks[task].dependents[i];
+			if (--pendingCounts[dependent] == 0)
+			{
+				ready.push_back(dependent);
+			}
+		}
+	}
+
+	return(reached < (int)m_tasks.size());
+}
+
+/***********************************************************
+ *  RunTask()
+ *
+ *  This method is used for running a task, unless one of
+ *  its dependencies failed, and queueing the tasks that
+ *  only waited on it.  A failure is passed on to every
+ *  task depending on it.
+ ***********************************************************/
+void StartupGraph::RunTask(int taskIndex, int threadIndex)
+{
+	STARTUP_TASK& task = m_tasks[taskIndex];
+
+	double startMilliseconds = GetMilliseconds();
+	bool bSucceeded = false;
+	if (task.bSkipped == false)
+	{
+		bSucceeded = task.run();
+	}
+	double endMilliseconds = GetMilliseconds();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	task.startMilliseconds = startMilliseconds;
+	task.endMilliseconds = endMilliseconds;
+	task.threadIndex = threadIndex;
+	task.bSucceeded = bSucceeded;
+	m_finishedCount++;
+
+	bool bWorkerQueued = false;
+	for (int i = 0; i < (int)task.dependents.size(); i++)
+	{
+		STARTUP_TASK& dependent = m_tasks[task.dependents[i]];
+		if (bSucceeded == false)
+		{
+			dependent.bSkipped = true;
+		}
+		if (--dependent.pendingCount == 0)
+		{
+			if (dependent.thread == TASK_GL)
+			{
+				m_glQueue.push_back(task.dependents[i]);
+			}
+			else
+			{
+				m_workerQueue.push_back(task.dependents[i]);
+				bWorkerQueued = true;
+			}
+		}
+	}
+
+	if (bWorkerQueued == true)
+	{
+		m_workerReady.notify_all();
+	}
+	// the GL thread also waits for the last task to finish
+	m_glReady.notify_one();
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running the worker tasks as they
+ *  become ready, until the graph is finished.
+ ***********************************************************/
+void StartupGraph::WorkerLoop(int threadIndex)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		while ((m_workerQueue.empty() == true) && (m_bStopping == false))
+		{
+			m_workerReady.wait(lock);
+		}
+		if (m_workerQueue.empty() == true)
+		{
+			return;
+		}
+
+		int task = m_workerQueue.front();
+		m_workerQueue.pop_front();
+		lock.unlock();
+		RunTask(task, threadIndex);
+		lock.lock();
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running the whole graph.  The
+ *  worker tasks are run by a pool of threads, and the GL
+ *  tasks by the calling thread, in the order they become
+ *  ready.  The graph can only be run once.
+ ***********************************************************/
+bool StartupGraph::Run()
+{
+	if (HasCycle() == true)
+	{
+		std::cout << "Startup graph: the task dependencies form a cycle" << std::endl;
+		return(false);
+	}
+
+	double runStart = GetMilliseconds();
+
+	int workerTasks = 0;
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		if (m_tasks[i].thread == TASK_WORKER)
+		{
+			workerTasks++;
+		}
+		if (m_tasks[i].pendingCount == 0)
+		{
+			if (m_tasks[i].thread == TASK_GL)
+			{
+				m_glQueue.push_back(i);
+			}
+			else
+			{
+				m_workerQueue.push_back(i);
+			}
+		}
+	}
+
+	// the calling thread runs the GL tasks, so the workers get
+	// the other cores
+	m_workerCount = std::min((int)std::thread::hardware_concurrency() - 1, MAX_WORKERS);
+	m_workerCount = std::min(std::max(m_workerCount, 1), std::max(workerTasks, 1));
+	std::vector<std::thread> workers;
+	for (int i = 0; i < m_workerCount; i++)
+	{
+		workers.push_back(std::thread(&StartupGraph::WorkerLoop, this, i + 1));
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_finishedCount < (int)m_tasks.size())
+	{
+		if (m_glQueue.empty() == false)
+		{
+			int task = m_glQueue.front();
+			m_glQueue.pop_front();
+			lock.unlock();
+			RunTask(task, 0);
+			lock.lock();
+		}
+		else
+		{
+			m_glReady.wait(lock);
+		}
+	}
+	m_bStopping = true;
+	m_workerReady.notify_all();
+	lock.unlock();
+
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	m_runMilliseconds = GetMilliseconds() - runStart;
+
+	bool bSucceeded = true;
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		if ((m_tasks[i].bSucceeded == false) && (m_tasks[i].bSkipped == false))
+		{
+			std::cout << "Startup task failed: " << m_tasks[i].name << std::endl;
+		}
+		bSucceeded = bSucceeded && m_tasks[i].bSucceeded;
+	}
+
+	return(bSucceeded);
+}
+
+/***********************************************************
+ *  MarkFirstFrame()
+ *
+ *  This method is used for noting the time the first frame
+ *  was handed to the renderer, which ends the startup.
+ ***********************************************************/
+void StartupGraph::MarkFirstFrame()
+{
+	if (m_firstFrameMilliseconds < 0.0)
+	{
+		m_firstFrameMilliseconds = GetMilliseconds();
+	}
+}
+
+/***********************************************************
+ *  PrintTrace()
+ *
+ *  This method is used for printing the tasks in the order
+ *  they started, with their start and end times, and the
+ *  time the tasks would have taken one after another.
+ ***********************************************************/
+void StartupGraph::PrintTrace()
+{
+	std::vector<int> order;
+	double serialMilliseconds = 0.0;
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		order.push_back(i);
+		serialMilliseconds += m_tasks[i].endMilliseconds - m_tasks[i].startMilliseconds;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int first, int second)
+	{
+		return(m_tasks[first].startMilliseconds < m_tasks[second].startMilliseconds);
+	});
+
+	std::ios::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+
+	std::cout << "Startup trace (ms from start):" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		const STARTUP_TASK& task = m_tasks[order[i]];
+		std::string thread = (task.threadIndex == 0) ? "gl" : "worker " + std::to_string(task.threadIndex);
+		std::cout << "  " << std::setw(9) << task.startMilliseconds << " - " << std::setw(9) << task.endMilliseconds
+			<< "  " << std::left << std::setw(9) << thread << std::right << "  " << task.name;
+		if (task.bSkipped == true)
+		{
+			std::cout << " (skipped)";
+		}
+		else if (task.bSucceeded == false)
+		{
+			std::cout << " (failed)";
+		}
+		std::cout << std::endl;
+	}
+
+	std::cout << "Startup: " << m_tasks.size() << " tasks ran in " << m_runMilliseconds << " ms on "
+		<< (m_workerCount + 1) << " threads, " << serialMilliseconds << " ms one after another";
+	if (m_firstFrameMilliseconds >= 0.0)
+	{
+		std::cout << ", first frame queued at " << m_firstFrameMilliseconds << " ms";
+	}
+	std::cout << std::endl;
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for writing every task as a complete
+ *  event of the Chrome trace format, one row per thread,
+ *  with the first frame as an instant event.
+ ***********************************************************/
+bool StartupGraph::WriteTrace(const char* filename)
+{
+	std::ofstream file(filename, std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write startup trace: " << filename << std::endl;
+		return(false);
+	}
+
+	// the trace format counts in microseconds
+	file << std::fixed << std::setprecision(1);
+	file << "{\"traceEvents\":[\n";
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		const STARTUP_TASK& task = m_tasks[i];
+		file << "{\"name\":\"" << task.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << task.threadIndex
+			<< ",\"ts\":" << (task.startMilliseconds * 1000.0)
+			<< ",\"dur\":" << ((task.endMilliseconds - task.startMilliseconds) * 1000.0)
+			<< ",\"args\":{\"thread\":\"" << ((task.thread == TASK_GL) ? "gl" : "worker")
+			<< "\",\"result\":\"" << ((task.bSkipped == true) ? "skipped" : ((task.bSucceeded == true) ? "ok" : "failed"))
+			<< "\"}},\n";
+	}
+	if (m_firstFrameMilliseconds >= 0.0)
+	{
+		file << "{\"name\":\"first frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":"
+			<< (m_firstFrameMilliseconds * 1000.0) << "},\n";
+	}
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gl\"}}\n";
+	file << "]}\n";
+
+	return(true);
+}
\ No newline at end of file
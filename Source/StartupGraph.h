@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupgraph.h
+// ============
+// run the startup steps as a dependency graph, with the file and CPU work
+// on worker threads, and trace when each step ran
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StartupGraph
+ *
+ *  This class contains the code for running the steps of
+ *  the application's startup as tasks that declare the
+ *  tasks they depend on.  A task starts as soon as all of
+ *  its dependencies finished, so the file reads, image
+ *  decodes and mesh generation run at the same time on
+ *  worker threads.  Tasks that call OpenGL run one at a
+ *  time on the thread that calls Run(), which owns the
+ *  context.  A task that fails skips every task depending
+ *  on it.  The start and end of every task are kept as a
+ *  trace, together with the time the first frame was
+ *  queued, measured from the graph's creation.
+ ***********************************************************/
+class StartupGraph
+{
+public:
+	// constructor
+	StartupGraph();
+	// destructor
+	~StartupGraph();
+
+	// threads a task may run on
+	enum TASK_THREAD
+	{
+		// any worker thread - the task must not call OpenGL
+		TASK_WORKER,
+		// the thread that calls Run(), which owns the context
+		TASK_GL
+	};
+
+private:
+	struct STARTUP_TASK
+	{
+		std::string name;
+		TASK_THREAD thread;
+		std::function<bool()> run;
+		// tasks waiting on this one, and the dependencies this
+		// one still waits on
+		std::vector<int> dependents;
+		int pendingCount;
+		// a dependency failed, so the task is not run
+		bool bSkipped;
+		bool bSucceeded;
+		// when the task ran, in milliseconds from the creation
+		// of the graph, and the thread it ran on - 0 is the GL
+		// thread
+		double startMilliseconds;
+		double endMilliseconds;
+		int threadIndex;
+	};
+
+	std::vector<STARTUP_TASK> m_tasks;
+	// tasks whose dependencies finished, by the thread they
+	// run on
+	std::deque<int> m_workerQueue;
+	std::deque<int> m_glQueue;
+	int m_finishedCount;
+	bool m_bStopping;
+	int m_workerCount;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workerReady;
+	std::condition_variable m_glReady;
+
+	std::chrono::steady_clock::time_point m_origin;
+	// total time of Run(), and when the first frame was queued
+	double m_runMilliseconds;
+	double m_firstFrameMilliseconds;
+
+	double GetMilliseconds();
+	// whether the dependencies form a cycle
+	bool HasCycle();
+	// run one task and release the tasks waiting on it
+	void RunTask(int task, int threadIndex);
+	void WorkerLoop(int threadIndex);
+
+public:
+	// add a task and get its index
+	int AddTask(const std::string& name, TASK_THREAD thread, std::function<bool()> run);
+	// make a task wait for another one - an index below 0 is
+	// ignored, so optional steps can be passed as -1
+	void AddDependency(int task, int dependency);
+
+	// run every task, returning when all of them finished -
+	// fails when any task failed or the tasks form a cycle
+	bool Run();
+
+	// note the time the first frame was queued
+	void MarkFirstFrame();
+
+	// print when each task ran and on which thread
+	void PrintTrace();
+	// write the trace as Chrome trace events, which can be
+	// opened in chrome://tracing or Perfetto
+	bool WriteTrace(const char* filename);
+};
\ No newline at end of file
@@ -0,0 +1,433 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticbatches.cpp
+// ============
+// merge the static scene objects that share shader state into
+// world-space vertex and index buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StaticBatches.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// size of the square floor cells the batches are split by -
+	// a cell holds a few desks of a stress scene, and the cell
+	// around the origin holds the whole desk scene
+	const float BATCH_CELL_SIZE = 160.0f;
+
+	/***********************************************************
+	 *  GetCellKey()
+	 *
+	 *  Pack the coordinates of a floor cell into one key.
+	 ***********************************************************/
+	long long GetCellKey(int cellX, int cellZ)
+	{
+		return(((long long)cellZ << 32) | (unsigned int)cellX);
+	}
+}
+
+/***********************************************************
+ *  StaticBatches()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StaticBatches::StaticBatches(MeshBuffer* pMeshBuffer)
+{
+	m_pMeshBuffer = pMeshBuffer;
+}
+
+/***********************************************************
+ *  ~StaticBatches()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StaticBatches::~StaticBatches()
+{
+	for (int i = 0; i < m_batches.size(); i++)
+	{
+		m_pMeshBuffer->RemoveMesh(m_batches[i].meshID);
+	}
+	m_batches.clear();
+	m_cellBatches.clear();
+	m_objects.clear();
+	m_pMeshBuffer = NULL;
+}
+
+/***********************************************************
+ *  KeysMatch()
+ *
+ *  This method is used for checking whether two objects can
+ *  be drawn with the same shader state.
+ ***********************************************************/
+bool StaticBatches::KeysMatch(const BATCH_KEY& first, const BATCH_KEY& second)
+{
+	if ((first.materialIndex != second.materialIndex) ||
+		(first.bUseTexture != second.bUseTexture) ||
+		(first.uvScale != second.uvScale))
+	{
+		return(false);
+	}
+
+	// only the value that the shader reads has to match
+	if (first.bUseTexture == true)
+	{
+		return(first.textureSlot == second.textureSlot);
+	}
+
+	return(first.color == second.color);
+}
+
+/***********************************************************
+ *  FindBatch()
+ *
+ *  This method is used for getting the batch that holds the
+ *  objects of a floor cell with the passed in shader state.
+ *  A new, empty batch is added when there is no match.
+ ***********************************************************/
+int StaticBatches::FindBatch(const BATCH_KEY& key, int cellX, int cellZ)
+{
+	std::vector<int>& cellBatches = m_cellBatches[GetCellKey(cellX, cellZ)];
+	for (int i = 0; i < cellBatches.size(); i++)
+	{
+		if (KeysMatch(m_batches[cellBatches[i]].key, key) == true)
+		{
+			return(cellBatches[i]);
+		}
+	}
+
+	BATCH batch;
+	batch.key = key;
+	batch.cellX = cellX;
+	batch.cellZ = cellZ;
+	batch.meshID = -1;
+	batch.bRebuild = true;
+	batch.dirtyBegin = 0;
+	batch.dirtyEnd = 0;
+	m_batches.push_back(batch);
+	cellBatches.push_back((int)m_batches.size() - 1);
+
+	return((int)m_batches.size() - 1);
+}
+
+/***********************************************************
+ *  BakeObject()
+ *
+ *  This method is used for transforming the vertices of the
+ *  object's shape into world space and writing them into
+ *  the object's range of its batch, one vertex for each
+ *  index of the shape.
+ ***********************************************************/
+void StaticBatches::BakeObject(int objectID)
+{
+	STATIC_OBJECT& object = m_objects[objectID];
+	BATCH& batch = m_batches[object.batchIndex];
+	const MESH_DATA& shape = ShapeGeometry::GetShape(object.mesh);
+
+	// normals are transformed by the inverse transpose so they
+	// stay perpendicular under non-uniform scaling
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(object.model)));
+
+	object.boundsMin = glm::vec3(object.model[3]);
+	object.boundsMax = object.boundsMin;
+	for (unsigned int i = 0; i < object.vertexCount; i++)
+	{
+		const MESH_VERTEX& source = shape.vertices[shape.indices[i]];
+		MESH_VERTEX& baked = batch.vertices[object.firstVertex + i];
+
+		baked.position = glm::vec3(object.model * glm::vec4(source.position, 1.0f));
+		baked.normal = glm::normalize(normalMatrix * source.normal);
+		baked.textureCoordinate = source.textureCoordinate;
+
+		if (i == 0)
+		{
+			object.boundsMin = baked.position;
+			object.boundsMax = baked.position;
+		}
+		object.boundsMin = glm::min(object.boundsMin, baked.position);
+		object.boundsMax = glm::max(object.boundsMax, baked.position);
+	}
+
+	// extend the range that has to be uploaded again
+	if (batch.dirtyBegin == batch.dirtyEnd)
+	{
+		batch.dirtyBegin = object.firstVertex;
+		batch.dirtyEnd = object.firstVertex + object.vertexCount;
+	}
+	else
+	{
+		batch.dirtyBegin = std::min(batch.dirtyBegin, object.firstVertex);
+		batch.dirtyEnd = std::max(batch.dirtyEnd, object.firstVertex + object.vertexCount);
+	}
+}
+
+/***********************************************************
+ *  RebuildBatch()
+ *
+ *  This method is used for laying out all the objects of a
+ *  batch into one vertex and index list, baking them and
+ *  copying the result into the shared mesh buffer.
+ ***********************************************************/
+void StaticBatches::RebuildBatch(BATCH& batch)
+{
+	batch.vertices.clear();
+	batch.indices.clear();
+
+	// reserve the vertex range of every object first - each
+	// triangle gets its own three vertices, so it can have its
+	// own cell of the lightmap
+	for (int i = 0; i < batch.objectIDs.size(); i++)
+	{
+		STATIC_OBJECT& object = m_objects[batch.objectIDs[i]];
+		const MESH_DATA& shape = ShapeGeometry::GetShape(object.mesh);
+
+		object.firstVertex = (unsigned int)batch.vertices.size();
+		object.vertexCount = (unsigned int)shape.indices.size();
+		object.firstIndex = (unsigned int)batch.indices.size();
+		object.indexCount = (unsigned int)shape.indices.size();
+		batch.vertices.resize(batch.vertices.size() + shape.indices.size());
+
+		for (int j = 0; j < shape.indices.size(); j++)
+		{
+			batch.indices.push_back(object.firstVertex + j);
+		}
+	}
+	for (int i = 0; i < batch.objectIDs.size(); i++)
+	{
+		BakeObject(batch.objectIDs[i]);
+	}
+
+	// the size of the batch changed, so it moves to a new range
+	// of the shared mesh buffer
+	if (batch.meshID >= 0)
+	{
+		m_pMeshBuffer->RemoveMesh(batch.meshID);
+		batch.meshID = -1;
+	}
+	if (batch.indices.size() > 0)
+	{
+		batch.meshID = m_pMeshBuffer->AddMesh(
+			batch.vertices.data(),
+			(unsigned int)batch.vertices.size(),
+			batch.indices.data(),
+			(unsigned int)batch.indices.size());
+	}
+
+	batch.bRebuild = false;
+	batch.dirtyBegin = 0;
+	batch.dirtyEnd = 0;
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a static object to the
+ *  batch matching its shader state in the floor cell of its
+ *  origin.  The batch is laid out again on the next commit.
+ ***********************************************************/
+int StaticBatches::AddObject(SHAPE_MESH mesh, glm::mat4 model, BATCH_KEY key)
+{
+	STATIC_OBJECT object;
+	object.mesh = mesh;
+	object.model = model;
+	object.key = key;
+	// the cells are centered on the origin, so the desk scene
+	// stays in one cell
+	object.cellX = (int)std::floor(model[3].x / BATCH_CELL_SIZE + 0.5f);
+	object.cellZ = (int)std::floor(model[3].z / BATCH_CELL_SIZE + 0.5f);
+	object.batchIndex = FindBatch(key, object.cellX, object.cellZ);
+	object.firstVertex = 0;
+	object.vertexCount = 0;
+	object.firstIndex = 0;
+	object.indexCount = 0;
+	object.boundsMin = glm::vec3(model[3]);
+	object.boundsMax = object.boundsMin;
+	m_objects.push_back(object);
+
+	int objectID = (int)m_objects.size() - 1;
+	m_batches[object.batchIndex].objectIDs.push_back(objectID);
+	m_batches[object.batchIndex].bRebuild = true;
+
+	return(objectID);
+}
+
+/***********************************************************
+ *  SetObjectTransform()
+ *
+ *  This method is used for moving a static object.  Only the
+ *  vertices of the edited object are baked again, and only
+ *  that range of the batch is uploaded on the next commit.
+ ***********************************************************/
+void StaticBatches::SetObjectTransform(int objectID, glm::mat4 model)
+{
+	if ((objectID < 0) || (objectID >= m_objects.size()))
+	{
+		return;
+	}
+
+	m_objects[objectID].model = model;
+
+	// a batch waiting to be laid out bakes all its objects anyway
+	if (m_batches[m_objects[objectID].batchIndex].bRebuild == false)
+	{
+		BakeObject(objectID);
+	}
+}
+
+/***********************************************************
+ *  SetObjectKey()
+ *
+ *  This method is used for changing the shader state of a
+ *  static object, which moves it from its batch into the
+ *  batch matching the new state.
+ ***********************************************************/
+void StaticBatches::SetObjectKey(int objectID, BATCH_KEY key)
+{
+	if ((objectID < 0) || (objectID >= m_objects.size()))
+	{
+		return;
+	}
+
+	STATIC_OBJECT& object = m_objects[objectID];
+	int newBatch = FindBatch(key, object.cellX, object.cellZ);
+	object.key = key;
+	if (newBatch == object.batchIndex)
+	{
+		return;
+	}
+
+	std::vector<int>& oldObjects = m_batches[object.batchIndex].objectIDs;
+	oldObjects.erase(std::find(oldObjects.begin(), oldObjects.end(), objectID));
+	m_batches[object.batchIndex].bRebuild = true;
+
+	object.batchIndex = newBatch;
+	m_batches[newBatch].objectIDs.push_back(objectID);
+	m_batches[newBatch].bRebuild = true;
+}
+
+/***********************************************************
+ *  Commit()
+ *
+ *  This method is used for uploading the batch changes to
+ *  the GPU.  Batches whose objects changed are rebuilt and
+ *  batches with moved objects upload only the edited range.
+ ***********************************************************/
+void StaticBatches::Commit()
+{
+	for (int i = 0; i < m_batches.size(); i++)
+	{
+		BATCH& batch = m_batches[i];
+
+		if (batch.bRebuild == true)
+		{
+			RebuildBatch(batch);
+		}
+		else if (batch.dirtyBegin != batch.dirtyEnd)
+		{
+			// an object moved out of the bounds of compact vertices
+			// needs the batch quantized again
+			if (m_pMeshBuffer->UpdateVertices(
+				batch.meshID,
+				batch.dirtyBegin,
+				batch.dirtyEnd - batch.dirtyBegin,
+				&batch.vertices[batch.dirtyBegin]) == false)
+			{
+				RebuildBatch(batch);
+			}
+
+			batch.dirtyBegin = 0;
+			batch.dirtyEnd = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetBatchMesh()
+ *
+ *  This method is used for getting the mesh that holds the
+ *  merged geometry of a batch, which draws all its objects
+ *  with a single draw command.
+ ***********************************************************/
+int StaticBatches::GetBatchMesh(int batchIndex)
+{
+	return(m_batches[batchIndex].meshID);
+}
+
+/***********************************************************
+ *  GetBatchKey()
+ *
+ *  This method is used for getting the shader state that
+ *  a batch is drawn with.
+ ***********************************************************/
+const StaticBatches::BATCH_KEY& StaticBatches::GetBatchKey(int batchIndex)
+{
+	return(m_batches[batchIndex].key);
+}
+
+/***********************************************************
+ *  GetBatchObjects()
+ *
+ *  This method is used for getting the objects of a batch.
+ *  Their index ranges follow each other in this order, so
+ *  neighboring objects can be drawn with one command.
+ ***********************************************************/
+const std::vector<int>& StaticBatches::GetBatchObjects(int batchIndex)
+{
+	return(m_batches[batchIndex].objectIDs);
+}
+
+/***********************************************************
+ *  GetBatchVertices()
+ *
+ *  This method is used for getting the world space vertices
+ *  baked into a batch.
+ ***********************************************************/
+const std::vector<MESH_VERTEX>& StaticBatches::GetBatchVertices(int batchIndex)
+{
+	return(m_batches[batchIndex].vertices);
+}
+
+/***********************************************************
+ *  GetBatchIndices()
+ *
+ *  This method is used for getting the indices of a batch,
+ *  which point into the batch's vertices.
+ ***********************************************************/
+const std::vector<unsigned int>& StaticBatches::GetBatchIndices(int batchIndex)
+{
+	return(m_batches[batchIndex].indices);
+}
+
+/***********************************************************
+ *  GetObject()
+ *
+ *  This method is used for getting a static object with its
+ *  ranges in its batch and its world space bounds.
+ ***********************************************************/
+const StaticBatches::STATIC_OBJECT& StaticBatches::GetObject(int objectID)
+{
+	return(m_objects[objectID]);
+}
+
+/***********************************************************
+ *  GetBatchCount()
+ *
+ *  This method is used for getting the number of batches.
+ ***********************************************************/
+int StaticBatches::GetBatchCount()
+{
+	return((int)m_batches.size());
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of static
+ *  objects merged into the batches.
+ ***********************************************************/
+int StaticBatches::GetObjectCount()
+{
+	return((int)m_objects.size());
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticbatches.h
+// ============
+// merge the static scene objects that share shader state into
+// world-space vertex and index buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuffer.h"
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
+
+/***********************************************************
+ *  StaticBatches
+ *
+ *  This class contains the code for baking the vertices of
+ *  objects that never move into world space, grouped by the
+ *  material and texture they are drawn with, so each group
+ *  can be drawn with a single draw command.  The groups are
+ *  also split by square cells of the floor, which bounds
+ *  the size of a batch in large scenes and keeps the compact
+ *  positions it is quantized to precise.  The triangles do
+ *  not share vertices, so the lighting of each one can be
+ *  baked separately.
+ ***********************************************************/
+class StaticBatches
+{
+public:
+	// constructor
+	StaticBatches(MeshBuffer* pMeshBuffer);
+	// destructor
+	~StaticBatches();
+
+	// shader state shared by all the objects in a batch
+	struct BATCH_KEY
+	{
+		int materialIndex;
+		bool bUseTexture;
+		int textureSlot;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+	};
+
+	struct STATIC_OBJECT
+	{
+		SHAPE_MESH mesh;
+		glm::mat4 model;
+		BATCH_KEY key;
+		// floor cell the object was added in, which it keeps
+		// when it is moved
+		int cellX;
+		int cellZ;
+		int batchIndex;
+		// range of the baked vertices and indices in the batch
+		unsigned int firstVertex;
+		unsigned int vertexCount;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		// world space bounding box of the baked vertices
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+
+private:
+	struct BATCH
+	{
+		BATCH_KEY key;
+		int cellX;
+		int cellZ;
+		std::vector<int> objectIDs;
+		std::vector<MESH_VERTEX> vertices;
+		std::vector<unsigned int> indices;
+		// range of the merged geometry in the shared mesh buffer
+		int meshID;
+		// the object list changed and the batch must be laid out again
+		bool bRebuild;
+		// range of vertices re-baked since the last upload
+		unsigned int dirtyBegin;
+		unsigned int dirtyEnd;
+	};
+
+	// pointer to the shared mesh buffer
+	MeshBuffer* m_pMeshBuffer;
+	// all the static objects, indexed by object ID
+	std::vector<STATIC_OBJECT> m_objects;
+	// the merged batches
+	std::vector<BATCH> m_batches;
+	// the batches of each floor cell, by the key of the cell
+	std::map<long long, std::vector<int> > m_cellBatches;
+
+	// compare two batch keys
+	bool KeysMatch(const BATCH_KEY& first, const BATCH_KEY& second);
+	// find the batch for a key in a floor cell, adding a new
+	// batch if needed
+	int FindBatch(const BATCH_KEY& key, int cellX, int cellZ);
+	// transform the object's vertices into its batch
+	void BakeObject(int objectID);
+	// lay out all the objects of a batch and upload it
+	void RebuildBatch(BATCH& batch);
+
+public:
+	// add a static object and get its object ID
+	int AddObject(SHAPE_MESH mesh, glm::mat4 model, BATCH_KEY key);
+	// move a static object - only its vertices are re-baked
+	void SetObjectTransform(int objectID, glm::mat4 model);
+	// change the shader state of a static object, which moves
+	// it into another batch
+	void SetObjectKey(int objectID, BATCH_KEY key);
+	// upload the batches that changed to the GPU
+	void Commit();
+
+	// get the mesh holding the merged geometry of a batch,
+	// or -1 when the batch is empty
+	int GetBatchMesh(int batchIndex);
+	// get the shader state of a batch
+	const BATCH_KEY& GetBatchKey(int batchIndex);
+	// get the object IDs of a batch, in the order their
+	// indices are laid out in the batch
+	const std::vector<int>& GetBatchObjects(int batchIndex);
+	// get the baked world space geometry of a batch
+	const std::vector<MESH_VERTEX>& GetBatchVertices(int batchIndex);
+	const std::vector<unsigned int>& GetBatchIndices(int batchIndex);
+	// get a static object, valid after the last commit
+	const STATIC_OBJECT& GetObject(int objectID);
+
+	int GetBatchCount();
+	int GetObjectCount();
+};
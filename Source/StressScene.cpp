@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.cpp
+// ============
+// replicate the desk scene into a seeded grid of varied desks for
+// scaling tests
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StressScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// size of the floor tile of a desk - the plane mesh reaches
+	// from -1 to 1 and the floor is scaled by 20 and 10
+	const float DESK_SPACING_X = 40.0f;
+	const float DESK_SPACING_Z = 20.0f;
+	// chance of a placed texture or material being swapped
+	const float SWAP_CHANCE = 0.5f;
+	// height and rate of the bob, and the speed of the spin,
+	// of the moving objects
+	const float BOB_HEIGHT = 0.25f;
+	const float BOB_RADIANS_PER_SECOND = 2.0f;
+	const float SPIN_DEGREES_PER_SECOND = 45.0f;
+	const float TWO_PI = 6.28318530718f;
+}
+
+/***********************************************************
+ *  StressScene()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StressScene::StressScene(const SETTINGS& settings)
+{
+	m_settings = settings;
+	if (m_settings.deskCount > MAX_DESKS)
+	{
+		std::cout << "Stress scene limited to " << MAX_DESKS << " desks instead of "
+			<< m_settings.deskCount << std::endl;
+		m_settings.deskCount = MAX_DESKS;
+	}
+	m_settings.deskCount = std::max(m_settings.deskCount, 1);
+	m_settings.movingFraction = std::min(std::max(m_settings.movingFraction, 0.0f), 1.0f);
+	m_columns = (int)std::ceil(std::sqrt((double)m_settings.deskCount));
+	m_desk = 0;
+	m_objectCount = 0;
+	m_textureSwaps = 0;
+	m_materialSwaps = 0;
+}
+
+/***********************************************************
+ *  ~StressScene()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StressScene::~StressScene()
+{
+	m_movingObjects.clear();
+}
+
+/***********************************************************
+ *  NextUnit()
+ *
+ *  This method is used for getting the next number of the
+ *  desk's generator, from 0 up to but not including 1.  The
+ *  output of the Mersenne twister is fixed by the standard,
+ *  but the distributions are not, so the number is built
+ *  from the raw bits to give the same scene on every
+ *  compiler.
+ ***********************************************************/
+float StressScene::NextUnit()
+{
+	return((float)(m_random() >> 8) * (1.0f / 16777216.0f));
+}
+
+/***********************************************************
+ *  GetDeskCount()
+ *
+ *  This method is used for getting the number of desks to
+ *  place.
+ ***********************************************************/
+int StressScene::GetDeskCount()
+{
+	return(m_settings.deskCount);
+}
+
+/***********************************************************
+ *  BeginDesk()
+ *
+ *  This method is used for starting to place a desk.  Its
+ *  generator is seeded from the scene seed and the desk
+ *  number, so the choices of a desk do not depend on how
+ *  many objects the desks before it placed.
+ ***********************************************************/
+void StressScene::BeginDesk(int desk)
+{
+	m_desk = desk;
+	std::seed_seq sequence{ m_settings.seed, (unsigned int)desk };
+	m_random.seed(sequence);
+}
+
+/***********************************************************
+ *  GetDeskOffset()
+ *
+ *  This method is used for getting the offset of the desk
+ *  being placed.  The floor tiles of the desks meet, and the
+ *  grid is centered where the one desk stands.
+ ***********************************************************/
+glm::vec3 StressScene::GetDeskOffset()
+{
+	int column = m_desk % m_columns;
+	int row = m_desk / m_columns;
+	int rows = (m_settings.deskCount + m_columns - 1) / m_columns;
+
+	return(glm::vec3(
+		(column - (m_columns - 1) / 2) * DESK_SPACING_X,
+		0.0f,
+		(row - (rows - 1) / 2) * DESK_SPACING_Z));
+}
+
+/***********************************************************
+ *  GetCenterDesk()
+ *
+ *  This method is used for getting the desk with no offset,
+ *  in the middle column of the middle row.  The rows before
+ *  the last are full, so the desk always exists.
+ ***********************************************************/
+int StressScene::GetCenterDesk()
+{
+	int rows = (m_settings.deskCount + m_columns - 1) / m_columns;
+
+	return(((rows - 1) / 2) * m_columns + (m_columns - 1) / 2);
+}
+
+/***********************************************************
+ *  PickTexture()
+ *
+ *  This method is used for keeping the placed texture slot,
+ *  or swapping it for a random loaded texture.
+ ***********************************************************/
+int StressScene::PickTexture(int textureSlot, int textureCount)
+{
+	if ((textureSlot < 0) || (textureCount <= 1) || (NextUnit() >= SWAP_CHANCE))
+	{
+		return(textureSlot);
+	}
+
+	m_textureSwaps++;
+	return(std::min((int)(NextUnit() * textureCount), textureCount - 1));
+}
+
+/***********************************************************
+ *  PickMaterial()
+ *
+ *  This method is used for keeping the placed material, or
+ *  swapping it for a random defined material.
+ ***********************************************************/
+int StressScene::PickMaterial(int materialIndex, int materialCount)
+{
+	if ((materialIndex < 0) || (materialCount <= 1) || (NextUnit() >= SWAP_CHANCE))
+	{
+		return(materialIndex);
+	}
+
+	m_materialSwaps++;
+	return(std::min((int)(NextUnit() * materialCount), materialCount - 1));
+}
+
+/***********************************************************
+ *  PickMoving()
+ *
+ *  This method is used for deciding whether the next placed
+ *  object moves.  A number is drawn for every object, so the
+ *  choices after it do not depend on the moving fraction.
+ ***********************************************************/
+bool StressScene::PickMoving()
+{
+	m_objectCount++;
+	return(NextUnit() < m_settings.movingFraction);
+}
+
+/***********************************************************
+ *  AddMovingObject()
+ *
+ *  This method is used for adding an entity that moves, with
+ *  the transform it was placed at.  The start of its bob and
+ *  the direction of its spin are drawn from the desk's
+ *  generator.
+ ***********************************************************/
+void StressScene::AddMovingObject(
+	EntityStore::ENTITY_ID entity,
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if (entity == EntityStore::INVALID_ENTITY)
+	{
+		return;
+	}
+
+	MOVING_OBJECT object;
+	object.entity = entity;
+	object.scaleXYZ = scaleXYZ;
+	object.rotationDegrees = rotationDegrees;
+	object.positionXYZ = positionXYZ;
+	object.phase = NextUnit() * TWO_PI;
+	object.spinDirection = (NextUnit() < 0.5f) ? -1.0f : 1.0f;
+	m_movingObjects.push_back(object);
+}
+
+/***********************************************************
+ *  GetSweptBounds()
+ *
+ *  This method is used for widening the bounds of a moving
+ *  object at its placed transform.  The spin turns it around
+ *  its position, so the bounds become a square around the
+ *  position reaching the farthest corner, and the bob moves
+ *  them up and down.
+ ***********************************************************/
+void StressScene::GetSweptBounds(glm::vec3 position, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	glm::vec3 reach = glm::max(glm::abs(boundsMin - position), glm::abs(boundsMax - position));
+	float radius = std::sqrt(reach.x * reach.x + reach.z * reach.z);
+
+	boundsMin = glm::vec3(position.x - radius, boundsMin.y - BOB_HEIGHT, position.z - radius);
+	boundsMax = glm::vec3(position.x + radius, boundsMax.y + BOB_HEIGHT, position.z + radius);
+}
+
+/***********************************************************
+ *  Animate()
+ *
+ *  This method is used for setting the transforms of the
+ *  moving objects at the passed in time.  The transforms
+ *  only depend on the time, so a replay at a fixed frame
+ *  rate moves them the same way every run.
+ ***********************************************************/
+void StressScene::Animate(EntityStore* pEntityStore, float seconds)
+{
+	for (size_t i = 0; i < m_movingObjects.size(); i++)
+	{
+		const MOVING_OBJECT& object = m_movingObjects[i];
+
+		glm::vec3 position = object.positionXYZ;
+		position.y += BOB_HEIGHT * std::sin(object.phase + seconds * BOB_RADIANS_PER_SECOND);
+		glm::vec3 rotation = object.rotationDegrees;
+		rotation.y += std::fmod(object.spinDirection * SPIN_DEGREES_PER_SECOND * seconds, 360.0f);
+
+		pEntityStore->SetTransform(object.entity, object.scaleXYZ, rotation, position);
+	}
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the size of the
+ *  generated scene and how much of it was varied.
+ ***********************************************************/
+void StressScene::PrintReport()
+{
+	std::cout << "Stress scene: " << m_settings.deskCount << " desks in rows of " << m_columns
+		<< " from seed " << m_settings.seed << ", " << m_objectCount << " objects, "
+		<< m_movingObjects.size() << " moving, " << m_textureSwaps << " textures and "
+		<< m_materialSwaps << " materials swapped" << std::endl;
+}
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.h
+// ============
+// replicate the desk scene into a seeded grid of varied desks for
+// scaling tests
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "EntityStore.h"
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <vector>
+
+/***********************************************************
+ *  StressScene
+ *
+ *  This class contains the code for turning the one desk of
+ *  the scene into a square grid of up to 100000 desks, each
+ *  on its own floor tile.  Every desk swaps some of its
+ *  textures and materials for other loaded ones, and a
+ *  fraction of its objects move instead of being batched.
+ *  Each desk draws its choices from its own generator seeded
+ *  with the scene seed and the desk number, so a seed always
+ *  gives the same scene, and a desk looks the same in grids
+ *  of any size.
+ ***********************************************************/
+class StressScene
+{
+public:
+	// how the scene is replicated
+	struct SETTINGS
+	{
+		int deskCount;
+		unsigned int seed;
+		// fraction of the objects that move, from 0 to 1
+		float movingFraction;
+	};
+
+	// constructor
+	StressScene(const SETTINGS& settings);
+	// destructor
+	~StressScene();
+
+	// largest grid that can be generated - only the desk where
+	// the one desk stands is baked into the batches, and the
+	// others are entities drawing the shared shape meshes, at
+	// about 3.3 KB of components a desk, so the limit keeps the
+	// scene well within the memory of a 32 bit process
+	static const int MAX_DESKS = 100000;
+
+private:
+	// an object that bobs and spins around its placed transform
+	struct MOVING_OBJECT
+	{
+		EntityStore::ENTITY_ID entity;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		// start of the bob in radians, and the spin direction
+		float phase;
+		float spinDirection;
+	};
+
+	SETTINGS m_settings;
+	// desks in each row of the grid
+	int m_columns;
+	// the desk being placed and its generator
+	int m_desk;
+	std::mt19937 m_random;
+	std::vector<MOVING_OBJECT> m_movingObjects;
+	// objects placed and the swaps made, for the report
+	int m_objectCount;
+	int m_textureSwaps;
+	int m_materialSwaps;
+
+	// get the next number of the desk's generator, from 0 to 1
+	float NextUnit();
+
+public:
+	// get the number of desks to place
+	int GetDeskCount();
+	// start placing a desk, seeding its generator
+	void BeginDesk(int desk);
+	// get the offset of the desk being placed in the grid
+	glm::vec3 GetDeskOffset();
+	// get the desk placed where the one desk stands
+	int GetCenterDesk();
+
+	// keep the placed texture or material, or swap it for a
+	// random loaded or defined one
+	int PickTexture(int textureSlot, int textureCount);
+	int PickMaterial(int materialIndex, int materialCount);
+	// decide whether the next placed object moves
+	bool PickMoving();
+	// add a moving object with the transform it was placed at
+	void AddMovingObject(EntityStore::ENTITY_ID entity, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ);
+	// widen the world bounds of a moving object placed at the
+	// passed in position to everywhere it bobs and spins to
+	void GetSweptBounds(glm::vec3 position, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+	// set the transforms of the moving objects at the passed in
+	// time since the scene was prepared
+	void Animate(EntityStore* pEntityStore, float seconds);
+
+	// print the size and the variation of the generated scene
+	void PrintReport();
+};
@@ -0,0 +1,733 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// build the world matrices of many objects at once from scale, Euler
+// rotation and position stored as structure of arrays
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+// the vector kernels are compiled in when the compiler targets
+// the instruction set - x64 always has SSE2, and AVX needs
+// /arch:AVX or -mavx
+#if defined(__AVX__)
+#define TRANSFORM_BATCH_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRANSFORM_BATCH_SSE
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX)
+#include <immintrin.h>
+#elif defined(TRANSFORM_BATCH_SSE)
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const float DEGREES_TO_RADIANS = 0.0174532925f;
+	const float TWO_OVER_PI = 0.636619772f;
+	// pi / 2 split in two, so the reduced angle keeps its
+	// precision for larger angles
+	const float PI_OVER_TWO_HIGH = 1.57079637f;
+	const float PI_OVER_TWO_LOW = -4.37113900e-8f;
+	// polynomial coefficients of sine and cosine on the
+	// range [-pi/4, pi/4]
+	const float SIN_C1 = -1.6666654611e-1f;
+	const float SIN_C2 = 8.3321608736e-3f;
+	const float SIN_C3 = -1.9515295891e-4f;
+	const float COS_C1 = 4.166664568298827e-2f;
+	const float COS_C2 = -1.388731625493765e-3f;
+	const float COS_C3 = 2.443315711809948e-5f;
+
+	// object counts and work per count used by the benchmark
+	const int BENCHMARK_COUNTS[3] = { 1000, 100000, 1000000 };
+	const int BENCHMARK_OBJECTS_PER_COUNT = 4000000;
+
+	/***********************************************************
+	 *  SinCos()
+	 *
+	 *  Get the sine and cosine of an angle in degrees.  The
+	 *  angle is reduced to a quarter turn around zero, where
+	 *  both are polynomials, and the quadrant swaps and negates
+	 *  the results.  The vector kernels do the same steps.
+	 ***********************************************************/
+	inline void SinCos(float degrees, float& sine, float& cosine)
+	{
+		float x = degrees * DEGREES_TO_RADIANS;
+		float quadrant = std::floor(x * TWO_OVER_PI + 0.5f);
+		float r = (x - quadrant * PI_OVER_TWO_HIGH) - quadrant * PI_OVER_TWO_LOW;
+		float z = r * r;
+		float s = r + r * z * (SIN_C1 + z * (SIN_C2 + z * SIN_C3));
+		float c = 1.0f - 0.5f * z + z * z * (COS_C1 + z * (COS_C2 + z * COS_C3));
+
+		switch ((int)quadrant & 3)
+		{
+		case 0:
+			sine = s;
+			cosine = c;
+			break;
+		case 1:
+			sine = c;
+			cosine = -s;
+			break;
+		case 2:
+			sine = -s;
+			cosine = -c;
+			break;
+		default:
+			sine = -c;
+			cosine = s;
+			break;
+		}
+	}
+
+	/***********************************************************
+	 *  WriteMatrix()
+	 *
+	 *  Write the world matrix of one object in column major
+	 *  order.  The upper 3x3 is rotationX * rotationY *
+	 *  rotationZ multiplied out, with each column scaled.
+	 ***********************************************************/
+	inline void WriteMatrix(float* pOut, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+	{
+		float sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCos(rotationDegrees.x, sinX, cosX);
+		SinCos(rotationDegrees.y, sinY, cosY);
+		SinCos(rotationDegrees.z, sinZ, cosZ);
+
+		pOut[0] = cosY * cosZ * scaleXYZ.x;
+		pOut[1] = (cosX * sinZ + sinX * sinY * cosZ) * scaleXYZ.x;
+		pOut[2] = (sinX * sinZ - cosX * sinY * cosZ) * scaleXYZ.x;
+		pOut[3] = 0.0f;
+		pOut[4] = -cosY * sinZ * scaleXYZ.y;
+		pOut[5] = (cosX * cosZ - sinX * sinY * sinZ) * scaleXYZ.y;
+		pOut[6] = (sinX * cosZ + cosX * sinY * sinZ) * scaleXYZ.y;
+		pOut[7] = 0.0f;
+		pOut[8] = sinY * scaleXYZ.z;
+		pOut[9] = -sinX * cosY * scaleXYZ.z;
+		pOut[10] = cosX * cosY * scaleXYZ.z;
+		pOut[11] = 0.0f;
+		pOut[12] = positionXYZ.x;
+		pOut[13] = positionXYZ.y;
+		pOut[14] = positionXYZ.z;
+		pOut[15] = 1.0f;
+	}
+
+	/***********************************************************
+	 *  ComposeWithMatrices()
+	 *
+	 *  Build a world matrix the way SetTransformations() did,
+	 *  by multiplying the five glm matrices.  It is the
+	 *  baseline of the benchmark.
+	 ***********************************************************/
+	glm::mat4 ComposeWithMatrices(glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+	{
+		glm::mat4 scale = glm::scale(scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(positionXYZ);
+
+		return(translation * rotationX * rotationY * rotationZ * scale);
+	}
+
+	double ElapsedMilliseconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		return(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
+#if defined(TRANSFORM_BATCH_SSE)
+	/***********************************************************
+	 *  SinCosSSE()
+	 *
+	 *  Get the sines and cosines of four angles in degrees.
+	 ***********************************************************/
+	inline void SinCosSSE(__m128 degrees, __m128& sine, __m128& cosine)
+	{
+		__m128 x = _mm_mul_ps(degrees, _mm_set1_ps(DEGREES_TO_RADIANS));
+		// the conversion rounds to the nearest quadrant
+		__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+		__m128 q = _mm_cvtepi32_ps(quadrant);
+		__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(PI_OVER_TWO_HIGH))), _mm_mul_ps(q, _mm_set1_ps(PI_OVER_TWO_LOW)));
+		__m128 z = _mm_mul_ps(r, r);
+
+		__m128 s = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(SIN_C3)), _mm_set1_ps(SIN_C2));
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(SIN_C1));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+
+		__m128 c = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(COS_C3)), _mm_set1_ps(COS_C2));
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(COS_C1));
+		c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+		c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+		// odd quadrants swap sine and cosine, and the second bit
+		// of the quadrant gives the sign
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+		sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sinSign);
+		cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosSign);
+	}
+
+	/***********************************************************
+	 *  StoreColumnSSE()
+	 *
+	 *  Store one column of the world matrices of four objects.
+	 *  Each passed in vector holds one row of the column for
+	 *  all four objects, so they are transposed first.
+	 ***********************************************************/
+	inline void StoreColumnSSE(float* pOut, int column, __m128 row0, __m128 row1, __m128 row2, __m128 row3)
+	{
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		_mm_storeu_ps(pOut + column * 4, row0);
+		_mm_storeu_ps(pOut + 16 + column * 4, row1);
+		_mm_storeu_ps(pOut + 32 + column * 4, row2);
+		_mm_storeu_ps(pOut + 48 + column * 4, row3);
+	}
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX)
+	/***********************************************************
+	 *  SinCosAVX()
+	 *
+	 *  Get the sines and cosines of eight angles in degrees.
+	 *  AVX has no 256 bit integer operations, so the quadrant
+	 *  bits are found with float rounding instead.
+	 ***********************************************************/
+	inline void SinCosAVX(__m256 degrees, __m256& sine, __m256& cosine)
+	{
+		__m256 x = _mm256_mul_ps(degrees, _mm256_set1_ps(DEGREES_TO_RADIANS));
+		__m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(PI_OVER_TWO_HIGH))), _mm256_mul_ps(q, _mm256_set1_ps(PI_OVER_TWO_LOW)));
+		__m256 z = _mm256_mul_ps(r, r);
+
+		__m256 s = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(SIN_C3)), _mm256_set1_ps(SIN_C2));
+		s = _mm256_add_ps(_mm256_mul_ps(s, z), _mm256_set1_ps(SIN_C1));
+		s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, z), r), r);
+
+		__m256 c = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(COS_C3)), _mm256_set1_ps(COS_C2));
+		c = _mm256_add_ps(_mm256_mul_ps(c, z), _mm256_set1_ps(COS_C1));
+		c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+		c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(z, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.0f));
+
+		// quadrant modulo 4, from 0 to 3
+		__m256 quadrant = _mm256_sub_ps(q, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(q, _mm256_set1_ps(0.25f))), _mm256_set1_ps(4.0f)));
+		__m256 half = _mm256_mul_ps(quadrant, _mm256_set1_ps(0.5f));
+		__m256 swap = _mm256_cmp_ps(_mm256_sub_ps(half, _mm256_floor_ps(half)), _mm256_setzero_ps(), _CMP_NEQ_OQ);
+		__m256 signBit = _mm256_set1_ps(-0.0f);
+		__m256 sinSign = _mm256_and_ps(_mm256_cmp_ps(quadrant, _mm256_set1_ps(1.5f), _CMP_GT_OQ), signBit);
+		__m256 cosSign = _mm256_and_ps(_mm256_and_ps(
+			_mm256_cmp_ps(quadrant, _mm256_set1_ps(0.5f), _CMP_GT_OQ),
+			_mm256_cmp_ps(quadrant, _mm256_set1_ps(2.5f), _CMP_LT_OQ)), signBit);
+
+		sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sinSign);
+		cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosSign);
+	}
+
+	/***********************************************************
+	 *  StoreColumnAVX()
+	 *
+	 *  Store one column of the world matrices of eight objects
+	 *  as two groups of four.
+	 ***********************************************************/
+	inline void StoreColumnAVX(float* pOut, int column, __m256 row0, __m256 row1, __m256 row2, __m256 row3)
+	{
+		StoreColumnSSE(pOut, column,
+			_mm256_castps256_ps128(row0), _mm256_castps256_ps128(row1),
+			_mm256_castps256_ps128(row2), _mm256_castps256_ps128(row3));
+		StoreColumnSSE(pOut + 64, column,
+			_mm256_extractf128_ps(row0, 1), _mm256_extractf128_ps(row1, 1),
+			_mm256_extractf128_ps(row2, 1), _mm256_extractf128_ps(row3, 1));
+	}
+#endif
+}
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+	m_kernel = GetBestKernel();
+}
+
+/***********************************************************
+ *  ~TransformBatch()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformBatch::~TransformBatch()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  AddTransform()
+ *
+ *  This method is used for adding an object with the passed
+ *  in scale, rotation in degrees and position.  The world
+ *  matrix is built by the next ComputeWorldMatrices().
+ ***********************************************************/
+int TransformBatch::AddTransform(glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+{
+	m_scaleX.push_back(scaleXYZ.x);
+	m_scaleY.push_back(scaleXYZ.y);
+	m_scaleZ.push_back(scaleXYZ.z);
+	m_rotationX.push_back(rotationDegrees.x);
+	m_rotationY.push_back(rotationDegrees.y);
+	m_rotationZ.push_back(rotationDegrees.z);
+	m_positionX.push_back(positionXYZ.x);
+	m_positionY.push_back(positionXYZ.y);
+	m_positionZ.push_back(positionXYZ.z);
+
+	return((int)m_scaleX.size() - 1);
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for changing the transform of an
+ *  object that was added before.
+ ***********************************************************/
+void TransformBatch::SetTransform(int index, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+{
+	if ((index < 0) || (index >= m_scaleX.size()))
+	{
+		return;
+	}
+
+	m_scaleX[index] = scaleXYZ.x;
+	m_scaleY[index] = scaleXYZ.y;
+	m_scaleZ[index] = scaleXYZ.z;
+	m_rotationX[index] = rotationDegrees.x;
+	m_rotationY[index] = rotationDegrees.y;
+	m_rotationZ[index] = rotationDegrees.z;
+	m_positionX[index] = positionXYZ.x;
+	m_positionY[index] = positionXYZ.y;
+	m_positionZ[index] = positionXYZ.z;
+}
+
+/***********************************************************
+ *  RemoveTransform()
+ *
+ *  This method is used for removing an object in constant
+ *  time.  The last object is moved into the removed index,
+ *  so only its index changes.  The index the moved object
+ *  had is returned.
+ ***********************************************************/
+int TransformBatch::RemoveTransform(int index)
+{
+	int last = GetCount() - 1;
+	if ((index < 0) || (index > last))
+	{
+		return(-1);
+	}
+
+	m_scaleX[index] = m_scaleX[last];
+	m_scaleY[index] = m_scaleY[last];
+	m_scaleZ[index] = m_scaleZ[last];
+	m_rotationX[index] = m_rotationX[last];
+	m_rotationY[index] = m_rotationY[last];
+	m_rotationZ[index] = m_rotationZ[last];
+	m_positionX[index] = m_positionX[last];
+	m_positionY[index] = m_positionY[last];
+	m_positionZ[index] = m_positionZ[last];
+	if (m_worldMatrices.size() == (size_t)(last + 1))
+	{
+		m_worldMatrices[index] = m_worldMatrices[last];
+		m_worldMatrices.pop_back();
+	}
+
+	m_scaleX.pop_back();
+	m_scaleY.pop_back();
+	m_scaleZ.pop_back();
+	m_rotationX.pop_back();
+	m_rotationY.pop_back();
+	m_rotationZ.pop_back();
+	m_positionX.pop_back();
+	m_positionY.pop_back();
+	m_positionZ.pop_back();
+
+	return(last);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the objects.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+	m_worldMatrices.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room for the passed in
+ *  number of objects, so adding them does not reallocate.
+ ***********************************************************/
+void TransformBatch::Reserve(int count)
+{
+	m_scaleX.reserve(count);
+	m_scaleY.reserve(count);
+	m_scaleZ.reserve(count);
+	m_rotationX.reserve(count);
+	m_rotationY.reserve(count);
+	m_rotationZ.reserve(count);
+	m_positionX.reserve(count);
+	m_positionY.reserve(count);
+	m_positionZ.reserve(count);
+	m_worldMatrices.reserve(count);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of objects.
+ ***********************************************************/
+int TransformBatch::GetCount()
+{
+	return((int)m_scaleX.size());
+}
+
+/***********************************************************
+ *  ComputeScalar()
+ *
+ *  This method is used for building the world matrices of
+ *  the objects in the passed in range one at a time.
+ ***********************************************************/
+void TransformBatch::ComputeScalar(int first, int last)
+{
+	for (int i = first; i < last; i++)
+	{
+		WriteMatrix(
+			&m_worldMatrices[i][0][0],
+			glm::vec3(m_scaleX[i], m_scaleY[i], m_scaleZ[i]),
+			glm::vec3(m_rotationX[i], m_rotationY[i], m_rotationZ[i]),
+			glm::vec3(m_positionX[i], m_positionY[i], m_positionZ[i]));
+	}
+}
+
+/***********************************************************
+ *  ComputeSSE()
+ *
+ *  This method is used for building the world matrices of
+ *  the objects in the passed in range four at a time.  The
+ *  objects left over are built by the scalar kernel.
+ ***********************************************************/
+void TransformBatch::ComputeSSE(int first, int last)
+{
+#if defined(TRANSFORM_BATCH_SSE)
+	int i = first;
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCosSSE(_mm_loadu_ps(&m_rotationX[i]), sinX, cosX);
+		SinCosSSE(_mm_loadu_ps(&m_rotationY[i]), sinY, cosY);
+		SinCosSSE(_mm_loadu_ps(&m_rotationZ[i]), sinZ, cosZ);
+
+		__m128 scaleX = _mm_loadu_ps(&m_scaleX[i]);
+		__m128 scaleY = _mm_loadu_ps(&m_scaleY[i]);
+		__m128 scaleZ = _mm_loadu_ps(&m_scaleZ[i]);
+		__m128 sinXsinY = _mm_mul_ps(sinX, sinY);
+		__m128 cosXsinY = _mm_mul_ps(cosX, sinY);
+		__m128 zero = _mm_setzero_ps();
+		float* pOut = &m_worldMatrices[i][0][0];
+
+		StoreColumnSSE(pOut, 0,
+			_mm_mul_ps(_mm_mul_ps(cosY, cosZ), scaleX),
+			_mm_mul_ps(_mm_add_ps(_mm_mul_ps(cosX, sinZ), _mm_mul_ps(sinXsinY, cosZ)), scaleX),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sinX, sinZ), _mm_mul_ps(cosXsinY, cosZ)), scaleX),
+			zero);
+		StoreColumnSSE(pOut, 1,
+			_mm_mul_ps(_mm_sub_ps(zero, _mm_mul_ps(cosY, sinZ)), scaleY),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cosX, cosZ), _mm_mul_ps(sinXsinY, sinZ)), scaleY),
+			_mm_mul_ps(_mm_add_ps(_mm_mul_ps(sinX, cosZ), _mm_mul_ps(cosXsinY, sinZ)), scaleY),
+			zero);
+		StoreColumnSSE(pOut, 2,
+			_mm_mul_ps(sinY, scaleZ),
+			_mm_mul_ps(_mm_sub_ps(zero, _mm_mul_ps(sinX, cosY)), scaleZ),
+			_mm_mul_ps(_mm_mul_ps(cosX, cosY), scaleZ),
+			zero);
+		StoreColumnSSE(pOut, 3,
+			_mm_loadu_ps(&m_positionX[i]),
+			_mm_loadu_ps(&m_positionY[i]),
+			_mm_loadu_ps(&m_positionZ[i]),
+			_mm_set1_ps(1.0f));
+	}
+
+	ComputeScalar(i, last);
+#else
+	ComputeScalar(first, last);
+#endif
+}
+
+/***********************************************************
+ *  ComputeAVX()
+ *
+ *  This method is used for building the world matrices of
+ *  the objects in the passed in range eight at a time.  The
+ *  objects left over are built by the SSE kernel.
+ ***********************************************************/
+void TransformBatch::ComputeAVX(int first, int last)
+{
+#if defined(TRANSFORM_BATCH_AVX)
+	int i = first;
+	for (; i + 8 <= last; i += 8)
+	{
+		__m256 sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCosAVX(_mm256_loadu_ps(&m_rotationX[i]), sinX, cosX);
+		SinCosAVX(_mm256_loadu_ps(&m_rotationY[i]), sinY, cosY);
+		SinCosAVX(_mm256_loadu_ps(&m_rotationZ[i]), sinZ, cosZ);
+
+		__m256 scaleX = _mm256_loadu_ps(&m_scaleX[i]);
+		__m256 scaleY = _mm256_loadu_ps(&m_scaleY[i]);
+		__m256 scaleZ = _mm256_loadu_ps(&m_scaleZ[i]);
+		__m256 sinXsinY = _mm256_mul_ps(sinX, sinY);
+		__m256 cosXsinY = _mm256_mul_ps(cosX, sinY);
+		__m256 zero = _mm256_setzero_ps();
+		float* pOut = &m_worldMatrices[i][0][0];
+
+		StoreColumnAVX(pOut, 0,
+			_mm256_mul_ps(_mm256_mul_ps(cosY, cosZ), scaleX),
+			_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(cosX, sinZ), _mm256_mul_ps(sinXsinY, cosZ)), scaleX),
+			_mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(sinX, sinZ), _mm256_mul_ps(cosXsinY, cosZ)), scaleX),
+			zero);
+		StoreColumnAVX(pOut, 1,
+			_mm256_mul_ps(_mm256_sub_ps(zero, _mm256_mul_ps(cosY, sinZ)), scaleY),
+			_mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(cosX, cosZ), _mm256_mul_ps(sinXsinY, sinZ)), scaleY),
+			_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(sinX, cosZ), _mm256_mul_ps(cosXsinY, sinZ)), scaleY),
+			zero);
+		StoreColumnAVX(pOut, 2,
+			_mm256_mul_ps(sinY, scaleZ),
+			_mm256_mul_ps(_mm256_sub_ps(zero, _mm256_mul_ps(sinX, cosY)), scaleZ),
+			_mm256_mul_ps(_mm256_mul_ps(cosX, cosY), scaleZ),
+			zero);
+		StoreColumnAVX(pOut, 3,
+			_mm256_loadu_ps(&m_positionX[i]),
+			_mm256_loadu_ps(&m_positionY[i]),
+			_mm256_loadu_ps(&m_positionZ[i]),
+			_mm256_set1_ps(1.0f));
+	}
+
+	ComputeSSE(i, last);
+#else
+	ComputeSSE(first, last);
+#endif
+}
+
+/***********************************************************
+ *  ComputeWorldMatrices()
+ *
+ *  This method is used for building the world matrix of
+ *  every object with the chosen kernel.
+ ***********************************************************/
+void TransformBatch::ComputeWorldMatrices()
+{
+	int count = GetCount();
+	m_worldMatrices.resize(count);
+
+	switch (m_kernel)
+	{
+	case KERNEL_AVX:
+		ComputeAVX(0, count);
+		break;
+	case KERNEL_SSE:
+		ComputeSSE(0, count);
+		break;
+	default:
+		ComputeScalar(0, count);
+		break;
+	}
+}
+
+/***********************************************************
+ *  GetWorldMatrices()
+ *
+ *  This method is used for getting the world matrices built
+ *  by the last ComputeWorldMatrices(), in object order.
+ ***********************************************************/
+const glm::mat4* TransformBatch::GetWorldMatrices()
+{
+	return(m_worldMatrices.data());
+}
+
+/***********************************************************
+ *  GetWorldMatrix()
+ *
+ *  This method is used for getting the world matrix of one
+ *  object.
+ ***********************************************************/
+const glm::mat4& TransformBatch::GetWorldMatrix(int index)
+{
+	return(m_worldMatrices[index]);
+}
+
+/***********************************************************
+ *  SetKernel()
+ *
+ *  This method is used for choosing the kernel the world
+ *  matrices are built with.
+ ***********************************************************/
+void TransformBatch::SetKernel(KERNEL kernel)
+{
+	m_kernel = std::min(kernel, GetBestKernel());
+}
+
+/***********************************************************
+ *  GetKernel()
+ *
+ *  This method is used for getting the kernel the world
+ *  matrices are built with.
+ ***********************************************************/
+TransformBatch::KERNEL TransformBatch::GetKernel()
+{
+	return(m_kernel);
+}
+
+/***********************************************************
+ *  GetBestKernel()
+ *
+ *  This method is used for getting the widest kernel this
+ *  build was compiled with.
+ ***********************************************************/
+TransformBatch::KERNEL TransformBatch::GetBestKernel()
+{
+#if defined(TRANSFORM_BATCH_AVX)
+	return(KERNEL_AVX);
+#elif defined(TRANSFORM_BATCH_SSE)
+	return(KERNEL_SSE);
+#else
+	return(KERNEL_SCALAR);
+#endif
+}
+
+/***********************************************************
+ *  GetKernelName()
+ *
+ *  This method is used for getting the printable name of a
+ *  kernel.
+ ***********************************************************/
+const char* TransformBatch::GetKernelName(KERNEL kernel)
+{
+	switch (kernel)
+	{
+	case KERNEL_AVX:
+		return("AVX");
+	case KERNEL_SSE:
+		return("SSE");
+	default:
+		return("scalar");
+	}
+}
+
+/***********************************************************
+ *  ComposeTransform()
+ *
+ *  This method is used for building the world matrix of a
+ *  single object with the scalar kernel.
+ ***********************************************************/
+glm::mat4 TransformBatch::ComposeTransform(glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ)
+{
+	glm::mat4 world;
+	WriteMatrix(&world[0][0], scaleXYZ, rotationDegrees, positionXYZ);
+
+	return(world);
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This method is used for timing the kernels against the
+ *  glm matrix products for 1k, 100k and 1M random objects.
+ *  Each count builds about the same number of matrices in
+ *  total, and the largest difference from the glm result is
+ *  printed with the time of each kernel.
+ ***********************************************************/
+void TransformBatch::RunBenchmark()
+{
+	std::mt19937 random(330);
+	std::uniform_real_distribution<float> scaleRange(0.1f, 5.0f);
+	std::uniform_real_distribution<float> angleRange(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> positionRange(-50.0f, 50.0f);
+
+	for (int c = 0; c < 3; c++)
+	{
+		int count = BENCHMARK_COUNTS[c];
+		int repeats = std::max(BENCHMARK_OBJECTS_PER_COUNT / count, 1);
+
+		TransformBatch batch;
+		for (int i = 0; i < count; i++)
+		{
+			batch.AddTransform(
+				glm::vec3(scaleRange(random), scaleRange(random), scaleRange(random)),
+				glm::vec3(angleRange(random), angleRange(random), angleRange(random)),
+				glm::vec3(positionRange(random), positionRange(random), positionRange(random)));
+		}
+
+		std::vector<glm::mat4> reference(count);
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeats; r++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				reference[i] = ComposeWithMatrices(
+					glm::vec3(batch.m_scaleX[i], batch.m_scaleY[i], batch.m_scaleZ[i]),
+					glm::vec3(batch.m_rotationX[i], batch.m_rotationY[i], batch.m_rotationZ[i]),
+					glm::vec3(batch.m_positionX[i], batch.m_positionY[i], batch.m_positionZ[i]));
+			}
+		}
+		double referenceNanoseconds = ElapsedMilliseconds(start) * 1000000.0 / ((double)count * repeats);
+
+		std::cout << "Transform benchmark, " << count << " objects:" << std::endl;
+		std::cout << "  glm matrices: " << referenceNanoseconds << " ns per object" << std::endl;
+
+		for (int k = KERNEL_SCALAR; k <= GetBestKernel(); k++)
+		{
+			batch.SetKernel((KERNEL)k);
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int r = 0; r < repeats; r++)
+			{
+				batch.ComputeWorldMatrices();
+			}
+			double nanoseconds = ElapsedMilliseconds(start) * 1000000.0 / ((double)count * repeats);
+
+			float maxError = 0.0f;
+			for (int i = 0; i < count; i++)
+			{
+				const float* pKernel = &batch.m_worldMatrices[i][0][0];
+				const float* pReference = &reference[i][0][0];
+				for (int e = 0; e < 16; e++)
+				{
+					maxError = std::max(maxError, std::fabs(pKernel[e] - pReference[e]));
+				}
+			}
+
+			std::cout << "  " << GetKernelName((KERNEL)k) << " kernel: " << nanoseconds << " ns per object, "
+				<< (referenceNanoseconds / nanoseconds) << "x faster, max difference " << maxError << std::endl;
+		}
+	}
+}
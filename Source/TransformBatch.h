@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// build the world matrices of many objects at once from scale, Euler
+// rotation and position stored as structure of arrays
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class contains the code for keeping the transforms
+ *  of many objects in one array per component, and for
+ *  building their world matrices with a kernel that works
+ *  on four (SSE) or eight (AVX) objects per step.  Each
+ *  matrix is written in closed form as
+ *  translation * rotationX * rotationY * rotationZ * scale,
+ *  the same order SceneManager::SetTransformations() uses,
+ *  without building and multiplying the five matrices.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+	// destructor
+	~TransformBatch();
+
+	// instruction sets the world matrices can be built with
+	enum KERNEL
+	{
+		KERNEL_SCALAR,
+		KERNEL_SSE,
+		KERNEL_AVX
+	};
+
+private:
+	// transform components, one array each - rotations are in
+	// degrees around the X, Y and Z axes
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	// world matrices built from the components
+	std::vector<glm::mat4> m_worldMatrices;
+	// kernel used by ComputeWorldMatrices()
+	KERNEL m_kernel;
+
+	// build the world matrices of part of the objects
+	void ComputeScalar(int first, int last);
+	void ComputeSSE(int first, int last);
+	void ComputeAVX(int first, int last);
+
+public:
+	// add an object and get its index
+	int AddTransform(glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ);
+	// change the transform of an object
+	void SetTransform(int index, glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ);
+	// remove an object by moving the last object into its
+	// index, and get the index the last object had
+	int RemoveTransform(int index);
+	// remove all the objects
+	void Clear();
+	// make room for the passed in number of objects
+	void Reserve(int count);
+	int GetCount();
+
+	// build the world matrices of every object
+	void ComputeWorldMatrices();
+	const glm::mat4* GetWorldMatrices();
+	const glm::mat4& GetWorldMatrix(int index);
+
+	// choose the kernel - kernels that were not compiled in
+	// fall back to the best one that was
+	void SetKernel(KERNEL kernel);
+	KERNEL GetKernel();
+	// best kernel this build supports
+	static KERNEL GetBestKernel();
+	static const char* GetKernelName(KERNEL kernel);
+
+	// build one world matrix with the scalar kernel
+	static glm::mat4 ComposeTransform(glm::vec3 scaleXYZ, glm::vec3 rotationDegrees, glm::vec3 positionXYZ);
+
+	// time every kernel against composing glm matrices for
+	// 1k, 100k and 1M objects and print the results
+	static void RunBenchmark();
+};
@@ -1,347 +1,681 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	// tell GLFW to capture all mouse events
-	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-	glfwSetScrollCallback(window, &ViewManager::scroll_callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	////Reference: LearnOpenGL - Camera. (n.d.).https://learnopengl.com/Getting-started/Camera  TR
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;// Stores the mouse initial x position 
-		gLastY = yMousePos;//Stores the mouse initial y position
-		gFirstMouse = false;
-	}
-
-	float xoffset = xMousePos - gLastX;
-	float yoffset = gLastY - yMousePos;
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-
-	//Sensitivity is defined for the mouse movement 
-	float sensitivity = 0.1f;
-	xoffset *= sensitivity;
-	yoffset *= sensitivity;
-
-
-	// Update the camera's yaw and pitch
-	g_pCamera->Yaw += xoffset;
-	g_pCamera->Pitch += yoffset;
-
-	// Pitch value is clamped to prevent camera from flipping
-	if (g_pCamera->Pitch > 89.0f)
-		g_pCamera->Pitch = 89.0f;
-	if (g_pCamera->Pitch < -89.0f)
-		g_pCamera->Pitch = -89.0f;
-
-	glm::vec3 direction;
-	direction.x = cos(glm::radians(g_pCamera->Yaw)) * cos(glm::radians(g_pCamera->Pitch));
-	direction.y = sin(glm::radians(g_pCamera->Pitch));
-	direction.z = sin(glm::radians(g_pCamera->Yaw)) * cos(glm::radians(g_pCamera->Pitch));
-	g_pCamera->Front = glm::normalize(direction);
-}
-
-
-/***********************************************************
- *  scroll_callback()
- *
- *  This method is called from GLFW when the mouse wheel is scrolled.
- ***********************************************************/
-
- //Reference: LearnOpenGL - Camera. (n.d.).https://learnopengl.com/Getting-started/Camera  TR
-void ViewManager::scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-
-
-	//  movement speed is clamped 
-	g_pCamera->MovementSpeed += (float)yoffset;
-	if (g_pCamera->MovementSpeed < 1.0f)
-		g_pCamera->MovementSpeed = 1.0f;
-	if (g_pCamera->MovementSpeed > 45.0f)
-		g_pCamera->MovementSpeed = 45.0f;
-
-
-
-}
-
-
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	
-	// Close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// If the camera object is null, then exit this method
-	if (NULL == g_pCamera)
-	{
-		return;
-	}
-
-	// Process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// Process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-
-	// Camera moves up and down using Q and E
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-	// change between different projection views
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
-	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
-
-		// change the camera settings to show a front orthographic view
-		g_pCamera->Position = glm::vec3(0.0f, 4.0f, 10.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
-	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
-
-		// change the camera settings to show a side orthographic view
-		g_pCamera->Position = glm::vec3(10.0f, 4.0f, 0.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(-1.0f, 0.0f, 0.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
-	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
-
-		// change the camera settings to show a top orthographic view
-		g_pCamera->Position = glm::vec3(0.0f, 7.0f, 0.0f);
-		g_pCamera->Up = glm::vec3(-1.0f, 0.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -1.0f, 0.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
-	{
-		// change to perspective projection
-		bOrthographicProjection = false;
-
-		// change the camera settings to show a perspective view
-		g_pCamera->Position = glm::vec3(0.0f, 5.5f, 8.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Zoom = 80;
-	}
-}
-	
-	
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	// define the current projection matrix
-	if (bOrthographicProjection == false)
-	{
-		// perspective projection
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-	}
-	else
-	{
-		// front-view orthographic projection with correct aspect ratio
-		double scale = 0.0;
-		if (WINDOW_WIDTH > WINDOW_HEIGHT)
-		{
-			scale = (double)WINDOW_HEIGHT / (double)WINDOW_WIDTH;
-			projection = glm::ortho(-5.0f, 5.0f, -5.0f * (float)scale, 5.0f * (float)scale, 0.1f, 100.0f);
-		}
-		else if (WINDOW_WIDTH < WINDOW_HEIGHT)
-		{
-			scale = (double)WINDOW_WIDTH / (double)WINDOW_HEIGHT;
-			projection = glm::ortho(-5.0f * (float)scale, 5.0f * (float)scale, -5.0f, 5.0f, 0.1f, 100.0f);
-		}
-		else
-		{
-			projection = glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f);
-		}
-	}
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for the initial window width and height
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+	// size of the window's framebuffer in pixels, kept current
+	// by the framebuffer size callback
+	int g_framebufferWidth = WINDOW_WIDTH;
+	int g_framebufferHeight = WINDOW_HEIGHT;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+	// recorder the camera input is written to or replayed from
+	InputRecorder* g_pInputRecorder = nullptr;
+	// keys that move the camera, change the projection or edit
+	// the scene, in the order of their bits in the held key mask
+	const int g_CameraKeys[] =
+		{ GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_Q, GLFW_KEY_E,
+		  GLFW_KEY_O, GLFW_KEY_2, GLFW_KEY_3, GLFW_KEY_P, GLFW_KEY_4, GLFW_KEY_M };
+	const int CAMERA_KEY_COUNT = sizeof(g_CameraKeys) / sizeof(g_CameraKeys[0]);
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// time between current frame and last frame
+	float gDeltaTime = 0.0f; 
+	float gLastFrame = 0.0f;
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+	// the following variable is true when the perspective and the
+	// front, side and top orthographic views are drawn together
+	bool bQuadView = false;
+
+	/***********************************************************
+	 *  MakeOrthographic()
+	 *
+	 *  Build the orthographic projection of a 10 unit wide view
+	 *  with the passed in aspect ratio.
+	 ***********************************************************/
+	glm::mat4 MakeOrthographic(GLfloat aspect)
+	{
+		if (aspect > 1.0f)
+		{
+			float scale = 1.0f / aspect;
+			return(glm::ortho(-5.0f, 5.0f, -5.0f * scale, 5.0f * scale, 0.1f, 100.0f));
+		}
+		if (aspect < 1.0f)
+		{
+			return(glm::ortho(-5.0f * aspect, 5.0f * aspect, -5.0f, 5.0f, 0.1f, 100.0f));
+		}
+
+		return(glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f));
+	}
+
+	/***********************************************************
+	 *  ApplyCursorPosition()
+	 *
+	 *  Turn the camera by the movement of the mouse cursor.
+	 ***********************************************************/
+	void ApplyCursorPosition(double xMousePos, double yMousePos)
+	{
+		////Reference: LearnOpenGL - Camera. (n.d.).https://learnopengl.com/Getting-started/Camera  TR
+		if (gFirstMouse)
+		{
+			gLastX = xMousePos;// Stores the mouse initial x position 
+			gLastY = yMousePos;//Stores the mouse initial y position
+			gFirstMouse = false;
+		}
+
+		float xoffset = xMousePos - gLastX;
+		float yoffset = gLastY - yMousePos;
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+
+
+		//Sensitivity is defined for the mouse movement 
+		float sensitivity = 0.1f;
+		xoffset *= sensitivity;
+		yoffset *= sensitivity;
+
+
+		// Update the camera's yaw and pitch
+		g_pCamera->Yaw += xoffset;
+		g_pCamera->Pitch += yoffset;
+
+		// Pitch value is clamped to prevent camera from flipping
+		if (g_pCamera->Pitch > 89.0f)
+			g_pCamera->Pitch = 89.0f;
+		if (g_pCamera->Pitch < -89.0f)
+			g_pCamera->Pitch = -89.0f;
+
+		glm::vec3 direction;
+		direction.x = cos(glm::radians(g_pCamera->Yaw)) * cos(glm::radians(g_pCamera->Pitch));
+		direction.y = sin(glm::radians(g_pCamera->Pitch));
+		direction.z = sin(glm::radians(g_pCamera->Yaw)) * cos(glm::radians(g_pCamera->Pitch));
+		g_pCamera->Front = glm::normalize(direction);
+	}
+
+	/***********************************************************
+	 *  ApplyScroll()
+	 *
+	 *  Change the camera movement speed by the mouse wheel.
+	 ***********************************************************/
+	void ApplyScroll(double yoffset)
+	{
+		//Reference: LearnOpenGL - Camera. (n.d.).https://learnopengl.com/Getting-started/Camera  TR
+		//  movement speed is clamped 
+		g_pCamera->MovementSpeed += (float)yoffset;
+		if (g_pCamera->MovementSpeed < 1.0f)
+			g_pCamera->MovementSpeed = 1.0f;
+		if (g_pCamera->MovementSpeed > 45.0f)
+			g_pCamera->MovementSpeed = 45.0f;
+	}
+
+	/***********************************************************
+	 *  GetCameraState()
+	 *
+	 *  Get the camera values that are recorded and compared by
+	 *  the input recorder.
+	 ***********************************************************/
+	InputRecorder::CAMERA_STATE GetCameraState()
+	{
+		InputRecorder::CAMERA_STATE camera;
+		camera.position = g_pCamera->Position;
+		camera.front = g_pCamera->Front;
+		camera.up = g_pCamera->Up;
+		camera.yaw = g_pCamera->Yaw;
+		camera.pitch = g_pCamera->Pitch;
+		camera.zoom = g_pCamera->Zoom;
+		camera.movementSpeed = g_pCamera->MovementSpeed;
+		return(camera);
+	}
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(
+	ShaderVariants *pShaderVariants)
+{
+	// initialize the member variables
+	m_pShaderVariants = pShaderVariants;
+	m_pWindow = NULL;
+	m_viewCount = 0;
+	m_heldKeys = 0;
+	m_lastHeldKeys = 0;
+	for (int i = 0; i < ShaderVariants::MAX_VIEWS; i++)
+	{
+		m_viewProjections[i] = glm::mat4(1.0f);
+		m_viewRects[i] = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+		m_viewPositions[i] = glm::vec3(0.0f);
+	}
+	g_pCamera = new Camera();
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
+	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 80;
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderVariants = NULL;
+	m_pWindow = NULL;
+	g_pInputRecorder = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// tell GLFW to capture all mouse events
+	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// this callback is used to receive mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+	glfwSetScrollCallback(window, &ViewManager::scroll_callback);
+	// this callback is used to receive window resizing events - the
+	// framebuffer can differ from the window size on high DPI screens
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+	glfwGetFramebufferSize(window, &g_framebufferWidth, &g_framebufferHeight);
+
+	// blending is enabled by the scene only for the transparent
+	// draws, so the opaque draws do not pay for it
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	// the replay turns the camera from the recorded events
+	if ((NULL != g_pInputRecorder) && (g_pInputRecorder->IsReplaying() == true))
+	{
+		return;
+	}
+	if (NULL != g_pInputRecorder)
+	{
+		g_pInputRecorder->RecordCursor(xMousePos, yMousePos);
+	}
+
+	ApplyCursorPosition(xMousePos, yMousePos);
+}
+
+
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the size of the window's framebuffer changes.  The size
+ *  is zero while the window is minimized.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	g_framebufferWidth = width;
+	g_framebufferHeight = height;
+}
+
+/***********************************************************
+ *  scroll_callback()
+ *
+ *  This method is called from GLFW when the mouse wheel is scrolled.
+ ***********************************************************/
+void ViewManager::scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	// the replay changes the speed from the recorded events
+	if ((NULL != g_pInputRecorder) && (g_pInputRecorder->IsReplaying() == true))
+	{
+		return;
+	}
+	if (NULL != g_pInputRecorder)
+	{
+		g_pInputRecorder->RecordScroll(xoffset, yoffset);
+	}
+
+	ApplyScroll(yoffset);
+}
+
+
+
+/***********************************************************
+ *  IsKeyHeld()
+ *
+ *  This method is used for checking whether one of the
+ *  camera keys is held in the current frame.
+ ***********************************************************/
+bool ViewManager::IsKeyHeld(int key)
+{
+	for (int i = 0; i < CAMERA_KEY_COUNT; i++)
+	{
+		if (g_CameraKeys[i] == key)
+		{
+			return((m_heldKeys & (1u << i)) != 0);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IsKeyPressed()
+ *
+ *  This method is used for checking whether one of the
+ *  camera keys went down in the current frame, after it was
+ *  not held in the last one.
+ ***********************************************************/
+bool ViewManager::IsKeyPressed(int key)
+{
+	for (int i = 0; i < CAMERA_KEY_COUNT; i++)
+	{
+		if (g_CameraKeys[i] == key)
+		{
+			return(((m_heldKeys & ~m_lastHeldKeys) & (1u << i)) != 0);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	
+	// Close the window if the escape key has been pressed
+	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// If the camera object is null, then exit this method
+	if (NULL == g_pCamera)
+	{
+		return;
+	}
+
+	// Process camera zooming in and out
+	if (IsKeyHeld(GLFW_KEY_W) == true)
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+	}
+	if (IsKeyHeld(GLFW_KEY_S) == true)
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+	}
+
+	// Process camera panning left and right
+	if (IsKeyHeld(GLFW_KEY_A) == true)
+	{
+		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+	}
+	if (IsKeyHeld(GLFW_KEY_D) == true)
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+	}
+
+	// Camera moves up and down using Q and E
+	if (IsKeyHeld(GLFW_KEY_Q) == true)
+	{
+		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+	}
+	if (IsKeyHeld(GLFW_KEY_E) == true)
+	{
+		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+	}
+	// change between different projection views
+	if (IsKeyHeld(GLFW_KEY_O) == true)
+	{
+		// change to a multi-view orthographic projection
+		bOrthographicProjection = true;
+		bQuadView = false;
+
+		// change the camera settings to show a front orthographic view
+		g_pCamera->Position = glm::vec3(0.0f, 4.0f, 10.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+	if (IsKeyHeld(GLFW_KEY_2) == true)
+	{
+		// change to a multi-view orthographic projection
+		bOrthographicProjection = true;
+		bQuadView = false;
+
+		// change the camera settings to show a side orthographic view
+		g_pCamera->Position = glm::vec3(10.0f, 4.0f, 0.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Front = glm::vec3(-1.0f, 0.0f, 0.0f);
+	}
+	if (IsKeyHeld(GLFW_KEY_3) == true)
+	{
+		// change to a multi-view orthographic projection
+		bOrthographicProjection = true;
+		bQuadView = false;
+
+		// change the camera settings to show a top orthographic view
+		g_pCamera->Position = glm::vec3(0.0f, 7.0f, 0.0f);
+		g_pCamera->Up = glm::vec3(-1.0f, 0.0f, 0.0f);
+		g_pCamera->Front = glm::vec3(0.0f, -1.0f, 0.0f);
+	}
+	if (IsKeyHeld(GLFW_KEY_P) == true)
+	{
+		// change to perspective projection
+		bOrthographicProjection = false;
+		bQuadView = false;
+
+		// change the camera settings to show a perspective view
+		g_pCamera->Position = glm::vec3(0.0f, 5.5f, 8.0f);
+		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Zoom = 80;
+	}
+	if (IsKeyHeld(GLFW_KEY_4) == true)
+	{
+		// draw the perspective camera and the three orthographic
+		// views together, one in each quarter of the window
+		bOrthographicProjection = false;
+		bQuadView = true;
+	}
+}
+	
+	
+
+/***********************************************************
+ *  AddView()
+ *
+ *  This method is used for adding a view to the ones drawn
+ *  in the current frame.
+ ***********************************************************/
+void ViewManager::AddView(glm::mat4 view, glm::mat4 projection, glm::vec3 position, glm::vec4 rect)
+{
+	if (m_viewCount >= ShaderVariants::MAX_VIEWS)
+	{
+		return;
+	}
+
+	m_viewProjections[m_viewCount] = projection * view;
+	m_viewRects[m_viewCount] = rect;
+	m_viewPositions[m_viewCount] = position;
+	m_viewCount++;
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// per-frame timing
+	float currentFrame = glfwGetTime();
+	gDeltaTime = currentFrame - gLastFrame;
+	gLastFrame = currentFrame;
+
+	// the camera keys are read from the keyboard, or from the
+	// recording along with the cursor and scroll events that
+	// arrived before the recorded frame
+	m_lastHeldKeys = m_heldKeys;
+	m_heldKeys = 0;
+	if ((NULL != g_pInputRecorder) && (g_pInputRecorder->IsReplaying() == true))
+	{
+		const InputRecorder::INPUT_EVENT* pEvents = NULL;
+		int eventCount = 0;
+		if (g_pInputRecorder->ReplayFrame(m_heldKeys, pEvents, eventCount) == false)
+		{
+			// every recorded frame was replayed
+			glfwSetWindowShouldClose(m_pWindow, true);
+		}
+		for (int i = 0; i < eventCount; i++)
+		{
+			if (pEvents[i].type == InputRecorder::INPUT_CURSOR)
+			{
+				ApplyCursorPosition(pEvents[i].x, pEvents[i].y);
+			}
+			else
+			{
+				ApplyScroll(pEvents[i].y);
+			}
+		}
+	}
+	else
+	{
+		for (int i = 0; i < CAMERA_KEY_COUNT; i++)
+		{
+			if (glfwGetKey(m_pWindow, g_CameraKeys[i]) == GLFW_PRESS)
+			{
+				m_heldKeys |= (1u << i);
+			}
+		}
+		if (NULL != g_pInputRecorder)
+		{
+			g_pInputRecorder->RecordFrame(currentFrame, m_heldKeys);
+		}
+	}
+
+	// recorded and replayed frames move the camera by the same
+	// fixed time, so the replay follows the recorded path at
+	// any frame rate
+	if ((NULL != g_pInputRecorder) &&
+		((g_pInputRecorder->IsRecording() == true) || (g_pInputRecorder->IsReplaying() == true)))
+	{
+		gDeltaTime = g_pInputRecorder->GetTimestep();
+	}
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	ProcessKeyboardEvents();
+
+	if (NULL != g_pInputRecorder)
+	{
+		if (g_pInputRecorder->IsRecording() == true)
+		{
+			g_pInputRecorder->RecordCamera(GetCameraState());
+		}
+		else if (g_pInputRecorder->IsReplaying() == true)
+		{
+			g_pInputRecorder->CheckCamera(GetCameraState());
+		}
+	}
+
+	// get the current view matrix from the camera
+	view = g_pCamera->GetViewMatrix();
+
+	// the aspect ratio follows the framebuffer, and the last
+	// one is kept while the window is minimized - each quarter
+	// of the quad view has the same aspect ratio as the window
+	static GLfloat aspect = (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT;
+	if ((g_framebufferWidth > 0) && (g_framebufferHeight > 0))
+	{
+		aspect = (GLfloat)g_framebufferWidth / (GLfloat)g_framebufferHeight;
+	}
+
+	// define the current projection matrix
+	if (bOrthographicProjection == false)
+	{
+		// perspective projection
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspect, 0.1f, 100.0f);
+	}
+	else
+	{
+		// front-view orthographic projection with correct aspect ratio
+		projection = MakeOrthographic(aspect);
+	}
+
+	m_viewCount = 0;
+	if (bQuadView == false)
+	{
+		AddView(view, projection, g_pCamera->Position, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+	}
+	else
+	{
+		// the camera fills the top left quarter, and the front,
+		// side and top orthographic views the other three - all
+		// four are drawn by the same draw commands
+		glm::mat4 orthographic = MakeOrthographic(aspect);
+		glm::vec3 frontPosition = glm::vec3(0.0f, 4.0f, 10.0f);
+		glm::vec3 sidePosition = glm::vec3(10.0f, 4.0f, 0.0f);
+		glm::vec3 topPosition = glm::vec3(0.0f, 7.0f, 0.0f);
+
+		AddView(view, projection, g_pCamera->Position, glm::vec4(0.5f, 0.5f, -0.5f, 0.5f));
+		AddView(
+			glm::lookAt(frontPosition, frontPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+			orthographic, frontPosition, glm::vec4(0.5f, 0.5f, 0.5f, 0.5f));
+		AddView(
+			glm::lookAt(sidePosition, sidePosition + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+			orthographic, sidePosition, glm::vec4(0.5f, 0.5f, -0.5f, -0.5f));
+		AddView(
+			glm::lookAt(topPosition, topPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f)),
+			orthographic, topPosition, glm::vec4(0.5f, 0.5f, 0.5f, -0.5f));
+	}
+
+	// the view values are set into the shader variants by the
+	// render thread, with the frame packet they belong to
+}
+
+/***********************************************************
+ *  SetInputRecorder()
+ *
+ *  This method is used for setting the recorder the camera
+ *  input is written to or replayed from.
+ ***********************************************************/
+void ViewManager::SetInputRecorder(InputRecorder* pInputRecorder)
+{
+	g_pInputRecorder = pInputRecorder;
+}
+
+/***********************************************************
+ *  GetViewCount()
+ *
+ *  This method is used for getting the number of views
+ *  drawn in the current frame.
+ ***********************************************************/
+int ViewManager::GetViewCount()
+{
+	return(m_viewCount);
+}
+
+/***********************************************************
+ *  GetViewProjections()
+ *
+ *  This method is used for getting the projection times
+ *  view matrix of each view of the current frame.
+ ***********************************************************/
+const glm::mat4* ViewManager::GetViewProjections()
+{
+	return(m_viewProjections);
+}
+
+/***********************************************************
+ *  GetViewRects()
+ *
+ *  This method is used for getting the part of the target
+ *  each view of the current frame covers.
+ ***********************************************************/
+const glm::vec4* ViewManager::GetViewRects()
+{
+	return(m_viewRects);
+}
+
+/***********************************************************
+ *  GetViewPositions()
+ *
+ *  This method is used for getting the camera position of
+ *  each view of the current frame.
+ ***********************************************************/
+const glm::vec3* ViewManager::GetViewPositions()
+{
+	return(m_viewPositions);
+}
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  This method is used for getting the position of the
+ *  camera in the current frame.
+ ***********************************************************/
+glm::vec3 ViewManager::GetViewPosition()
+{
+	return(g_pCamera->Position);
+}
+
+/***********************************************************
+ *  GetFramebufferSize()
+ *
+ *  This method is used for getting the current size of the
+ *  window's framebuffer in pixels.
+ ***********************************************************/
+void ViewManager::GetFramebufferSize(int& width, int& height)
+{
+	width = g_framebufferWidth;
+	height = g_framebufferHeight;
 }
\ No newline at end of file
@@ -1,45 +1,80 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "camera.h"
-
-// GLFW library
-#include "GLFW/glfw3.h" 
-
-class ViewManager
-{
-public:
-	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
-	// destructor
-	~ViewManager();
-
-	// mouse position callback for mouse interaction with the 3D scene
-	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
-	static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// active OpenGL display window
-	GLFWwindow* m_pWindow;
-
-	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
-
-public:
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
-	
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderVariants.h"
+#include "InputRecorder.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderVariants* pShaderVariants);
+	// destructor
+	~ViewManager();
+
+	// mouse position callback for mouse interaction with the 3D scene
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+	// framebuffer size callback for following the window size
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+private:
+	// pointer to shader variants object
+	ShaderVariants* m_pShaderVariants;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// views drawn in the current frame - one, or four in the
+	// quad view
+	int m_viewCount;
+	glm::mat4 m_viewProjections[ShaderVariants::MAX_VIEWS];
+	// part of the target each view covers, as a scale and an
+	// offset in normalized device coordinates
+	glm::vec4 m_viewRects[ShaderVariants::MAX_VIEWS];
+	glm::vec3 m_viewPositions[ShaderVariants::MAX_VIEWS];
+	// camera keys held in the current frame, one bit per key,
+	// read from the keyboard or from a replayed recording
+	unsigned int m_heldKeys;
+	// the keys held in the last frame, for the key presses
+	unsigned int m_lastHeldKeys;
+
+	// check whether a camera key is held in the current frame
+	bool IsKeyHeld(int key);
+	// process keyboard events for interaction with the 3D scene
+	void ProcessKeyboardEvents();
+	// add a view to the current frame
+	void AddView(glm::mat4 view, glm::mat4 projection, glm::vec3 position, glm::vec4 rect);
+
+public:
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	// set the recorder the camera input is written to or
+	// replayed from, or NULL for live input only
+	void SetInputRecorder(InputRecorder* pInputRecorder);
+	
+	// prepare the conversion from 3D object display to 2D scene display
+	void PrepareSceneView();
+
+	// get the views of the current frame - the first one is
+	// the camera the user moves
+	int GetViewCount();
+	const glm::mat4* GetViewProjections();
+	const glm::vec4* GetViewRects();
+	const glm::vec3* GetViewPositions();
+	glm::vec3 GetViewPosition();
+	// get the size of the window's framebuffer in pixels
+	void GetFramebufferSize(int& width, int& height);
+	// check whether a camera key went down in the current frame
+	bool IsKeyPressed(int key);
 };
\ No newline at end of file